@@ -0,0 +1,50 @@
+#ifndef BACKLIGHT_H
+#define BACKLIGHT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// ============================================================================
+// Backlight
+// ============================================================================
+//
+// Levels are perceptual percentages (0-100). A gamma LUT maps them onto a
+// 10-bit LEDC duty so equal steps look equal, and changes run on the LEDC
+// hardware fade engine: the CPU starts a fade and is not involved again
+// until the next one (the loop is free to sleep meanwhile).
+//
+// A view change dips the backlight briefly while the new view draws; the
+// restore is scheduled from lcd_update(). backlight_curve_percent() gives
+// the automatic level for a time of day, interpolated between the points
+// of a fixed curve in backlight.c.
+
+#define BACKLIGHT_GAMMA             2.2f
+#define BACKLIGHT_FADE_MS           250     // Default for lcd_set_backlight()
+#define BACKLIGHT_TRANSITION_MS     1500    // Larger automatic jumps (boot, manual to auto)
+#define BACKLIGHT_DIP_PERCENT       40      // View change: dip to this share of the level
+#define BACKLIGHT_DIP_MS            90      // ...for this long each way
+
+// LEDC set-up; starts dark (the first backlight_set fades in)
+esp_err_t backlight_init(void);
+
+// Fade to percent over fade_ms (0 = at once). Replaces any fade in progress.
+void backlight_set(uint8_t percent, uint32_t fade_ms);
+
+// Brief dip for a view change (no-op while dark or already dipped)
+void backlight_dip(void);
+
+// Start the restore once a dip is over. Returns ms until it needs calling
+// again (UINT32_MAX when nothing is pending).
+uint32_t backlight_update(void);
+
+// Last requested level
+uint8_t backlight_get(void);
+
+// Off for deep sleep: stops PWM and holds the pin low
+void backlight_sleep(void);
+
+// Automatic level for minutes since local midnight (0-1439)
+uint8_t backlight_curve_percent(int minute_of_day);
+
+#endif // BACKLIGHT_H
@@ -0,0 +1,76 @@
+#ifndef BOOT_PIPELINE_H
+#define BOOT_PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// ============================================================================
+// Boot Pipeline
+// ============================================================================
+//
+// Boot is a small dependency graph instead of one long sequence. Each stage
+// lists the stages it needs; stages that touch LVGL run on the main task in
+// table order, the rest get a short-lived task that starts as soon as its
+// dependencies are done. A stage that fails (e.g. WiFi falling back to AP
+// mode) makes everything depending on it fail without running.
+//
+// Stages can also be completed from outside (boot_stage_done), which is how
+// "first live departure" is marked from the fetch callback.
+//
+// Start and end times (us since reset) are kept for /api/boot and /metrics.
+
+typedef enum {
+    BOOT_STAGE_LCD = 0,         // Panel, LVGL, cached views, splash screen
+    BOOT_STAGE_STORAGE,         // NVS and settings
+    BOOT_STAGE_NETIF,           // esp_netif / WiFi driver init
+    BOOT_STAGE_WIFI,            // Association + DHCP (fails into AP mode)
+    BOOT_STAGE_TFNSW,           // TfNSW client, API key
+    BOOT_STAGE_SPLASH,          // Splash animation
+    BOOT_STAGE_SD,              // SD card and log writer
+    BOOT_STAGE_DNS,             // API host pre-resolved into the lwIP cache
+    BOOT_STAGE_TIME,            // SNTP (gives up waiting after a few seconds)
+    BOOT_STAGE_SERVICES,        // Web server, LAN sync
+    BOOT_STAGE_FIRST_FETCH,     // First TfNSW request started
+    BOOT_STAGE_FIRST_DEPARTURE, // First live departures handed to the display
+    BOOT_STAGE_COUNT
+} boot_stage_id_t;
+
+#define BOOT_DEP(stage)     (1u << (stage))
+
+typedef struct {
+    boot_stage_id_t id;
+    esp_err_t (*run)(void);     // NULL: completed with boot_stage_done()
+    uint32_t deps;              // BOOT_DEP() mask
+    bool main_task;             // Run inline on the calling (LVGL) task
+} boot_stage_t;
+
+typedef enum {
+    BOOT_STATE_PENDING = 0,
+    BOOT_STATE_RUNNING,
+    BOOT_STATE_DONE,
+    BOOT_STATE_FAILED,          // Failed, or a dependency failed
+} boot_state_t;
+
+typedef struct {
+    boot_state_t state;
+    int64_t start_us;
+    int64_t end_us;
+    esp_err_t result;
+} boot_stage_info_t;
+
+// Start background stages and run the main-task ones in order. Returns once
+// every main-task stage has finished; background stages keep going.
+esp_err_t boot_pipeline_run(const boot_stage_t *stages, int count);
+
+// Complete a stage that has no run function (first call wins)
+void boot_stage_done(boot_stage_id_t id, esp_err_t result);
+
+// Wait for stages in mask to finish; true if all of them succeeded
+bool boot_wait(uint32_t mask, uint32_t timeout_ms);
+
+bool boot_stage_is_done(boot_stage_id_t id);
+void boot_get_stage(boot_stage_id_t id, boot_stage_info_t *out);
+const char* boot_stage_name(boot_stage_id_t id);
+
+#endif // BOOT_PIPELINE_H
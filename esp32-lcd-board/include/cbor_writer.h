@@ -0,0 +1,42 @@
+#ifndef CBOR_WRITER_H
+#define CBOR_WRITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+// ============================================================================
+// Streaming CBOR Writer (RFC 8949)
+// ============================================================================
+//
+// Binary counterpart to json_writer: items go into a small buffer that is
+// flushed with httpd_resp_send_chunk(). Maps and arrays are definite-length,
+// so the caller passes the item count up front (a map of n pairs is followed
+// by 2n items, key then value).
+
+#define CBOR_WRITER_BUF  256
+
+typedef struct {
+    httpd_req_t *req;
+    esp_err_t err;                          // First send error (sticky)
+    uint16_t len;
+    uint8_t buf[CBOR_WRITER_BUF];
+} cbor_writer_t;
+
+// Start an application/cbor response (lives on the handler's stack)
+void cw_begin(cbor_writer_t *w, httpd_req_t *req);
+
+// Flush and terminate the chunked response; returns the first error seen
+esp_err_t cw_finish(cbor_writer_t *w);
+
+void cw_map(cbor_writer_t *w, uint32_t pairs);
+void cw_array(cbor_writer_t *w, uint32_t items);
+
+void cw_text(cbor_writer_t *w, const char *value);   // NULL encodes as null
+void cw_uint(cbor_writer_t *w, uint64_t value);
+void cw_int(cbor_writer_t *w, int64_t value);
+void cw_bool(cbor_writer_t *w, bool value);
+void cw_null(cbor_writer_t *w);
+
+#endif // CBOR_WRITER_H
@@ -51,10 +51,16 @@
 #define SD_PIN_CLK 7  // Shared with LCD
 #define SD_PIN_CS 4   // SD card chip select
 #define SD_MOUNT_POINT "/sdcard"
+#define SD_CARD_ENABLED 1           // Bus access is arbitrated with the LCD (spi_arbiter.h)
+#define SD_SPI_FREQ_KHZ 20000
+#ifndef SD_LOG_TEST_ENABLED
+#define SD_LOG_TEST_ENABLED 0       // Bench builds: -DSD_LOG_TEST_ENABLED=1 adds the "sd_log_test" command
+#endif
 
 // SD Card file paths (relative to mount point)
 #define SETTINGS_FILE "/config.json"
 #define LOG_FILE "/system.log"
+#define LOG_FILE_OLD "/system.old"    // Previous log after rotation
 #define DEPARTURES_FILE "/departures.json"
 
 // ============================================================================
@@ -62,6 +68,13 @@
 // ============================================================================
 #define RGB_LED_PIN 8
 
+// ============================================================================
+// LED Strip (optional WS2812 chain showing a departure timeline)
+// ============================================================================
+#define LED_STRIP_ENABLED 0         // Set to 1 when a strip is wired up
+#define LED_STRIP_PIN 2
+#define LED_STRIP_LEN 16
+
 // ============================================================================
 // Button Configuration (BOOT button on ESP32-C6)
 // ============================================================================
@@ -81,6 +94,7 @@
 #define NVS_NAMESPACE "wifi_creds"
 #define NVS_KEY_SSID "ssid"
 #define NVS_KEY_PASS "password"
+#define NVS_KEY_FAST_CONN "fast_conn"     // Last AP BSSID/channel (wifi_manager.c)
 
 // ============================================================================
 // Web Server
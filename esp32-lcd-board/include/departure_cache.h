@@ -0,0 +1,59 @@
+#ifndef DEPARTURE_CACHE_H
+#define DEPARTURE_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "tfnsw_client.h"
+
+// ============================================================================
+// Persistent Departure Cache
+// ============================================================================
+//
+// Last good departures per stop, kept on the "storage" partition (SPIFFS,
+// mounted at /storage) so a reboot can show real, age-marked departures
+// before WiFi is up. One file per stop:
+//
+//   header   magic "DBDC", u8 format, u8 codec (LAN_PROTO_VERSION),
+//            u16 payload length, u32 CRC32 over header + payload
+//   payload  lan_encode_snapshot() frame
+//
+// Files with a bad CRC or another format/codec version are deleted on load.
+// Saves write <file>.tmp and rename it over the old file; if a reset leaves
+// only the .tmp, load picks it up.
+// Writes are rate limited per stop to DEPARTURES_CACHE_WRITE_INTERVAL_MS.
+
+#ifndef DEPARTURES_CACHE_BASE_PATH
+#define DEPARTURES_CACHE_BASE_PATH          "/storage"      // Host tests point it elsewhere
+#endif
+#define DEPARTURES_CACHE_PARTITION          "storage"
+#define DEPARTURES_CACHE_FORMAT             1
+#define DEPARTURES_CACHE_WRITE_INTERVAL_MS  (5 * 60 * 1000)
+#define DEPARTURES_CACHE_MAX_AGE_S          (3 * 60 * 60)   // Older files are ignored
+
+// Mount the storage partition. An unformatted partition is formatted by a
+// background task and this returns ESP_ERR_NOT_FINISHED (nothing to load yet).
+esp_err_t departures_cache_init(void);
+
+// Persist a successful fetch for stop_id. Returns ESP_OK when written or
+// skipped by the rate limit.
+esp_err_t departures_cache_save(const char* stop_id, const tfnsw_departures_t* departures);
+
+// Load stop_id's snapshot marked as cached: status SUCCESS_CACHED, stale,
+// and data_age_seconds set (-1 while the clock is unsynced). Departures
+// already gone are dropped. ESP_ERR_NOT_FOUND if there is no file,
+// ESP_ERR_TIMEOUT if it is too old to be useful.
+esp_err_t departures_cache_load(const char* stop_id, tfnsw_departures_t* out_departures);
+
+// Apply the load-time marking above to departures kept elsewhere (e.g. RTC
+// memory across deep sleep), with their own age limit. ESP_ERR_TIMEOUT if
+// they are too old or nothing is left.
+esp_err_t departures_cache_mark(tfnsw_departures_t* departures, int64_t max_age_s);
+
+// Check if a usable snapshot exists for stop_id
+bool departures_cache_is_valid(const char* stop_id);
+
+// Delete every cached snapshot
+esp_err_t departures_cache_clear(void);
+
+#endif // DEPARTURE_CACHE_H
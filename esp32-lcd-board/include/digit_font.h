@@ -0,0 +1,22 @@
+#ifndef DIGIT_FONT_H
+#define DIGIT_FONT_H
+
+#include "lvgl.h"
+
+// ============================================================================
+// Tabular Digit Fonts
+// ============================================================================
+//
+// Countdowns change every minute, and with proportional digits "11 min"
+// and "10 min" differ in width, so the label (and what is right-aligned to
+// it) shifts. digit_font() returns a copy of a font whose '0'..'9' glyphs
+// all take the widest digit's advance, centred within it. Those ten glyph
+// descriptors are looked up once when the copy is made; a digit then costs
+// an array index instead of the font's cmap search. Every other character
+// goes to the base font unchanged.
+
+// Tabular-digit variant of base (base itself if it can't be made). Call
+// from the LVGL task; the copy lives for the life of the program.
+const lv_font_t* digit_font(const lv_font_t* base);
+
+#endif // DIGIT_FONT_H
@@ -0,0 +1,56 @@
+#ifndef DISPLAY_MIRROR_H
+#define DISPLAY_MIRROR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+// ============================================================================
+// Display Mirror (/ws/display)
+// ============================================================================
+//
+// Every area sent to the panel is run-length encoded and streamed to WebSocket
+// viewers as binary frames. There is no shadow framebuffer: a viewer starts
+// from a full-screen repaint and then follows the dirty rectangles.
+//
+// Stream records (little-endian u16 fields):
+//   MIRROR_REC_HELLO  u8 type, u16 width, u16 height, u8 format
+//   MIRROR_REC_RECT   u8 type, u16 x, u16 y, u16 w, u16 h, RLE pixel data
+//
+// Pixels are 16-bit exactly as sent to the panel (format 0: big-endian RGB565
+// in the panel's BGR element order). RLE is PackBits over pixels: a control
+// byte c >= 0x80 repeats the next pixel (c & 0x7F) + 1 times, c < 0x80 is
+// followed by c + 1 literal pixels. A record ends once w * h pixels are decoded.
+
+#define MIRROR_REC_HELLO        0x01
+#define MIRROR_REC_RECT         0x02
+#define MIRROR_FORMAT_RGB565_BE 0
+
+#define MIRROR_MAX_CLIENTS      2
+#define MIRROR_INTERVAL_MS      50          // Sender period (max 20 frames/s)
+#define MIRROR_BYTES_PER_SEC    (160 * 1024) // Encoded byte budget per second
+
+// Start the sender task (buffers live only while a viewer is connected)
+esp_err_t display_mirror_init(void);
+
+// Register a viewer socket after the WebSocket handshake
+esp_err_t display_mirror_add_client(httpd_handle_t hd, int fd);
+
+// Forget a viewer whose socket closed (call from the server's close_fn before
+// the fd can be reused). Buffers are freed once the last viewer is gone.
+void display_mirror_remove_client(int fd);
+
+// True while at least one viewer is connected
+bool display_mirror_active(void);
+
+// Encode a panel transfer (x2/y2 exclusive, pixels in panel wire format).
+// Called from the LCD flush path; never blocks. Areas that do not fit the
+// budget are dropped and reported through display_mirror_take_resync().
+void display_mirror_feed(int x1, int y1, int x2, int y2, const void *pixels);
+
+// Area viewers missed (or the full screen for a new viewer), x2/y2 exclusive.
+// Returns true at most once per budget refill; the LCD driver repaints it.
+bool display_mirror_take_resync(int *x1, int *y1, int *x2, int *y2);
+
+#endif // DISPLAY_MIRROR_H
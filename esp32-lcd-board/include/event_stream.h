@@ -0,0 +1,41 @@
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "tfnsw_client.h"
+
+// ============================================================================
+// Server-Sent Events (/api/events)
+// ============================================================================
+//
+// Each topic is formatted once per change into a compact JSON object whose
+// keys match /api/status, then the same bytes go to every client. Topics that
+// have not changed since the last message are not sent again.
+
+// Topics (bit mask for event_stream_publish)
+#define EVENT_TOPIC_VIEW    (1U << 0)   // "view":       current view
+#define EVENT_TOPIC_TFNSW   (1U << 1)   // "tfnsw":      fetch status + view's departures
+#define EVENT_TOPIC_WIFI    (1U << 2)   // "wifi":       connection, rssi, ip
+#define EVENT_TOPIC_HEAP    (1U << 3)   // "heap":       free / min free heap
+#define EVENT_TOPIC_ALL     0x0F
+
+#define EVENT_STREAM_MAX_CLIENTS  3
+#define EVENT_STREAM_POLL_MS      1000  // Polled topics (wifi, heap) check rate
+
+// Start the stream task
+esp_err_t event_stream_init(void);
+
+// Take over an /api/events request (sends headers, then streams asynchronously)
+esp_err_t event_stream_add_client(httpd_req_t *req);
+
+// Mark topics changed; safe from any task, never blocks
+void event_stream_publish(uint32_t topics);
+
+// The "tfnsw" object, shared with /api/status: the view on screen's first
+// departures and the status of its last fetch. deps is the caller's scratch
+// (it is large). Returns the length; >= size means buf was too small.
+int event_stream_format_tfnsw(char *buf, int size, tfnsw_departures_t *deps);
+
+#endif // EVENT_STREAM_H
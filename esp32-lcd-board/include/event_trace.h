@@ -0,0 +1,43 @@
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+// ============================================================================
+// Binary Event Tracer (/api/trace)
+// ============================================================================
+//
+// Ring of 16-byte events (begin, end, instant) stamped with the calling task
+// and a microsecond timestamp. Recording is lock-free like log_ring: one
+// atomic add reserves a slot and a sequence stamp publishes it. Names must
+// be string literals; they are interned into a small table on first use.
+//
+// GET /api/trace streams the ring as Chrome Trace Event JSON, which loads
+// straight into Perfetto (ui.perfetto.dev) or chrome://tracing.
+
+#define TRACE_RING_SIZE     512     // Events, power of two (8 KB)
+#define TRACE_MAX_NAMES     32
+#define TRACE_MAX_TASKS     16
+
+// Open a span on the calling task; spans nest per task
+void trace_begin(const char *name);
+
+// Close the innermost span; arg shows up in the span's args
+void trace_end(const char *name, uint32_t arg);
+
+// Point event
+void trace_instant(const char *name, uint32_t arg);
+
+// Record a span after the fact (for work that is only interesting once it
+// is known to have done something, e.g. a frame that flushed pixels)
+void trace_span(const char *name, int64_t start_us, uint32_t arg);
+
+// Drop everything recorded so far
+void trace_clear(void);
+
+// /api/trace: Chrome Trace Event JSON of the current ring
+esp_err_t trace_export(httpd_req_t *req);
+
+#endif // EVENT_TRACE_H
@@ -0,0 +1,50 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+// ============================================================================
+// Streaming JSON Writer
+// ============================================================================
+//
+// Emits JSON straight into a small buffer that is flushed to the response
+// with httpd_resp_send_chunk(), so handlers never build a cJSON tree. Output
+// matches cJSON_PrintUnformatted() (or cJSON_Print() with pretty set) for the
+// same sequence of calls. Keys are ignored inside arrays.
+
+#define JSON_WRITER_BUF        256
+#define JSON_WRITER_MAX_DEPTH  8
+
+typedef struct {
+    httpd_req_t *req;
+    esp_err_t err;                          // First send error (sticky)
+    bool pretty;                            // cJSON_Print layout
+    uint8_t depth;
+    bool in_array[JSON_WRITER_MAX_DEPTH];
+    bool has_items[JSON_WRITER_MAX_DEPTH];
+    uint16_t len;
+    char buf[JSON_WRITER_BUF];
+} json_writer_t;
+
+// Start an application/json response (lives on the handler's stack)
+void jw_begin(json_writer_t *w, httpd_req_t *req, bool pretty);
+
+// Flush and terminate the chunked response; returns the first error seen
+esp_err_t jw_finish(json_writer_t *w);
+
+void jw_object_begin(json_writer_t *w, const char *key);
+void jw_object_end(json_writer_t *w);
+void jw_array_begin(json_writer_t *w, const char *key);
+void jw_array_end(json_writer_t *w);
+
+void jw_string(json_writer_t *w, const char *key, const char *value);
+void jw_number(json_writer_t *w, const char *key, double value);
+void jw_bool(json_writer_t *w, const char *key, bool value);
+
+// A value already formatted as compact JSON, written as is (cJSON_CreateRaw)
+void jw_raw(json_writer_t *w, const char *key, const char *json, size_t len);
+
+#endif // JSON_WRITER_H
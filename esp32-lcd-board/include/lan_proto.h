@@ -0,0 +1,156 @@
+#ifndef LAN_PROTO_H
+#define LAN_PROTO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "tfnsw_client.h"
+
+// ============================================================================
+// LAN Sync Protocol (v1)
+// ============================================================================
+//
+// One board (the hub) fetches from TfNSW; followers hold a TCP connection
+// to it (found over mDNS as _depboard._tcp) and receive snapshots for the
+// stop they are showing. Everything here is transport-free so both ends
+// can be driven on a host; lan_sync.c owns the sockets and tasks.
+//
+// Framing, all integers little-endian:
+//   u16 length     bytes that follow (type + payload)
+//   u8  type       lan_msg_type_t
+//   ...            payload
+//
+// Messages:
+//   HELLO      both ways, first frame    u32 magic "DBLS", u8 version, u32 node id
+//   SUBSCRIBE  follower -> hub           str stop_id, u32 version held (0 = none)
+//              Also the follower's keepalive: it renews the lease every
+//              LAN_SUBSCRIBE_MS and the hub drops it after LAN_LEASE_MS.
+//   SNAPSHOT   hub -> follower           see lan_encode_snapshot()
+//              Sent when the stop's version differs from the follower's.
+//   PING       hub -> follower           empty; sent when idle for LAN_PING_MS
+//
+// str = u8 length + bytes (no terminator). A follower that hears nothing
+// for LAN_HUB_TIMEOUT_MS drops the connection; after LAN_FAILOVER_MS
+// without a hub it fetches for itself until a hub is back.
+
+#define LAN_PROTO_MAGIC         0x534C4244u     // "DBLS"
+#define LAN_PROTO_VERSION       1
+#define LAN_FRAME_MAX           3584            // Worst-case SNAPSHOT is ~3.2 KB
+#define LAN_SMALL_FRAME_MAX     64              // Anything but SNAPSHOT
+
+#define LAN_SUBSCRIBE_MS        10000
+#define LAN_LEASE_MS            30000
+#define LAN_PING_MS             5000
+#define LAN_HUB_TIMEOUT_MS      15000
+#define LAN_FAILOVER_MS         10000
+#define LAN_DISCOVER_MS         5000            // Retry interval while no hub
+
+typedef enum {
+    LAN_MSG_HELLO = 1,
+    LAN_MSG_SUBSCRIBE = 2,
+    LAN_MSG_SNAPSHOT = 3,
+    LAN_MSG_PING = 4,
+} lan_msg_type_t;
+
+// ============================================================================
+// Codec
+// ============================================================================
+
+// Encoders write a whole frame and return its size, or 0 if cap is too small
+size_t lan_encode_hello(uint8_t *buf, size_t cap, uint32_t node_id);
+size_t lan_encode_subscribe(uint8_t *buf, size_t cap, const char *stop_id, uint32_t have_version);
+size_t lan_encode_snapshot(uint8_t *buf, size_t cap, const char *stop_id, uint32_t version,
+                           const tfnsw_departures_t *deps);
+size_t lan_encode_ping(uint8_t *buf, size_t cap);
+
+// Decoders take the payload after the type byte
+bool lan_decode_hello(const uint8_t *p, size_t len, uint32_t *node_id);
+bool lan_decode_subscribe(const uint8_t *p, size_t len, char *stop_id, size_t stop_size,
+                          uint32_t *have_version);
+bool lan_decode_snapshot(const uint8_t *p, size_t len, char *stop_id, size_t stop_size,
+                         uint32_t *version, tfnsw_departures_t *out);
+
+// Stream reassembly: append received bytes at buf + len, then call
+// lan_rx_next() until it returns 0
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t len;
+    size_t consumed;        // Bytes of the frame returned last time
+} lan_rx_t;
+
+void lan_rx_init(lan_rx_t *rx, uint8_t *buf, size_t cap);
+
+// 1 = frame ready (payload valid until the next call), 0 = need more
+// bytes, -1 = malformed or oversized frame (drop the connection)
+int lan_rx_next(lan_rx_t *rx, uint8_t *type, const uint8_t **payload, size_t *len);
+
+// ============================================================================
+// Follower State Machine
+// ============================================================================
+
+typedef enum {
+    LAN_FOLLOWER_SEARCHING = 0,     // No hub; looking for one
+    LAN_FOLLOWER_CONNECTED,         // Hub connected, HELLO not seen yet
+    LAN_FOLLOWER_FOLLOWING,         // Receiving snapshots
+} lan_follower_state_t;
+
+// Actions returned to the transport (bitmask)
+#define LAN_ACT_SEND_HELLO      (1u << 0)
+#define LAN_ACT_SEND_SUBSCRIBE  (1u << 1)
+#define LAN_ACT_DISCONNECT      (1u << 2)   // Close the hub connection
+#define LAN_ACT_DISCOVER        (1u << 3)   // Look for a hub and connect
+#define LAN_ACT_START_FALLBACK  (1u << 4)   // Fetch locally with tfnsw_client
+#define LAN_ACT_STOP_FALLBACK   (1u << 5)
+#define LAN_ACT_DELIVER         (1u << 6)   // Active stop's snapshot is in *out
+#define LAN_ACT_SEND_SNAPSHOT   (1u << 7)   // Hub only
+#define LAN_ACT_SEND_PING       (1u << 8)   // Hub only
+#define LAN_ACT_WATCH           (1u << 9)   // Hub only: keep fetching peer's stop
+
+typedef struct {
+    lan_follower_state_t state;
+    char stop_id[16];               // Stop being shown ("" = none)
+    uint32_t have_version;          // Hub version of the snapshot we hold
+    uint32_t hub_id;
+    uint32_t last_rx_ms;
+    uint32_t last_sub_ms;
+    uint32_t lost_ms;               // When the hub went away
+    uint32_t last_discover_ms;
+    bool fallback;                  // Fetching locally
+} lan_follower_t;
+
+void lan_follower_init(lan_follower_t *f, uint32_t now_ms);
+uint32_t lan_follower_connected(lan_follower_t *f, uint32_t now_ms);
+uint32_t lan_follower_disconnected(lan_follower_t *f, uint32_t now_ms);
+uint32_t lan_follower_set_stop(lan_follower_t *f, const char *stop_id, uint32_t now_ms);
+uint32_t lan_follower_on_frame(lan_follower_t *f, uint8_t type, const uint8_t *payload,
+                               size_t len, uint32_t now_ms, tfnsw_departures_t *out);
+uint32_t lan_follower_tick(lan_follower_t *f, uint32_t now_ms);
+
+// ============================================================================
+// Hub Per-Follower State
+// ============================================================================
+
+typedef struct {
+    bool hello;                     // Follower's HELLO seen
+    uint32_t node_id;
+    char stop_id[16];               // Subscribed stop ("" = none yet)
+    uint32_t sent_version;          // Version the follower holds
+    uint32_t lease_until_ms;
+    uint32_t last_tx_ms;
+} lan_hub_peer_t;
+
+void lan_hub_peer_init(lan_hub_peer_t *p, uint32_t now_ms);
+
+// HELLO must come first (else DISCONNECT); SUBSCRIBE renews the lease and
+// returns WATCH so the transport can call tfnsw_watch_stop()
+uint32_t lan_hub_peer_on_frame(lan_hub_peer_t *p, uint8_t type, const uint8_t *payload,
+                               size_t len, uint32_t now_ms);
+
+// current_version is the hub's snapshot version for p->stop_id (0 = none)
+uint32_t lan_hub_peer_tick(lan_hub_peer_t *p, uint32_t current_version, uint32_t now_ms);
+
+// Call after a SNAPSHOT or PING frame was sent
+void lan_hub_peer_sent(lan_hub_peer_t *p, uint32_t version, uint32_t now_ms);
+
+#endif // LAN_PROTO_H
@@ -0,0 +1,50 @@
+#ifndef LAN_SYNC_H
+#define LAN_SYNC_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "tfnsw_client.h"
+
+// ============================================================================
+// LAN Hub / Follower
+// ============================================================================
+//
+// Optional role so several boards in one place share a single set of TfNSW
+// fetches. The hub runs the normal fetch engine, advertises itself over
+// mDNS and streams snapshots to followers; followers make no TfNSW
+// requests while a hub is reachable. Protocol details are in lan_proto.h.
+
+#define LAN_SYNC_PORT           47710
+#define LAN_SYNC_MAX_PEERS      4               // Followers per hub
+#define LAN_SYNC_SERVICE        "_depboard"
+#define LAN_SYNC_PROTO          "_tcp"
+
+typedef enum {
+    LAN_ROLE_STANDALONE = 0,    // Fetch for ourselves, no LAN traffic
+    LAN_ROLE_HUB,
+    LAN_ROLE_FOLLOWER,
+    LAN_ROLE_COUNT
+} lan_role_t;
+
+// Start the role's task (call once WiFi is up and tfnsw_init() has run).
+// on_update receives departures for the active stop, from the hub or from
+// the local fallback fetch.
+esp_err_t lan_sync_start(lan_role_t role, void (*on_update)(const tfnsw_departures_t* departures));
+
+lan_role_t lan_sync_get_role(void);
+bool lan_sync_is_follower(void);
+
+// Follower: stop to subscribe to (NULL or "" when not on a realtime view)
+void lan_sync_set_active_stop(const char* stop_id);
+
+// "standalone", "hub", "follower"
+const char* lan_sync_role_name(lan_role_t role);
+bool lan_sync_role_from_name(const char* name, lan_role_t* out_role);
+
+// Current state for status output ("hub", "searching", "following", ...)
+const char* lan_sync_state_name(void);
+
+// Hub: connected followers
+int lan_sync_peer_count(void);
+
+#endif // LAN_SYNC_H
@@ -88,6 +88,9 @@ void lcd_clear_view_data(view_id_t id);
 // Clear all view data
 void lcd_clear_all_view_data(void);
 
+// Copy the departures the view renders from; false if it has none
+bool lcd_get_view_data(view_id_t id, tfnsw_departures_t* out);
+
 // Render current view
 void lcd_render_current_view(void);
 
@@ -134,26 +137,44 @@ void lcd_refresh_scene(void);
 // Initialize LCD display with LVGL
 esp_err_t lcd_init(void);
 
-// LVGL update - call periodically from main loop
-void lcd_update(void);
+// LVGL update - call from the main loop. Returns how many ms it can wait
+// before the next call (pending changes from other tasks wake it earlier).
+uint32_t lcd_update(void);
 
 // Set backlight brightness (0-100)
 void lcd_set_backlight(uint8_t brightness);
 
+// Backlight and panel off before deep sleep (main loop only)
+void lcd_sleep(void);
+
+#ifdef LCD_HEADLESS
+// Host builds only: LCD_WIDTH x LCD_HEIGHT lv_color_t pixels, row-major
+const void* lcd_get_framebuffer(void);
+
+// Host builds only: last brightness passed to lcd_set_backlight
+uint8_t lcd_get_backlight(void);
+#endif
+
+// Legacy draw API: colours are RGB565 (see COLOR_* in config.h). Calls are
+// queued (safe from any task) and rasterised straight to the panel by
+// lcd_update() without creating LVGL objects; the next view render replaces them.
+// A clear drops draws still queued; any call returns ESP_ERR_TIMEOUT if the
+// queue stays full (lcd_update() not keeping up) and the op is not drawn.
+
 // Clear screen with color (legacy)
-void lcd_clear(uint16_t color);
+esp_err_t lcd_clear(uint16_t color);
 
 // Fill rectangle (legacy)
-void lcd_fill_rect(int x, int y, int w, int h, uint16_t color);
+esp_err_t lcd_fill_rect(int x, int y, int w, int h, uint16_t color);
 
 // Draw rectangle outline (legacy)
-void lcd_draw_rect(int x, int y, int w, int h, uint16_t color);
+esp_err_t lcd_draw_rect(int x, int y, int w, int h, uint16_t color);
 
 // Draw string (legacy)
-void lcd_draw_string(int x, int y, const char* str, uint16_t color, uint16_t bg, uint8_t size);
+esp_err_t lcd_draw_string(int x, int y, const char* str, uint16_t color, uint16_t bg, uint8_t size);
 
 // Draw centered string (legacy)
-void lcd_draw_string_centered(int y, const char* str, uint16_t color, uint16_t bg, uint8_t size);
+esp_err_t lcd_draw_string_centered(int y, const char* str, uint16_t color, uint16_t bg, uint8_t size);
 
 // ============================================================================
 // Screen Templates (LVGL)
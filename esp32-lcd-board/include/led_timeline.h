@@ -0,0 +1,59 @@
+#ifndef LED_TIMELINE_H
+#define LED_TIMELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "config.h"
+#include "tfnsw_client.h"
+
+// ============================================================================
+// LED Strip Departure Timeline
+// ============================================================================
+//
+// A WS2812 chain (LED_STRIP_LEN LEDs on LED_STRIP_PIN) shows the next
+// LED_TIMELINE_WINDOW_S of departures, LED 0 being now. Each departure
+// lights the LED for its time in its direction's colour; departures due
+// within LED_TIMELINE_DUE_S pulse.
+//
+// Frames are composed when departures arrive or the timeline moves on by
+// one LED: every pulse phase is rendered up front into a GRB frame buffer,
+// through one LUT that folds gamma and the backlight level together. An
+// animation step then only hands the next buffer to the RMT TX channel;
+// the main loop does no per-pixel work between compositions.
+
+#define LED_TIMELINE_WINDOW_S   (20 * 60)   // Time covered by the strip
+#define LED_TIMELINE_DUE_S      120         // Pulse departures this close
+#define LED_TIMELINE_FRAMES     16          // Pulse phases per cycle
+#define LED_TIMELINE_PULSE_MS   1600        // One pulse cycle
+#define LED_TIMELINE_GAMMA      2.6f
+#define LED_TIMELINE_MAX_OUT    64          // Full-scale output (WS2812s are bright)
+
+#define LED_TIMELINE_FRAME_BYTES    (LED_STRIP_LEN * 3)
+
+// One departure as the strip sees it
+typedef struct {
+    int64_t when;                   // Unix s (realtime where known)
+    tfnsw_direction_t direction;
+} led_timeline_entry_t;
+
+// Set up the RMT channel (no-op unless LED_STRIP_ENABLED)
+esp_err_t led_timeline_init(void);
+
+// Feed each fetch for the view on screen (safe from the fetch task)
+void led_timeline_note_departures(const tfnsw_departures_t* departures);
+
+// Compose and step the animation from the main loop. Returns ms until it
+// needs calling again (UINT32_MAX when the strip is static and empty).
+uint32_t led_timeline_update(void);
+
+// Blank the strip and wait for the transfer (before deep sleep)
+void led_timeline_off(void);
+
+// Render entries at time now (Unix s) into frames[LED_TIMELINE_FRAMES] at
+// brightness percent. Returns the number of frames to cycle through (1 when
+// nothing pulses). Needs no hardware, so host builds can check the output.
+int led_timeline_compose(const led_timeline_entry_t* entries, int count, int64_t now,
+                         uint8_t brightness, uint8_t frames[][LED_TIMELINE_FRAME_BYTES]);
+
+#endif // LED_TIMELINE_H
@@ -0,0 +1,64 @@
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+// ============================================================================
+// In-RAM Log Ring (/api/logs)
+// ============================================================================
+//
+// Fixed ring of 32-byte binary records in static RAM. A writer reserves a
+// slot with one atomic add and publishes it with a sequence stamp, so any
+// task or (non-IRAM) ISR can log without a lock. Records hold the format
+// pointer and raw argument words; printf formatting only happens when a
+// reader (the /api/logs stream or the SD writer) asks for the line.
+//
+// Because formatting is deferred, format strings and any %s arguments must
+// be static (string literals or const tables). Arguments beyond
+// LOG_RING_ARG_WORDS 32-bit words (64-bit and double take two) print as "?".
+//
+// Sequence numbers increase forever; a slot is reused every LOG_RING_SIZE
+// records and readers that fall behind get a "lines dropped" marker.
+
+#define LOG_RING_SIZE           256     // Records, power of two
+#define LOG_RING_ARG_WORDS      4
+#define LOG_RING_MAX_TAGS       32
+#define LOG_RING_LINE_MAX       192     // Formatted line incl. prefix
+
+#define LOG_FOLLOW_MAX_CLIENTS  2
+#define LOG_FOLLOW_POLL_MS      250
+
+typedef enum {
+    LOG_RING_ERROR = 0,
+    LOG_RING_WARN,
+    LOG_RING_INFO,
+    LOG_RING_DEBUG,
+} log_ring_level_t;
+
+void log_ring_write(log_ring_level_t level, const char *tag, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+void log_ring_vwrite(log_ring_level_t level, const char *tag, const char *fmt, va_list args);
+
+// Sequence number of the next record, and of the oldest one still readable
+uint32_t log_ring_head(void);
+uint32_t log_ring_oldest(void);
+
+// Format the next record at or after *cursor as
+//   "<seq> <sec>.<ms> <E|W|I|D> <tag>: <message>\n"
+// and advance the cursor. Returns the line length, or 0 when caught up.
+size_t log_ring_read(uint32_t *cursor, char *buf, size_t size);
+
+// Forget everything logged so far (readers start from the current head)
+void log_ring_clear(void);
+
+// /api/logs: dump from since (0 = oldest) as chunked text/plain
+esp_err_t log_ring_export(httpd_req_t *req, uint32_t since);
+
+// /api/logs?follow=1: dump, then keep the response open and stream new lines
+esp_err_t log_ring_follow(httpd_req_t *req, uint32_t since);
+
+#endif // LOG_RING_H
@@ -11,7 +11,17 @@
 /*====================
    COLOR SETTINGS
  *====================*/
+/* 1 = render into 8-bit RGB332 buffers and expand to RGB565 through a lookup
+ * table in the flush path (halves draw buffer RAM, costs colour fidelity) */
+#ifndef LCD_RENDER_INDEXED8
+#define LCD_RENDER_INDEXED8 0
+#endif
+
+#if LCD_RENDER_INDEXED8
+#define LV_COLOR_DEPTH 8
+#else
 #define LV_COLOR_DEPTH 16
+#endif
 #define LV_COLOR_16_SWAP 1
 
 /*====================
@@ -47,6 +57,41 @@
 /*====================
    FONT USAGE
  *====================*/
+/* 1 = use the subset fonts generated by tools/gen_subset_fonts.py into
+ * src/fonts/ instead of LVGL's full built-in Montserrat. They keep the
+ * lv_font_montserrat_N names, so no code changes are needed. src/CMakeLists.txt
+ * reads this line and runs the generator as a build step (needs lv_font_conv
+ * or npx). */
+#ifndef LCD_USE_SUBSET_FONTS
+#define LCD_USE_SUBSET_FONTS 0
+#endif
+
+#if LCD_USE_SUBSET_FONTS
+#define LV_FONT_MONTSERRAT_8 0
+#define LV_FONT_MONTSERRAT_10 0
+#define LV_FONT_MONTSERRAT_12 0
+#define LV_FONT_MONTSERRAT_14 0
+#define LV_FONT_MONTSERRAT_16 0
+#define LV_FONT_MONTSERRAT_18 0
+#define LV_FONT_MONTSERRAT_20 0
+#define LV_FONT_MONTSERRAT_22 0
+#define LV_FONT_MONTSERRAT_24 0
+#define LV_FONT_MONTSERRAT_26 0
+#define LV_FONT_MONTSERRAT_28 0
+#define LV_FONT_MONTSERRAT_30 0
+#define LV_FONT_MONTSERRAT_32 0
+#define LV_FONT_MONTSERRAT_34 0
+#define LV_FONT_MONTSERRAT_36 0
+#define LV_FONT_MONTSERRAT_38 0
+#define LV_FONT_MONTSERRAT_40 0
+#define LV_FONT_MONTSERRAT_42 0
+#define LV_FONT_MONTSERRAT_44 0
+#define LV_FONT_MONTSERRAT_46 0
+#define LV_FONT_MONTSERRAT_48 0
+
+/* LV_FONT_CUSTOM_DECLARE for exactly the sizes generated */
+#include "../src/fonts/lv_font_subset.h"
+#else
 #define LV_FONT_MONTSERRAT_8 0
 #define LV_FONT_MONTSERRAT_10 0
 #define LV_FONT_MONTSERRAT_12 1
@@ -68,6 +113,7 @@
 #define LV_FONT_MONTSERRAT_44 0
 #define LV_FONT_MONTSERRAT_46 0
 #define LV_FONT_MONTSERRAT_48 0
+#endif
 
 #define LV_FONT_DEFAULT &lv_font_montserrat_14
 
@@ -0,0 +1,60 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+// ============================================================================
+// Metrics Registry (/metrics)
+// ============================================================================
+//
+// Fixed set of counters, gauges and histograms in static memory. Updates are
+// single atomic operations, so any task can record without taking a lock.
+// Heap, RSSI, task stacks and render timings are sampled at scrape time.
+
+// Counters (monotonic)
+typedef enum {
+    MET_TFNSW_FETCH_TOTAL = 0,
+    MET_TFNSW_FETCH_ERRORS_TOTAL,       // Failed before an HTTP status arrived
+    MET_TFNSW_HTTP_2XX,                 // tfnsw_http_responses_total{class=...}
+    MET_TFNSW_HTTP_3XX,
+    MET_TFNSW_HTTP_4XX,
+    MET_TFNSW_HTTP_5XX,
+    MET_TFNSW_RESPONSE_BYTES_TOTAL,
+    MET_TFNSW_PARSE_FAILURES_TOTAL,
+    MET_WIFI_DISCONNECTS_TOTAL,         // Lost an established connection
+    METRIC_COUNTER_COUNT
+} metric_counter_t;
+
+// Gauges (last value)
+typedef enum {
+    MET_TFNSW_LAST_RESPONSE_BYTES = 0,
+    METRIC_GAUGE_COUNT
+} metric_gauge_t;
+
+// Histograms (milliseconds, shared bucket layout)
+typedef enum {
+    MET_FETCH_CONNECT_MS = 0,           // Request start -> TCP/TLS connected
+    MET_FETCH_WAIT_MS,                  // Connected -> first response header
+    MET_FETCH_DOWNLOAD_MS,              // First header -> body complete
+    MET_FETCH_PARSE_MS,                 // JSON parse into departures
+    MET_WIFI_CONNECT_DIRECTED_MS,       // esp_wifi_connect() -> IP, cached BSSID/channel
+    MET_WIFI_CONNECT_SCAN_MS,           // esp_wifi_connect() -> IP, full scan
+    METRIC_HIST_COUNT
+} metric_hist_t;
+
+#define METRIC_HIST_BUCKETS 10          // Plus +Inf
+
+void metrics_inc(metric_counter_t counter);
+void metrics_add(metric_counter_t counter, uint32_t value);
+void metrics_set(metric_gauge_t gauge, int32_t value);
+void metrics_observe(metric_hist_t hist, uint32_t value_ms);
+
+// Count an HTTP status code under its class counter (1xx is ignored)
+void metrics_count_http_status(int status_code);
+
+// Write every metric in Prometheus text format (text/plain; version=0.0.4)
+esp_err_t metrics_export(httpd_req_t *req);
+
+#endif // METRICS_H
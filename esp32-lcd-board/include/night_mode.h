@@ -0,0 +1,72 @@
+#ifndef NIGHT_MODE_H
+#define NIGHT_MODE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "tfnsw_client.h"
+#include "lcd_driver.h"
+
+// ============================================================================
+// Night Mode (deep sleep through the overnight break in service)
+// ============================================================================
+//
+// Each successful fetch is scanned for a gap of at least NIGHT_GAP_MIN_S
+// between departures: the service before it is the last one tonight, the
+// one after it the first one tomorrow. Once the last service has gone, the
+// panel and backlight are switched off and the chip deep sleeps on an RTC
+// timer until NIGHT_WAKE_LEAD_S before the first service.
+//
+// RTC memory keeps, across the sleep: the fetch taken just before sleeping
+// (which already lists the morning's first services), the view, and whether
+// the clock was synced. The RTC timer keeps the system time running, so a
+// timer wake redraws the board from that snapshot straight away and fetches
+// without waiting for SNTP. The WiFi AP cache has its own RTC copy
+// (wifi_manager.c). The BOOT button is not an LP GPIO on the C6, so only
+// the timer can wake the board.
+
+#define NIGHT_GAP_MIN_S         (90 * 60)   // Shortest gap treated as the overnight break
+#define NIGHT_AFTER_LAST_S      (10 * 60)   // Stay up this long after the last service
+#define NIGHT_WAKE_LEAD_S       (20 * 60)   // Wake this long before the first service
+#define NIGHT_MIN_SLEEP_S       (30 * 60)   // Not worth a reboot below this
+#define NIGHT_FRESH_S           (5 * 60)    // Only decide on a fetch this recent
+#define NIGHT_ACTIVITY_HOLD_S   (10 * 60)   // A button press keeps the board up this long
+
+typedef struct {
+    bool woke_from_sleep;       // This boot is a night-mode timer wake
+    uint32_t nights;            // Deep sleeps since power-on
+    int64_t last_service;       // Unix time, 0 if not seen
+    int64_t first_service;      // Unix time, 0 if not seen
+} night_status_t;
+
+// Read the wake cause and RTC state (call first in app_main)
+void night_init(void);
+
+// True on a timer wake from night mode
+bool night_woke_from_sleep(void);
+
+// True if the clock was synced before the sleep this boot woke from
+bool night_clock_valid(void);
+
+// The departures saved before sleeping, marked as cached (see
+// departures_cache_mark), and the view they were on
+esp_err_t night_restore_snapshot(view_id_t* view, tfnsw_departures_t* out);
+
+// Feed each successful fetch for the stop on screen
+void night_note_departures(const char* stop_id, const tfnsw_departures_t* departures);
+
+// Button press (keeps the board awake for NIGHT_ACTIVITY_HOLD_S)
+void night_note_activity(void);
+
+// Wake time (Unix s) if stop_id's overnight break has started and is long
+// enough to sleep through, else 0
+int64_t night_sleep_due(const char* stop_id);
+
+// Save the RTC state and deep sleep until wake_at. The caller blanks the
+// display and LED first. Only returns if the sleep could not start.
+esp_err_t night_sleep_until(int64_t wake_at, view_id_t view, const char* stop_id,
+                            bool clock_synced);
+
+void night_get_status(night_status_t* out);
+
+#endif // NIGHT_MODE_H
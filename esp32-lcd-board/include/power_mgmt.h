@@ -0,0 +1,60 @@
+#ifndef POWER_MGMT_H
+#define POWER_MGMT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+// ============================================================================
+// Power Management (/api/power)
+// ============================================================================
+//
+// Power-save mode (settings "power_save") configures esp_pm for dynamic
+// frequency scaling and automatic light sleep, with WiFi in modem sleep
+// waking for the AP's DTIM beacons. The CPU then sleeps whenever every task
+// is blocked, so periodic work has to wait on deadlines rather than poll:
+// the main loop sleeps until LVGL, the LED or its own timers next need it,
+// and other tasks wake it with power_loop_wake() when they set a pending flag.
+//
+// Time asleep is counted from the light sleep exit hook and split by the
+// view on screen. /api/power turns that into an estimated current draw using
+// the rough model below (calibrate against a meter for a given board).
+
+#define POWER_CPU_MAX_MHZ       160
+#define POWER_CPU_MIN_MHZ       40      // XTAL; the lowest DFS step on the C6
+
+#define POWER_LOOP_MIN_MS       10      // Main loop never runs faster than before
+#define POWER_LOOP_MAX_MS       1000    // Longest the main loop sleeps without a wake
+
+// Current model (mA at 3.3 V)
+#define POWER_EST_AWAKE_MA      32.0f   // CPU running, radio in modem sleep
+#define POWER_EST_SLEEP_MA      1.5f    // Light sleep, averaged over DTIM wakeups
+#define POWER_EST_PANEL_MA      6.0f    // ST7789 controller, always on
+#define POWER_EST_BACKLIGHT_MA  40.0f   // Backlight at 100%
+
+// Apply the saved mode (call once WiFi is initialised)
+esp_err_t power_init(bool light_sleep);
+
+// Switch between power-save and full-speed mode at runtime
+esp_err_t power_set_light_sleep(bool enable);
+bool power_light_sleep_enabled(void);
+
+// Main loop: block until timeout_ms (clamped to POWER_LOOP_MIN/MAX_MS) or a
+// power_loop_wake(). The first call registers the calling task.
+void power_loop_wait(uint32_t timeout_ms);
+
+// Wake the main loop early (any task)
+void power_loop_wake(void);
+
+// Attribute time from now on to this view / backlight level
+void power_note_view(int view);
+void power_note_backlight(uint8_t percent);
+
+// Start a new measurement window
+void power_reset_stats(void);
+
+// /api/power: sleep share and estimated draw, overall and per view
+esp_err_t power_export(httpd_req_t *req);
+
+#endif // POWER_MGMT_H
@@ -0,0 +1,60 @@
+#ifndef RENDER_PERF_H
+#define RENDER_PERF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lcd_driver.h"
+
+// ============================================================================
+// Render Profiler
+// ============================================================================
+
+// Histogram buckets are powers of two: bucket N counts samples in [2^(N-1), 2^N)
+// (bucket 0 holds zero, the last bucket holds everything above its lower bound)
+#define PERF_HIST_BUCKETS 20
+
+// Metrics recorded by the LCD driver
+typedef enum {
+    PERF_FRAME_US = 0,        // lv_timer_handler() calls that produced a frame (us)
+    PERF_FLUSH_US,            // Single flush_cb call, panel submit time (us)
+    PERF_FLUSH_PX,            // Pixels pushed by a single flush_cb call
+    PERF_FRAME_PX,            // Pixels flushed across one frame
+    PERF_INVALID_PX,          // Invalidated area LVGL redrew in one refresh (px)
+    PERF_METRIC_COUNT
+} perf_metric_t;
+
+// Fixed-size histogram (no allocation, safe to copy)
+typedef struct {
+    uint32_t count;
+    uint64_t sum;
+    uint32_t min;
+    uint32_t max;
+    uint32_t buckets[PERF_HIST_BUCKETS];
+} perf_hist_t;
+
+// Snapshot returned to readers (web server)
+typedef struct {
+    perf_hist_t metrics[PERF_METRIC_COUNT];
+    perf_hist_t view_rebuild_us[VIEW_COUNT];  // lcd_render_current_view() per view
+    uint32_t since_ms;                        // Uptime when stats were last reset
+} render_perf_snapshot_t;
+
+// Record a sample for a metric (called from the LVGL/main task)
+void render_perf_record(perf_metric_t metric, uint32_t value);
+
+// Record the cost of rebuilding a view's widget tree
+void render_perf_record_view(view_id_t view, uint32_t us);
+
+// Copy all histograms into out (callable from any task)
+void render_perf_get_snapshot(render_perf_snapshot_t *out);
+
+// Clear all histograms
+void render_perf_reset(void);
+
+// Metric name for JSON output ("frame_us", "flush_px", ...)
+const char* render_perf_metric_name(perf_metric_t metric);
+
+// Upper bound of a histogram bucket (UINT32_MAX for the overflow bucket)
+uint32_t render_perf_bucket_limit(int bucket);
+
+#endif // RENDER_PERF_H
@@ -51,8 +51,10 @@ void rgb_led_set_status(led_status_t status);
 // Get current status mode
 led_status_t rgb_led_get_status(void);
 
-// Update LED animation (call from main loop at ~10ms interval)
-void rgb_led_update(void);
+// Update LED animation from the main loop. Returns ms until the next change
+// (UINT32_MAX while the colour is static); the LED is only rewritten when
+// its colour changes.
+uint32_t rgb_led_update(void);
 
 // Flash the LED briefly (non-blocking, call rgb_led_update to animate)
 void rgb_led_flash(uint32_t color, int duration_ms);
@@ -2,6 +2,8 @@
 #define SD_CARD_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include "esp_err.h"
 
 // Initialize SD card
@@ -24,4 +26,14 @@ esp_err_t sd_write_file(const char* path, const char* content);
 esp_err_t sd_append_file(const char* path, const char* content);
 esp_err_t sd_delete_file(const char* path);
 
+// Batched log file (LOG_FILE): appends are copied into RAM and written by a
+// background task in 4 KB batches, every 5 s or sooner when half full.
+// Appends never touch the card; they are dropped if the writer falls behind.
+esp_err_t sd_log_start(void);
+esp_err_t sd_log_append(const char* text, size_t len);
+esp_err_t sd_log_flush(void);
+size_t sd_log_size(void);
+uint32_t sd_log_dropped(void);
+esp_err_t sd_log_clear(void);
+
 #endif // SD_CARD_H
@@ -15,6 +15,9 @@ typedef struct {
     uint32_t theme_color;       // RGB888 theme accent color
     uint8_t brightness;         // 0-100 brightness level
     uint8_t default_scene;      // Default scene on boot
+    uint8_t lan_role;           // lan_role_t (applied at boot)
+    bool power_save;            // Light sleep + DFS (power_mgmt.h)
+    bool night_sleep;           // Deep sleep between last and first service (night_mode.h)
 
     // Departure board data
     char destination[64];
@@ -46,16 +49,22 @@ void settings_init(void);
 // Load settings from SD card (returns ESP_OK if loaded, ESP_ERR_NOT_FOUND if no file)
 esp_err_t settings_load(void);
 
-// Save current settings to SD card
+// Save current settings to NVS now
 esp_err_t settings_save(void);
 
+// Commit pending changes if any (also runs from esp_restart())
+esp_err_t settings_flush(void);
+
 // Get current settings (read-only pointer)
 const device_settings_t* settings_get(void);
 
-// Update individual settings (auto-saves if SD mounted)
+// Update individual settings (committed to NVS after a quiet period)
 void settings_set_theme_color(uint32_t color);
 void settings_set_brightness(uint8_t brightness);
 void settings_set_default_scene(uint8_t scene);
+void settings_set_lan_role(uint8_t role);
+void settings_set_power_save(bool enabled);
+void settings_set_night_sleep(bool enabled);
 
 // Update departure board settings
 void settings_set_departure(const char* dest, const char* calling,
@@ -74,31 +83,18 @@ bool settings_is_loaded(void);
 void settings_reset(void);
 
 // ============================================================================
-// Departure Cache Functions (SD card based)
-// ============================================================================
-
-// Save departures to SD card cache
-esp_err_t departures_cache_save(const tfnsw_departures_t* departures);
-
-// Load departures from SD card cache
-esp_err_t departures_cache_load(tfnsw_departures_t* out_departures);
-
-// Check if cached departures are still valid (not expired)
-bool departures_cache_is_valid(void);
-
-// Clear the departures cache
-esp_err_t departures_cache_clear(void);
-
-// ============================================================================
-// Logging Functions (SD card based)
+// Logging Functions (log_ring, copied to SD card)
 // ============================================================================
 
-// Initialize logging to SD card
+// Start copying the log ring to the SD card
 esp_err_t log_init(void);
 
-// Log a message with timestamp
-void log_info(const char* tag, const char* format, ...);
-void log_error(const char* tag, const char* format, ...);
+// Log a message with timestamp. Formatting is deferred (see log_ring.h):
+// the format and any %s arguments must be string literals or static.
+void log_info(const char* tag, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+void log_error(const char* tag, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
 
 // Get current log file size
 size_t log_get_size(void);
@@ -0,0 +1,58 @@
+#ifndef SPI_ARBITER_H
+#define SPI_ARBITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// ============================================================================
+// LCD / SD SPI Bus Arbitration
+// ============================================================================
+//
+// The SD card shares LCD_HOST (MOSI/CLK) with the panel. The SPI master
+// driver already serialises transactions, so this layer is about ordering:
+// the display always has priority and SD block I/O only starts in the gaps
+// between frames, one short slice at a time.
+//
+//   LCD   frame_begin/frame_end around each lv_timer_handler() call, and
+//         lcd_queued/lcd_done per colour transfer (done is ISR safe)
+//   SD    sd_begin/sd_end around each slice of at most SPI_ARB_SD_SLICE_SECTORS
+//
+// sd_begin waits until no frame is being rendered and the panel's DMA queue
+// has drained. If the display keeps the bus busy for SPI_ARB_SD_MAX_WAIT_MS
+// the slice goes ahead anyway (counted as forced) so SD always progresses;
+// the next frame is then late by at most one slice.
+
+#define SPI_ARB_SD_SLICE_SECTORS    8       // 4 KB, ~2 ms at 20 MHz
+#define SPI_ARB_SD_MAX_WAIT_MS      100
+
+typedef struct {
+    uint32_t sd_slices;             // SD slices run
+    uint32_t sd_forced;             // ...of which started while the LCD was busy
+    uint32_t frames_delayed;        // Frames that started during an SD slice
+    uint32_t sd_wait_max_us;        // Longest wait for a gap
+    uint32_t sd_hold_max_us;        // Longest slice
+    uint64_t sd_wait_total_us;
+    uint32_t sd_wait_peak_us;       // As sd_wait_max_us, since spi_arbiter_reset_peaks()
+    uint32_t sd_hold_peak_us;       // As sd_hold_max_us, since spi_arbiter_reset_peaks()
+} spi_arbiter_stats_t;
+
+// Called by lcd_init() before the bus is created
+esp_err_t spi_arbiter_init(void);
+
+// LCD side
+void spi_arbiter_frame_begin(void);
+void spi_arbiter_frame_end(void);
+void spi_arbiter_lcd_queued(void);
+void spi_arbiter_lcd_done(void);        // ISR safe (IRAM)
+
+// SD side: wait for a gap, run one slice, release
+esp_err_t spi_arbiter_sd_begin(uint32_t max_wait_ms);
+void spi_arbiter_sd_end(void);
+
+void spi_arbiter_get_stats(spi_arbiter_stats_t *out);
+
+// Start a new measurement window for the *_peak_us fields
+void spi_arbiter_reset_peaks(void);
+
+#endif // SPI_ARBITER_H
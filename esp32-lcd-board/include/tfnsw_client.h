@@ -28,12 +28,14 @@
 
 // API configuration
 #define TFNSW_API_BASE_URL      "https://api.transport.nsw.gov.au"
+#define TFNSW_API_HOST          "api.transport.nsw.gov.au"  // Pre-resolved at boot
 #define TFNSW_API_DEPARTURE_PATH "/v1/tp/departure_mon"
 #define TFNSW_MAX_DEPARTURES    8       // Increased for dual-direction display
 #define TFNSW_MAX_PER_DIRECTION 4       // Max departures per direction
 #define TFNSW_FETCH_INTERVAL_MS 30000   // 30 seconds (max 2x per minute)
 #define TFNSW_FETCH_TIMEOUT_MS  15000   // 15 second timeout
 #define TFNSW_MAX_RETRIES       3
+#define TFNSW_STOP_CACHE_SLOTS  4       // Stops kept for /api/departures
 
 // Metro direction enumeration
 typedef enum {
@@ -244,6 +246,15 @@ esp_err_t tfnsw_start_single_view_fetch(
     const char* stop_id,
     void (*on_update)(const tfnsw_departures_t* departures));
 
+/**
+ * Keep a stop fetched in the background alongside the active one
+ * Used by a LAN hub for its followers; the lease must be renewed or the
+ * stop is dropped. Results land in the per-stop snapshots.
+ * @param stop_id The stop ID to keep fresh
+ * @param lease_ms How long the watch lasts without renewal
+ */
+void tfnsw_watch_stop(const char* stop_id, uint32_t lease_ms);
+
 /**
  * Switch the active stop for single-view fetch mode
  * Clears existing data and starts fetching for new stop
@@ -312,6 +323,37 @@ void tfnsw_get_current_departures(tfnsw_departures_t* out_departures);
  */
 void tfnsw_get_current_dual_departures(tfnsw_dual_departures_t* out_departures);
 
+// Cached stop summary (see tfnsw_list_stop_snapshots)
+typedef struct {
+    char stop_id[16];
+    char station_name[64];
+    uint32_t version;
+} tfnsw_stop_version_t;
+
+/**
+ * Get the latest successful fetch for a stop (thread-safe copy)
+ * @param stop_id TfNSW stop ID
+ * @param out_departures Copy destination, or NULL to read only the version
+ * @param out_version Snapshot version; increases whenever the stop's data changes
+ * @return ESP_ERR_NOT_FOUND if the stop has not been fetched since boot
+ */
+esp_err_t tfnsw_get_stop_snapshot(const char* stop_id, tfnsw_departures_t* out_departures,
+                                  uint32_t* out_version);
+
+/**
+ * Store a snapshot received from elsewhere (LAN follower) as if it had
+ * been fetched locally
+ */
+void tfnsw_store_stop_snapshot(const char* stop_id, const tfnsw_departures_t* departures);
+
+/**
+ * List the stops that currently have a snapshot
+ * @param out Array to fill
+ * @param max Capacity of out
+ * @return Number of entries written
+ */
+int tfnsw_list_stop_snapshots(tfnsw_stop_version_t* out, int max);
+
 /**
  * Determine direction from destination name
  * @param destination The destination station name
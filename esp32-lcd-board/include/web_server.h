@@ -4,8 +4,8 @@
 #include "esp_err.h"
 #include "esp_http_server.h"
 
-// Command callback type
-typedef void (*display_cmd_cb_t)(const char* command, const char* params);
+// Command callback type (display: an error answers 503, e.g. draw queue full)
+typedef esp_err_t (*display_cmd_cb_t)(const char* command, const char* params);
 typedef void (*system_cmd_cb_t)(const char* command);
 typedef void (*api_key_set_cb_t)(void);
 
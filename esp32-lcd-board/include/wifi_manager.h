@@ -10,7 +10,10 @@ typedef void (*wifi_event_cb_t)(void);
 // Initialize WiFi subsystem
 esp_err_t wifi_init(void);
 
-// Try to connect with stored credentials, start AP if none stored
+// Try to connect with stored credentials, start AP if none stored or the
+// first connection fails. The last AP's BSSID/channel are cached in NVS and
+// tried first; a failed directed attempt falls back to a full scan. Once
+// connected, drops are retried with backoff (250 ms doubling to 30 s).
 esp_err_t wifi_connect(void);
 
 // Start AP mode for configuration
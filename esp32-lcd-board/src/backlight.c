@@ -0,0 +1,220 @@
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#ifndef LCD_HEADLESS
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#endif
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "config.h"
+#include "backlight.h"
+#include "power_mgmt.h"
+
+// Time-of-day curve: (minute of day, percent), interpolated linearly and
+// wrapping at midnight. Dim overnight, ramps around sunrise and sunset.
+typedef struct {
+    uint16_t minute;
+    uint8_t percent;
+} curve_point_t;
+
+static const curve_point_t day_curve[] = {
+    {    0, 15 },
+    {  330, 15 },   // 05:30
+    {  450, 50 },   // 07:30
+    {  510, 80 },   // 08:30
+    { 1080, 80 },   // 18:00
+    { 1170, 40 },   // 19:30
+    { 1290, 20 },   // 21:30
+};
+
+static uint8_t level = 0;               // Last requested percent
+static int64_t dip_until_us = 0;        // Restore due (0 = no dip)
+
+// ============================================================================
+// Curve
+// ============================================================================
+
+uint8_t backlight_curve_percent(int minute_of_day)
+{
+    const int n = sizeof(day_curve) / sizeof(day_curve[0]);
+    minute_of_day = ((minute_of_day % 1440) + 1440) % 1440;
+
+    for (int i = 0; i < n; i++) {
+        const curve_point_t *a = &day_curve[i];
+        const curve_point_t *b = &day_curve[(i + 1) % n];
+        int end = i + 1 < n ? b->minute : b->minute + 1440;
+        if (minute_of_day >= a->minute && minute_of_day < end) {
+            int span = end - a->minute;
+            return (uint8_t)(a->percent + (b->percent - a->percent) * (minute_of_day - a->minute) / span);
+        }
+    }
+    return day_curve[0].percent;    // Before the first point (curve starts at 0)
+}
+
+#ifdef LCD_HEADLESS
+// ============================================================================
+// Host Builds (no LEDC)
+// ============================================================================
+
+esp_err_t backlight_init(void)
+{
+    level = 0;
+    return ESP_OK;
+}
+
+void backlight_set(uint8_t percent, uint32_t fade_ms)
+{
+    level = percent > 100 ? 100 : percent;
+    dip_until_us = 0;
+    power_note_backlight(level);
+}
+
+void backlight_dip(void)
+{
+}
+
+uint32_t backlight_update(void)
+{
+    return UINT32_MAX;
+}
+
+void backlight_sleep(void)
+{
+    backlight_set(0, 0);
+}
+#else
+// ============================================================================
+// LEDC
+// ============================================================================
+
+static const char *TAG = "backlight";
+
+#define BL_MODE         LEDC_LOW_SPEED_MODE
+#define BL_CHANNEL      LEDC_CHANNEL_0
+#define BL_TIMER        LEDC_TIMER_0
+#define BL_RESOLUTION   LEDC_TIMER_10_BIT
+#define BL_DUTY_MAX     1023
+#define BL_FREQ_HZ      5000
+
+static uint16_t gamma_duty[101];
+
+static void build_gamma_lut(void)
+{
+    for (int p = 0; p <= 100; p++) {
+        float duty = powf(p / 100.0f, BACKLIGHT_GAMMA) * BL_DUTY_MAX + 0.5f;
+        gamma_duty[p] = (uint16_t)duty;
+        if (p > 0 && gamma_duty[p] == 0) {
+            gamma_duty[p] = 1;      // Any non-zero level stays visibly on
+        }
+    }
+}
+
+// Start a hardware fade to duty (or set it at once); returns straight away
+static void fade_to_duty(uint32_t duty, uint32_t fade_ms)
+{
+    // A running fade would block the next one until it ends
+    ledc_fade_stop(BL_MODE, BL_CHANNEL);
+
+    esp_err_t ret;
+    if (fade_ms == 0 || ledc_get_duty(BL_MODE, BL_CHANNEL) == duty) {
+        ret = ledc_set_duty_and_update(BL_MODE, BL_CHANNEL, duty, 0);
+    } else {
+        ret = ledc_set_fade_time_and_start(BL_MODE, BL_CHANNEL, duty, fade_ms, LEDC_FADE_NO_WAIT);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Backlight fade failed: %s", esp_err_to_name(ret));
+    }
+}
+
+esp_err_t backlight_init(void)
+{
+    build_gamma_lut();
+
+    // Still held low if this boot is a wake from night mode
+    gpio_hold_dis(LCD_PIN_BL);
+
+    ledc_timer_config_t ledc_timer = {
+        .speed_mode = BL_MODE,
+        .timer_num = BL_TIMER,
+        .duty_resolution = BL_RESOLUTION,
+        .freq_hz = BL_FREQ_HZ,
+        .clk_cfg = LEDC_USE_RC_FAST_CLK     // Keeps running through light sleep
+    };
+    esp_err_t ret = ledc_timer_config(&ledc_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure LEDC timer: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ledc_channel_config_t ledc_channel = {
+        .speed_mode = BL_MODE,
+        .channel = BL_CHANNEL,
+        .timer_sel = BL_TIMER,
+        .intr_type = LEDC_INTR_DISABLE,
+        .gpio_num = LCD_PIN_BL,
+        .duty = 0,
+        .hpoint = 0
+    };
+    ret = ledc_channel_config(&ledc_channel);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure LEDC channel: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ret = ledc_fade_func_install(0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to install LEDC fade: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    gpio_sleep_sel_dis(LCD_PIN_BL);     // Keep driving the pin while asleep
+    level = 0;
+    return ESP_OK;
+}
+
+void backlight_set(uint8_t percent, uint32_t fade_ms)
+{
+    if (percent > 100) percent = 100;
+    ESP_LOGD(TAG, "Backlight %d%% -> %d%% over %lu ms", level, percent, (unsigned long)fade_ms);
+    level = percent;
+    dip_until_us = 0;
+    power_note_backlight(percent);
+    fade_to_duty(gamma_duty[percent], fade_ms);
+}
+
+void backlight_dip(void)
+{
+    if (level == 0 || dip_until_us) return;
+    fade_to_duty(gamma_duty[level * BACKLIGHT_DIP_PERCENT / 100], BACKLIGHT_DIP_MS);
+    dip_until_us = esp_timer_get_time() + BACKLIGHT_DIP_MS * 1000;
+}
+
+uint32_t backlight_update(void)
+{
+    if (!dip_until_us) return UINT32_MAX;
+
+    int64_t left_us = dip_until_us - esp_timer_get_time();
+    if (left_us > 0) {
+        return (uint32_t)((left_us + 999) / 1000);
+    }
+    dip_until_us = 0;
+    fade_to_duty(gamma_duty[level], BACKLIGHT_DIP_MS);
+    return UINT32_MAX;
+}
+
+void backlight_sleep(void)
+{
+    // Held low through deep sleep (the pin would float)
+    level = 0;
+    dip_until_us = 0;
+    power_note_backlight(0);
+    ledc_fade_stop(BL_MODE, BL_CHANNEL);
+    ledc_stop(BL_MODE, BL_CHANNEL, 0);
+    gpio_hold_en(LCD_PIN_BL);
+}
+#endif
+
+uint8_t backlight_get(void)
+{
+    return level;
+}
@@ -0,0 +1,178 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "boot_pipeline.h"
+#include "event_trace.h"
+
+static const char *TAG = "boot";
+
+#define BOOT_TASK_STACK     4096
+#define BOOT_TASK_PRIORITY  5
+
+_Static_assert(BOOT_STAGE_COUNT <= 24, "one event group bit per stage");
+
+static const char *stage_names[BOOT_STAGE_COUNT] = {
+    "lcd", "storage", "netif", "wifi", "tfnsw", "splash", "sd",
+    "dns", "time", "services", "first_fetch", "first_departure",
+};
+
+static EventGroupHandle_t finished_bits = NULL;    // Set when a stage is done or failed
+static boot_stage_info_t info[BOOT_STAGE_COUNT];
+static uint32_t stage_deps[BOOT_STAGE_COUNT];
+static portMUX_TYPE info_lock = portMUX_INITIALIZER_UNLOCKED;
+
+const char* boot_stage_name(boot_stage_id_t id)
+{
+    return id < BOOT_STAGE_COUNT ? stage_names[id] : "?";
+}
+
+// ============================================================================
+// Stage State
+// ============================================================================
+
+static bool mark_running(boot_stage_id_t id)
+{
+    bool ok = false;
+    portENTER_CRITICAL(&info_lock);
+    if (info[id].state == BOOT_STATE_PENDING) {
+        info[id].state = BOOT_STATE_RUNNING;
+        info[id].start_us = esp_timer_get_time();
+        ok = true;
+    }
+    portEXIT_CRITICAL(&info_lock);
+    return ok;
+}
+
+static void mark_finished(boot_stage_id_t id, esp_err_t result)
+{
+    int64_t now = esp_timer_get_time();
+    bool first = false;
+
+    portENTER_CRITICAL(&info_lock);
+    if (info[id].state != BOOT_STATE_DONE && info[id].state != BOOT_STATE_FAILED) {
+        if (info[id].state == BOOT_STATE_PENDING) {
+            info[id].start_us = now;
+        }
+        info[id].state = result == ESP_OK ? BOOT_STATE_DONE : BOOT_STATE_FAILED;
+        info[id].end_us = now;
+        info[id].result = result;
+        first = true;
+    }
+    portEXIT_CRITICAL(&info_lock);
+    if (!first) return;
+
+    trace_span(stage_names[id], info[id].start_us, (uint32_t)result);
+    if (result == ESP_OK) {
+        ESP_LOGI(TAG, "%s done at %lld ms (%lld ms)", stage_names[id], now / 1000,
+                 (now - info[id].start_us) / 1000);
+    } else {
+        ESP_LOGW(TAG, "%s failed at %lld ms: %s", stage_names[id], now / 1000,
+                 esp_err_to_name(result));
+    }
+    xEventGroupSetBits(finished_bits, BOOT_DEP(id));
+}
+
+// Wait for a stage's dependencies; false if any of them failed
+static bool wait_deps(boot_stage_id_t id)
+{
+    uint32_t deps = stage_deps[id];
+    if (deps == 0) return true;
+    xEventGroupWaitBits(finished_bits, deps, pdFALSE, pdTRUE, portMAX_DELAY);
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++) {
+        if ((deps & BOOT_DEP(i)) && info[i].state == BOOT_STATE_FAILED) {
+            ESP_LOGW(TAG, "%s skipped: %s failed", stage_names[id], stage_names[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void run_stage(const boot_stage_t *stage)
+{
+    if (!wait_deps(stage->id)) {
+        mark_finished(stage->id, ESP_ERR_INVALID_STATE);
+        return;
+    }
+    if (!mark_running(stage->id)) return;
+    mark_finished(stage->id, stage->run());
+}
+
+// ============================================================================
+// Pipeline
+// ============================================================================
+
+static void stage_task(void *arg)
+{
+    run_stage((const boot_stage_t *)arg);
+    vTaskDelete(NULL);
+}
+
+esp_err_t boot_pipeline_run(const boot_stage_t *stages, int count)
+{
+    if (!finished_bits) {
+        finished_bits = xEventGroupCreate();
+        if (!finished_bits) return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (stages[i].id < BOOT_STAGE_COUNT) {
+            stage_deps[stages[i].id] = stages[i].deps;
+        }
+    }
+
+    // Background stages first so they start as early as their inputs allow
+    for (int i = 0; i < count; i++) {
+        if (stages[i].main_task || !stages[i].run) continue;
+        if (xTaskCreate(stage_task, stage_names[stages[i].id], BOOT_TASK_STACK,
+                        (void *)&stages[i], BOOT_TASK_PRIORITY, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to start %s", stage_names[stages[i].id]);
+            mark_finished(stages[i].id, ESP_ERR_NO_MEM);
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (stages[i].main_task && stages[i].run) {
+            run_stage(&stages[i]);
+        }
+    }
+    return ESP_OK;
+}
+
+void boot_stage_done(boot_stage_id_t id, esp_err_t result)
+{
+    if (id >= BOOT_STAGE_COUNT || !finished_bits) return;
+    mark_finished(id, result);
+}
+
+bool boot_wait(uint32_t mask, uint32_t timeout_ms)
+{
+    if (!finished_bits) return false;
+    EventBits_t bits = xEventGroupWaitBits(finished_bits, mask, pdFALSE, pdTRUE,
+                                           pdMS_TO_TICKS(timeout_ms));
+    if ((bits & mask) != mask) return false;
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++) {
+        if ((mask & BOOT_DEP(i)) && info[i].state != BOOT_STATE_DONE) return false;
+    }
+    return true;
+}
+
+bool boot_stage_is_done(boot_stage_id_t id)
+{
+    return id < BOOT_STAGE_COUNT && info[id].state == BOOT_STATE_DONE;
+}
+
+void boot_get_stage(boot_stage_id_t id, boot_stage_info_t *out)
+{
+    if (!out) return;
+    if (id >= BOOT_STAGE_COUNT) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    portENTER_CRITICAL(&info_lock);
+    *out = info[id];
+    portEXIT_CRITICAL(&info_lock);
+}
@@ -0,0 +1,142 @@
+#include <string.h>
+
+#include "cbor_writer.h"
+
+// Major types (RFC 8949 section 3.1)
+#define CBOR_UINT   0
+#define CBOR_NEGINT 1
+#define CBOR_TEXT   3
+#define CBOR_ARRAY  4
+#define CBOR_MAP    5
+#define CBOR_SIMPLE 7
+
+#define CBOR_FALSE  20
+#define CBOR_TRUE   21
+#define CBOR_NULL   22
+
+// ============================================================================
+// Output Buffer
+// ============================================================================
+
+static void cw_flush(cbor_writer_t *w)
+{
+    if (w->len > 0 && w->err == ESP_OK) {
+        w->err = httpd_resp_send_chunk(w->req, (const char *)w->buf, w->len);
+    }
+    w->len = 0;
+}
+
+static void cw_write(cbor_writer_t *w, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    while (len > 0) {
+        if (w->len == CBOR_WRITER_BUF) {
+            cw_flush(w);
+        }
+        size_t n = CBOR_WRITER_BUF - w->len;
+        if (n > len) n = len;
+        memcpy(w->buf + w->len, p, n);
+        w->len += n;
+        p += n;
+        len -= n;
+    }
+}
+
+// Initial byte plus the shortest big-endian argument that holds value
+static void cw_head(cbor_writer_t *w, uint8_t major, uint64_t value)
+{
+    uint8_t head[9];
+    size_t len;
+
+    if (value < 24) {
+        head[0] = (major << 5) | (uint8_t)value;
+        len = 1;
+    } else if (value <= 0xFF) {
+        head[0] = (major << 5) | 24;
+        len = 2;
+    } else if (value <= 0xFFFF) {
+        head[0] = (major << 5) | 25;
+        len = 3;
+    } else if (value <= 0xFFFFFFFFu) {
+        head[0] = (major << 5) | 26;
+        len = 5;
+    } else {
+        head[0] = (major << 5) | 27;
+        len = 9;
+    }
+
+    for (size_t i = len - 1; i > 0; i--) {
+        head[i] = value & 0xFF;
+        value >>= 8;
+    }
+    cw_write(w, head, len);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void cw_begin(cbor_writer_t *w, httpd_req_t *req)
+{
+    w->req = req;
+    w->err = ESP_OK;
+    w->len = 0;
+    httpd_resp_set_type(req, "application/cbor");
+}
+
+esp_err_t cw_finish(cbor_writer_t *w)
+{
+    cw_flush(w);
+    if (w->err == ESP_OK) {
+        w->err = httpd_resp_send_chunk(w->req, NULL, 0);
+    }
+    return w->err;
+}
+
+void cw_map(cbor_writer_t *w, uint32_t pairs)
+{
+    cw_head(w, CBOR_MAP, pairs);
+}
+
+void cw_array(cbor_writer_t *w, uint32_t items)
+{
+    cw_head(w, CBOR_ARRAY, items);
+}
+
+void cw_text(cbor_writer_t *w, const char *value)
+{
+    if (!value) {
+        cw_null(w);
+        return;
+    }
+    size_t len = strlen(value);
+    cw_head(w, CBOR_TEXT, len);
+    cw_write(w, value, len);
+}
+
+void cw_uint(cbor_writer_t *w, uint64_t value)
+{
+    cw_head(w, CBOR_UINT, value);
+}
+
+void cw_int(cbor_writer_t *w, int64_t value)
+{
+    if (value < 0) {
+        // Negative n is stored as -1 - n
+        cw_head(w, CBOR_NEGINT, (uint64_t)(-1 - value));
+    } else {
+        cw_head(w, CBOR_UINT, (uint64_t)value);
+    }
+}
+
+void cw_bool(cbor_writer_t *w, bool value)
+{
+    uint8_t b = (CBOR_SIMPLE << 5) | (value ? CBOR_TRUE : CBOR_FALSE);
+    cw_write(w, &b, 1);
+}
+
+void cw_null(cbor_writer_t *w)
+{
+    uint8_t b = (CBOR_SIMPLE << 5) | CBOR_NULL;
+    cw_write(w, &b, 1);
+}
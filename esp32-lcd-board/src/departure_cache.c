@@ -0,0 +1,398 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <dirent.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_spiffs.h"
+#include "esp_rom_crc.h"
+
+#include "departure_cache.h"
+#include "lan_proto.h"
+
+static const char *TAG = "DEP_CACHE";
+
+#define CACHE_MAGIC             0x43444244u     // "DBDC"
+#define CACHE_FILE_PREFIX       "dep_"
+#define CACHE_WRITE_SLOTS       4
+#define CACHE_GONE_GRACE_S      60              // Keep departures this long after they leave
+
+// On-flash header, followed by payload_len bytes of snapshot frame
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t format;
+    uint8_t codec;
+    uint16_t payload_len;
+    uint32_t crc;               // Over this header (crc = 0) and the payload
+} cache_header_t;
+
+// Last write per stop, for the rate limit
+typedef struct {
+    char stop_id[16];
+    int64_t written_ms;
+} cache_write_slot_t;
+
+static volatile bool cache_mounted = false;
+static SemaphoreHandle_t cache_mutex = NULL;
+static cache_write_slot_t write_slots[CACHE_WRITE_SLOTS] = {0};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+// Build the file path; stop IDs are short alphanumerics so they are safe names
+static bool cache_path(const char *stop_id, char *path, size_t size, const char *suffix)
+{
+    if (!stop_id || !stop_id[0] || strlen(stop_id) >= sizeof(write_slots[0].stop_id)) {
+        return false;
+    }
+    for (const char *c = stop_id; *c; c++) {
+        if (!isalnum((unsigned char)*c)) return false;
+    }
+    snprintf(path, size, "%s/" CACHE_FILE_PREFIX "%s.bin%s",
+             DEPARTURES_CACHE_BASE_PATH, stop_id, suffix);
+    return true;
+}
+
+static uint32_t cache_crc(const cache_header_t *hdr, const uint8_t *payload)
+{
+    cache_header_t h = *hdr;
+    h.crc = 0;
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)&h, sizeof(h));
+    return esp_rom_crc32_le(crc, payload, hdr->payload_len);
+}
+
+// Same check as tfnsw_client: before SNTP the clock starts in 1970
+static bool clock_is_valid(void)
+{
+    time_t now = time(NULL);
+    struct tm tm_now;
+    localtime_r(&now, &tm_now);
+    return tm_now.tm_year + 1900 >= 2024;
+}
+
+// Rate limit slot for a stop: its own, else an empty one, else the oldest
+static cache_write_slot_t *write_slot_for(const char *stop_id)
+{
+    cache_write_slot_t *oldest = &write_slots[0];
+    for (int i = 0; i < CACHE_WRITE_SLOTS; i++) {
+        if (strcmp(write_slots[i].stop_id, stop_id) == 0) {
+            return &write_slots[i];
+        }
+    }
+    for (int i = 0; i < CACHE_WRITE_SLOTS; i++) {
+        if (!write_slots[i].stop_id[0]) {
+            return &write_slots[i];
+        }
+        if (write_slots[i].written_ms < oldest->written_ms) {
+            oldest = &write_slots[i];
+        }
+    }
+    return oldest;
+}
+
+// Mark loaded data as cached, set its age and drop services that have left
+esp_err_t departures_cache_mark(tfnsw_departures_t *deps, int64_t max_age_s)
+{
+    deps->status = TFNSW_STATUS_SUCCESS_CACHED;
+    deps->is_cached_fallback = true;
+    deps->is_stale = true;
+    deps->next_fetch_time = 0;
+    deps->consecutive_errors = 0;
+
+    if (!clock_is_valid() || deps->last_fetch_time <= 0) {
+        // No way to tell the age yet; show the stored minutes as they were
+        deps->data_age_seconds = -1;
+        return ESP_OK;
+    }
+
+    int64_t now = (int64_t)time(NULL);
+    int64_t age = now - deps->last_fetch_time / 1000;
+    if (age < 0) age = 0;
+    if (age > max_age_s) {
+        return ESP_ERR_TIMEOUT;
+    }
+    deps->data_age_seconds = (int)age;
+
+    int kept = 0;
+    for (int i = 0; i < deps->count; i++) {
+        const tfnsw_departure_t *d = &deps->departures[i];
+        int64_t when = d->is_realtime && d->estimated_time > 0 ? d->estimated_time
+                                                               : d->scheduled_time;
+        if (when > 0 && when < now - CACHE_GONE_GRACE_S) continue;
+        if (kept != i) deps->departures[kept] = *d;
+        if (when > 0) deps->departures[kept].mins_to_departure = (int)((when - now) / 60);
+        kept++;
+    }
+    deps->count = kept;
+    return kept > 0 ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+// ============================================================================
+// Mount
+// ============================================================================
+
+static esp_err_t cache_mount(bool format_if_mount_failed)
+{
+    esp_vfs_spiffs_conf_t conf = {
+        .base_path = DEPARTURES_CACHE_BASE_PATH,
+        .partition_label = DEPARTURES_CACHE_PARTITION,
+        .max_files = 2,
+        .format_if_mount_failed = format_if_mount_failed,
+    };
+    return esp_vfs_spiffs_register(&conf);
+}
+
+// Formatting the whole partition takes several seconds, so the first boot
+// does it here instead of holding up the display
+static void cache_format_task(void *pvParameters)
+{
+    (void)pvParameters;
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = cache_mount(true);
+    if (ret == ESP_OK) {
+        cache_mounted = true;
+        ESP_LOGI(TAG, "Storage formatted and mounted in %lld ms",
+                 (long long)((esp_timer_get_time() - start_us) / 1000));
+    } else {
+        ESP_LOGE(TAG, "Failed to format storage: %s", esp_err_to_name(ret));
+    }
+    vTaskDelete(NULL);
+}
+
+esp_err_t departures_cache_init(void)
+{
+    if (cache_mounted) return ESP_OK;
+
+    if (!cache_mutex) {
+        cache_mutex = xSemaphoreCreateMutex();
+        if (!cache_mutex) return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = cache_mount(false);
+    if (ret == ESP_OK) {
+        cache_mounted = true;
+        size_t total = 0, used = 0;
+        esp_spiffs_info(DEPARTURES_CACHE_PARTITION, &total, &used);
+        ESP_LOGI(TAG, "Mounted %s (%u/%u bytes used)", DEPARTURES_CACHE_BASE_PATH,
+                 (unsigned)used, (unsigned)total);
+        return ESP_OK;
+    }
+    if (ret == ESP_ERR_NOT_FOUND) {
+        ESP_LOGE(TAG, "No '%s' partition - departure cache disabled", DEPARTURES_CACHE_PARTITION);
+        return ret;
+    }
+
+    ESP_LOGW(TAG, "Storage not formatted (%s) - formatting in background", esp_err_to_name(ret));
+    if (xTaskCreate(cache_format_task, "cache_fmt", 3072, NULL, 1, NULL) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_ERR_NOT_FINISHED;
+}
+
+// ============================================================================
+// Save / Load
+// ============================================================================
+
+esp_err_t departures_cache_save(const char* stop_id, const tfnsw_departures_t* departures)
+{
+    char path[48], tmp_path[48];
+    if (!departures || !cache_path(stop_id, path, sizeof(path), "") ||
+        !cache_path(stop_id, tmp_path, sizeof(tmp_path), ".tmp")) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!cache_mounted) return ESP_ERR_INVALID_STATE;
+
+    // Only fresh results are worth keeping; never replace a good file with an empty one
+    if (departures->status != TFNSW_STATUS_SUCCESS || departures->count == 0) {
+        return ESP_OK;
+    }
+
+    if (xSemaphoreTake(cache_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    int64_t now_ms = esp_timer_get_time() / 1000;
+    cache_write_slot_t *slot = write_slot_for(stop_id);
+    if (strcmp(slot->stop_id, stop_id) == 0 &&
+        now_ms - slot->written_ms < DEPARTURES_CACHE_WRITE_INTERVAL_MS) {
+        xSemaphoreGive(cache_mutex);
+        return ESP_OK;
+    }
+
+    uint8_t *buf = malloc(sizeof(cache_header_t) + LAN_FRAME_MAX);
+    if (!buf) {
+        xSemaphoreGive(cache_mutex);
+        return ESP_ERR_NO_MEM;
+    }
+
+    cache_header_t *hdr = (cache_header_t *)buf;
+    uint8_t *payload = buf + sizeof(cache_header_t);
+    size_t len = lan_encode_snapshot(payload, LAN_FRAME_MAX, stop_id, 0, departures);
+    esp_err_t ret = ESP_OK;
+
+    if (len == 0) {
+        ret = ESP_ERR_INVALID_SIZE;
+    } else {
+        hdr->magic = CACHE_MAGIC;
+        hdr->format = DEPARTURES_CACHE_FORMAT;
+        hdr->codec = LAN_PROTO_VERSION;
+        hdr->payload_len = (uint16_t)len;
+        hdr->crc = cache_crc(hdr, payload);
+
+        // Write beside the old file and swap, so a reset mid-write keeps the last good copy
+        size_t total = sizeof(cache_header_t) + len;
+        FILE *f = fopen(tmp_path, "wb");
+        if (!f) {
+            ret = ESP_FAIL;
+        } else {
+            bool ok = fwrite(buf, 1, total, f) == total;
+            ok = (fclose(f) == 0) && ok;
+            if (ok) {
+                remove(path);
+                ok = rename(tmp_path, path) == 0;
+            }
+            if (!ok) {
+                remove(tmp_path);
+                ret = ESP_FAIL;
+            }
+        }
+    }
+    free(buf);
+
+    if (ret == ESP_OK) {
+        strncpy(slot->stop_id, stop_id, sizeof(slot->stop_id) - 1);
+        slot->stop_id[sizeof(slot->stop_id) - 1] = '\0';
+        slot->written_ms = now_ms;
+        ESP_LOGI(TAG, "Saved %s (%d departures, %u bytes)", stop_id, departures->count,
+                 (unsigned)(sizeof(cache_header_t) + len));
+    } else {
+        ESP_LOGW(TAG, "Failed to save %s: %s", stop_id, esp_err_to_name(ret));
+    }
+
+    xSemaphoreGive(cache_mutex);
+    return ret;
+}
+
+// Read and verify one file into out (caller holds the mutex)
+static esp_err_t cache_read(const char *stop_id, const char *path, tfnsw_departures_t *out)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return ESP_ERR_NOT_FOUND;
+
+    cache_header_t hdr;
+    uint8_t *payload = NULL;
+    esp_err_t ret = ESP_OK;
+
+    if (fread(&hdr, 1, sizeof(hdr), f) != sizeof(hdr) || hdr.magic != CACHE_MAGIC) {
+        ret = ESP_ERR_INVALID_CRC;
+    } else if (hdr.format != DEPARTURES_CACHE_FORMAT || hdr.codec != LAN_PROTO_VERSION) {
+        ret = ESP_ERR_INVALID_VERSION;
+    } else if (hdr.payload_len < 3 || hdr.payload_len > LAN_FRAME_MAX) {
+        ret = ESP_ERR_INVALID_SIZE;
+    } else if (!(payload = malloc(hdr.payload_len))) {
+        ret = ESP_ERR_NO_MEM;
+    } else if (fread(payload, 1, hdr.payload_len, f) != hdr.payload_len ||
+               cache_crc(&hdr, payload) != hdr.crc) {
+        ret = ESP_ERR_INVALID_CRC;
+    }
+    fclose(f);
+
+    if (ret == ESP_OK) {
+        // Frame: u16 length, u8 type, snapshot payload
+        char snap_stop[16];
+        uint32_t version;
+        size_t frame_len = payload[0] | ((size_t)payload[1] << 8);
+        if (frame_len != (size_t)hdr.payload_len - 2 || payload[2] != LAN_MSG_SNAPSHOT ||
+            !lan_decode_snapshot(payload + 3, hdr.payload_len - 3, snap_stop, sizeof(snap_stop),
+                                 &version, out) ||
+            strcmp(snap_stop, stop_id) != 0) {
+            ret = ESP_ERR_INVALID_RESPONSE;
+        }
+    }
+    free(payload);
+
+    if (ret != ESP_OK && ret != ESP_ERR_NO_MEM) {
+        ESP_LOGW(TAG, "Discarding %s: %s", path, esp_err_to_name(ret));
+        remove(path);
+    }
+    return ret;
+}
+
+esp_err_t departures_cache_load(const char* stop_id, tfnsw_departures_t* out_departures)
+{
+    char path[48], tmp_path[48];
+    if (!out_departures || !cache_path(stop_id, path, sizeof(path), "") ||
+        !cache_path(stop_id, tmp_path, sizeof(tmp_path), ".tmp")) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!cache_mounted) return ESP_ERR_INVALID_STATE;
+
+    if (xSemaphoreTake(cache_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t ret = cache_read(stop_id, path, out_departures);
+    if (ret == ESP_ERR_NOT_FOUND) {
+        // A reset between save's remove() and rename() leaves only the new
+        // copy; a half-written one fails its CRC and is discarded
+        ret = cache_read(stop_id, tmp_path, out_departures);
+        if (ret == ESP_OK) {
+            ESP_LOGI(TAG, "Recovered %s from an interrupted save", stop_id);
+            rename(tmp_path, path);
+        }
+    }
+    xSemaphoreGive(cache_mutex);
+
+    if (ret == ESP_OK) {
+        ret = departures_cache_mark(out_departures, DEPARTURES_CACHE_MAX_AGE_S);
+    }
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Loaded %s: %d departures, age %d s", stop_id,
+                 out_departures->count, out_departures->data_age_seconds);
+    } else if (ret == ESP_ERR_TIMEOUT) {
+        ESP_LOGI(TAG, "Cached %s is too old to show", stop_id);
+    }
+    return ret;
+}
+
+bool departures_cache_is_valid(const char* stop_id)
+{
+    tfnsw_departures_t *tmp = malloc(sizeof(tfnsw_departures_t));
+    if (!tmp) return false;
+    bool valid = departures_cache_load(stop_id, tmp) == ESP_OK;
+    free(tmp);
+    return valid;
+}
+
+esp_err_t departures_cache_clear(void)
+{
+    if (!cache_mounted) return ESP_ERR_INVALID_STATE;
+    if (xSemaphoreTake(cache_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    int removed = 0;
+    DIR *dir = opendir(DEPARTURES_CACHE_BASE_PATH);
+    if (dir) {
+        struct dirent *entry;
+        char path[300];
+        while ((entry = readdir(dir)) != NULL) {
+            if (strncmp(entry->d_name, CACHE_FILE_PREFIX, strlen(CACHE_FILE_PREFIX)) != 0) {
+                continue;
+            }
+            snprintf(path, sizeof(path), "%s/%s", DEPARTURES_CACHE_BASE_PATH, entry->d_name);
+            if (remove(path) == 0) removed++;
+        }
+        closedir(dir);
+    }
+    memset(write_slots, 0, sizeof(write_slots));
+
+    xSemaphoreGive(cache_mutex);
+    ESP_LOGI(TAG, "Cleared %d cached snapshots", removed);
+    return ESP_OK;
+}
@@ -0,0 +1,65 @@
+#include <stddef.h>
+#include <string.h>
+#include "esp_log.h"
+
+#include "digit_font.h"
+
+static const char *TAG = "digit_font";
+
+// One per base font in use (the countdowns use three sizes)
+#define DIGIT_FONT_SLOTS 6
+
+typedef struct {
+    lv_font_t font;                     // Copy of base, get_glyph_dsc swapped
+    const lv_font_t* base;
+    lv_font_glyph_dsc_t digits[10];     // '0'..'9' at the widest advance
+} digit_font_slot_t;
+
+static digit_font_slot_t slots[DIGIT_FONT_SLOTS];
+static int slot_count = 0;
+
+static bool digit_glyph_dsc(const lv_font_t* font, lv_font_glyph_dsc_t* dsc,
+                            uint32_t letter, uint32_t letter_next)
+{
+    const digit_font_slot_t* slot =
+        (const digit_font_slot_t*)((const char*)font - offsetof(digit_font_slot_t, font));
+
+    if (letter >= '0' && letter <= '9') {
+        *dsc = slot->digits[letter - '0'];
+        return true;
+    }
+    // The bitmap is then fetched through this copy, which shares base->dsc
+    return slot->base->get_glyph_dsc(slot->base, dsc, letter, letter_next);
+}
+
+const lv_font_t* digit_font(const lv_font_t* base)
+{
+    for (int i = 0; i < slot_count; i++) {
+        if (slots[i].base == base) return &slots[i].font;
+    }
+    if (slot_count >= DIGIT_FONT_SLOTS) {
+        ESP_LOGW(TAG, "No slot left, using proportional digits");
+        return base;
+    }
+
+    digit_font_slot_t* slot = &slots[slot_count];
+    uint16_t widest = 0;
+    for (int d = 0; d < 10; d++) {
+        // No kerning: tabular digits sit on a fixed pitch
+        if (!base->get_glyph_dsc(base, &slot->digits[d], '0' + d, 0)) {
+            ESP_LOGW(TAG, "Font has no digit glyphs, using it as is");
+            return base;
+        }
+        if (slot->digits[d].adv_w > widest) widest = slot->digits[d].adv_w;
+    }
+    for (int d = 0; d < 10; d++) {
+        slot->digits[d].ofs_x += (widest - slot->digits[d].adv_w) / 2;
+        slot->digits[d].adv_w = widest;
+    }
+
+    slot->font = *base;
+    slot->font.get_glyph_dsc = digit_glyph_dsc;
+    slot->base = base;
+    slot_count++;
+    return &slot->font;
+}
@@ -0,0 +1,410 @@
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/message_buffer.h"
+#include "esp_log.h"
+
+#include "config.h"
+#include "display_mirror.h"
+#include "power_mgmt.h"
+
+static const char *TAG = "mirror";
+
+// Encoded records wait in a message buffer (written by the flush path, read by
+// the sender task) so the LCD task never touches a socket.
+#define MIRROR_CHUNK_BYTES   2048    // Largest single record
+#define MIRROR_BUFFER_BYTES  16384   // Records queued between sender runs
+#define MIRROR_TX_BYTES      6144    // One WebSocket frame of packed records
+#define MIRROR_RECT_HDR      9
+#define MIRROR_BUDGET_STEP   (MIRROR_BYTES_PER_SEC * MIRROR_INTERVAL_MS / 1000)
+
+typedef struct {
+    httpd_handle_t hd;
+    int fd;
+    bool ready;              // HELLO sent, receives rect frames
+} mirror_client_t;
+
+static portMUX_TYPE mirror_lock = portMUX_INITIALIZER_UNLOCKED;
+static mirror_client_t clients[MIRROR_MAX_CLIENTS];
+static volatile int client_count = 0;
+
+// Allocated with the first viewer, freed by the sender after the last one
+static MessageBufferHandle_t mirror_buf = NULL;
+static uint8_t *encode_buf = NULL;
+static uint8_t *tx_buf = NULL;
+static bool feed_busy = false;      // Flush path is using the buffers
+static TaskHandle_t mirror_task_handle = NULL;
+
+// Byte budget: refilled by the sender, spent by the encoder (may go negative)
+static int32_t mirror_budget = 0;
+
+// Area viewers have not received yet (x2/y2 exclusive)
+static bool resync_pending = false;
+static int resync_x1, resync_y1, resync_x2, resync_y2;
+
+// ============================================================================
+// Encoder
+// ============================================================================
+
+static inline uint8_t* put_u16(uint8_t *p, int v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+    return p + 2;
+}
+
+// PackBits over 16-bit pixels. Worst case is 2 bytes per pixel plus one
+// control byte per 128 pixels.
+static size_t mirror_encode_rect(uint8_t *out, int x, int y, int w, int h, const uint16_t *px)
+{
+    uint8_t *p = out;
+    *p++ = MIRROR_REC_RECT;
+    p = put_u16(p, x);
+    p = put_u16(p, y);
+    p = put_u16(p, w);
+    p = put_u16(p, h);
+
+    int n = w * h;
+    int i = 0;
+    while (i < n) {
+        int run = 1;
+        while (i + run < n && run < 128 && px[i + run] == px[i]) {
+            run++;
+        }
+
+        if (run >= 2) {
+            *p++ = (uint8_t)(0x80 | (run - 1));
+            memcpy(p, &px[i], 2);
+            p += 2;
+            i += run;
+        } else {
+            // Literal block until the next run starts
+            int start = i;
+            int len = 0;
+            while (i < n && len < 128 && !(i + 1 < n && px[i + 1] == px[i])) {
+                i++;
+                len++;
+            }
+            *p++ = (uint8_t)(len - 1);
+            memcpy(p, &px[start], (size_t)len * 2);
+            p += len * 2;
+        }
+    }
+    return (size_t)(p - out);
+}
+
+static void mirror_mark_resync(int x1, int y1, int x2, int y2)
+{
+    portENTER_CRITICAL(&mirror_lock);
+    if (!resync_pending) {
+        resync_x1 = x1;
+        resync_y1 = y1;
+        resync_x2 = x2;
+        resync_y2 = y2;
+        resync_pending = true;
+    } else {
+        if (x1 < resync_x1) resync_x1 = x1;
+        if (y1 < resync_y1) resync_y1 = y1;
+        if (x2 > resync_x2) resync_x2 = x2;
+        if (y2 > resync_y2) resync_y2 = y2;
+    }
+    portEXIT_CRITICAL(&mirror_lock);
+}
+
+void display_mirror_feed(int x1, int y1, int x2, int y2, const void *pixels)
+{
+    if (client_count == 0 || !pixels) return;
+
+    int w = x2 - x1;
+    int h = y2 - y1;
+    if (w <= 0 || h <= 0) return;
+
+    // Hold the buffers so the sender cannot free them under us
+    portENTER_CRITICAL(&mirror_lock);
+    bool usable = client_count > 0 && mirror_buf;
+    bool over_budget = mirror_budget <= 0;
+    feed_busy = usable && !over_budget;
+    portEXIT_CRITICAL(&mirror_lock);
+    if (!usable) return;
+
+    if (over_budget) {
+        mirror_mark_resync(x1, y1, x2, y2);
+        return;
+    }
+
+    // Rows per record so the worst case still fits one chunk
+    int max_px = (MIRROR_CHUNK_BYTES - MIRROR_RECT_HDR - 1) * 128 / 257;
+    int rows_per_rec = max_px / w;
+    if (rows_per_rec < 1) rows_per_rec = 1;
+
+    const uint16_t *src = (const uint16_t *)pixels;
+    int32_t spent = 0;
+    for (int row = 0; row < h; row += rows_per_rec) {
+        int rows = (h - row < rows_per_rec) ? (h - row) : rows_per_rec;
+        size_t len = mirror_encode_rect(encode_buf, x1, y1 + row, w, rows, src + row * w);
+        if (xMessageBufferSend(mirror_buf, encode_buf, len, 0) != len) {
+            // Sender is behind: the rest of this area is repainted later
+            mirror_mark_resync(x1, y1 + row, x2, y2);
+            break;
+        }
+        spent += (int32_t)len;
+    }
+
+    portENTER_CRITICAL(&mirror_lock);
+    mirror_budget -= spent;
+    feed_busy = false;
+    portEXIT_CRITICAL(&mirror_lock);
+}
+
+bool display_mirror_take_resync(int *x1, int *y1, int *x2, int *y2)
+{
+    bool taken = false;
+
+    portENTER_CRITICAL(&mirror_lock);
+    if (resync_pending && client_count > 0 && mirror_budget > 0) {
+        *x1 = resync_x1;
+        *y1 = resync_y1;
+        *x2 = resync_x2;
+        *y2 = resync_y2;
+        resync_pending = false;
+        taken = true;
+    }
+    portEXIT_CRITICAL(&mirror_lock);
+    return taken;
+}
+
+bool display_mirror_active(void)
+{
+    return client_count > 0;
+}
+
+// ============================================================================
+// Sender Task
+// ============================================================================
+
+void display_mirror_remove_client(int fd)
+{
+    bool removed = false;
+
+    portENTER_CRITICAL(&mirror_lock);
+    for (int i = 0; i < client_count; i++) {
+        if (clients[i].fd == fd) {
+            clients[i] = clients[client_count - 1];
+            client_count--;
+            removed = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&mirror_lock);
+
+    if (removed) {
+        ESP_LOGI(TAG, "Viewer %d disconnected", fd);
+    }
+}
+
+// With the last viewer gone, hand the buffers back. Fails while the flush
+// path is inside display_mirror_feed(); the sender retries next period.
+static bool mirror_release_buffers(void)
+{
+    portENTER_CRITICAL(&mirror_lock);
+    bool idle = client_count == 0 && !feed_busy;
+    MessageBufferHandle_t buf = idle ? mirror_buf : NULL;
+    uint8_t *enc = idle ? encode_buf : NULL;
+    uint8_t *tx = idle ? tx_buf : NULL;
+    if (idle) {
+        mirror_buf = NULL;
+        encode_buf = NULL;
+        tx_buf = NULL;
+        mirror_budget = 0;
+        resync_pending = false;
+    }
+    portEXIT_CRITICAL(&mirror_lock);
+
+    if (buf) {
+        vMessageBufferDelete(buf);
+        ESP_LOGI(TAG, "No viewers, buffers freed");
+    }
+    free(enc);
+    free(tx);
+    return idle;
+}
+
+static esp_err_t mirror_send(const mirror_client_t *c, const uint8_t *data, size_t len)
+{
+    if (httpd_ws_get_fd_info(c->hd, c->fd) != HTTPD_WS_CLIENT_WEBSOCKET) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    httpd_ws_frame_t frame = {
+        .final = true,
+        .type = HTTPD_WS_TYPE_BINARY,
+        .payload = (uint8_t *)data,
+        .len = len
+    };
+    return httpd_ws_send_data(c->hd, c->fd, &frame);
+}
+
+// Send to every ready client (or only new ones for HELLO) and drop dead sockets
+static void mirror_broadcast(const uint8_t *data, size_t len, bool hello)
+{
+    mirror_client_t snapshot[MIRROR_MAX_CLIENTS];
+    int count;
+
+    portENTER_CRITICAL(&mirror_lock);
+    count = client_count;
+    memcpy(snapshot, clients, sizeof(snapshot));
+    portEXIT_CRITICAL(&mirror_lock);
+
+    for (int i = 0; i < count; i++) {
+        if (snapshot[i].ready == hello) continue;
+
+        if (mirror_send(&snapshot[i], data, len) != ESP_OK) {
+            display_mirror_remove_client(snapshot[i].fd);
+            continue;
+        }
+
+        if (hello) {
+            portENTER_CRITICAL(&mirror_lock);
+            for (int j = 0; j < client_count; j++) {
+                if (clients[j].fd == snapshot[i].fd) clients[j].ready = true;
+            }
+            portEXIT_CRITICAL(&mirror_lock);
+        }
+    }
+}
+
+static void mirror_task(void *arg)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (1) {
+        // Nothing to send without viewers; sleep until one connects
+        if (client_count == 0 && mirror_release_buffers()) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            last_wake = xTaskGetTickCount();
+        }
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(MIRROR_INTERVAL_MS));
+        if (!mirror_buf) continue;
+
+        portENTER_CRITICAL(&mirror_lock);
+        mirror_budget += MIRROR_BUDGET_STEP;
+        if (mirror_budget > MIRROR_BUFFER_BYTES) mirror_budget = MIRROR_BUFFER_BYTES;
+        bool resync = resync_pending;
+        portEXIT_CRITICAL(&mirror_lock);
+
+        // The main loop repaints the dropped area once there is budget again
+        if (resync) {
+            power_loop_wake();
+        }
+
+        // New viewers get the stream header before any rect
+        uint8_t hello[6];
+        hello[0] = MIRROR_REC_HELLO;
+        put_u16(&hello[1], LCD_WIDTH);
+        put_u16(&hello[3], LCD_HEIGHT);
+        hello[5] = MIRROR_FORMAT_RGB565_BE;
+        mirror_broadcast(hello, sizeof(hello), true);
+
+        // Pack queued records into as few frames as possible
+        size_t used = 0;
+        while (1) {
+            if (MIRROR_TX_BYTES - used < MIRROR_CHUNK_BYTES) {
+                mirror_broadcast(tx_buf, used, false);
+                used = 0;
+            }
+            size_t n = xMessageBufferReceive(mirror_buf, tx_buf + used, MIRROR_TX_BYTES - used, 0);
+            if (n == 0) break;
+            used += n;
+        }
+        if (used > 0) {
+            mirror_broadcast(tx_buf, used, false);
+        }
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+esp_err_t display_mirror_init(void)
+{
+    if (mirror_task_handle) return ESP_OK;
+
+    BaseType_t ret = xTaskCreate(mirror_task, "display_mirror", 4096, NULL, 3, &mirror_task_handle);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create mirror task");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t display_mirror_add_client(httpd_handle_t hd, int fd)
+{
+    // Buffers are only paid for while someone actually watches. The sender
+    // may free them between our check and the registration, so allocate
+    // and look again until the client goes in with buffers in place.
+    MessageBufferHandle_t buf = NULL;
+    uint8_t *enc = NULL;
+    uint8_t *tx = NULL;
+    bool full = false;
+
+    while (1) {
+        portENTER_CRITICAL(&mirror_lock);
+        bool have_buffers = mirror_buf || buf;
+        if (have_buffers) {
+            int slot = 0;
+            while (slot < client_count && clients[slot].fd != fd) {
+                slot++;
+            }
+            if (slot == client_count && client_count >= MIRROR_MAX_CLIENTS) {
+                full = true;
+            } else {
+                // A known fd is a new connection on a reused socket
+                clients[slot].hd = hd;
+                clients[slot].fd = fd;
+                clients[slot].ready = false;
+                if (slot == client_count) client_count++;
+                if (!mirror_buf) {
+                    mirror_buf = buf;
+                    encode_buf = enc;
+                    tx_buf = tx;
+                    buf = NULL;
+                    enc = NULL;
+                    tx = NULL;
+                }
+            }
+        }
+        portEXIT_CRITICAL(&mirror_lock);
+        if (have_buffers) break;
+
+        enc = malloc(MIRROR_CHUNK_BYTES);
+        tx = malloc(MIRROR_TX_BYTES);
+        buf = xMessageBufferCreate(MIRROR_BUFFER_BYTES);
+        if (!enc || !tx || !buf) {
+            if (buf) vMessageBufferDelete(buf);
+            free(enc);
+            free(tx);
+            ESP_LOGE(TAG, "No memory for mirror buffers");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    // Unused if another viewer got its buffers in first
+    if (buf) vMessageBufferDelete(buf);
+    free(enc);
+    free(tx);
+
+    if (full) {
+        ESP_LOGW(TAG, "Viewer limit reached (%d)", MIRROR_MAX_CLIENTS);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // A new viewer starts from a full repaint
+    mirror_mark_resync(0, 0, LCD_WIDTH, LCD_HEIGHT);
+    if (mirror_task_handle) {
+        xTaskNotifyGive(mirror_task_handle);
+    }
+    ESP_LOGI(TAG, "Viewer %d connected", fd);
+    return ESP_OK;
+}
@@ -0,0 +1,296 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#include "event_stream.h"
+#include "wifi_manager.h"
+#include "lcd_driver.h"
+#include "tfnsw_client.h"
+
+static const char *TAG = "events";
+
+#define EVENT_TOPIC_COUNT   4
+#define EVENT_MSG_MAX       768
+#define EVENT_PING_MS       15000   // Comment line so dead sockets get noticed
+
+static const char *topic_names[EVENT_TOPIC_COUNT] = { "view", "tfnsw", "wifi", "heap" };
+
+typedef struct {
+    httpd_req_t *req;       // Async copy owned by this module
+    bool synced;            // Has received every topic once
+} event_client_t;
+
+static portMUX_TYPE client_lock = portMUX_INITIALIZER_UNLOCKED;
+static event_client_t clients[EVENT_STREAM_MAX_CLIENTS];
+static int client_count = 0;
+
+static TaskHandle_t stream_task_handle = NULL;
+
+// Last message per topic (only touched by the stream task)
+static char last_msg[EVENT_TOPIC_COUNT][EVENT_MSG_MAX];
+static size_t last_len[EVENT_TOPIC_COUNT];
+static char scratch[EVENT_MSG_MAX];
+static tfnsw_departures_t deps_scratch;
+
+// ============================================================================
+// Topic Formatting
+// ============================================================================
+
+// Append a JSON string literal, escaping quotes, backslashes and control chars
+static int append_json_str(char *buf, int pos, int size, const char *s)
+{
+    if (pos < size) buf[pos] = '"';
+    pos++;
+    for (; s && *s && pos < size - 2; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            buf[pos++] = '\\';
+            buf[pos++] = (char)c;
+        } else if (c >= 0x20) {
+            buf[pos++] = (char)c;
+        }
+    }
+    if (pos < size) buf[pos] = '"';
+    return pos + 1;
+}
+
+#define APPEND(...) \
+    do { if (pos < size) pos += snprintf(buf + pos, size - pos, __VA_ARGS__); } while (0)
+
+static int format_view(char *buf, int size)
+{
+    int pos = 0;
+    view_id_t view = lcd_get_current_view();
+    const view_config_t *config = lcd_get_view_config(view);
+    APPEND("{\"view\":%d,\"name\":", (int)view);
+    pos = append_json_str(buf, pos, size, config ? config->name : "Unknown");
+    APPEND("}");
+    return pos;
+}
+
+int event_stream_format_tfnsw(char *buf, int size, tfnsw_departures_t *deps)
+{
+    int pos = 0;
+    // What the view on screen is showing, with its last fetch's status (the
+    // single-view fetch reports to the view store, not current_departures)
+    if (!lcd_get_view_data(lcd_get_current_view(), deps)) {
+        deps->count = 0;
+        deps->status = TFNSW_STATUS_IDLE;
+    }
+
+    APPEND("{\"has_api_key\":%s,\"status\":", tfnsw_has_api_key() ? "true" : "false");
+    pos = append_json_str(buf, pos, size, tfnsw_status_to_string(deps->status));
+    if (deps->count > 0) {
+        APPEND(",\"station\":");
+        pos = append_json_str(buf, pos, size, deps->station_name);
+        APPEND(",\"departures\":[");
+        for (int i = 0; i < deps->count && i < 3; i++) {
+            char mins_str[16];
+            tfnsw_format_departure_time(deps->departures[i].mins_to_departure,
+                                        mins_str, sizeof(mins_str));
+            APPEND("%s{\"destination\":", i ? "," : "");
+            pos = append_json_str(buf, pos, size, deps->departures[i].destination);
+            APPEND(",\"mins\":\"%s\",\"realtime\":%s}", mins_str,
+                   deps->departures[i].is_realtime ? "true" : "false");
+        }
+        APPEND("]");
+    }
+    APPEND("}");
+    return pos;
+}
+
+static int format_wifi(char *buf, int size)
+{
+    int pos = 0;
+    // RSSI rounded to 5 dBm so normal jitter does not produce a message
+    int rssi = wifi_get_rssi();
+    rssi = (rssi - 2) / 5 * 5;
+
+    APPEND("{\"wifi_connected\":%s,\"ssid\":", wifi_is_connected() ? "true" : "false");
+    pos = append_json_str(buf, pos, size, wifi_get_ssid());
+    APPEND(",\"rssi\":%d,\"ip\":", rssi);
+    pos = append_json_str(buf, pos, size, wifi_get_ip());
+    APPEND("}");
+    return pos;
+}
+
+static int format_heap(char *buf, int size)
+{
+    int pos = 0;
+    // KB resolution: allocator noise below that is not interesting
+    APPEND("{\"free_heap\":%lu,\"min_free_heap\":%lu}",
+           (unsigned long)(esp_get_free_heap_size() / 1024 * 1024),
+           (unsigned long)(esp_get_minimum_free_heap_size() / 1024 * 1024));
+    return pos;
+}
+
+#undef APPEND
+
+// Build "event: <topic>\ndata: <json>\n\n" into scratch
+static size_t format_topic(int topic)
+{
+    int size = sizeof(scratch);
+    int pos = snprintf(scratch, size, "event: %s\ndata: ", topic_names[topic]);
+    int body_size = size - pos - 3;
+
+    switch (topic) {
+        case 0: pos += format_view(scratch + pos, body_size); break;
+        case 1: pos += event_stream_format_tfnsw(scratch + pos, body_size, &deps_scratch); break;
+        case 2: pos += format_wifi(scratch + pos, body_size); break;
+        default: pos += format_heap(scratch + pos, body_size); break;
+    }
+    if (pos > size - 3) {
+        ESP_LOGW(TAG, "Topic %s truncated", topic_names[topic]);
+        return 0;
+    }
+    memcpy(scratch + pos, "\n\n", 3);
+    return (size_t)pos + 2;
+}
+
+// ============================================================================
+// Fan-out
+// ============================================================================
+
+static void drop_client(int index)
+{
+    httpd_req_t *req = clients[index].req;
+
+    portENTER_CRITICAL(&client_lock);
+    clients[index] = clients[client_count - 1];
+    client_count--;
+    portEXIT_CRITICAL(&client_lock);
+
+    httpd_req_async_handler_complete(req);
+    ESP_LOGI(TAG, "Client disconnected (%d left)", client_count);
+}
+
+// Send to every synced client; drops clients whose socket has gone away
+static void send_to_clients(const char *data, size_t len)
+{
+    for (int i = client_count - 1; i >= 0; i--) {
+        if (!clients[i].synced) continue;
+        if (httpd_resp_send_chunk(clients[i].req, data, len) != ESP_OK) {
+            drop_client(i);
+        }
+    }
+}
+
+static void stream_task(void *arg)
+{
+    uint32_t last_ping_ms = 0;
+
+    while (1) {
+        uint32_t topics = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &topics, pdMS_TO_TICKS(EVENT_STREAM_POLL_MS));
+        if (client_count == 0) continue;
+
+        // Wifi and heap have no publisher; the dedup below keeps them quiet
+        topics |= EVENT_TOPIC_WIFI | EVENT_TOPIC_HEAP;
+
+        bool new_clients = false;
+        for (int i = 0; i < client_count; i++) {
+            if (!clients[i].synced) new_clients = true;
+        }
+        if (new_clients) {
+            topics = EVENT_TOPIC_ALL;
+        }
+
+        for (int t = 0; t < EVENT_TOPIC_COUNT; t++) {
+            if (!(topics & (1U << t))) continue;
+
+            size_t len = format_topic(t);
+            if (len == 0) continue;
+            if (len == last_len[t] && memcmp(scratch, last_msg[t], len) == 0) continue;
+
+            memcpy(last_msg[t], scratch, len);
+            last_len[t] = len;
+            send_to_clients(last_msg[t], len);
+        }
+
+        // New clients get the last message of every topic
+        for (int i = client_count - 1; i >= 0; i--) {
+            if (clients[i].synced) continue;
+            esp_err_t ret = ESP_OK;
+            for (int t = 0; t < EVENT_TOPIC_COUNT && ret == ESP_OK; t++) {
+                if (last_len[t] > 0) {
+                    ret = httpd_resp_send_chunk(clients[i].req, last_msg[t], last_len[t]);
+                }
+            }
+            if (ret == ESP_OK) {
+                clients[i].synced = true;
+            } else {
+                drop_client(i);
+            }
+        }
+
+        uint32_t now_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+        if (now_ms - last_ping_ms >= EVENT_PING_MS) {
+            last_ping_ms = now_ms;
+            send_to_clients(": ping\n\n", 8);
+        }
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+esp_err_t event_stream_init(void)
+{
+    if (stream_task_handle) return ESP_OK;
+
+    BaseType_t ret = xTaskCreate(stream_task, "event_stream", 4096, NULL, 3, &stream_task_handle);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create event stream task");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t event_stream_add_client(httpd_req_t *req)
+{
+    if (!stream_task_handle) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Events not available");
+        return ESP_FAIL;
+    }
+    if (client_count >= EVENT_STREAM_MAX_CLIENTS) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_send(req, "Too many event clients", HTTPD_RESP_USE_STRLEN);
+        return ESP_OK;
+    }
+
+    // Headers and the retry hint go out now, on the httpd task
+    httpd_resp_set_type(req, "text/event-stream");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    static const char preamble[] = "retry: 3000\n\n";
+    if (httpd_resp_send_chunk(req, preamble, sizeof(preamble) - 1) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    httpd_req_t *async_req = NULL;
+    esp_err_t ret = httpd_req_async_handler_begin(req, &async_req);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to detach event request: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    portENTER_CRITICAL(&client_lock);
+    clients[client_count].req = async_req;
+    clients[client_count].synced = false;
+    client_count++;
+    portEXIT_CRITICAL(&client_lock);
+
+    ESP_LOGI(TAG, "Client connected (%d total)", client_count);
+    event_stream_publish(EVENT_TOPIC_ALL);
+    return ESP_OK;
+}
+
+void event_stream_publish(uint32_t topics)
+{
+    if (stream_task_handle && client_count > 0) {
+        xTaskNotify(stream_task_handle, topics, eSetBits);
+    }
+}
@@ -0,0 +1,233 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#include "event_trace.h"
+#include "json_writer.h"
+
+#define TRACE_MASK      (TRACE_RING_SIZE - 1)
+#define TRACE_TASK_ISR  0xFF
+#define TRACE_TASK_MORE 0xFE    // Task table full
+#define TRACE_NAME_NONE 0xFF
+
+_Static_assert((TRACE_RING_SIZE & TRACE_MASK) == 0, "TRACE_RING_SIZE must be a power of two");
+
+typedef enum {
+    TRACE_PH_BEGIN = 'B',
+    TRACE_PH_END = 'E',
+    TRACE_PH_INSTANT = 'i',
+} trace_phase_t;
+
+typedef struct {
+    uint32_t seq;           // seq + 1 once published, 0 while being written
+    uint32_t ts_us;         // Low 32 bits of esp_timer_get_time()
+    uint32_t arg;
+    uint8_t phase;          // trace_phase_t
+    uint8_t name;           // Index into names
+    uint8_t task;           // Index into tasks (TRACE_TASK_ISR from an ISR)
+    uint8_t reserved;
+} trace_event_t;
+
+_Static_assert(sizeof(trace_event_t) == 16, "trace events are 16 bytes");
+
+static trace_event_t ring[TRACE_RING_SIZE];
+static uint32_t ring_head = 0;
+static uint32_t ring_floor = 0;
+
+static const char *names[TRACE_MAX_NAMES];
+
+// Task names are copied when a task first traces so the export still has
+// them after the task is deleted
+typedef struct {
+    TaskHandle_t handle;
+    char name[configMAX_TASK_NAME_LEN];
+    bool ready;
+} trace_task_t;
+
+static trace_task_t tasks[TRACE_MAX_TASKS];
+static uint32_t task_count = 0;
+
+// ============================================================================
+// Interning
+// ============================================================================
+
+static uint8_t name_id(const char *name)
+{
+    for (int i = 0; i < TRACE_MAX_NAMES; i++) {
+        const char *n = __atomic_load_n(&names[i], __ATOMIC_ACQUIRE);
+        if (!n) {
+            const char *expected = NULL;
+            if (__atomic_compare_exchange_n(&names[i], &expected, name, false,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                return (uint8_t)i;
+            }
+            n = expected;
+        }
+        if (n == name || strcmp(n, name) == 0) {
+            return (uint8_t)i;
+        }
+    }
+    return TRACE_NAME_NONE;
+}
+
+static uint8_t task_id(void)
+{
+    if (xPortInIsrContext()) return TRACE_TASK_ISR;
+
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    uint32_t count = __atomic_load_n(&task_count, __ATOMIC_ACQUIRE);
+    for (uint32_t i = 0; i < count && i < TRACE_MAX_TASKS; i++) {
+        if (tasks[i].ready && tasks[i].handle == self) {
+            return (uint8_t)i;
+        }
+    }
+
+    if (count >= TRACE_MAX_TASKS) return TRACE_TASK_MORE;
+
+    // A task only races with other tasks here, never with itself
+    uint32_t slot = __atomic_fetch_add(&task_count, 1, __ATOMIC_ACQ_REL);
+    if (slot >= TRACE_MAX_TASKS) return TRACE_TASK_MORE;
+    tasks[slot].handle = self;
+    strncpy(tasks[slot].name, pcTaskGetName(self), sizeof(tasks[slot].name) - 1);
+    __atomic_store_n(&tasks[slot].ready, true, __ATOMIC_RELEASE);
+    return (uint8_t)slot;
+}
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+static void record(trace_phase_t phase, const char *name, uint32_t ts_us, uint32_t arg)
+{
+    uint32_t seq = __atomic_fetch_add(&ring_head, 1, __ATOMIC_RELAXED);
+    trace_event_t *e = &ring[seq & TRACE_MASK];
+
+    __atomic_store_n(&e->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    e->ts_us = ts_us;
+    e->arg = arg;
+    e->phase = (uint8_t)phase;
+    e->name = name ? name_id(name) : TRACE_NAME_NONE;
+    e->task = task_id();
+
+    __atomic_store_n(&e->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+static uint32_t now_us(void)
+{
+    return (uint32_t)esp_timer_get_time();
+}
+
+void trace_begin(const char *name)
+{
+    record(TRACE_PH_BEGIN, name, now_us(), 0);
+}
+
+void trace_end(const char *name, uint32_t arg)
+{
+    record(TRACE_PH_END, name, now_us(), arg);
+}
+
+void trace_instant(const char *name, uint32_t arg)
+{
+    record(TRACE_PH_INSTANT, name, now_us(), arg);
+}
+
+void trace_span(const char *name, int64_t start_us, uint32_t arg)
+{
+    uint32_t end_us = now_us();
+    record(TRACE_PH_BEGIN, name, (uint32_t)start_us, 0);
+    record(TRACE_PH_END, name, end_us, arg);
+}
+
+void trace_clear(void)
+{
+    __atomic_store_n(&ring_floor, __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE), __ATOMIC_RELAXED);
+}
+
+// ============================================================================
+// Chrome Trace Export
+// ============================================================================
+
+// Copy one event if it is still the one with this sequence number
+static bool read_event(uint32_t seq, trace_event_t *out)
+{
+    const trace_event_t *slot = &ring[seq & TRACE_MASK];
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != seq + 1) return false;
+    memcpy(out, slot, sizeof(*out));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq + 1;
+}
+
+static void write_thread_name(json_writer_t *w, int tid, const char *name)
+{
+    jw_object_begin(w, NULL);
+    jw_string(w, "name", "thread_name");
+    jw_string(w, "ph", "M");
+    jw_number(w, "pid", 1);
+    jw_number(w, "tid", tid);
+    jw_object_begin(w, "args");
+    jw_string(w, "name", name);
+    jw_object_end(w);
+    jw_object_end(w);
+}
+
+esp_err_t trace_export(httpd_req_t *req)
+{
+    uint32_t head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+    uint32_t oldest = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0;
+    uint32_t floor = __atomic_load_n(&ring_floor, __ATOMIC_RELAXED);
+    if ((int32_t)(floor - oldest) > 0) oldest = floor;
+
+    // Timestamps are 32-bit; widen them relative to now (the ring covers
+    // far less than the ~35 minutes a signed difference can span)
+    int64_t now64 = esp_timer_get_time();
+    uint32_t now32 = (uint32_t)now64;
+
+    json_writer_t w;
+    jw_begin(&w, req, false);
+    jw_object_begin(&w, NULL);
+    jw_string(&w, "displayTimeUnit", "ms");
+    jw_array_begin(&w, "traceEvents");
+
+    uint32_t count = __atomic_load_n(&task_count, __ATOMIC_ACQUIRE);
+    for (uint32_t i = 0; i < count && i < TRACE_MAX_TASKS; i++) {
+        if (tasks[i].ready) {
+            write_thread_name(&w, (int)i, tasks[i].name);
+        }
+    }
+    write_thread_name(&w, TRACE_TASK_MORE, "other");
+    write_thread_name(&w, TRACE_TASK_ISR, "isr");
+
+    char ph[2] = { 0, 0 };
+    for (uint32_t seq = oldest; seq != head && w.err == ESP_OK; seq++) {
+        trace_event_t e;
+        if (!read_event(seq, &e)) continue;
+
+        const char *name = e.name < TRACE_MAX_NAMES ? names[e.name] : NULL;
+        ph[0] = (char)e.phase;
+        int64_t ts = now64 - (int32_t)(now32 - e.ts_us);
+
+        jw_object_begin(&w, NULL);
+        jw_string(&w, "name", name ? name : "?");
+        jw_string(&w, "ph", ph);
+        jw_number(&w, "ts", (double)ts);
+        jw_number(&w, "pid", 1);
+        jw_number(&w, "tid", e.task);
+        if (e.phase == TRACE_PH_INSTANT) {
+            jw_string(&w, "s", "t");
+        }
+        if (e.phase != TRACE_PH_BEGIN) {
+            jw_object_begin(&w, "args");
+            jw_number(&w, "v", e.arg);
+            jw_object_end(&w);
+        }
+        jw_object_end(&w);
+    }
+
+    jw_array_end(&w);
+    jw_object_end(&w);
+    return jw_finish(&w);
+}
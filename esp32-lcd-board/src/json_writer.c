@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include <float.h>
+
+#include "json_writer.h"
+
+// ============================================================================
+// Output Buffer
+// ============================================================================
+
+static void jw_flush(json_writer_t *w)
+{
+    if (w->len > 0 && w->err == ESP_OK) {
+        w->err = httpd_resp_send_chunk(w->req, w->buf, w->len);
+    }
+    w->len = 0;
+}
+
+static void jw_write(json_writer_t *w, const char *data, size_t len)
+{
+    while (len > 0) {
+        if (w->len == JSON_WRITER_BUF) {
+            jw_flush(w);
+        }
+        size_t n = JSON_WRITER_BUF - w->len;
+        if (n > len) n = len;
+        memcpy(w->buf + w->len, data, n);
+        w->len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+static inline void jw_putc(json_writer_t *w, char c)
+{
+    jw_write(w, &c, 1);
+}
+
+static void jw_tabs(json_writer_t *w, int count)
+{
+    for (int i = 0; i < count; i++) {
+        jw_putc(w, '\t');
+    }
+}
+
+// Same escaping as cJSON: quote, backslash, the short escapes, \uXXXX for
+// other control characters, everything else raw
+static void jw_quoted(json_writer_t *w, const char *s)
+{
+    jw_putc(w, '"');
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        const char *esc = NULL;
+        switch (c) {
+            case '"':  esc = "\\\""; break;
+            case '\\': esc = "\\\\"; break;
+            case '\b': esc = "\\b"; break;
+            case '\f': esc = "\\f"; break;
+            case '\n': esc = "\\n"; break;
+            case '\r': esc = "\\r"; break;
+            case '\t': esc = "\\t"; break;
+            default: break;
+        }
+        if (esc) {
+            jw_write(w, esc, 2);
+        } else if (c < 32) {
+            char hex[7];
+            snprintf(hex, sizeof(hex), "\\u%04x", c);
+            jw_write(w, hex, 6);
+        } else {
+            jw_putc(w, (char)c);
+        }
+    }
+    jw_putc(w, '"');
+}
+
+// Separator, indentation and key before a value at the current depth
+static void jw_member(json_writer_t *w, const char *key)
+{
+    if (w->depth == 0) return;  // Root value
+
+    int level = w->depth - 1;
+    if (w->in_array[level]) {
+        if (w->has_items[level]) {
+            jw_write(w, w->pretty ? ", " : ",", w->pretty ? 2 : 1);
+        }
+    } else {
+        if (w->has_items[level]) {
+            jw_putc(w, ',');
+            if (w->pretty) jw_putc(w, '\n');
+        }
+        if (w->pretty) jw_tabs(w, w->depth);
+        jw_quoted(w, key ? key : "");
+        jw_putc(w, ':');
+        if (w->pretty) jw_putc(w, '\t');
+    }
+    w->has_items[level] = true;
+}
+
+static void jw_open(json_writer_t *w, const char *key, bool array)
+{
+    jw_member(w, key);
+    if (w->depth >= JSON_WRITER_MAX_DEPTH) {
+        w->err = ESP_ERR_INVALID_SIZE;
+        return;
+    }
+    jw_putc(w, array ? '[' : '{');
+    if (!array && w->pretty) jw_putc(w, '\n');
+    w->in_array[w->depth] = array;
+    w->has_items[w->depth] = false;
+    w->depth++;
+}
+
+static void jw_close(json_writer_t *w, bool array)
+{
+    if (w->depth == 0) return;
+    w->depth--;
+    if (!array && w->pretty) {
+        if (w->has_items[w->depth]) jw_putc(w, '\n');
+        jw_tabs(w, w->depth);
+    }
+    jw_putc(w, array ? ']' : '}');
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void jw_begin(json_writer_t *w, httpd_req_t *req, bool pretty)
+{
+    memset(w, 0, offsetof(json_writer_t, buf));
+    w->req = req;
+    w->pretty = pretty;
+    w->err = ESP_OK;
+    httpd_resp_set_type(req, "application/json");
+}
+
+esp_err_t jw_finish(json_writer_t *w)
+{
+    jw_flush(w);
+    if (w->err == ESP_OK) {
+        w->err = httpd_resp_send_chunk(w->req, NULL, 0);
+    }
+    return w->err;
+}
+
+void jw_object_begin(json_writer_t *w, const char *key)
+{
+    jw_open(w, key, false);
+}
+
+void jw_object_end(json_writer_t *w)
+{
+    jw_close(w, false);
+}
+
+void jw_array_begin(json_writer_t *w, const char *key)
+{
+    jw_open(w, key, true);
+}
+
+void jw_array_end(json_writer_t *w)
+{
+    jw_close(w, true);
+}
+
+void jw_string(json_writer_t *w, const char *key, const char *value)
+{
+    // cJSON_AddStringToObject() adds nothing for a NULL string
+    if (!value) return;
+    jw_member(w, key);
+    jw_quoted(w, value);
+}
+
+// cJSON's compare_double(): %1.15g output that reads back within an ulp of
+// the value is kept
+static bool jw_close_enough(double a, double b)
+{
+    double max_val = fabs(a) > fabs(b) ? fabs(a) : fabs(b);
+    return fabs(a - b) <= max_val * DBL_EPSILON;
+}
+
+// Number formatting follows cJSON's print_number()
+void jw_number(json_writer_t *w, const char *key, double value)
+{
+    char num[26];
+    int len;
+
+    jw_member(w, key);
+    if (isnan(value) || isinf(value)) {
+        len = snprintf(num, sizeof(num), "null");
+    } else {
+        int as_int = value >= INT_MAX ? INT_MAX : (value <= (double)INT_MIN ? INT_MIN : (int)value);
+        if (value == (double)as_int) {
+            len = snprintf(num, sizeof(num), "%d", as_int);
+        } else {
+            double check = 0;
+            len = snprintf(num, sizeof(num), "%1.15g", value);
+            if (sscanf(num, "%lg", &check) != 1 || !jw_close_enough(check, value)) {
+                len = snprintf(num, sizeof(num), "%1.17g", value);
+            }
+        }
+    }
+    jw_write(w, num, (size_t)len);
+}
+
+void jw_bool(json_writer_t *w, const char *key, bool value)
+{
+    jw_member(w, key);
+    if (value) {
+        jw_write(w, "true", 4);
+    } else {
+        jw_write(w, "false", 5);
+    }
+}
+
+void jw_raw(json_writer_t *w, const char *key, const char *json, size_t len)
+{
+    jw_member(w, key);
+    jw_write(w, json, len);
+}
@@ -0,0 +1,443 @@
+#include <string.h>
+
+#include "lan_proto.h"
+
+// Wrap-safe "a is at or after b" for millisecond tick counts
+#define MS_REACHED(now, t)  ((int32_t)((now) - (t)) >= 0)
+#define MS_SINCE(now, t)    ((uint32_t)((now) - (t)))
+
+// ============================================================================
+// Byte Writer / Reader
+// ============================================================================
+
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+} lan_out_t;
+
+static void put_bytes(lan_out_t *o, const void *data, size_t n)
+{
+    if (o->overflow || o->len + n > o->cap) {
+        o->overflow = true;
+        return;
+    }
+    memcpy(o->buf + o->len, data, n);
+    o->len += n;
+}
+
+static void put_u8(lan_out_t *o, uint8_t v)
+{
+    put_bytes(o, &v, 1);
+}
+
+static void put_le(lan_out_t *o, uint64_t v, size_t n)
+{
+    uint8_t b[8];
+    for (size_t i = 0; i < n; i++) {
+        b[i] = (uint8_t)(v >> (8 * i));
+    }
+    put_bytes(o, b, n);
+}
+
+static void put_str(lan_out_t *o, const char *s)
+{
+    size_t n = s ? strnlen(s, 255) : 0;
+    put_u8(o, (uint8_t)n);
+    put_bytes(o, s, n);
+}
+
+// Reserve the u16 length, write the type; lan_frame_end() fills the length
+static void lan_frame_begin(lan_out_t *o, uint8_t *buf, size_t cap, uint8_t type)
+{
+    o->buf = buf;
+    o->cap = cap;
+    o->len = 0;
+    o->overflow = false;
+    put_le(o, 0, 2);
+    put_u8(o, type);
+}
+
+static size_t lan_frame_end(lan_out_t *o)
+{
+    if (o->overflow || o->len - 2 > 0xFFFF) return 0;
+    o->buf[0] = (uint8_t)(o->len - 2);
+    o->buf[1] = (uint8_t)((o->len - 2) >> 8);
+    return o->len;
+}
+
+typedef struct {
+    const uint8_t *p;
+    size_t len;
+    bool bad;
+} lan_in_t;
+
+static uint64_t get_le(lan_in_t *in, size_t n)
+{
+    uint64_t v = 0;
+    if (in->bad || in->len < n) {
+        in->bad = true;
+        return 0;
+    }
+    for (size_t i = 0; i < n; i++) {
+        v |= (uint64_t)in->p[i] << (8 * i);
+    }
+    in->p += n;
+    in->len -= n;
+    return v;
+}
+
+// Copies into a fixed char array, truncating to fit
+static void get_str(lan_in_t *in, char *dst, size_t size)
+{
+    size_t n = (size_t)get_le(in, 1);
+    if (in->bad || in->len < n) {
+        in->bad = true;
+        dst[0] = '\0';
+        return;
+    }
+    size_t keep = n < size - 1 ? n : size - 1;
+    memcpy(dst, in->p, keep);
+    dst[keep] = '\0';
+    in->p += n;
+    in->len -= n;
+}
+
+// ============================================================================
+// Codec
+// ============================================================================
+
+size_t lan_encode_hello(uint8_t *buf, size_t cap, uint32_t node_id)
+{
+    lan_out_t o;
+    lan_frame_begin(&o, buf, cap, LAN_MSG_HELLO);
+    put_le(&o, LAN_PROTO_MAGIC, 4);
+    put_u8(&o, LAN_PROTO_VERSION);
+    put_le(&o, node_id, 4);
+    return lan_frame_end(&o);
+}
+
+size_t lan_encode_subscribe(uint8_t *buf, size_t cap, const char *stop_id, uint32_t have_version)
+{
+    lan_out_t o;
+    lan_frame_begin(&o, buf, cap, LAN_MSG_SUBSCRIBE);
+    put_str(&o, stop_id);
+    put_le(&o, have_version, 4);
+    return lan_frame_end(&o);
+}
+
+size_t lan_encode_ping(uint8_t *buf, size_t cap)
+{
+    lan_out_t o;
+    lan_frame_begin(&o, buf, cap, LAN_MSG_PING);
+    return lan_frame_end(&o);
+}
+
+// SNAPSHOT payload:
+//   str stop_id, u32 version, i64 fetched_ms, u8 status, u8 flags (bit0
+//   suspended), str station, str suspension_message, u8 count, then per
+//   departure: str destination, str platform, str line, str calling,
+//   i64 scheduled, i64 estimated (unix s), i16 mins, i32 delay_s,
+//   u8 direction, u8 flags (realtime, cancelled, delayed, occupancy valid),
+//   u8 occupancy, u8 alert_severity, str alert
+size_t lan_encode_snapshot(uint8_t *buf, size_t cap, const char *stop_id, uint32_t version,
+                           const tfnsw_departures_t *deps)
+{
+    lan_out_t o;
+    lan_frame_begin(&o, buf, cap, LAN_MSG_SNAPSHOT);
+    put_str(&o, stop_id);
+    put_le(&o, version, 4);
+    put_le(&o, (uint64_t)deps->last_fetch_time, 8);
+    put_u8(&o, (uint8_t)deps->status);
+    put_u8(&o, deps->service_suspended ? 0x01 : 0);
+    put_str(&o, deps->station_name);
+    put_str(&o, deps->service_suspended ? deps->suspension_message : "");
+
+    int count = deps->count < TFNSW_MAX_DEPARTURES ? deps->count : TFNSW_MAX_DEPARTURES;
+    put_u8(&o, (uint8_t)count);
+    for (int i = 0; i < count; i++) {
+        const tfnsw_departure_t *d = &deps->departures[i];
+        put_str(&o, d->destination);
+        put_str(&o, d->platform);
+        put_str(&o, d->line_name);
+        put_str(&o, d->calling_stations);
+        put_le(&o, (uint64_t)d->scheduled_time, 8);
+        put_le(&o, (uint64_t)d->estimated_time, 8);
+        put_le(&o, (uint16_t)(int16_t)d->mins_to_departure, 2);
+        put_le(&o, (uint32_t)d->delay_seconds, 4);
+        put_u8(&o, (uint8_t)d->direction);
+        put_u8(&o, (d->is_realtime ? 0x01 : 0) | (d->is_cancelled ? 0x02 : 0) |
+                   (d->is_delayed ? 0x04 : 0) | (d->occupancy_available ? 0x08 : 0));
+        put_u8(&o, d->occupancy_percent);
+        put_u8(&o, (uint8_t)d->alert_severity);
+        put_str(&o, d->alert_severity != TFNSW_ALERT_NONE ? d->alert_message : "");
+    }
+    return lan_frame_end(&o);
+}
+
+bool lan_decode_hello(const uint8_t *p, size_t len, uint32_t *node_id)
+{
+    lan_in_t in = { p, len, false };
+    uint32_t magic = (uint32_t)get_le(&in, 4);
+    uint8_t version = (uint8_t)get_le(&in, 1);
+    uint32_t id = (uint32_t)get_le(&in, 4);
+    if (in.bad || magic != LAN_PROTO_MAGIC || version != LAN_PROTO_VERSION) {
+        return false;
+    }
+    if (node_id) *node_id = id;
+    return true;
+}
+
+bool lan_decode_subscribe(const uint8_t *p, size_t len, char *stop_id, size_t stop_size,
+                          uint32_t *have_version)
+{
+    lan_in_t in = { p, len, false };
+    get_str(&in, stop_id, stop_size);
+    *have_version = (uint32_t)get_le(&in, 4);
+    return !in.bad;
+}
+
+bool lan_decode_snapshot(const uint8_t *p, size_t len, char *stop_id, size_t stop_size,
+                         uint32_t *version, tfnsw_departures_t *out)
+{
+    lan_in_t in = { p, len, false };
+    memset(out, 0, sizeof(*out));
+
+    get_str(&in, stop_id, stop_size);
+    *version = (uint32_t)get_le(&in, 4);
+    out->last_fetch_time = (int64_t)get_le(&in, 8);
+    out->status = (tfnsw_status_t)get_le(&in, 1);
+    out->service_suspended = (get_le(&in, 1) & 0x01) != 0;
+    get_str(&in, out->station_name, sizeof(out->station_name));
+    get_str(&in, out->suspension_message, sizeof(out->suspension_message));
+
+    int count = (int)get_le(&in, 1);
+    if (count > TFNSW_MAX_DEPARTURES) return false;
+    for (int i = 0; i < count && !in.bad; i++) {
+        tfnsw_departure_t *d = &out->departures[i];
+        get_str(&in, d->destination, sizeof(d->destination));
+        get_str(&in, d->platform, sizeof(d->platform));
+        get_str(&in, d->line_name, sizeof(d->line_name));
+        get_str(&in, d->calling_stations, sizeof(d->calling_stations));
+        d->scheduled_time = (int64_t)get_le(&in, 8);
+        d->estimated_time = (int64_t)get_le(&in, 8);
+        d->mins_to_departure = (int16_t)get_le(&in, 2);
+        d->delay_seconds = (int32_t)get_le(&in, 4);
+        uint8_t direction = (uint8_t)get_le(&in, 1);
+        d->direction = direction <= TFNSW_DIRECTION_SOUTHBOUND ? (tfnsw_direction_t)direction
+                                                               : TFNSW_DIRECTION_UNKNOWN;
+        uint8_t flags = (uint8_t)get_le(&in, 1);
+        d->is_realtime = flags & 0x01;
+        d->is_cancelled = flags & 0x02;
+        d->is_delayed = flags & 0x04;
+        d->occupancy_available = flags & 0x08;
+        d->occupancy_percent = (uint8_t)get_le(&in, 1);
+        uint8_t severity = (uint8_t)get_le(&in, 1);
+        d->alert_severity = severity <= TFNSW_ALERT_SEVERE ? (tfnsw_alert_severity_t)severity
+                                                           : TFNSW_ALERT_NONE;
+        get_str(&in, d->alert_message, sizeof(d->alert_message));
+    }
+    out->count = count;
+    return !in.bad && in.len == 0;
+}
+
+// ============================================================================
+// Stream Reassembly
+// ============================================================================
+
+void lan_rx_init(lan_rx_t *rx, uint8_t *buf, size_t cap)
+{
+    rx->buf = buf;
+    rx->cap = cap;
+    rx->len = 0;
+    rx->consumed = 0;
+}
+
+int lan_rx_next(lan_rx_t *rx, uint8_t *type, const uint8_t **payload, size_t *len)
+{
+    // Drop the frame handed out last time
+    if (rx->consumed) {
+        memmove(rx->buf, rx->buf + rx->consumed, rx->len - rx->consumed);
+        rx->len -= rx->consumed;
+        rx->consumed = 0;
+    }
+
+    if (rx->len < 2) return 0;
+    size_t frame_len = (size_t)rx->buf[0] | ((size_t)rx->buf[1] << 8);
+    if (frame_len == 0 || frame_len + 2 > rx->cap) return -1;
+    if (rx->len < frame_len + 2) return 0;
+
+    *type = rx->buf[2];
+    *payload = rx->buf + 3;
+    *len = frame_len - 1;
+    rx->consumed = frame_len + 2;
+    return 1;
+}
+
+// ============================================================================
+// Follower State Machine
+// ============================================================================
+
+void lan_follower_init(lan_follower_t *f, uint32_t now_ms)
+{
+    memset(f, 0, sizeof(*f));
+    f->state = LAN_FOLLOWER_SEARCHING;
+    f->lost_ms = now_ms;
+    f->last_discover_ms = now_ms - LAN_DISCOVER_MS;  // Discover on the first tick
+}
+
+uint32_t lan_follower_connected(lan_follower_t *f, uint32_t now_ms)
+{
+    f->state = LAN_FOLLOWER_CONNECTED;
+    f->last_rx_ms = now_ms;
+    f->last_sub_ms = now_ms;
+    return LAN_ACT_SEND_HELLO | LAN_ACT_SEND_SUBSCRIBE;
+}
+
+uint32_t lan_follower_disconnected(lan_follower_t *f, uint32_t now_ms)
+{
+    if (f->state != LAN_FOLLOWER_SEARCHING) {
+        f->state = LAN_FOLLOWER_SEARCHING;
+        f->lost_ms = now_ms;
+        f->last_discover_ms = now_ms;
+    }
+    return 0;
+}
+
+uint32_t lan_follower_set_stop(lan_follower_t *f, const char *stop_id, uint32_t now_ms)
+{
+    const char *id = stop_id ? stop_id : "";
+    if (strcmp(f->stop_id, id) == 0) return 0;
+
+    strncpy(f->stop_id, id, sizeof(f->stop_id) - 1);
+    f->stop_id[sizeof(f->stop_id) - 1] = '\0';
+    f->have_version = 0;
+
+    if (f->state == LAN_FOLLOWER_FOLLOWING) {
+        f->last_sub_ms = now_ms;
+        return LAN_ACT_SEND_SUBSCRIBE;
+    }
+    return 0;
+}
+
+uint32_t lan_follower_on_frame(lan_follower_t *f, uint8_t type, const uint8_t *payload,
+                               size_t len, uint32_t now_ms, tfnsw_departures_t *out)
+{
+    uint32_t actions = 0;
+    f->last_rx_ms = now_ms;
+
+    switch (type) {
+        case LAN_MSG_HELLO:
+            if (!lan_decode_hello(payload, len, &f->hub_id)) {
+                return LAN_ACT_DISCONNECT;
+            }
+            f->state = LAN_FOLLOWER_FOLLOWING;
+            if (f->fallback) {
+                f->fallback = false;
+                actions |= LAN_ACT_STOP_FALLBACK;
+            }
+            break;
+
+        case LAN_MSG_SNAPSHOT: {
+            if (f->state != LAN_FOLLOWER_FOLLOWING) break;
+            char stop_id[16];
+            uint32_t version;
+            if (!lan_decode_snapshot(payload, len, stop_id, sizeof(stop_id), &version, out)) {
+                return LAN_ACT_DISCONNECT;
+            }
+            // A snapshot for the stop we just left can still be in flight
+            if (strcmp(stop_id, f->stop_id) == 0) {
+                f->have_version = version;
+                actions |= LAN_ACT_DELIVER;
+            }
+            break;
+        }
+
+        case LAN_MSG_PING:
+        default:
+            break;  // Unknown types are skipped so the hub can add new ones
+    }
+    return actions;
+}
+
+uint32_t lan_follower_tick(lan_follower_t *f, uint32_t now_ms)
+{
+    uint32_t actions = 0;
+
+    if (f->state == LAN_FOLLOWER_SEARCHING) {
+        if (!f->fallback && MS_SINCE(now_ms, f->lost_ms) >= LAN_FAILOVER_MS) {
+            f->fallback = true;
+            actions |= LAN_ACT_START_FALLBACK;
+        }
+        if (MS_SINCE(now_ms, f->last_discover_ms) >= LAN_DISCOVER_MS) {
+            f->last_discover_ms = now_ms;
+            actions |= LAN_ACT_DISCOVER;
+        }
+        return actions;
+    }
+
+    if (MS_SINCE(now_ms, f->last_rx_ms) >= LAN_HUB_TIMEOUT_MS) {
+        return LAN_ACT_DISCONNECT;
+    }
+    if (f->state == LAN_FOLLOWER_FOLLOWING && MS_SINCE(now_ms, f->last_sub_ms) >= LAN_SUBSCRIBE_MS) {
+        f->last_sub_ms = now_ms;
+        actions |= LAN_ACT_SEND_SUBSCRIBE;
+    }
+    return actions;
+}
+
+// ============================================================================
+// Hub Per-Follower State
+// ============================================================================
+
+void lan_hub_peer_init(lan_hub_peer_t *p, uint32_t now_ms)
+{
+    memset(p, 0, sizeof(*p));
+    p->lease_until_ms = now_ms + LAN_LEASE_MS;
+    p->last_tx_ms = now_ms;
+}
+
+uint32_t lan_hub_peer_on_frame(lan_hub_peer_t *p, uint8_t type, const uint8_t *payload,
+                               size_t len, uint32_t now_ms)
+{
+    if (type == LAN_MSG_HELLO) {
+        if (!lan_decode_hello(payload, len, &p->node_id)) return LAN_ACT_DISCONNECT;
+        p->hello = true;
+        return 0;
+    }
+    if (!p->hello) return LAN_ACT_DISCONNECT;
+
+    if (type == LAN_MSG_SUBSCRIBE) {
+        char stop_id[16];
+        uint32_t have_version;
+        if (!lan_decode_subscribe(payload, len, stop_id, sizeof(stop_id), &have_version)) {
+            return LAN_ACT_DISCONNECT;
+        }
+        memcpy(p->stop_id, stop_id, sizeof(p->stop_id));
+        p->sent_version = have_version;
+        p->lease_until_ms = now_ms + LAN_LEASE_MS;
+        return p->stop_id[0] ? LAN_ACT_WATCH : 0;
+    }
+    return 0;
+}
+
+uint32_t lan_hub_peer_tick(lan_hub_peer_t *p, uint32_t current_version, uint32_t now_ms)
+{
+    if (MS_REACHED(now_ms, p->lease_until_ms)) {
+        return LAN_ACT_DISCONNECT;
+    }
+    if (p->stop_id[0] && current_version != 0 && current_version != p->sent_version) {
+        return LAN_ACT_SEND_SNAPSHOT;
+    }
+    if (p->hello && MS_SINCE(now_ms, p->last_tx_ms) >= LAN_PING_MS) {
+        return LAN_ACT_SEND_PING;
+    }
+    return 0;
+}
+
+void lan_hub_peer_sent(lan_hub_peer_t *p, uint32_t version, uint32_t now_ms)
+{
+    if (version) p->sent_version = version;
+    p->last_tx_ms = now_ms;
+}
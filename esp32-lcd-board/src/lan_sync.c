@@ -0,0 +1,562 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_timer.h"
+#include "lwip/sockets.h"
+#include "mdns.h"
+
+#include "config.h"
+#include "lan_sync.h"
+#include "lan_proto.h"
+
+static const char *TAG = "lan_sync";
+
+#define LAN_POLL_MS         250     // select()/recv() timeout; also the tick rate
+#define LAN_SEND_TIMEOUT_MS 2000
+
+static lan_role_t role = LAN_ROLE_STANDALONE;
+static void (*update_callback)(const tfnsw_departures_t *departures) = NULL;
+static TaskHandle_t sync_task_handle = NULL;
+static uint32_t node_id = 0;
+
+// Follower: stop requested by the UI, picked up by the follower task
+static SemaphoreHandle_t stop_mutex = NULL;
+static char requested_stop[16] = "";
+static volatile bool stop_changed = false;
+
+// Status for /api/status (written by the sync task only)
+static volatile lan_follower_state_t follower_state = LAN_FOLLOWER_SEARCHING;
+static volatile bool follower_fallback = false;
+static volatile int hub_peer_count = 0;
+
+static const char *role_names[LAN_ROLE_COUNT] = { "standalone", "hub", "follower" };
+
+static inline uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// ============================================================================
+// Socket Helpers
+// ============================================================================
+
+static void set_timeouts(int fd, int recv_ms)
+{
+    struct timeval tv = { .tv_sec = recv_ms / 1000, .tv_usec = (recv_ms % 1000) * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    tv.tv_sec = LAN_SEND_TIMEOUT_MS / 1000;
+    tv.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+static bool send_all(int fd, const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        int n = send(fd, data, len, 0);
+        if (n <= 0) return false;
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+// Read whatever is available into the reassembly buffer; false = closed
+static bool recv_into(int fd, lan_rx_t *rx)
+{
+    if (rx->len >= rx->cap) return false;
+    int n = recv(fd, rx->buf + rx->len, rx->cap - rx->len, 0);
+    if (n > 0) {
+        rx->len += (size_t)n;
+        return true;
+    }
+    return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+// ============================================================================
+// mDNS
+// ============================================================================
+
+static esp_err_t mdns_setup(void)
+{
+    esp_err_t err = mdns_init();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "mdns_init failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    char hostname[24];
+    snprintf(hostname, sizeof(hostname), "depboard-%04lx", (unsigned long)(node_id & 0xFFFF));
+    mdns_hostname_set(hostname);
+    mdns_instance_name_set(BOARD_NAME);
+    ESP_LOGI(TAG, "mDNS hostname: %s.local", hostname);
+
+    if (role == LAN_ROLE_HUB) {
+        mdns_txt_item_t txt[] = {
+            { "role", "hub" },
+            { "proto", "1" },
+        };
+        err = mdns_service_add(NULL, LAN_SYNC_SERVICE, LAN_SYNC_PROTO, LAN_SYNC_PORT,
+                               txt, sizeof(txt) / sizeof(txt[0]));
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "mdns_service_add failed: %s", esp_err_to_name(err));
+        }
+    }
+    return err;
+}
+
+// Find a hub over mDNS and open a connection to it (-1 if none answered)
+static int discover_and_connect(void)
+{
+    mdns_result_t *results = NULL;
+    if (mdns_query_ptr(LAN_SYNC_SERVICE, LAN_SYNC_PROTO, 2000, LAN_SYNC_MAX_PEERS, &results) != ESP_OK ||
+        !results) {
+        return -1;
+    }
+
+    struct sockaddr_in addr = { .sin_family = AF_INET };
+    bool found = false;
+    for (mdns_result_t *r = results; r && !found; r = r->next) {
+        for (mdns_ip_addr_t *a = r->addr; a; a = a->next) {
+            if (a->addr.type == ESP_IPADDR_TYPE_V4) {
+                addr.sin_addr.s_addr = a->addr.u_addr.ip4.addr;
+                addr.sin_port = htons(r->port);
+                found = true;
+                break;
+            }
+        }
+    }
+    mdns_query_results_free(results);
+    if (!found) return -1;
+
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0) return -1;
+    set_timeouts(fd, LAN_POLL_MS);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        ESP_LOGW(TAG, "Hub at %s did not accept (errno %d)", inet_ntoa(addr.sin_addr), errno);
+        close(fd);
+        return -1;
+    }
+    ESP_LOGI(TAG, "Connected to hub at %s:%d", inet_ntoa(addr.sin_addr), ntohs(addr.sin_port));
+    return fd;
+}
+
+// ============================================================================
+// Hub
+// ============================================================================
+
+typedef struct {
+    int fd;                             // -1 = free
+    lan_hub_peer_t state;
+    lan_rx_t rx;
+    uint8_t rx_buf[LAN_SMALL_FRAME_MAX];
+} hub_peer_t;
+
+static hub_peer_t hub_peers[LAN_SYNC_MAX_PEERS];
+
+static void hub_drop(hub_peer_t *p, const char *why)
+{
+    ESP_LOGI(TAG, "Follower %08lx dropped (%s)", (unsigned long)p->state.node_id, why);
+    close(p->fd);
+    p->fd = -1;
+    hub_peer_count--;
+}
+
+static void hub_accept(int listen_fd)
+{
+    struct sockaddr_in from;
+    socklen_t from_len = sizeof(from);
+    int fd = accept(listen_fd, (struct sockaddr *)&from, &from_len);
+    if (fd < 0) return;
+
+    hub_peer_t *p = NULL;
+    for (int i = 0; i < LAN_SYNC_MAX_PEERS && !p; i++) {
+        if (hub_peers[i].fd < 0) p = &hub_peers[i];
+    }
+    if (!p) {
+        ESP_LOGW(TAG, "Follower limit reached, refusing %s", inet_ntoa(from.sin_addr));
+        close(fd);
+        return;
+    }
+
+    set_timeouts(fd, LAN_POLL_MS);
+    p->fd = fd;
+    lan_hub_peer_init(&p->state, now_ms());
+    lan_rx_init(&p->rx, p->rx_buf, sizeof(p->rx_buf));
+    hub_peer_count++;
+
+    uint8_t hello[16];
+    size_t n = lan_encode_hello(hello, sizeof(hello), node_id);
+    if (!send_all(fd, hello, n)) {
+        hub_drop(p, "send failed");
+        return;
+    }
+    ESP_LOGI(TAG, "Follower connected from %s", inet_ntoa(from.sin_addr));
+}
+
+static void hub_read(hub_peer_t *p)
+{
+    if (!recv_into(p->fd, &p->rx)) {
+        hub_drop(p, "closed");
+        return;
+    }
+
+    uint8_t type;
+    const uint8_t *payload;
+    size_t len;
+    int ret;
+    while ((ret = lan_rx_next(&p->rx, &type, &payload, &len)) == 1) {
+        uint32_t act = lan_hub_peer_on_frame(&p->state, type, payload, len, now_ms());
+        if (act & LAN_ACT_DISCONNECT) {
+            hub_drop(p, "protocol error");
+            return;
+        }
+        if (act & LAN_ACT_WATCH) {
+            tfnsw_watch_stop(p->state.stop_id, LAN_LEASE_MS);
+        }
+    }
+    if (ret < 0) {
+        hub_drop(p, "bad frame");
+    }
+}
+
+static void hub_service(hub_peer_t *p, uint8_t *tx, tfnsw_departures_t *deps)
+{
+    uint32_t version = 0;
+    if (p->state.stop_id[0]) {
+        tfnsw_get_stop_snapshot(p->state.stop_id, NULL, &version);
+    }
+
+    uint32_t now = now_ms();
+    uint32_t act = lan_hub_peer_tick(&p->state, version, now);
+    if (act & LAN_ACT_DISCONNECT) {
+        hub_drop(p, "lease expired");
+        return;
+    }
+
+    size_t n = 0;
+    if (act & LAN_ACT_SEND_SNAPSHOT) {
+        if (tfnsw_get_stop_snapshot(p->state.stop_id, deps, &version) != ESP_OK) return;
+        n = lan_encode_snapshot(tx, LAN_FRAME_MAX, p->state.stop_id, version, deps);
+    } else if (act & LAN_ACT_SEND_PING) {
+        version = 0;
+        n = lan_encode_ping(tx, LAN_FRAME_MAX);
+    }
+    if (n == 0) return;
+
+    if (!send_all(p->fd, tx, n)) {
+        hub_drop(p, "send failed");
+        return;
+    }
+    lan_hub_peer_sent(&p->state, version, now);
+}
+
+static void hub_task(void *arg)
+{
+    uint8_t *tx = malloc(LAN_FRAME_MAX);
+    tfnsw_departures_t *deps = malloc(sizeof(tfnsw_departures_t));
+    int listen_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (!tx || !deps || listen_fd < 0) {
+        ESP_LOGE(TAG, "Hub start failed (no memory or socket)");
+        goto done;
+    }
+
+    int yes = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(LAN_SYNC_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, 2) != 0) {
+        ESP_LOGE(TAG, "Hub cannot listen on port %d (errno %d)", LAN_SYNC_PORT, errno);
+        goto done;
+    }
+
+    for (int i = 0; i < LAN_SYNC_MAX_PEERS; i++) {
+        hub_peers[i].fd = -1;
+    }
+    ESP_LOGI(TAG, "Hub listening on port %d", LAN_SYNC_PORT);
+
+    while (1) {
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(listen_fd, &rfds);
+        int max_fd = listen_fd;
+        for (int i = 0; i < LAN_SYNC_MAX_PEERS; i++) {
+            if (hub_peers[i].fd >= 0) {
+                FD_SET(hub_peers[i].fd, &rfds);
+                if (hub_peers[i].fd > max_fd) max_fd = hub_peers[i].fd;
+            }
+        }
+
+        struct timeval tv = { .tv_sec = 0, .tv_usec = LAN_POLL_MS * 1000 };
+        if (select(max_fd + 1, &rfds, NULL, NULL, &tv) > 0) {
+            if (FD_ISSET(listen_fd, &rfds)) {
+                hub_accept(listen_fd);
+            }
+            for (int i = 0; i < LAN_SYNC_MAX_PEERS; i++) {
+                if (hub_peers[i].fd >= 0 && FD_ISSET(hub_peers[i].fd, &rfds)) {
+                    hub_read(&hub_peers[i]);
+                }
+            }
+        }
+
+        for (int i = 0; i < LAN_SYNC_MAX_PEERS; i++) {
+            if (hub_peers[i].fd >= 0) {
+                hub_service(&hub_peers[i], tx, deps);
+            }
+        }
+    }
+
+done:
+    if (listen_fd >= 0) close(listen_fd);
+    free(tx);
+    free(deps);
+    sync_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+// ============================================================================
+// Follower
+// ============================================================================
+
+typedef struct {
+    lan_follower_t sm;
+    int fd;
+    lan_rx_t rx;
+    tfnsw_departures_t *deps;
+} follower_ctx_t;
+
+static void follower_disconnect(follower_ctx_t *c)
+{
+    if (c->fd >= 0) {
+        close(c->fd);
+        c->fd = -1;
+        ESP_LOGW(TAG, "Lost hub connection");
+    }
+    lan_follower_disconnected(&c->sm, now_ms());
+}
+
+// Carry out the state machine's requests; may recurse once for connect
+static void follower_apply(follower_ctx_t *c, uint32_t act)
+{
+    uint8_t tx[LAN_SMALL_FRAME_MAX];
+
+    if (act & LAN_ACT_DELIVER) {
+        tfnsw_store_stop_snapshot(c->sm.stop_id, c->deps);
+        if (update_callback) {
+            update_callback(c->deps);
+        }
+    }
+
+    if (act & LAN_ACT_DISCONNECT) {
+        follower_disconnect(c);
+        return;
+    }
+
+    if ((act & LAN_ACT_SEND_HELLO) && c->fd >= 0) {
+        size_t n = lan_encode_hello(tx, sizeof(tx), node_id);
+        if (!send_all(c->fd, tx, n)) {
+            follower_disconnect(c);
+            return;
+        }
+    }
+    if ((act & LAN_ACT_SEND_SUBSCRIBE) && c->fd >= 0) {
+        size_t n = lan_encode_subscribe(tx, sizeof(tx), c->sm.stop_id, c->sm.have_version);
+        if (!send_all(c->fd, tx, n)) {
+            follower_disconnect(c);
+            return;
+        }
+    }
+
+    if (act & LAN_ACT_START_FALLBACK) {
+        if (tfnsw_has_api_key()) {
+            ESP_LOGW(TAG, "No hub - fetching locally");
+            tfnsw_start_single_view_fetch(c->sm.stop_id[0] ? c->sm.stop_id : NULL, update_callback);
+        } else {
+            ESP_LOGW(TAG, "No hub and no API key - waiting for a hub");
+        }
+    }
+    if (act & LAN_ACT_STOP_FALLBACK) {
+        ESP_LOGI(TAG, "Hub is back - stopping local fetch");
+        tfnsw_stop_background_fetch();
+    }
+
+    if ((act & LAN_ACT_DISCOVER) && c->fd < 0) {
+        c->fd = discover_and_connect();
+        if (c->fd >= 0) {
+            lan_rx_init(&c->rx, c->rx.buf, c->rx.cap);
+            follower_apply(c, lan_follower_connected(&c->sm, now_ms()));
+        }
+    }
+}
+
+static void follower_task(void *arg)
+{
+    follower_ctx_t c = { .fd = -1 };
+    uint8_t *rx_buf = malloc(LAN_FRAME_MAX);
+    c.deps = malloc(sizeof(tfnsw_departures_t));
+    if (!rx_buf || !c.deps) {
+        ESP_LOGE(TAG, "Follower start failed (no memory)");
+        free(rx_buf);
+        free(c.deps);
+        sync_task_handle = NULL;
+        vTaskDelete(NULL);
+        return;
+    }
+    lan_rx_init(&c.rx, rx_buf, LAN_FRAME_MAX);
+    lan_follower_init(&c.sm, now_ms());
+
+    while (1) {
+        // Pick up view changes
+        if (stop_changed && xSemaphoreTake(stop_mutex, pdMS_TO_TICKS(50)) == pdTRUE) {
+            char stop_id[16];
+            memcpy(stop_id, requested_stop, sizeof(stop_id));
+            stop_changed = false;
+            xSemaphoreGive(stop_mutex);
+
+            follower_apply(&c, lan_follower_set_stop(&c.sm, stop_id, now_ms()));
+            if (c.sm.fallback) {
+                tfnsw_set_active_stop(stop_id[0] ? stop_id : NULL);
+            }
+        }
+
+        if (c.fd >= 0) {
+            // recv() blocks for up to LAN_POLL_MS
+            if (!recv_into(c.fd, &c.rx)) {
+                follower_disconnect(&c);
+            } else {
+                uint8_t type;
+                const uint8_t *payload;
+                size_t len;
+                int ret = 0;
+                while (c.fd >= 0 && (ret = lan_rx_next(&c.rx, &type, &payload, &len)) == 1) {
+                    follower_apply(&c, lan_follower_on_frame(&c.sm, type, payload, len, now_ms(), c.deps));
+                }
+                if (c.fd >= 0 && ret < 0) {
+                    follower_disconnect(&c);
+                }
+            }
+        } else {
+            vTaskDelay(pdMS_TO_TICKS(LAN_POLL_MS));
+        }
+
+        follower_apply(&c, lan_follower_tick(&c.sm, now_ms()));
+        follower_state = c.sm.state;
+        follower_fallback = c.sm.fallback;
+    }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+esp_err_t lan_sync_start(lan_role_t new_role, void (*on_update)(const tfnsw_departures_t* departures))
+{
+    if (new_role == LAN_ROLE_STANDALONE || new_role >= LAN_ROLE_COUNT) {
+        return ESP_OK;
+    }
+    if (sync_task_handle) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    role = new_role;
+    update_callback = on_update;
+
+    uint8_t mac[6];
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    node_id = ((uint32_t)mac[2] << 24) | ((uint32_t)mac[3] << 16) | ((uint32_t)mac[4] << 8) | mac[5];
+
+    if (!stop_mutex) {
+        stop_mutex = xSemaphoreCreateMutex();
+        if (!stop_mutex) return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = mdns_setup();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (role == LAN_ROLE_HUB) {
+        // Followers' stops are fetched even while this board shows a static view
+        if (!tfnsw_is_background_fetch_running()) {
+            err = tfnsw_start_single_view_fetch(NULL, on_update);
+            if (err != ESP_OK) {
+                // Followers still get whatever a realtime view's fetch stores
+                ESP_LOGE(TAG, "Failed to start the hub's fetch task: %s", esp_err_to_name(err));
+            }
+        }
+    }
+
+    BaseType_t ret = xTaskCreate(role == LAN_ROLE_HUB ? hub_task : follower_task,
+                                 role == LAN_ROLE_HUB ? "lan_hub" : "lan_follower",
+                                 4096, NULL, 4, &sync_task_handle);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create LAN sync task");
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "LAN sync started as %s (node %08lx)", role_names[role], (unsigned long)node_id);
+    return ESP_OK;
+}
+
+lan_role_t lan_sync_get_role(void)
+{
+    return role;
+}
+
+bool lan_sync_is_follower(void)
+{
+    return role == LAN_ROLE_FOLLOWER;
+}
+
+void lan_sync_set_active_stop(const char* stop_id)
+{
+    if (!stop_mutex || xSemaphoreTake(stop_mutex, pdMS_TO_TICKS(100)) != pdTRUE) return;
+    strncpy(requested_stop, stop_id ? stop_id : "", sizeof(requested_stop) - 1);
+    requested_stop[sizeof(requested_stop) - 1] = '\0';
+    stop_changed = true;
+    xSemaphoreGive(stop_mutex);
+}
+
+const char* lan_sync_role_name(lan_role_t r)
+{
+    return r < LAN_ROLE_COUNT ? role_names[r] : "unknown";
+}
+
+bool lan_sync_role_from_name(const char* name, lan_role_t* out_role)
+{
+    for (int i = 0; name && i < LAN_ROLE_COUNT; i++) {
+        if (strcmp(name, role_names[i]) == 0) {
+            *out_role = (lan_role_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* lan_sync_state_name(void)
+{
+    if (role != LAN_ROLE_FOLLOWER) {
+        return role_names[role];
+    }
+    if (follower_fallback && follower_state != LAN_FOLLOWER_FOLLOWING) {
+        return "fallback";
+    }
+    switch (follower_state) {
+        case LAN_FOLLOWER_CONNECTED: return "connecting";
+        case LAN_FOLLOWER_FOLLOWING: return "following";
+        default: return "searching";
+    }
+}
+
+int lan_sync_peer_count(void)
+{
+    return hub_peer_count;
+}
@@ -1,22 +1,35 @@
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#ifndef LCD_HEADLESS
 #include "driver/gpio.h"
-#include "driver/ledc.h"
 #include "driver/spi_master.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_vendor.h"
 #include "esp_lcd_panel_ops.h"
+#endif
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "esp_random.h"
+#include "esp_heap_caps.h"
 
 #include "lvgl.h"
 #include "config.h"
 #include "lcd_driver.h"
 #include "tfnsw_client.h"
 #include "rgb_led.h"
+#include "render_perf.h"
+#include "display_mirror.h"
+#include "event_stream.h"
+#include "spi_arbiter.h"
+#include "event_trace.h"
+#include "power_mgmt.h"
+#include "backlight.h"
+#include "digit_font.h"
 
 static const char *TAG = "lcd_driver";
 
@@ -24,13 +37,80 @@ static const char *TAG = "lcd_driver";
 static lv_disp_draw_buf_t draw_buf;
 static lv_disp_drv_t disp_drv;
 static lv_disp_t *disp = NULL;
+#ifdef LCD_HEADLESS
+// Host builds (LCD_HEADLESS) have no panel: LVGL flushes into a RAM framebuffer
+static lv_color_t headless_fb[LCD_WIDTH * LCD_HEIGHT];
+#else
 static esp_lcd_panel_handle_t panel_handle = NULL;
+#endif
 
 // LVGL buffer
-#define LVGL_BUF_SIZE (LCD_WIDTH * 40)
+#define LVGL_BUF_LINES 40
+#define LVGL_BUF_SIZE (LCD_WIDTH * LVGL_BUF_LINES)
 static lv_color_t *buf1 = NULL;
 static lv_color_t *buf2 = NULL;
 
+#if LV_COLOR_DEPTH == 8 && defined(LCD_HEADLESS)
+#error "LCD_RENDER_INDEXED8 needs the panel flush path and cannot be used with LCD_HEADLESS"
+#endif
+
+#if LV_COLOR_DEPTH == 8
+// 8-bit render mode (LCD_RENDER_INDEXED8 in lv_conf.h): LVGL draws RGB332 into
+// plain internal RAM and the flush path expands each pixel through a 256-entry
+// LUT into small DMA bounce buffers, ping-ponged while the previous one is sent.
+#define LCD_BOUNCE_LINES 10
+#define LCD_BOUNCE_SIZE (LCD_WIDTH * LCD_BOUNCE_LINES)
+static uint16_t rgb332_to_rgb565[256];
+static uint16_t *bounce_buf[2] = {NULL, NULL};
+static uint32_t bounce_seq[2] = {0, 0};  // Last transfer sent from each bounce buffer
+static int bounce_index = 0;
+#endif
+
+// Colour transfers queued to the panel vs completed (counted from the panel IO
+// ISR). Transfers finish in order, so a buffer queued as transfer N can be
+// reused once color_tx_done has reached N.
+static uint32_t color_tx_queued = 0;
+static volatile uint32_t color_tx_done = 0;
+static TaskHandle_t color_tx_waiter = NULL;
+// Transfers lcd_wait_tx gave up waiting for (written off on top of
+// color_tx_done, which only completions advance) and how often that happened
+static uint32_t color_tx_lost = 0;
+static uint32_t color_tx_timeouts = 0;
+
+// Immediate-mode raster layer for the legacy draw API. Ops are queued from any
+// task and rasterised by lcd_update() into the idle draw buffers, one band at
+// a time, so they never allocate LVGL objects.
+#define RASTER_QUEUE_DEPTH 8
+#define RASTER_SUBMIT_WAIT_MS 50    // Longest a caller waits for queue room
+#define RASTER_TEXT_MAX 96
+#if LV_COLOR_DEPTH == 8
+#define RASTER_BAND_LINES LCD_BOUNCE_LINES
+#define RASTER_BAND(i) (bounce_buf[i])
+#else
+#define RASTER_BAND_LINES LVGL_BUF_LINES
+#define RASTER_BAND(i) ((uint16_t *)((i) ? buf2 : buf1))
+#endif
+
+typedef enum {
+    RASTER_CLEAR,
+    RASTER_FILL,
+    RASTER_FRAME,
+    RASTER_TEXT,
+    RASTER_TEXT_CENTERED,
+} raster_op_type_t;
+
+typedef struct {
+    raster_op_type_t type;
+    int16_t x, y, w, h;
+    uint16_t color;             // RGB565
+    uint16_t bg;                // RGB565 (text background)
+    uint8_t size;               // Legacy text size (1-4)
+    char text[RASTER_TEXT_MAX];
+} raster_op_t;
+
+static QueueHandle_t raster_queue = NULL;
+static bool raster_active = false;  // Raster output on screen, LVGL refresh paused
+
 // Scene management
 static lcd_scene_t current_scene = SCENE_HIGH_SPEED;
 static volatile int pending_scene = -1;  // -1 = no pending change
@@ -70,15 +150,6 @@ static char next2_departure_dest[64] = "Tallawong";
 static display_status_t current_display_status = DISPLAY_STATUS_IDLE;
 static bool is_realtime_data = false;
 static int current_delay_seconds = 0;
-static tfnsw_departures_t realtime_departures = {0};
-static tfnsw_dual_departures_t dual_departures = {0};
-
-// Simple mode data
-static tfnsw_departures_t northbound_data = {0};
-static tfnsw_departures_t southbound_data = {0};
-static bool simple_mode_enabled = false;
-static volatile bool pending_north_update = false;
-static volatile bool pending_south_update = false;
 
 // High speed view rotation state
 static lv_timer_t *hs_rotation_timer = NULL;
@@ -130,20 +201,11 @@ static const hs_service_t hs_services[] = {
     },
 };
 #define HS_SERVICE_COUNT (sizeof(hs_services) / sizeof(hs_services[0]))
-static bool realtime_mode_enabled = false;
-static bool dual_mode_enabled = false;
-static volatile bool pending_realtime_update = false;  // Thread-safe update flag
-static volatile bool pending_dual_update = false;      // Thread-safe update flag for dual mode
 
 // Forward declarations
-static void lcd_show_realtime_metro_board(void);
-static void lcd_show_dual_metro_board(void);
-static void lcd_show_simple_metro_board(bool northbound);
-static void lcd_apply_realtime_update(void);
-static void lcd_apply_dual_update(void);
-static void lcd_apply_simple_update(bool northbound);
 static const char* get_current_time_str(void);
 static void lcd_render_departure_view(const view_config_t* config, const tfnsw_departures_t* data);
+static void raster_process_queue(void);
 
 // ============================================================================
 // View Registry - Predefined Views
@@ -272,9 +334,20 @@ static const view_config_t view_registry[VIEW_COUNT] = {
     },
 };
 
-// View data storage (one per view) - volatile for thread safety
-static volatile tfnsw_departures_t view_data[VIEW_COUNT] = {0};
+// View data store: the only copy of realtime departures in the driver. Each
+// slot points at an immutable heap snapshot: writers fill a new one unlocked
+// and swap it in, the renderer takes a reference and builds the view with
+// the store unlocked. The mutex only covers pointer swaps and reference
+// counts, so nobody waits on a render and no update is ever dropped. Only
+// views holding data (normally just the active realtime view) cost RAM.
+typedef struct {
+    uint32_t refs;                  // The slot's and the renderer's
+    tfnsw_departures_t data;
+} view_snapshot_t;
+
+static view_snapshot_t *view_data[VIEW_COUNT] = {NULL};
 static volatile bool view_data_pending[VIEW_COUNT] = {false};
+static SemaphoreHandle_t view_data_mutex = NULL;
 
 // Current view tracking
 static view_id_t current_view = VIEW_HIGH_SPEED;
@@ -403,6 +476,7 @@ void lcd_set_view(view_id_t id)
 {
     if (id >= VIEW_COUNT) return;
     pending_scene = (int)id;  // Use existing pending mechanism
+    power_loop_wake();
 }
 
 void lcd_next_view(void)
@@ -423,31 +497,98 @@ bool lcd_is_view_enabled(view_id_t id)
     return view_registry[id].enabled;
 }
 
-void lcd_update_view_data(view_id_t id, const tfnsw_departures_t* data)
+// A snapshot for a writer to fill before view_store_publish()
+static view_snapshot_t* view_snapshot_new(view_id_t id)
 {
-    if (id >= VIEW_COUNT || !data) return;
-    memcpy((void*)&view_data[id], data, sizeof(tfnsw_departures_t));
+    if (id >= VIEW_COUNT || !view_data_mutex) return NULL;
+    view_snapshot_t *snap = calloc(1, sizeof(view_snapshot_t));
+    if (!snap) {
+        ESP_LOGE("LCD", "No memory for view %d data", id);
+        return NULL;
+    }
+    snap->refs = 1;
+    return snap;
+}
+
+// Drop a reference; call with the store locked. Returns the snapshot if
+// that was the last one, for the caller to free once unlocked.
+static view_snapshot_t* view_snapshot_unref(view_snapshot_t *snap)
+{
+    return snap && --snap->refs == 0 ? snap : NULL;
+}
+
+// Swap snap into the view's slot and schedule a redraw from lcd_update()
+static void view_store_publish(view_id_t id, view_snapshot_t *snap)
+{
+    xSemaphoreTake(view_data_mutex, portMAX_DELAY);
+    view_snapshot_t *old = view_snapshot_unref(view_data[id]);
+    view_data[id] = snap;
     view_data_pending[id] = true;
+    xSemaphoreGive(view_data_mutex);
+    free(old);
+    power_loop_wake();
+    event_stream_publish(EVENT_TOPIC_TFNSW);
+}
+
+// The view's current snapshot, held until view_store_release()
+static view_snapshot_t* view_store_acquire(view_id_t id)
+{
+    if (id >= VIEW_COUNT || !view_data_mutex) return NULL;
+    xSemaphoreTake(view_data_mutex, portMAX_DELAY);
+    view_snapshot_t *snap = view_data[id];
+    if (snap) snap->refs++;
+    xSemaphoreGive(view_data_mutex);
+    return snap;
+}
+
+static void view_store_release(view_snapshot_t *snap)
+{
+    if (!snap) return;
+    xSemaphoreTake(view_data_mutex, portMAX_DELAY);
+    view_snapshot_t *last = view_snapshot_unref(snap);
+    xSemaphoreGive(view_data_mutex);
+    free(last);
+}
+
+void lcd_update_view_data(view_id_t id, const tfnsw_departures_t* data)
+{
+    if (!data) return;
+    view_snapshot_t *snap = view_snapshot_new(id);
+    if (!snap) return;
+    memcpy(&snap->data, data, sizeof(tfnsw_departures_t));
+    view_store_publish(id, snap);
     ESP_LOGI("LCD", "View %d data updated: count=%d, status=%d", id, data->count, data->status);
 }
 
 void lcd_clear_view_data(view_id_t id)
 {
-    if (id >= VIEW_COUNT) return;
-    memset((void*)&view_data[id], 0, sizeof(tfnsw_departures_t));
+    if (id >= VIEW_COUNT || !view_data_mutex) return;
+    xSemaphoreTake(view_data_mutex, portMAX_DELAY);
+    view_snapshot_t *old = view_snapshot_unref(view_data[id]);
+    view_data[id] = NULL;
     view_data_pending[id] = false;
+    xSemaphoreGive(view_data_mutex);
+    free(old);
     ESP_LOGI("LCD", "View %d data cleared", id);
 }
 
 void lcd_clear_all_view_data(void)
 {
     for (int i = 0; i < VIEW_COUNT; i++) {
-        memset((void*)&view_data[i], 0, sizeof(tfnsw_departures_t));
-        view_data_pending[i] = false;
+        lcd_clear_view_data((view_id_t)i);
     }
     ESP_LOGI("LCD", "All view data cleared");
 }
 
+bool lcd_get_view_data(view_id_t id, tfnsw_departures_t* out)
+{
+    view_snapshot_t *snap = view_store_acquire(id);
+    if (!snap) return false;
+    memcpy(out, &snap->data, sizeof(tfnsw_departures_t));
+    view_store_release(snap);
+    return true;
+}
+
 // Get demo data for a specific view (used as fallback when realtime unavailable)
 static const tfnsw_departures_t* get_demo_data_for_view(view_id_t view)
 {
@@ -472,7 +613,7 @@ static bool is_realtime_data_valid(const tfnsw_departures_t* data)
     return true;
 }
 
-void lcd_render_current_view(void)
+static void render_current_view(void)
 {
     const view_config_t* config = lcd_get_view_config(current_view);
     if (!config) return;
@@ -497,13 +638,15 @@ void lcd_render_current_view(void)
     // Get appropriate data
     const tfnsw_departures_t* data;
     bool using_demo = false;
+    view_snapshot_t *snap = NULL;
 
     if (config->data_source == VIEW_DATA_STATIC) {
         data = get_demo_data_for_view(current_view);
         using_demo = true;
     } else {
-        // Try realtime data first
-        const tfnsw_departures_t* realtime_data = (const tfnsw_departures_t*)&view_data[current_view];
+        // Try realtime data first (held by reference while the view is built)
+        snap = view_store_acquire(current_view);
+        const tfnsw_departures_t* realtime_data = snap ? &snap->data : NULL;
 
         if (is_realtime_data_valid(realtime_data)) {
             data = realtime_data;
@@ -513,11 +656,13 @@ void lcd_render_current_view(void)
             data = get_demo_data_for_view(current_view);
             using_demo = true;
             ESP_LOGI("LCD", "Realtime unavailable (count=%d, status=%d), using demo data",
-                     realtime_data->count, realtime_data->status);
+                     realtime_data ? realtime_data->count : 0,
+                     realtime_data ? realtime_data->status : TFNSW_STATUS_IDLE);
         }
     }
 
     lcd_render_departure_view(config, data);
+    view_store_release(snap);
 
     // If using demo data, the status dot will show yellow (scheduled only)
     if (using_demo) {
@@ -525,6 +670,16 @@ void lcd_render_current_view(void)
     }
 }
 
+void lcd_render_current_view(void)
+{
+    view_id_t view = current_view;
+    int64_t start_us = esp_timer_get_time();
+    trace_begin("render_view");
+    render_current_view();
+    trace_end("render_view", (uint32_t)view);
+    render_perf_record_view(view, (uint32_t)(esp_timer_get_time() - start_us));
+}
+
 // ============================================================================
 // UI Component Functions (DRY)
 // ============================================================================
@@ -551,6 +706,23 @@ static void view_rotation_timer_cb(lv_timer_t *timer)
     }
 }
 
+// Stop header rotation timers and forget labels that are about to be deleted
+static void release_view_timers(void)
+{
+    if (view_rotation_timer) {
+        lv_timer_del(view_rotation_timer);
+        view_rotation_timer = NULL;
+    }
+    if (hs_rotation_timer) {
+        lv_timer_del(hs_rotation_timer);
+        hs_rotation_timer = NULL;
+    }
+    view_header_label = NULL;
+    view_time_label = NULL;
+    hs_header_label = NULL;
+    hs_time_label = NULL;
+}
+
 // Render header bar with title and time
 static void render_header(lv_obj_t* scr, const view_config_t* config, bool show_fetching)
 {
@@ -796,7 +968,7 @@ static void render_service_row(lv_obj_t* scr, int y, const tfnsw_departure_t* de
 
     lv_obj_t *mins = lv_label_create(scr);
     lv_label_set_text(mins, mins_str);
-    lv_obj_set_style_text_font(mins, font, 0);
+    lv_obj_set_style_text_font(mins, digit_font(font), 0);
     lv_obj_set_style_text_color(mins, lv_color_hex(get_status_color(mins_until, dep->is_realtime, dep->is_delayed)), 0);
     lv_obj_align(mins, LV_ALIGN_TOP_RIGHT, -10, y);
 }
@@ -819,8 +991,13 @@ static int recalc_minutes_until(const tfnsw_departure_t* dep)
         return dep->mins_to_departure;  // Fallback to stored value
     }
 
-    // Get current time
+    // Get current time (before SNTP, e.g. cached data at boot, keep the stored value)
     time_t now = time(NULL);
+    struct tm tm_now;
+    localtime_r(&now, &tm_now);
+    if (tm_now.tm_year + 1900 < 2024) {
+        return dep->mins_to_departure;
+    }
     int diff_seconds = (int)(departure_time - now);
     return diff_seconds / 60;
 }
@@ -859,6 +1036,23 @@ static void lcd_render_departure_view(const view_config_t* config, const tfnsw_d
         render_status_dot(scr, LCD_WIDTH - 70, 9, data->status, has_rt, data->count);
     }
 
+    // Age marker for departures restored from flash (-1 = age unknown)
+    if (data && data->is_cached_fallback && data->count > 0) {
+        char age_str[16];
+        if (data->data_age_seconds < 0) {
+            snprintf(age_str, sizeof(age_str), "cached");
+        } else if (data->data_age_seconds < 3600) {
+            snprintf(age_str, sizeof(age_str), "%dm old", data->data_age_seconds / 60);
+        } else {
+            snprintf(age_str, sizeof(age_str), "%dh old", data->data_age_seconds / 3600);
+        }
+        lv_obj_t *age_lbl = lv_label_create(scr);
+        lv_label_set_text(age_lbl, age_str);
+        lv_obj_set_style_text_font(age_lbl, &lv_font_montserrat_12, 0);
+        lv_obj_set_style_text_color(age_lbl, lv_color_hex(THEME_BG), 0);
+        lv_obj_align(age_lbl, LV_ALIGN_TOP_RIGHT, -78, 5);
+    }
+
     int y_pos = 26;
 
     // ===== DIRECTION INDICATOR =====
@@ -939,7 +1133,7 @@ static void lcd_render_departure_view(const view_config_t* config, const tfnsw_d
 
     view_time_label = lv_label_create(scr);
     lv_label_set_text(view_time_label, mins_str);
-    lv_obj_set_style_text_font(view_time_label, &lv_font_montserrat_24, 0);
+    lv_obj_set_style_text_font(view_time_label, digit_font(&lv_font_montserrat_24), 0);
     lv_obj_set_style_text_color(view_time_label, lv_color_hex(get_status_color(first_mins, first->is_realtime, first->is_delayed)), 0);
     lv_obj_align(view_time_label, LV_ALIGN_TOP_RIGHT, -10, y_pos);
 
@@ -1026,65 +1220,236 @@ static void lcd_render_departure_view(const view_config_t* config, const tfnsw_d
 // ============================================================================
 // LVGL Display Flush Callback
 // ============================================================================
+
+#if LV_COLOR_DEPTH == 8
+// Build RGB332 -> byte-swapped RGB565 table (same wire order as LV_COLOR_16_SWAP)
+static void build_rgb332_lut(void)
+{
+    for (int i = 0; i < 256; i++) {
+        lv_color_t c;
+        c.full = (uint8_t)i;
+        uint16_t r5 = (c.ch.red * 31 + 3) / 7;
+        uint16_t g6 = (c.ch.green * 63 + 3) / 7;
+        uint16_t b5 = (c.ch.blue * 31 + 1) / 3;
+        uint16_t px = (r5 << 11) | (g6 << 5) | b5;
+        rgb332_to_rgb565[i] = (px >> 8) | (px << 8);
+    }
+}
+#endif
+
+// ============================================================================
+// Panel Transfers
+// ============================================================================
+
+#ifndef LCD_HEADLESS
+// Panel IO finished sending a colour transaction (one per draw_bitmap call)
+static bool IRAM_ATTR lcd_color_trans_done_cb(esp_lcd_panel_io_handle_t io,
+                                              esp_lcd_panel_io_event_data_t *edata,
+                                              void *user_ctx)
+{
+    __atomic_fetch_add(&color_tx_done, 1, __ATOMIC_RELAXED);
+    spi_arbiter_lcd_done();
+    if (color_tx_waiter) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(color_tx_waiter, &woken);
+        return woken == pdTRUE;
+    }
+    return false;
+}
+#endif
+
+// Forward declaration (defined with the headless framebuffer below)
+#ifdef LCD_HEADLESS
+static void headless_blit(int x1, int y1, int x2, int y2, const void *src);
+#endif
+
+// Queue a bitmap to the panel (and any display mirror viewers); returns the
+// transfer's sequence number
+static uint32_t lcd_queue_bitmap(int x1, int y1, int x2, int y2, const void *data)
+{
+    uint32_t seq = ++color_tx_queued;
+    display_mirror_feed(x1, y1, x2, y2, data);
+#ifdef LCD_HEADLESS
+    headless_blit(x1, y1, x2, y2, data);
+    __atomic_fetch_add(&color_tx_done, 1, __ATOMIC_RELAXED);
+#else
+    spi_arbiter_lcd_queued();
+    esp_err_t ret = esp_lcd_panel_draw_bitmap(panel_handle, x1, y1, x2, y2, data);
+    if (ret != ESP_OK) {
+        // No completion callback will come for a rejected transfer
+        __atomic_fetch_add(&color_tx_done, 1, __ATOMIC_RELAXED);
+        spi_arbiter_lcd_done();
+    }
+#endif
+    return seq;
+}
+
+// Transfers finished, counting ones written off after a timeout
+static uint32_t color_tx_completed(void)
+{
+    uint32_t done = __atomic_load_n(&color_tx_done, __ATOMIC_RELAXED);
+
+    // A written-off transfer that completes after all stops being lost
+    int32_t excess = (int32_t)(done + color_tx_lost - color_tx_queued);
+    if (excess > 0) {
+        color_tx_lost -= (uint32_t)excess < color_tx_lost ? (uint32_t)excess : color_tx_lost;
+    }
+    return done + color_tx_lost;
+}
+
+// Block until transfer seq (and everything before it) has left its buffer
+static void lcd_wait_tx(uint32_t seq)
+{
+    int waited_ms = 0;
+    while ((int32_t)(color_tx_completed() - seq) < 0) {
+        color_tx_waiter = xTaskGetCurrentTaskHandle();
+        if ((int32_t)(color_tx_completed() - seq) < 0) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10));
+            waited_ms += 10;
+        }
+        color_tx_waiter = NULL;
+        if (waited_ms >= 200) {
+            color_tx_lost += seq - color_tx_completed();
+            color_tx_timeouts++;
+            ESP_LOGW(TAG, "Panel transfer %lu timed out (%lu so far)",
+                     (unsigned long)seq, (unsigned long)color_tx_timeouts);
+            break;
+        }
+    }
+}
+
+#if LV_COLOR_DEPTH == 8
+// Expand an RGB332 area into bounce buffers and queue it to the panel in chunks
+static void flush_indexed(int x1, int y1, int x2, int y2, const lv_color_t *src)
+{
+    int width = x2 - x1;
+    int chunk_rows = LCD_BOUNCE_SIZE / width;  // Narrow areas pack more rows per chunk
+
+    for (int y = y1; y < y2; y += chunk_rows) {
+        int rows = (y2 - y < chunk_rows) ? (y2 - y) : chunk_rows;
+        int count = width * rows;
+
+        lcd_wait_tx(bounce_seq[bounce_index]);
+        uint16_t *dst = bounce_buf[bounce_index];
+
+        for (int i = 0; i < count; i++) {
+            dst[i] = rgb332_to_rgb565[src[i].full];
+        }
+        src += count;
+
+        bounce_seq[bounce_index] = lcd_queue_bitmap(x1, y, x2, y + rows, dst);
+        bounce_index ^= 1;
+    }
+}
+#endif
+
+// Per-frame flush accumulators (reset by lcd_update around lv_timer_handler)
+static uint32_t frame_flush_px = 0;
+static uint32_t frame_flush_count = 0;
+
+#ifdef LCD_HEADLESS
+static void headless_blit(int x1, int y1, int x2, int y2, const void *data)
+{
+    const lv_color_t *src = data;
+    int width = x2 - x1;
+    for (int y = y1; y < y2; y++) {
+        memcpy(&headless_fb[y * LCD_WIDTH + x1], src, width * sizeof(lv_color_t));
+        src += width;
+    }
+}
+
+const void* lcd_get_framebuffer(void)
+{
+    return headless_fb;
+}
+
+uint8_t lcd_get_backlight(void)
+{
+    return backlight_get();
+}
+#endif
+
 static void lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
 {
-    esp_lcd_panel_handle_t panel = (esp_lcd_panel_handle_t)drv->user_data;
     int x1 = area->x1;
     int y1 = area->y1;
     int x2 = area->x2 + 1;
     int y2 = area->y2 + 1;
 
-    esp_lcd_panel_draw_bitmap(panel, x1, y1, x2, y2, color_map);
+    int64_t start_us = esp_timer_get_time();
+    trace_begin("flush");
+#if LV_COLOR_DEPTH == 8
+    flush_indexed(x1, y1, x2, y2, color_map);
+#else
+    lcd_queue_bitmap(x1, y1, x2, y2, color_map);
+#endif
+    uint32_t px = (uint32_t)(x2 - x1) * (uint32_t)(y2 - y1);
+    trace_end("flush", px);
+    render_perf_record(PERF_FLUSH_US, (uint32_t)(esp_timer_get_time() - start_us));
+    render_perf_record(PERF_FLUSH_PX, px);
+    frame_flush_px += px;
+    frame_flush_count++;
+
     lv_disp_flush_ready(drv);
 }
 
+// Called by LVGL after each refresh with the total redrawn (invalidated) area
+static void lvgl_monitor_cb(lv_disp_drv_t *drv, uint32_t time, uint32_t px)
+{
+    (void)drv;
+    (void)time;
+    render_perf_record(PERF_INVALID_PX, px);
+}
+
 // ============================================================================
 // LCD Initialization
 // ============================================================================
-esp_err_t lcd_init(void)
+#ifdef LCD_HEADLESS
+static esp_err_t lcd_panel_init(void)
+{
+    ESP_LOGI(TAG, "Headless build: rendering to %dx%d RAM framebuffer", LCD_WIDTH, LCD_HEIGHT);
+    memset(headless_fb, 0, sizeof(headless_fb));
+    return ESP_OK;
+}
+#else
+// Backlight PWM, SPI bus and ST7789 panel bring-up
+static esp_err_t lcd_panel_init(void)
 {
     esp_err_t ret;
 
-    ESP_LOGI(TAG, "Initializing LCD with LVGL...");
     ESP_LOGI(TAG, "LCD pins: MOSI=%d, SCLK=%d, CS=%d, DC=%d, RST=%d, BL=%d",
              LCD_PIN_MOSI, LCD_PIN_SCLK, LCD_PIN_CS, LCD_PIN_DC, LCD_PIN_RST, LCD_PIN_BL);
 
-    // Configure backlight PWM
-    ESP_LOGI(TAG, "Configuring backlight PWM...");
-    ledc_timer_config_t ledc_timer = {
-        .speed_mode = LEDC_LOW_SPEED_MODE,
-        .timer_num = LEDC_TIMER_0,
-        .duty_resolution = LEDC_TIMER_8_BIT,
-        .freq_hz = 5000,
-        .clk_cfg = LEDC_AUTO_CLK
-    };
-    ret = ledc_timer_config(&ledc_timer);
+    // Backlight PWM (dark until the first screen asks for a level)
+    ret = backlight_init();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure LEDC timer: %s", esp_err_to_name(ret));
         return ret;
     }
+    ESP_LOGI(TAG, "Backlight configured");
 
-    ledc_channel_config_t ledc_channel = {
-        .speed_mode = LEDC_LOW_SPEED_MODE,
-        .channel = LEDC_CHANNEL_0,
-        .timer_sel = LEDC_TIMER_0,
-        .intr_type = LEDC_INTR_DISABLE,
-        .gpio_num = LCD_PIN_BL,
-        .duty = 51,  // 20% brightness (51/255)
-        .hpoint = 0
-    };
-    ret = ledc_channel_config(&ledc_channel);
+    // SPI bus shared with the SD card; spi_arbiter keeps card I/O between frames
+    ret = spi_arbiter_init();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure LEDC channel: %s", esp_err_to_name(ret));
         return ret;
     }
-    ESP_LOGI(TAG, "Backlight configured");
+#if SD_CARD_ENABLED
+    // Hold SD CS high so the card ignores panel traffic until it is mounted
+    gpio_config_t sd_cs_conf = {
+        .pin_bit_mask = 1ULL << SD_PIN_CS,
+        .mode = GPIO_MODE_OUTPUT,
+    };
+    gpio_config(&sd_cs_conf);
+    gpio_set_level(SD_PIN_CS, 1);
+#endif
 
-    // Configure SPI bus for LCD only (SD card disabled to avoid conflicts)
     ESP_LOGI(TAG, "Initializing SPI bus...");
     spi_bus_config_t buscfg = {
         .mosi_io_num = LCD_PIN_MOSI,
+#if SD_CARD_ENABLED
+        .miso_io_num = SD_PIN_MISO,  // Only the SD card reads
+#else
         .miso_io_num = -1,  // LCD doesn't need MISO
+#endif
         .sclk_io_num = LCD_PIN_SCLK,
         .quadwp_io_num = -1,
         .quadhd_io_num = -1,
@@ -1108,6 +1473,7 @@ esp_err_t lcd_init(void)
         .lcd_param_bits = LCD_PARAM_BITS,
         .spi_mode = 0,
         .trans_queue_depth = 10,
+        .on_color_trans_done = lcd_color_trans_done_cb,
     };
     ret = esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)LCD_HOST, &io_config, &io_handle);
     if (ret != ESP_OK) {
@@ -1177,27 +1543,69 @@ esp_err_t lcd_init(void)
         return ret;
     }
     ESP_LOGI(TAG, "LCD panel initialized: %dx%d", LCD_WIDTH, LCD_HEIGHT);
+    return ESP_OK;
+}
+#endif
+
+esp_err_t lcd_init(void)
+{
+    ESP_LOGI(TAG, "Initializing LCD with LVGL...");
+
+    esp_err_t ret = lcd_panel_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
 
     // Initialize LVGL
     lv_init();
 
     // Allocate LVGL draw buffers
+#if LV_COLOR_DEPTH == 8
+    // Draw buffers are never DMA'd directly in 8-bit mode, only the bounce buffers are
+    buf1 = heap_caps_malloc(LVGL_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    buf2 = heap_caps_malloc(LVGL_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    bounce_buf[0] = heap_caps_malloc(LCD_BOUNCE_SIZE * sizeof(uint16_t), MALLOC_CAP_DMA);
+    bounce_buf[1] = heap_caps_malloc(LCD_BOUNCE_SIZE * sizeof(uint16_t), MALLOC_CAP_DMA);
+    if (!buf1 || !buf2 || !bounce_buf[0] || !bounce_buf[1]) {
+        ESP_LOGE(TAG, "Failed to allocate LVGL buffers");
+        return ESP_ERR_NO_MEM;
+    }
+    build_rgb332_lut();
+    ESP_LOGI(TAG, "8-bit render mode: %d B draw + %d B bounce buffers",
+             (int)(2 * LVGL_BUF_SIZE), (int)(2 * LCD_BOUNCE_SIZE * sizeof(uint16_t)));
+#else
     buf1 = heap_caps_malloc(LVGL_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_DMA);
     buf2 = heap_caps_malloc(LVGL_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_DMA);
     if (!buf1 || !buf2) {
         ESP_LOGE(TAG, "Failed to allocate LVGL buffers");
         return ESP_ERR_NO_MEM;
     }
+#endif
 
     lv_disp_draw_buf_init(&draw_buf, buf1, buf2, LVGL_BUF_SIZE);
 
+    view_data_mutex = xSemaphoreCreateMutex();
+    if (!view_data_mutex) {
+        ESP_LOGE(TAG, "Failed to create view data mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    raster_queue = xQueueCreate(RASTER_QUEUE_DEPTH, sizeof(raster_op_t));
+    if (!raster_queue) {
+        ESP_LOGE(TAG, "Failed to create raster queue");
+        return ESP_ERR_NO_MEM;
+    }
+
     // Initialize display driver
     lv_disp_drv_init(&disp_drv);
     disp_drv.hor_res = LCD_WIDTH;
     disp_drv.ver_res = LCD_HEIGHT;
     disp_drv.flush_cb = lvgl_flush_cb;
+    disp_drv.monitor_cb = lvgl_monitor_cb;
     disp_drv.draw_buf = &draw_buf;
+#ifndef LCD_HEADLESS
     disp_drv.user_data = panel_handle;
+#endif
     disp = lv_disp_drv_register(&disp_drv);
 
     ESP_LOGI(TAG, "LVGL initialized successfully");
@@ -1206,25 +1614,58 @@ esp_err_t lcd_init(void)
 
 void lcd_set_backlight(uint8_t brightness)
 {
-    uint32_t duty = (brightness * 255) / 100;
-    ESP_LOGI(TAG, "Setting backlight: %d%% (duty: %lu/255)", brightness, duty);
-    esp_err_t ret = ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, duty);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "ledc_set_duty failed: %s", esp_err_to_name(ret));
-        return;
-    }
-    ret = ledc_update_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "ledc_update_duty failed: %s", esp_err_to_name(ret));
-    }
+    ESP_LOGI(TAG, "Setting backlight: %d%%", brightness);
+    backlight_set(brightness, BACKLIGHT_FADE_MS);
+}
+
+#ifdef LCD_HEADLESS
+void lcd_sleep(void)
+{
+    backlight_sleep();
 }
+#else
+void lcd_sleep(void)
+{
+    backlight_sleep();
+
+    // ST7789 sleep-in; lcd_init() resets the panel on the way back up
+    esp_lcd_panel_disp_on_off(panel_handle, false);
+    esp_lcd_panel_disp_sleep(panel_handle, true);
+}
+#endif
 
 // Track last refresh time for periodic updates
 static uint32_t last_realtime_refresh_ms = 0;
 #define REALTIME_REFRESH_INTERVAL_MS 30000  // Refresh realtime views every 30 seconds
 
-void lcd_update(void)
+// How long the main loop can sleep before LVGL needs another handler call.
+// The display refresh timer fires every refresh period even with nothing to
+// draw, so it only counts while an area is invalid or an animation runs.
+static uint32_t lvgl_idle_ms(uint32_t handler_ms)
+{
+    lv_disp_t *d = lv_disp_get_default();
+    if (!d || d->inv_p > 0 || lv_anim_count_running() > 0) {
+        return handler_ms;
+    }
+
+    uint32_t next = POWER_LOOP_MAX_MS;
+    for (lv_timer_t *t = lv_timer_get_next(NULL); t; t = lv_timer_get_next(t)) {
+        if (t->paused || t == d->refr_timer) continue;
+        uint32_t elapsed = lv_tick_elaps(t->last_run);
+        uint32_t left = elapsed >= t->period ? 0 : t->period - elapsed;
+        if (left < next) next = left;
+    }
+    return next;
+}
+
+uint32_t lcd_update(void)
 {
+    uint32_t next_ms = POWER_LOOP_MAX_MS;
+
+    // Bring the backlight back up after a view-change dip
+    uint32_t backlight_ms = backlight_update();
+    if (backlight_ms < next_ms) next_ms = backlight_ms;
+
     // Periodic refresh for realtime views (ensures countdown stays accurate)
     const view_config_t* curr_config = lcd_get_view_config(current_view);
     if (curr_config && curr_config->data_source == VIEW_DATA_REALTIME) {
@@ -1234,6 +1675,8 @@ void lcd_update(void)
             lcd_refresh_scene();
             ESP_LOGI("LCD", "Periodic refresh for realtime view %d", current_view);
         }
+        uint32_t left = REALTIME_REFRESH_INTERVAL_MS - (now_ms - last_realtime_refresh_ms);
+        if (left < next_ms) next_ms = left;
     }
 
     // Process pending scene/view change (thread-safe: only modify LVGL from main loop)
@@ -1242,21 +1685,16 @@ void lcd_update(void)
         current_view = (view_id_t)pending_scene;
         current_scene = (lcd_scene_t)pending_scene;  // Keep legacy scene in sync
         pending_scene = -1;
+        trace_instant("view_change", (uint32_t)current_view);
+        power_note_view((int)current_view);
 
-        // Clean up rotation timers when leaving views
+        // Clean up rotation timers when leaving views; the backlight dips
+        // while the new view draws
         if (old_view != current_view) {
-            if (view_rotation_timer) {
-                lv_timer_del(view_rotation_timer);
-                view_rotation_timer = NULL;
-            }
-            if (hs_rotation_timer) {
-                lv_timer_del(hs_rotation_timer);
-                hs_rotation_timer = NULL;
-            }
-            view_header_label = NULL;
-            view_time_label = NULL;
-            hs_header_label = NULL;
-            hs_time_label = NULL;
+            release_view_timers();
+            backlight_dip();
+            uint32_t dip_ms = backlight_update();
+            if (dip_ms < next_ms) next_ms = dip_ms;
         }
 
         // Apply view config color and LED
@@ -1276,6 +1714,7 @@ void lcd_update(void)
         }
 
         lcd_refresh_scene();
+        event_stream_publish(EVENT_TOPIC_VIEW | EVENT_TOPIC_TFNSW);
     }
 
     // Process pending theme change
@@ -1295,29 +1734,40 @@ void lcd_update(void)
         }
     }
 
-    // Process pending realtime update (legacy)
-    if (pending_realtime_update) {
-        pending_realtime_update = false;
-        lcd_apply_realtime_update();
+    // Legacy draw calls are rasterised straight to the panel. LVGL stays paused
+    // while that output is up and resumes once a screen builder adds widgets.
+    raster_process_queue();
+    if (raster_active) {
+        if (lv_obj_get_child_cnt(lv_scr_act()) == 0) {
+            return next_ms;     // raster_submit() wakes the loop
+        }
+        raster_active = false;
+        lv_obj_invalidate(lv_scr_act());
     }
 
-    // Process pending dual-direction update (legacy)
-    if (pending_dual_update) {
-        pending_dual_update = false;
-        lcd_apply_dual_update();
+    // Repaint whatever the display mirror had to drop so viewers catch up
+    int mx1, my1, mx2, my2;
+    if (display_mirror_take_resync(&mx1, &my1, &mx2, &my2)) {
+        lv_area_t area = { .x1 = mx1, .y1 = my1, .x2 = mx2 - 1, .y2 = my2 - 1 };
+        _lv_inv_area(lv_disp_get_default(), &area);
     }
 
-    // Process pending simple mode updates (legacy)
-    if (pending_north_update) {
-        pending_north_update = false;
-        lcd_apply_simple_update(true);
-    }
-    if (pending_south_update) {
-        pending_south_update = false;
-        lcd_apply_simple_update(false);
+    // Only handler calls that flushed something count as a frame
+    frame_flush_px = 0;
+    frame_flush_count = 0;
+    int64_t start_us = esp_timer_get_time();
+    spi_arbiter_frame_begin();
+    uint32_t handler_ms = lv_timer_handler();
+    spi_arbiter_frame_end();
+    if (frame_flush_count > 0) {
+        render_perf_record(PERF_FRAME_US, (uint32_t)(esp_timer_get_time() - start_us));
+        render_perf_record(PERF_FRAME_PX, frame_flush_px);
+        // Idle handler calls would flood the trace ring, so only frames are kept
+        trace_span("frame", start_us, frame_flush_px);
     }
 
-    lv_timer_handler();
+    uint32_t lvgl_ms = lvgl_idle_ms(handler_ms);
+    return lvgl_ms < next_ms ? lvgl_ms : next_ms;
 }
 
 // ============================================================================
@@ -1334,6 +1784,7 @@ void lcd_set_scene(lcd_scene_t scene)
     if (scene < SCENE_COUNT) {
         // Set pending scene - will be applied in lcd_update() from main loop
         pending_scene = (int)scene;
+        power_loop_wake();
     }
 }
 
@@ -1342,6 +1793,7 @@ void lcd_next_scene(void)
     // Calculate next scene and set as pending - will be applied in lcd_update() from main loop
     // This is thread-safe: LVGL operations only happen in the main loop
     pending_scene = (current_scene + 1) % SCENE_COUNT;
+    power_loop_wake();
 }
 
 void lcd_refresh_scene(void)
@@ -1556,7 +2008,7 @@ void lcd_show_departure_board(void)
     }
     lv_obj_t *mins_lbl = lv_label_create(scr);
     lv_label_set_text(mins_lbl, mins_str);
-    lv_obj_set_style_text_font(mins_lbl, &lv_font_montserrat_24, 0);
+    lv_obj_set_style_text_font(mins_lbl, digit_font(&lv_font_montserrat_24), 0);
     lv_obj_set_style_text_color(mins_lbl, lv_color_hex(theme_accent_color), 0);
     lv_obj_align(mins_lbl, LV_ALIGN_TOP_RIGHT, -10, 30);
 
@@ -1586,7 +2038,7 @@ void lcd_show_departure_board(void)
 
     lv_obj_t *next_mins = lv_label_create(scr);
     lv_label_set_text(next_mins, next_departure_time);
-    lv_obj_set_style_text_font(next_mins, &lv_font_montserrat_16, 0);
+    lv_obj_set_style_text_font(next_mins, digit_font(&lv_font_montserrat_16), 0);
     lv_obj_set_style_text_color(next_mins, lv_color_hex(theme_accent_color), 0);
     lv_obj_align(next_mins, LV_ALIGN_TOP_RIGHT, -10, 90);
 
@@ -1598,7 +2050,7 @@ void lcd_show_departure_board(void)
 
     lv_obj_t *next2_mins = lv_label_create(scr);
     lv_label_set_text(next2_mins, next2_departure_time);
-    lv_obj_set_style_text_font(next2_mins, &lv_font_montserrat_16, 0);
+    lv_obj_set_style_text_font(next2_mins, digit_font(&lv_font_montserrat_16), 0);
     lv_obj_set_style_text_color(next2_mins, lv_color_hex(theme_accent_color), 0);
     lv_obj_align(next2_mins, LV_ALIGN_TOP_RIGHT, -10, 115);
 
@@ -1610,7 +2062,7 @@ void lcd_show_departure_board(void)
 
     lv_obj_t *next3_mins = lv_label_create(scr);
     lv_label_set_text(next3_mins, "14 min");
-    lv_obj_set_style_text_font(next3_mins, &lv_font_montserrat_16, 0);
+    lv_obj_set_style_text_font(next3_mins, digit_font(&lv_font_montserrat_16), 0);
     lv_obj_set_style_text_color(next3_mins, lv_color_hex(theme_accent_color), 0);
     lv_obj_align(next3_mins, LV_ALIGN_TOP_RIGHT, -10, 140);
 }
@@ -1690,7 +2142,7 @@ void lcd_show_high_speed(void)
     snprintf(mins_str, sizeof(mins_str), "%d min", svc->mins_to_departure);
     hs_mins_label = lv_label_create(scr);
     lv_label_set_text(hs_mins_label, mins_str);
-    lv_obj_set_style_text_font(hs_mins_label, &lv_font_montserrat_24, 0);
+    lv_obj_set_style_text_font(hs_mins_label, digit_font(&lv_font_montserrat_24), 0);
     lv_obj_set_style_text_color(hs_mins_label, lv_color_hex(theme_accent_color), 0);
     lv_obj_align(hs_mins_label, LV_ALIGN_TOP_RIGHT, -10, 28);
 
@@ -1819,7 +2271,7 @@ void lcd_show_high_speed(void)
         snprintf(next_mins_str[i], sizeof(next_mins_str[i]), "%d min", next_svc->mins_to_departure);
         lv_obj_t *next_mins = lv_label_create(scr);
         lv_label_set_text(next_mins, next_mins_str[i]);
-        lv_obj_set_style_text_font(next_mins, &lv_font_montserrat_16, 0);
+        lv_obj_set_style_text_font(next_mins, digit_font(&lv_font_montserrat_16), 0);
         lv_obj_set_style_text_color(next_mins, lv_color_hex(theme_accent_color), 0);
         lv_obj_align(next_mins, LV_ALIGN_TOP_RIGHT, -10, next_y[i-1]);
     }
@@ -2087,67 +2539,256 @@ void lcd_show_error(const char* message)
     lv_refr_now(NULL);
 }
 
-// Legacy functions for compatibility
-void lcd_clear(uint16_t color)
+// ============================================================================
+// Immediate-mode Raster Layer (legacy draw API)
+// ============================================================================
+
+static uint32_t raster_band_seq[2] = {0, 0};
+static int raster_band_index = 0;
+
+static const lv_font_t* legacy_font_for_size(uint8_t size)
 {
-    lv_obj_t *scr = lv_scr_act();
-    lv_obj_set_style_bg_color(scr, lv_color_hex(color), 0);
-    lv_refr_now(NULL);
+    if (size >= 4) return &lv_font_montserrat_32;
+    if (size >= 3) return &lv_font_montserrat_24;
+    if (size >= 2) return &lv_font_montserrat_16;
+    return &lv_font_montserrat_12;
+}
+
+// RGB565 -> panel wire format. The panel runs in BGR order (see the theme
+// colour notes above), so swap red/blue, then byte-swap for SPI.
+static inline uint16_t raster_panel_color(uint16_t rgb565)
+{
+    uint16_t bgr = ((rgb565 & 0x1F) << 11) | (rgb565 & 0x07E0) | (rgb565 >> 11);
+    return (uint16_t)((bgr >> 8) | (bgr << 8));
+}
+
+static inline uint16_t raster_mix(uint16_t fg, uint16_t bg, uint32_t a)
+{
+    uint32_t r = (((fg >> 11) & 0x1F) * a + ((bg >> 11) & 0x1F) * (255 - a)) / 255;
+    uint32_t g = (((fg >> 5) & 0x3F) * a + ((bg >> 5) & 0x3F) * (255 - a)) / 255;
+    uint32_t b = ((fg & 0x1F) * a + (bg & 0x1F) * (255 - a)) / 255;
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+// Next free band buffer (waits for its previous transfer to finish)
+static uint16_t* raster_next_band(void)
+{
+    lcd_wait_tx(raster_band_seq[raster_band_index]);
+    return RASTER_BAND(raster_band_index);
+}
+
+static void raster_push_band(int x1, int y1, int x2, int y2, uint16_t *band)
+{
+    raster_band_seq[raster_band_index] = lcd_queue_bitmap(x1, y1, x2, y2, band);
+    raster_band_index ^= 1;
+}
+
+// Split a clipped rectangle into band-sized row chunks
+static int raster_chunk_rows(int width)
+{
+    return (LCD_WIDTH * RASTER_BAND_LINES) / width;
+}
+
+static void raster_fill(int x, int y, int w, int h, uint16_t color)
+{
+    int x1 = x < 0 ? 0 : x;
+    int y1 = y < 0 ? 0 : y;
+    int x2 = (x + w > LCD_WIDTH) ? LCD_WIDTH : x + w;
+    int y2 = (y + h > LCD_HEIGHT) ? LCD_HEIGHT : y + h;
+    if (x1 >= x2 || y1 >= y2) return;
+
+    uint16_t px = raster_panel_color(color);
+    int width = x2 - x1;
+    int chunk_rows = raster_chunk_rows(width);
+
+    for (int by = y1; by < y2; by += chunk_rows) {
+        int rows = (y2 - by < chunk_rows) ? (y2 - by) : chunk_rows;
+        uint16_t *band = raster_next_band();
+        for (int i = 0; i < width * rows; i++) {
+            band[i] = px;
+        }
+        raster_push_band(x1, by, x2, by + rows, band);
+    }
+}
+
+// Blend the rows of one glyph that fall inside the band (band is RGB565)
+static void raster_glyph(uint16_t *band, int band_x, int band_y, int band_w, int band_rows,
+                         const lv_font_t *font, uint32_t letter, uint32_t next,
+                         int pen_x, int top_y, uint16_t fg)
+{
+    lv_font_glyph_dsc_t g;
+    if (!lv_font_get_glyph_dsc(font, &g, letter, next)) return;
+    if (g.box_w == 0 || g.box_h == 0 || g.bpp == 0 || g.bpp > 8) return;
+
+    const lv_font_t *src_font = g.resolved_font ? g.resolved_font : font;
+    const uint8_t *bitmap = lv_font_get_glyph_bitmap(src_font, letter);
+    if (!bitmap) return;
+
+    int gx = pen_x + g.ofs_x;
+    int gy = top_y + (font->line_height - font->base_line) - g.box_h - g.ofs_y;
+    uint32_t max_val = (1U << g.bpp) - 1;
+
+    for (int row = 0; row < g.box_h; row++) {
+        int py = gy + row;
+        if (py < band_y || py >= band_y + band_rows) continue;
+
+        // Glyph bitmaps are packed MSB-first with no row padding
+        uint32_t bit = (uint32_t)row * g.box_w * g.bpp;
+        for (int col = 0; col < g.box_w; col++, bit += g.bpp) {
+            int px = gx + col;
+            if (px < band_x || px >= band_x + band_w) continue;
+
+            uint32_t byte = bit >> 3;
+            uint32_t shift = bit & 7;
+            uint32_t word = bitmap[byte] << 8;
+            if (shift + g.bpp > 8) word |= bitmap[byte + 1];
+            uint32_t v = (word >> (16 - shift - g.bpp)) & max_val;
+            if (!v) continue;
+
+            uint16_t *dst = &band[(py - band_y) * band_w + (px - band_x)];
+            *dst = raster_mix(fg, *dst, v * 255 / max_val);
+        }
+    }
+}
+
+static void raster_text(const raster_op_t *op)
+{
+    const lv_font_t *font = legacy_font_for_size(op->size);
+    int text_w = lv_txt_get_width(op->text, strlen(op->text), font, 0, LV_TEXT_FLAG_NONE);
+    int x = (op->type == RASTER_TEXT_CENTERED) ? (LCD_WIDTH - text_w) / 2 : op->x;
+    int y = op->y;
+
+    int x1 = x < 0 ? 0 : x;
+    int y1 = y < 0 ? 0 : y;
+    int x2 = (x + text_w > LCD_WIDTH) ? LCD_WIDTH : x + text_w;
+    int y2 = (y + font->line_height > LCD_HEIGHT) ? LCD_HEIGHT : y + font->line_height;
+    if (x1 >= x2 || y1 >= y2) return;
+
+    int width = x2 - x1;
+    int chunk_rows = raster_chunk_rows(width);
+
+    for (int by = y1; by < y2; by += chunk_rows) {
+        int rows = (y2 - by < chunk_rows) ? (y2 - by) : chunk_rows;
+        int count = width * rows;
+        uint16_t *band = raster_next_band();
+        for (int i = 0; i < count; i++) {
+            band[i] = op->bg;
+        }
+
+        uint32_t i = 0;
+        int pen_x = x;
+        uint32_t letter = _lv_txt_encoded_next(op->text, &i);
+        while (letter) {
+            uint32_t next_i = i;
+            uint32_t next = _lv_txt_encoded_next(op->text, &next_i);
+            raster_glyph(band, x1, by, width, rows, font, letter, next, pen_x, y, op->color);
+            pen_x += lv_font_get_glyph_width(font, letter, next);
+            letter = next;
+            i = next_i;
+        }
+
+        for (int j = 0; j < count; j++) {
+            band[j] = raster_panel_color(band[j]);
+        }
+        raster_push_band(x1, by, x2, by + rows, band);
+    }
+}
+
+// Take the screen over from LVGL: drop its widgets (no refresh) and make sure
+// no LVGL flush is still reading the buffers we are about to draw into
+static void raster_begin(void)
+{
+    if (!raster_active) {
+        release_view_timers();
+        lv_obj_clean(lv_scr_act());
+        raster_active = true;
+    }
+    lcd_wait_tx(color_tx_queued);
 }
 
-void lcd_draw_string(int x, int y, const char* str, uint16_t color, uint16_t bg, uint8_t size)
+static void raster_process_queue(void)
 {
-    lv_obj_t *label = lv_label_create(lv_scr_act());
-    lv_label_set_text(label, str);
-    lv_obj_set_style_text_color(label, lv_color_hex(color), 0);
+    if (!raster_queue || uxQueueMessagesWaiting(raster_queue) == 0) return;
+
+    raster_begin();
+
+    raster_op_t op;
+    while (xQueueReceive(raster_queue, &op, 0) == pdTRUE) {
+        switch (op.type) {
+            case RASTER_CLEAR:
+                raster_fill(0, 0, LCD_WIDTH, LCD_HEIGHT, op.color);
+                break;
+            case RASTER_FILL:
+                raster_fill(op.x, op.y, op.w, op.h, op.color);
+                break;
+            case RASTER_FRAME:
+                raster_fill(op.x, op.y, op.w, 1, op.color);
+                raster_fill(op.x, op.y + op.h - 1, op.w, 1, op.color);
+                raster_fill(op.x, op.y, 1, op.h, op.color);
+                raster_fill(op.x + op.w - 1, op.y, 1, op.h, op.color);
+                break;
+            case RASTER_TEXT:
+            case RASTER_TEXT_CENTERED:
+                raster_text(&op);
+                break;
+        }
+    }
 
-    const lv_font_t *font = &lv_font_montserrat_14;
-    if (size >= 4) font = &lv_font_montserrat_32;
-    else if (size >= 3) font = &lv_font_montserrat_24;
-    else if (size >= 2) font = &lv_font_montserrat_16;
-    else font = &lv_font_montserrat_12;
+    // Hand the buffers back to LVGL idle
+    lcd_wait_tx(color_tx_queued);
+}
 
-    lv_obj_set_style_text_font(label, font, 0);
-    lv_obj_set_pos(label, x, y);
+// Queue a draw op for lcd_update(), waiting up to RASTER_SUBMIT_WAIT_MS for
+// room. A clear hides everything queued before it, so it replaces the backlog.
+static esp_err_t raster_submit(const raster_op_t *op)
+{
+    if (!raster_queue) return ESP_ERR_INVALID_STATE;
+    if (op->type == RASTER_CLEAR) {
+        xQueueReset(raster_queue);
+    }
+    if (xQueueSend(raster_queue, op, pdMS_TO_TICKS(RASTER_SUBMIT_WAIT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "Raster queue full, draw op %d refused", op->type);
+        return ESP_ERR_TIMEOUT;
+    }
+    power_loop_wake();
+    return ESP_OK;
 }
 
-void lcd_draw_string_centered(int y, const char* str, uint16_t color, uint16_t bg, uint8_t size)
+// Legacy functions for compatibility (queued, drawn by lcd_update)
+esp_err_t lcd_clear(uint16_t color)
 {
-    lv_obj_t *label = lv_label_create(lv_scr_act());
-    lv_label_set_text(label, str);
-    lv_obj_set_style_text_color(label, lv_color_hex(color), 0);
+    raster_op_t op = {.type = RASTER_CLEAR, .color = color};
+    return raster_submit(&op);
+}
 
-    const lv_font_t *font = &lv_font_montserrat_14;
-    if (size >= 4) font = &lv_font_montserrat_32;
-    else if (size >= 3) font = &lv_font_montserrat_24;
-    else if (size >= 2) font = &lv_font_montserrat_16;
-    else font = &lv_font_montserrat_12;
+esp_err_t lcd_draw_string(int x, int y, const char* str, uint16_t color, uint16_t bg, uint8_t size)
+{
+    if (!str) return ESP_ERR_INVALID_ARG;
+    raster_op_t op = {.type = RASTER_TEXT, .x = x, .y = y, .color = color, .bg = bg, .size = size};
+    strncpy(op.text, str, sizeof(op.text) - 1);
+    return raster_submit(&op);
+}
 
-    lv_obj_set_style_text_font(label, font, 0);
-    lv_obj_align(label, LV_ALIGN_TOP_MID, 0, y);
+esp_err_t lcd_draw_string_centered(int y, const char* str, uint16_t color, uint16_t bg, uint8_t size)
+{
+    if (!str) return ESP_ERR_INVALID_ARG;
+    raster_op_t op = {.type = RASTER_TEXT_CENTERED, .y = y, .color = color, .bg = bg, .size = size};
+    strncpy(op.text, str, sizeof(op.text) - 1);
+    return raster_submit(&op);
 }
 
-void lcd_fill_rect(int x, int y, int w, int h, uint16_t color)
+esp_err_t lcd_fill_rect(int x, int y, int w, int h, uint16_t color)
 {
-    lv_obj_t *rect = lv_obj_create(lv_scr_act());
-    lv_obj_set_scrollbar_mode(rect, LV_SCROLLBAR_MODE_OFF);
-    lv_obj_set_pos(rect, x, y);
-    lv_obj_set_size(rect, w, h);
-    lv_obj_set_style_bg_color(rect, lv_color_hex(color), 0);
-    lv_obj_set_style_radius(rect, 0, 0);
-    lv_obj_set_style_border_width(rect, 0, 0);
+    if (w <= 0 || h <= 0) return ESP_ERR_INVALID_ARG;
+    raster_op_t op = {.type = RASTER_FILL, .x = x, .y = y, .w = w, .h = h, .color = color};
+    return raster_submit(&op);
 }
 
-void lcd_draw_rect(int x, int y, int w, int h, uint16_t color)
+esp_err_t lcd_draw_rect(int x, int y, int w, int h, uint16_t color)
 {
-    lv_obj_t *rect = lv_obj_create(lv_scr_act());
-    lv_obj_set_scrollbar_mode(rect, LV_SCROLLBAR_MODE_OFF);
-    lv_obj_set_pos(rect, x, y);
-    lv_obj_set_size(rect, w, h);
-    lv_obj_set_style_bg_opa(rect, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_color(rect, lv_color_hex(color), 0);
-    lv_obj_set_style_border_width(rect, 1, 0);
-    lv_obj_set_style_radius(rect, 0, 0);
+    if (w <= 0 || h <= 0) return ESP_ERR_INVALID_ARG;
+    raster_op_t op = {.type = RASTER_FRAME, .x = x, .y = y, .w = w, .h = h, .color = color};
+    return raster_submit(&op);
 }
 
 // ============================================================================
@@ -2159,6 +2800,7 @@ void lcd_set_theme_accent(uint32_t color)
     // Set pending theme - will be applied in lcd_update() from main loop
     pending_theme = color;
     theme_change_pending = true;
+    power_loop_wake();
 }
 
 uint32_t lcd_get_theme_accent(void)
@@ -2414,443 +3056,36 @@ void lcd_show_no_services(const char* message)
     current_display_status = DISPLAY_STATUS_NO_SERVICES;
 }
 
+// ============================================================================
+// Legacy Realtime Adapters
+// ============================================================================
+// The pre-view-registry realtime APIs feed the same per-view store as
+// lcd_update_view_data() and are drawn by the common view renderer.
+
 void lcd_update_realtime_departures(const tfnsw_departures_t* departures)
 {
-    if (!departures) return;
-
-    // Copy data (thread-safe)
-    memcpy(&realtime_departures, departures, sizeof(tfnsw_departures_t));
-    realtime_mode_enabled = true;
-
-    // Set pending flag - actual LVGL update happens in lcd_update() from main loop
-    pending_realtime_update = true;
+    lcd_update_view_data((view_id_t)SCENE_DEPARTURE_BOARD, departures);
 }
 
-// Apply realtime update - called from lcd_update() in main loop (thread-safe for LVGL)
-static void lcd_apply_realtime_update(void)
+// Helper: Merge and sort dual departures into a single array
+static int merge_dual_departures(const tfnsw_dual_departures_t* deps, tfnsw_departure_t* merged, int max_count)
 {
-    // Only update display if we're on the departure board scene
-    if (current_scene != SCENE_DEPARTURE_BOARD) {
-        return;
-    }
-
-    tfnsw_departures_t* deps = &realtime_departures;
-
-    // Handle different statuses
-    switch (deps->status) {
-        case TFNSW_STATUS_ERROR_NO_API_KEY:
-            lcd_show_api_key_required();
-            return;
-
-        case TFNSW_STATUS_FETCHING:
-            if (deps->count == 0) {
-                lcd_show_fetching();
-            }
-            return;
-
-        case TFNSW_STATUS_ERROR_AUTH:
-            lcd_show_data_error("Invalid API Key",
-                               "Your API key is not valid",
-                               "Check key at opendata.transport.nsw.gov.au");
-            return;
-
-        case TFNSW_STATUS_ERROR_RATE_LIMIT:
-            lcd_show_data_error("Rate Limited",
-                               "Too many requests",
-                               "Try again in a few minutes");
-            return;
-
-        case TFNSW_STATUS_ERROR_NETWORK:
-        case TFNSW_STATUS_ERROR_TIMEOUT:
-            if (deps->count == 0) {
-                lcd_show_data_error("Network Error",
-                                   deps->error_message[0] ? deps->error_message : "Connection failed",
-                                   "Check WiFi connection");
-            }
-            return;
+    int total = 0;
+    int ni = 0, si = 0;
 
-        case TFNSW_STATUS_ERROR_SERVER:
-            lcd_show_data_error("Server Error",
-                               "TfNSW service unavailable",
-                               "Try again later");
-            return;
+    // Merge sort both arrays by mins_to_departure
+    while (total < max_count && (ni < deps->northbound_count || si < deps->southbound_count)) {
+        bool use_north = false;
 
-        case TFNSW_STATUS_ERROR_NO_DATA:
-            lcd_show_no_services(deps->suspension_message[0] ?
-                                deps->suspension_message : NULL);
-            return;
-
-        case TFNSW_STATUS_SUCCESS:
-        case TFNSW_STATUS_IDLE:
-            break;
-
-        default:
-            if (deps->count == 0) {
-                lcd_show_data_error("Error",
-                                   deps->error_message[0] ? deps->error_message : "Unknown error",
-                                   "Press button to retry");
-            }
-            return;
-    }
-
-    // Show realtime departure board
-    if (deps->count > 0) {
-        lcd_show_realtime_metro_board();
-    } else {
-        lcd_show_no_services(NULL);
-    }
-}
-
-// Enhanced departure board with realtime data
-static void lcd_show_realtime_metro_board(void)
-{
-    lv_obj_t *scr = lv_scr_act();
-    lv_obj_clean(scr);
-    lv_obj_set_style_bg_color(scr, lv_color_hex(THEME_BG), 0);
-    lv_obj_set_scrollbar_mode(scr, LV_SCROLLBAR_MODE_OFF);
-    lv_obj_clear_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
-
-    tfnsw_departures_t* deps = &realtime_departures;
-
-    // ===== HEADER BAR =====
-    lv_obj_t *header_bg = lv_label_create(scr);
-    lv_obj_set_size(header_bg, LCD_WIDTH, 26);
-    lv_obj_set_pos(header_bg, 0, 0);
-    lv_obj_set_style_bg_color(header_bg, lv_color_hex(theme_accent_color), 0);
-    lv_obj_set_style_bg_opa(header_bg, LV_OPA_COVER, 0);
-
-    lv_obj_t *svc_type = lv_label_create(scr);
-    lv_label_set_text(svc_type, "Metro");
-    lv_obj_set_style_text_font(svc_type, &lv_font_montserrat_14, 0);
-    lv_obj_set_style_text_color(svc_type, lv_color_hex(THEME_BG), 0);
-    lv_obj_set_pos(svc_type, 8, 5);
-
-    // Live indicator or status
-    if (deps->status == TFNSW_STATUS_SUCCESS) {
-        lv_obj_t *live_indicator = lv_label_create(scr);
-        lv_label_set_text(live_indicator, "LIVE");
-        lv_obj_set_style_text_font(live_indicator, &lv_font_montserrat_12, 0);
-        lv_obj_set_style_text_color(live_indicator, lv_color_hex(THEME_BG), 0);
-        lv_obj_set_pos(live_indicator, 55, 7);
-    }
-
-    lv_obj_t *time_now = lv_label_create(scr);
-    lv_label_set_text(time_now, get_current_time_str());
-    lv_obj_set_style_text_font(time_now, &lv_font_montserrat_14, 0);
-    lv_obj_set_style_text_color(time_now, lv_color_hex(THEME_BG), 0);
-    lv_obj_align(time_now, LV_ALIGN_TOP_RIGHT, -8, 5);
-
-    current_display_status = DISPLAY_STATUS_LIVE;
-
-    if (deps->count == 0) {
-        // No departures
-        lv_obj_t *no_svc = lv_label_create(scr);
-        lv_label_set_text(no_svc, "See platform screens");
-        lv_obj_set_style_text_font(no_svc, &lv_font_montserrat_16, 0);
-        lv_obj_set_style_text_color(no_svc, lv_color_hex(THEME_SECONDARY), 0);
-        lv_obj_align(no_svc, LV_ALIGN_CENTER, 0, 0);
-        return;
-    }
-
-    // ===== FIRST DEPARTURE (MAIN) =====
-    tfnsw_departure_t* first = &deps->departures[0];
-
-    // Destination - validate before display
-    const char *dest_str = first->destination;
-    if (!dest_str || dest_str[0] == '\0' || strlen(dest_str) < 3) {
-        dest_str = "Unknown";  // Fallback for empty/corrupt destinations
-    }
-    lv_obj_t *dest_lbl = lv_label_create(scr);
-    lv_label_set_text(dest_lbl, dest_str);
-    lv_obj_set_style_text_font(dest_lbl, &lv_font_montserrat_24, 0);
-    lv_obj_set_style_text_color(dest_lbl, lv_color_hex(THEME_TEXT), 0);
-    lv_obj_set_pos(dest_lbl, 10, 30);
-
-    // Minutes display
-    char mins_str[24];
-    if (first->mins_to_departure <= 0) {
-        snprintf(mins_str, sizeof(mins_str), "NOW");
-    } else if (first->mins_to_departure == 1) {
-        snprintf(mins_str, sizeof(mins_str), "1 min");
-    } else {
-        snprintf(mins_str, sizeof(mins_str), "%d min", first->mins_to_departure);
-    }
-
-    lv_obj_t *mins_lbl = lv_label_create(scr);
-    lv_label_set_text(mins_lbl, mins_str);
-    lv_obj_set_style_text_font(mins_lbl, &lv_font_montserrat_24, 0);
-    lv_obj_set_style_text_color(mins_lbl, lv_color_hex(theme_accent_color), 0);
-    lv_obj_align(mins_lbl, LV_ALIGN_TOP_RIGHT, -10, 30);
-
-    // Realtime indicator and delay
-    int y_indicator = 56;
-    if (first->is_realtime) {
-        lv_obj_t *rt_dot = lv_label_create(scr);
-        lv_obj_set_size(rt_dot, 6, 6);
-        lv_obj_set_pos(rt_dot, 10, y_indicator + 4);
-        lv_obj_set_style_bg_color(rt_dot, lv_color_hex(0x00FF00), 0);  // Green dot
-        lv_obj_set_style_bg_opa(rt_dot, LV_OPA_COVER, 0);
-        lv_obj_set_style_radius(rt_dot, 3, 0);
-
-        lv_obj_t *rt_lbl = lv_label_create(scr);
-        if (first->delay_seconds > 60) {
-            char delay_str[32];
-            snprintf(delay_str, sizeof(delay_str), "Delayed +%d min", first->delay_seconds / 60);
-            lv_label_set_text(rt_lbl, delay_str);
-            lv_obj_set_style_text_color(rt_lbl, lv_color_hex(0xFF8800), 0);  // Orange for delay
-        } else if (first->delay_seconds < -60) {
-            lv_label_set_text(rt_lbl, "Running early");
-            lv_obj_set_style_text_color(rt_lbl, lv_color_hex(0x00AAFF), 0);  // Blue for early
-        } else {
-            lv_label_set_text(rt_lbl, "On time");
-            lv_obj_set_style_text_color(rt_lbl, lv_color_hex(0x00FF00), 0);  // Green for on time
-        }
-        lv_obj_set_style_text_font(rt_lbl, &lv_font_montserrat_12, 0);
-        lv_obj_set_pos(rt_lbl, 20, y_indicator);
-    } else {
-        // Scheduled time indicator
-        lv_obj_t *sched_lbl = lv_label_create(scr);
-        lv_label_set_text(sched_lbl, "Scheduled");
-        lv_obj_set_style_text_font(sched_lbl, &lv_font_montserrat_12, 0);
-        lv_obj_set_style_text_color(sched_lbl, lv_color_hex(THEME_SECONDARY), 0);
-        lv_obj_set_pos(sched_lbl, 10, y_indicator);
-    }
-
-    // Platform if available
-    if (first->platform[0] != '\0') {
-        lv_obj_t *platform = lv_label_create(scr);
-        char plat_str[16];
-        snprintf(plat_str, sizeof(plat_str), "Plat %s", first->platform);
-        lv_label_set_text(platform, plat_str);
-        lv_obj_set_style_text_font(platform, &lv_font_montserrat_12, 0);
-        lv_obj_set_style_text_color(platform, lv_color_hex(THEME_SECONDARY), 0);
-        lv_obj_align(platform, LV_ALIGN_TOP_RIGHT, -10, y_indicator);
-    }
-
-    // ===== CALLING STATIONS (scrolling) =====
-    if (first->calling_stations[0] != '\0') {
-        lv_obj_t *calling_lbl = lv_label_create(scr);
-        lv_label_set_text(calling_lbl, first->calling_stations);
-        lv_obj_set_style_text_font(calling_lbl, &lv_font_montserrat_12, 0);
-        lv_obj_set_style_text_color(calling_lbl, lv_color_hex(THEME_TEXT), 0);
-        lv_obj_set_width(calling_lbl, LCD_WIDTH - 20);
-        lv_label_set_long_mode(calling_lbl, LV_LABEL_LONG_SCROLL_CIRCULAR);
-        lv_obj_set_style_anim_speed(calling_lbl, 20, 0);  // Slow scroll
-        lv_obj_set_pos(calling_lbl, 10, 70);
-    }
-
-    // ===== SEPARATOR =====
-    lv_obj_t *line = lv_label_create(scr);
-    lv_obj_set_size(line, LCD_WIDTH, 1);
-    lv_obj_set_pos(line, 0, 85);
-    lv_obj_set_style_bg_color(line, lv_color_hex(THEME_SECONDARY), 0);
-    lv_obj_set_style_bg_opa(line, LV_OPA_COVER, 0);
-
-    // ===== NEXT SERVICES =====
-    int y_offset = 92;
-    int row_height = 20;
-
-    for (int i = 1; i < deps->count && i < 4; i++) {
-        tfnsw_departure_t* dep = &deps->departures[i];
-        int y = y_offset + (i - 1) * row_height;
-
-        // Destination - validate before display
-        const char *next_dest_str = dep->destination;
-        if (!next_dest_str || next_dest_str[0] == '\0' || strlen(next_dest_str) < 3) {
-            next_dest_str = "Unknown";
-        }
-        lv_obj_t *next_dest = lv_label_create(scr);
-        lv_label_set_text(next_dest, next_dest_str);
-        lv_obj_set_style_text_font(next_dest, &lv_font_montserrat_14, 0);
-        lv_obj_set_style_text_color(next_dest, lv_color_hex(THEME_TEXT), 0);
-        lv_obj_set_width(next_dest, LCD_WIDTH - 80);
-        lv_label_set_long_mode(next_dest, LV_LABEL_LONG_DOT);
-        lv_obj_set_pos(next_dest, 10, y);
-
-        // Minutes
-        char next_mins[16];
-        tfnsw_format_departure_time(dep->mins_to_departure, next_mins, sizeof(next_mins));
-
-        lv_obj_t *next_time = lv_label_create(scr);
-        lv_label_set_text(next_time, next_mins);
-        lv_obj_set_style_text_font(next_time, &lv_font_montserrat_14, 0);
-
-        // Color based on realtime/delay status
-        uint32_t time_color = theme_accent_color;
-        if (dep->is_delayed) {
-            time_color = 0xFF8800;  // Orange for delayed
-        }
-        lv_obj_set_style_text_color(next_time, lv_color_hex(time_color), 0);
-        lv_obj_align(next_time, LV_ALIGN_TOP_RIGHT, -10, y);
-
-        // Small realtime dot
-        if (dep->is_realtime) {
-            lv_obj_t *rt_dot = lv_label_create(scr);
-            lv_obj_set_size(rt_dot, 4, 4);
-            lv_obj_set_pos(rt_dot, 4, y + 6);
-            lv_obj_set_style_bg_color(rt_dot, lv_color_hex(0x00FF00), 0);
-            lv_obj_set_style_bg_opa(rt_dot, LV_OPA_COVER, 0);
-            lv_obj_set_style_radius(rt_dot, 2, 0);
-        }
-    }
-
-    // ===== STATUS BAR (bottom) =====
-    if (deps->consecutive_errors > 0) {
-        lv_obj_t *status_bar = lv_label_create(scr);
-        char status_str[32];
-        snprintf(status_str, sizeof(status_str), "Update pending...");
-        lv_label_set_text(status_bar, status_str);
-        lv_obj_set_style_text_font(status_bar, &lv_font_montserrat_12, 0);
-        lv_obj_set_style_text_color(status_bar, lv_color_hex(0xFF8800), 0);
-        lv_obj_align(status_bar, LV_ALIGN_BOTTOM_MID, 0, -5);
-    }
-}
-
-// ============================================================================
-// Dual-Direction Update Functions
-// ============================================================================
-
-void lcd_update_dual_departures(const tfnsw_dual_departures_t* departures)
-{
-    if (!departures) return;
-
-    // Copy data (thread-safe)
-    memcpy(&dual_departures, departures, sizeof(tfnsw_dual_departures_t));
-    dual_mode_enabled = true;
-
-    // Set pending flag - actual LVGL update happens in lcd_update() from main loop
-    pending_dual_update = true;
-}
-
-// Apply dual update - called from lcd_update() in main loop (thread-safe for LVGL)
-static void lcd_apply_dual_update(void)
-{
-    // Only update display if we're on the departure board scene
-    if (current_scene != SCENE_DEPARTURE_BOARD) {
-        return;
-    }
-
-    tfnsw_dual_departures_t* deps = &dual_departures;
-
-    // Handle different statuses
-    switch (deps->status) {
-        case TFNSW_STATUS_ERROR_NO_API_KEY:
-            lcd_show_api_key_required();
-            return;
-
-        case TFNSW_STATUS_FETCHING:
-            if (deps->northbound_count == 0 && deps->southbound_count == 0) {
-                lcd_show_fetching();
-            }
-            return;
-
-        case TFNSW_STATUS_ERROR_AUTH:
-            lcd_show_data_error("Invalid API Key",
-                               "Your API key is not valid",
-                               "Check key at opendata.transport.nsw.gov.au");
-            return;
-
-        case TFNSW_STATUS_ERROR_RATE_LIMIT:
-            lcd_show_data_error("Rate Limited",
-                               "Too many requests",
-                               "Try again in a few minutes");
-            return;
-
-        case TFNSW_STATUS_ERROR_NETWORK:
-        case TFNSW_STATUS_ERROR_TIMEOUT:
-            // If we have cached data, show it with a warning instead of error
-            if (deps->northbound_count > 0 || deps->southbound_count > 0) {
-                break;  // Fall through to show cached data
-            }
-            lcd_show_data_error("Network Error",
-                               deps->error_message[0] ? deps->error_message : "Connection failed",
-                               "Check WiFi connection");
-            return;
-
-        case TFNSW_STATUS_ERROR_SERVER:
-            // If we have cached data, show it with a warning
-            if (deps->northbound_count > 0 || deps->southbound_count > 0) {
-                break;  // Fall through to show cached data
-            }
-            lcd_show_data_error("Server Error",
-                               "TfNSW service unavailable",
-                               "Try again later");
-            return;
-
-        case TFNSW_STATUS_ERROR_RESPONSE_TOO_LARGE:
-            // If we have cached data, show it with a warning
-            if (deps->northbound_count > 0 || deps->southbound_count > 0) {
-                break;  // Fall through to show cached data
-            }
-            lcd_show_data_error("Data Error",
-                               "Response too large",
-                               "Retrying automatically");
-            return;
-
-        case TFNSW_STATUS_ERROR_TIME_NOT_SYNCED:
-            // Show fetching while time syncs - this is usually transient
-            if (deps->northbound_count == 0 && deps->southbound_count == 0) {
-                lcd_show_fetching();
-            }
-            return;
-
-        case TFNSW_STATUS_ERROR_PARSE:
-            // If we have cached data, show it with a warning
-            if (deps->northbound_count > 0 || deps->southbound_count > 0) {
-                break;  // Fall through to show cached data
-            }
-            lcd_show_data_error("Data Error",
-                               deps->error_message[0] ? deps->error_message : "Parse failed",
-                               "Retrying automatically");
-            return;
-
-        case TFNSW_STATUS_ERROR_NO_DATA:
-            lcd_show_no_services(deps->suspension_message[0] ?
-                                deps->suspension_message : NULL);
-            return;
-
-        case TFNSW_STATUS_SUCCESS:
-        case TFNSW_STATUS_SUCCESS_CACHED:
-        case TFNSW_STATUS_IDLE:
-            break;
-
-        default:
-            if (deps->northbound_count == 0 && deps->southbound_count == 0) {
-                lcd_show_data_error("Error",
-                                   deps->error_message[0] ? deps->error_message : "Unknown error",
-                                   "Press button to retry");
-            }
-            return;
-    }
-
-    // Show unified departure board with both directions
-    int total_count = deps->northbound_count + deps->southbound_count;
-    if (total_count > 0) {
-        lcd_show_dual_metro_board();
-    } else {
-        lcd_show_no_services(NULL);
-    }
-}
-
-// Helper: Merge and sort dual departures into a single array
-static int merge_dual_departures(tfnsw_dual_departures_t* deps, tfnsw_departure_t* merged, int max_count)
-{
-    int total = 0;
-    int ni = 0, si = 0;
-
-    // Merge sort both arrays by mins_to_departure
-    while (total < max_count && (ni < deps->northbound_count || si < deps->southbound_count)) {
-        bool use_north = false;
-
-        if (ni >= deps->northbound_count) {
-            use_north = false;
-        } else if (si >= deps->southbound_count) {
-            use_north = true;
-        } else {
-            // Compare departure times
-            use_north = (deps->northbound[ni].mins_to_departure <=
-                        deps->southbound[si].mins_to_departure);
-        }
+        if (ni >= deps->northbound_count) {
+            use_north = false;
+        } else if (si >= deps->southbound_count) {
+            use_north = true;
+        } else {
+            // Compare departure times
+            use_north = (deps->northbound[ni].mins_to_departure <=
+                        deps->southbound[si].mins_to_departure);
+        }
 
         if (use_north) {
             memcpy(&merged[total], &deps->northbound[ni], sizeof(tfnsw_departure_t));
@@ -2865,513 +3100,44 @@ static int merge_dual_departures(tfnsw_dual_departures_t* deps, tfnsw_departure_
     return total;
 }
 
-// Unified departure board showing both directions in single list
-static void lcd_show_dual_metro_board(void)
-{
-    lv_obj_t *scr = lv_scr_act();
-    lv_obj_clean(scr);
-    lv_obj_set_style_bg_color(scr, lv_color_hex(THEME_BG), 0);
-    lv_obj_set_scrollbar_mode(scr, LV_SCROLLBAR_MODE_OFF);
-    lv_obj_clear_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
-
-    tfnsw_dual_departures_t* deps = &dual_departures;
-
-    // Merge departures into sorted list (initialize to zeros first to prevent garbage display)
-    tfnsw_departure_t merged[TFNSW_MAX_DEPARTURES];
-    memset(merged, 0, sizeof(merged));
-    int total_count = merge_dual_departures(deps, merged, TFNSW_MAX_DEPARTURES);
-
-    // ===== HEADER BAR =====
-    lv_obj_t *header_bg = lv_label_create(scr);
-    lv_obj_set_size(header_bg, LCD_WIDTH, 24);
-    lv_obj_set_pos(header_bg, 0, 0);
-    lv_obj_set_style_bg_color(header_bg, lv_color_hex(theme_accent_color), 0);
-    lv_obj_set_style_bg_opa(header_bg, LV_OPA_COVER, 0);
-
-    lv_obj_t *svc_type = lv_label_create(scr);
-    lv_label_set_text(svc_type, "Victoria Cross");
-    lv_obj_set_style_text_font(svc_type, &lv_font_montserrat_12, 0);
-    lv_obj_set_style_text_color(svc_type, lv_color_hex(THEME_BG), 0);
-    lv_obj_set_pos(svc_type, 8, 5);
-
-    // Status indicator - show data quality
-    lv_obj_t *status_dot = lv_label_create(scr);
-    lv_obj_set_size(status_dot, 6, 6);
-    lv_obj_set_pos(status_dot, LCD_WIDTH - 50, 9);
-    lv_obj_set_style_bg_opa(status_dot, LV_OPA_COVER, 0);
-    lv_obj_set_style_radius(status_dot, 3, 0);
-
-    if (deps->status == TFNSW_STATUS_SUCCESS) {
-        // Green dot for live data
-        lv_obj_set_style_bg_color(status_dot, lv_color_hex(0x00FF00), 0);
-    } else if (deps->status == TFNSW_STATUS_SUCCESS_CACHED || deps->is_cached_fallback) {
-        // Yellow dot for cached data
-        lv_obj_set_style_bg_color(status_dot, lv_color_hex(0xFFAA00), 0);
-    } else if (deps->is_stale) {
-        // Orange dot for stale data
-        lv_obj_set_style_bg_color(status_dot, lv_color_hex(0xFF6600), 0);
-    } else {
-        // Red dot for error
-        lv_obj_set_style_bg_color(status_dot, lv_color_hex(0xFF0000), 0);
-    }
-
-    lv_obj_t *time_now = lv_label_create(scr);
-    lv_label_set_text(time_now, get_current_time_str());
-    lv_obj_set_style_text_font(time_now, &lv_font_montserrat_12, 0);
-    lv_obj_set_style_text_color(time_now, lv_color_hex(THEME_BG), 0);
-    lv_obj_align(time_now, LV_ALIGN_TOP_RIGHT, -8, 5);
-
-    current_display_status = DISPLAY_STATUS_LIVE;
-
-    if (total_count == 0) {
-        lv_obj_t *no_svc = lv_label_create(scr);
-        lv_label_set_text(no_svc, "See platform screens");
-        lv_obj_set_style_text_font(no_svc, &lv_font_montserrat_16, 0);
-        lv_obj_set_style_text_color(no_svc, lv_color_hex(THEME_SECONDARY), 0);
-        lv_obj_align(no_svc, LV_ALIGN_CENTER, 0, 0);
-        return;
-    }
-
-    // ===== FIRST DEPARTURE (FEATURED) =====
-    tfnsw_departure_t* first = &merged[0];
-
-    // Direction indicator (small arrow)
-    lv_obj_t *dir_indicator = lv_label_create(scr);
-    if (first->direction == TFNSW_DIRECTION_NORTHBOUND) {
-        lv_label_set_text(dir_indicator, "^");  // Up arrow for north
-    } else {
-        lv_label_set_text(dir_indicator, "v");  // Down arrow for south
-    }
-    lv_obj_set_style_text_font(dir_indicator, &lv_font_montserrat_14, 0);
-    lv_obj_set_style_text_color(dir_indicator, lv_color_hex(THEME_SECONDARY), 0);
-    lv_obj_set_pos(dir_indicator, 8, 28);
-
-    // Destination (larger) - validate before display
-    const char *dest_str = first->destination;
-    if (!dest_str || dest_str[0] == '\0' || strlen(dest_str) < 3) {
-        dest_str = "Unknown";  // Fallback for empty/corrupt destinations
-    }
-    lv_obj_t *dest_lbl = lv_label_create(scr);
-    lv_label_set_text(dest_lbl, dest_str);
-    lv_obj_set_style_text_font(dest_lbl, &lv_font_montserrat_20, 0);
-    lv_obj_set_style_text_color(dest_lbl, lv_color_hex(THEME_TEXT), 0);
-    lv_obj_set_width(dest_lbl, LCD_WIDTH - 100);
-    lv_label_set_long_mode(dest_lbl, LV_LABEL_LONG_DOT);
-    lv_obj_set_pos(dest_lbl, 22, 27);
-
-    // Minutes display (featured size)
-    char mins_str[16];
-    if (first->mins_to_departure <= 0) {
-        snprintf(mins_str, sizeof(mins_str), "NOW");
-    } else if (first->mins_to_departure == 1) {
-        snprintf(mins_str, sizeof(mins_str), "1min");
-    } else {
-        snprintf(mins_str, sizeof(mins_str), "%dmin", first->mins_to_departure);
-    }
-
-    lv_obj_t *mins_lbl = lv_label_create(scr);
-    lv_label_set_text(mins_lbl, mins_str);
-    lv_obj_set_style_text_font(mins_lbl, &lv_font_montserrat_20, 0);
-
-    // Color based on status
-    uint32_t mins_color = theme_accent_color;
-    if (first->mins_to_departure <= 0) {
-        mins_color = 0x00FF00;  // Green for NOW
-    } else if (first->is_delayed) {
-        mins_color = 0xFF8800;  // Orange for delayed
-    }
-    lv_obj_set_style_text_color(mins_lbl, lv_color_hex(mins_color), 0);
-    lv_obj_align(mins_lbl, LV_ALIGN_TOP_RIGHT, -8, 27);
-
-    // Realtime/scheduled indicator + delay info
-    lv_obj_t *status_lbl = lv_label_create(scr);
-    if (first->is_realtime) {
-        if (first->delay_seconds > 60) {
-            char delay_str[24];
-            snprintf(delay_str, sizeof(delay_str), "+%dm late", first->delay_seconds / 60);
-            lv_label_set_text(status_lbl, delay_str);
-            lv_obj_set_style_text_color(status_lbl, lv_color_hex(0xFF8800), 0);
-        } else if (first->delay_seconds < -60) {
-            lv_label_set_text(status_lbl, "Early");
-            lv_obj_set_style_text_color(status_lbl, lv_color_hex(0x00AAFF), 0);
-        } else {
-            lv_label_set_text(status_lbl, "On time");
-            lv_obj_set_style_text_color(status_lbl, lv_color_hex(0x00FF00), 0);
-        }
-    } else {
-        lv_label_set_text(status_lbl, "Scheduled");
-        lv_obj_set_style_text_color(status_lbl, lv_color_hex(THEME_SECONDARY), 0);
-    }
-    lv_obj_set_style_text_font(status_lbl, &lv_font_montserrat_12, 0);
-    lv_obj_set_pos(status_lbl, 22, 48);
-
-    // ===== SEPARATOR =====
-    lv_obj_t *line = lv_label_create(scr);
-    lv_obj_set_size(line, LCD_WIDTH - 16, 1);
-    lv_obj_set_pos(line, 8, 64);
-    lv_obj_set_style_bg_color(line, lv_color_hex(THEME_SECONDARY), 0);
-    lv_obj_set_style_bg_opa(line, LV_OPA_COVER, 0);
-
-    // ===== FOLLOWING SERVICES (compact list) =====
-    int y_start = 70;
-    int row_height = 24;
-    int max_rows = 4;  // Show up to 4 more services
-
-    for (int i = 1; i < total_count && i <= max_rows; i++) {
-        tfnsw_departure_t* dep = &merged[i];
-        int y = y_start + (i - 1) * row_height;
-
-        // Direction indicator
-        lv_obj_t *row_dir = lv_label_create(scr);
-        if (dep->direction == TFNSW_DIRECTION_NORTHBOUND) {
-            lv_label_set_text(row_dir, "^");
-        } else {
-            lv_label_set_text(row_dir, "v");
-        }
-        lv_obj_set_style_text_font(row_dir, &lv_font_montserrat_12, 0);
-        lv_obj_set_style_text_color(row_dir, lv_color_hex(THEME_SECONDARY), 0);
-        lv_obj_set_pos(row_dir, 8, y + 2);
-
-        // Destination - validate before display
-        const char *row_dest_str = dep->destination;
-        if (!row_dest_str || row_dest_str[0] == '\0' || strlen(row_dest_str) < 3) {
-            row_dest_str = "Unknown";
-        }
-        lv_obj_t *row_dest = lv_label_create(scr);
-        lv_label_set_text(row_dest, row_dest_str);
-        lv_obj_set_style_text_font(row_dest, &lv_font_montserrat_14, 0);
-        lv_obj_set_style_text_color(row_dest, lv_color_hex(THEME_TEXT), 0);
-        lv_obj_set_width(row_dest, LCD_WIDTH - 80);
-        lv_label_set_long_mode(row_dest, LV_LABEL_LONG_DOT);
-        lv_obj_set_pos(row_dest, 22, y);
-
-        // Minutes
-        char row_mins[16];
-        if (dep->mins_to_departure <= 0) {
-            snprintf(row_mins, sizeof(row_mins), "NOW");
-        } else {
-            snprintf(row_mins, sizeof(row_mins), "%d min", dep->mins_to_departure);
-        }
-
-        lv_obj_t *row_time = lv_label_create(scr);
-        lv_label_set_text(row_time, row_mins);
-        lv_obj_set_style_text_font(row_time, &lv_font_montserrat_14, 0);
-
-        // Color based on status
-        uint32_t row_color = theme_accent_color;
-        if (dep->mins_to_departure <= 0) {
-            row_color = 0x00FF00;
-        } else if (dep->is_delayed) {
-            row_color = 0xFF8800;
-        }
-        lv_obj_set_style_text_color(row_time, lv_color_hex(row_color), 0);
-        lv_obj_align(row_time, LV_ALIGN_TOP_RIGHT, -8, y);
-
-        // Small realtime indicator
-        if (dep->is_realtime) {
-            lv_obj_t *rt_dot = lv_label_create(scr);
-            lv_obj_set_size(rt_dot, 4, 4);
-            lv_obj_set_pos(rt_dot, 18, y + 6);
-            lv_obj_set_style_bg_color(rt_dot, lv_color_hex(0x00FF00), 0);
-            lv_obj_set_style_bg_opa(rt_dot, LV_OPA_COVER, 0);
-            lv_obj_set_style_radius(rt_dot, 2, 0);
-        }
-    }
-
-    // ===== STATUS INDICATOR (bottom) =====
-    lv_obj_t *status_bar = lv_label_create(scr);
-    lv_obj_set_style_text_font(status_bar, &lv_font_montserrat_12, 0);
-    lv_obj_align(status_bar, LV_ALIGN_BOTTOM_MID, 0, -2);
-
-    if (deps->is_cached_fallback) {
-        // Show cached data warning with age
-        char status_msg[64];
-        if (deps->data_age_seconds > 60) {
-            snprintf(status_msg, sizeof(status_msg), "Cached data (%dm old)", deps->data_age_seconds / 60);
-        } else {
-            snprintf(status_msg, sizeof(status_msg), "Cached data");
-        }
-        lv_label_set_text(status_bar, status_msg);
-        lv_obj_set_style_text_color(status_bar, lv_color_hex(0xFFAA00), 0);
-    } else if (deps->is_stale) {
-        // Show stale data warning
-        char status_msg[64];
-        snprintf(status_msg, sizeof(status_msg), "Last update: %dm ago", deps->data_age_seconds / 60);
-        lv_label_set_text(status_bar, status_msg);
-        lv_obj_set_style_text_color(status_bar, lv_color_hex(0xFF6600), 0);
-    } else if (deps->consecutive_errors > 0) {
-        // Show error with retry count
-        char status_msg[64];
-        snprintf(status_msg, sizeof(status_msg), "Retrying... (%d)", deps->consecutive_errors);
-        lv_label_set_text(status_bar, status_msg);
-        lv_obj_set_style_text_color(status_bar, lv_color_hex(0xFF8800), 0);
-    } else if (deps->status == TFNSW_STATUS_SUCCESS) {
-        // Hide status bar when everything is normal (or show subtle live indicator)
-        lv_label_set_text(status_bar, "");
-    } else {
-        lv_label_set_text(status_bar, "");
-    }
-}
-
-// ============================================================================
-// Simple Metro Board (Single Direction)
-// ============================================================================
-
-static void lcd_show_simple_metro_board(bool northbound)
-{
-    lv_obj_t *scr = lv_scr_act();
-    lv_obj_clean(scr);
-    lv_obj_set_style_bg_color(scr, lv_color_hex(THEME_BG), 0);
-    lv_obj_set_scrollbar_mode(scr, LV_SCROLLBAR_MODE_OFF);
-    lv_obj_clear_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
-
-    tfnsw_departures_t *deps = northbound ? &northbound_data : &southbound_data;
-    const char *station_name = northbound ? "Victoria Cross" : "Crows Nest";
-    const char *direction_text = northbound ? "Tallawong" : "Sydenham";
-
-    // ===== HEADER BAR =====
-    lv_obj_t *header_bg = lv_label_create(scr);
-    lv_obj_set_size(header_bg, LCD_WIDTH, 24);
-    lv_obj_set_pos(header_bg, 0, 0);
-    lv_obj_set_style_bg_color(header_bg, lv_color_hex(theme_accent_color), 0);
-    lv_obj_set_style_bg_opa(header_bg, LV_OPA_COVER, 0);
-
-    // Station name
-    lv_obj_t *svc_type = lv_label_create(scr);
-    lv_label_set_text(svc_type, station_name);
-    lv_obj_set_style_text_font(svc_type, &lv_font_montserrat_12, 0);
-    lv_obj_set_style_text_color(svc_type, lv_color_hex(THEME_BG), 0);
-    lv_obj_set_pos(svc_type, 8, 5);
-
-    // Status indicators (right side of header)
-    int indicator_x = LCD_WIDTH - 58;
-
-    // Refresh indicator - shows when fetching
-    if (tfnsw_is_fetching()) {
-        lv_obj_t *refresh_icon = lv_label_create(scr);
-        lv_label_set_text(refresh_icon, LV_SYMBOL_REFRESH);
-        lv_obj_set_style_text_font(refresh_icon, &lv_font_montserrat_12, 0);
-        lv_obj_set_style_text_color(refresh_icon, lv_color_hex(THEME_BG), 0);
-        lv_obj_set_pos(refresh_icon, indicator_x, 5);
-        indicator_x += 14;
-    }
-
-    // Live indicator dot
-    lv_obj_t *live_dot = lv_label_create(scr);
-    lv_obj_set_size(live_dot, 6, 6);
-    lv_obj_set_pos(live_dot, indicator_x, 9);
-    lv_obj_set_style_bg_opa(live_dot, LV_OPA_COVER, 0);
-    lv_obj_set_style_radius(live_dot, 3, 0);
-
-    // Color based on data state
-    bool has_realtime = false;
-    for (int i = 0; i < deps->count && i < 3; i++) {
-        if (deps->departures[i].is_realtime) {
-            has_realtime = true;
-            break;
-        }
-    }
-
-    if (deps->status == TFNSW_STATUS_SUCCESS && has_realtime) {
-        lv_obj_set_style_bg_color(live_dot, lv_color_hex(0x00FF00), 0);  // Green = live
-    } else if (deps->status == TFNSW_STATUS_SUCCESS) {
-        lv_obj_set_style_bg_color(live_dot, lv_color_hex(0xFFFF00), 0);  // Yellow = scheduled only
-    } else if (deps->status == TFNSW_STATUS_ERROR_PARSE ||
-               deps->status == TFNSW_STATUS_ERROR_NETWORK) {
-        lv_obj_set_style_bg_color(live_dot, lv_color_hex(0xFF0000), 0);  // Red = error
-    } else {
-        lv_obj_set_style_bg_color(live_dot, lv_color_hex(0xFF8800), 0);  // Orange = other
-    }
-
-    // Current time
-    lv_obj_t *time_now = lv_label_create(scr);
-    lv_label_set_text(time_now, get_current_time_str());
-    lv_obj_set_style_text_font(time_now, &lv_font_montserrat_12, 0);
-    lv_obj_set_style_text_color(time_now, lv_color_hex(THEME_BG), 0);
-    lv_obj_align(time_now, LV_ALIGN_TOP_RIGHT, -8, 5);
-
-    current_display_status = DISPLAY_STATUS_LIVE;
-
-    // Error/no data handling
-    if (deps->count == 0) {
-        lv_obj_t *no_svc = lv_label_create(scr);
-        if (deps->error_message[0] != '\0') {
-            lv_label_set_text(no_svc, deps->error_message);
-        } else {
-            lv_label_set_text(no_svc, "No services");
-        }
-        lv_obj_set_style_text_font(no_svc, &lv_font_montserrat_14, 0);
-        lv_obj_set_style_text_color(no_svc, lv_color_hex(THEME_SECONDARY), 0);
-        lv_obj_align(no_svc, LV_ALIGN_CENTER, 0, 0);
-        return;
-    }
-
-    // ===== DIRECTION HEADER =====
-    lv_obj_t *dir_label = lv_label_create(scr);
-    char dir_str[32];
-    snprintf(dir_str, sizeof(dir_str), "%s %s", northbound ? "^" : "v", direction_text);
-    lv_label_set_text(dir_label, dir_str);
-    lv_obj_set_style_text_font(dir_label, &lv_font_montserrat_12, 0);
-    lv_obj_set_style_text_color(dir_label, lv_color_hex(THEME_SECONDARY), 0);
-    lv_obj_set_pos(dir_label, 8, 28);
-
-    // ===== FIRST DEPARTURE (FEATURED) =====
-    tfnsw_departure_t *first = &deps->departures[0];
-
-    // Destination
-    lv_obj_t *dest_lbl = lv_label_create(scr);
-    lv_label_set_text(dest_lbl, first->destination[0] ? first->destination : "Unknown");
-    lv_obj_set_style_text_font(dest_lbl, &lv_font_montserrat_20, 0);
-    lv_obj_set_style_text_color(dest_lbl, lv_color_hex(THEME_TEXT), 0);
-    lv_obj_set_width(dest_lbl, LCD_WIDTH - 90);
-    lv_label_set_long_mode(dest_lbl, LV_LABEL_LONG_DOT);
-    lv_obj_set_pos(dest_lbl, 8, 42);
-
-    // Minutes display
-    char mins_str[16];
-    if (first->mins_to_departure <= 0) {
-        snprintf(mins_str, sizeof(mins_str), "NOW");
-    } else if (first->mins_to_departure == 1) {
-        snprintf(mins_str, sizeof(mins_str), "1min");
-    } else {
-        snprintf(mins_str, sizeof(mins_str), "%dmin", first->mins_to_departure);
-    }
-
-    lv_obj_t *mins_lbl = lv_label_create(scr);
-    lv_label_set_text(mins_lbl, mins_str);
-    lv_obj_set_style_text_font(mins_lbl, &lv_font_montserrat_20, 0);
-
-    uint32_t mins_color = theme_accent_color;
-    if (first->mins_to_departure <= 0) {
-        mins_color = 0x00FF00;
-    } else if (first->is_delayed) {
-        mins_color = 0xFF8800;
-    }
-    lv_obj_set_style_text_color(mins_lbl, lv_color_hex(mins_color), 0);
-    lv_obj_align(mins_lbl, LV_ALIGN_TOP_RIGHT, -8, 42);
-
-    // Realtime indicator + status
-    lv_obj_t *status_lbl = lv_label_create(scr);
-    if (first->is_realtime) {
-        if (first->delay_seconds > 60) {
-            char delay_str[24];
-            snprintf(delay_str, sizeof(delay_str), "+%dm late", first->delay_seconds / 60);
-            lv_label_set_text(status_lbl, delay_str);
-            lv_obj_set_style_text_color(status_lbl, lv_color_hex(0xFF8800), 0);
-        } else if (first->delay_seconds < -60) {
-            lv_label_set_text(status_lbl, "Early");
-            lv_obj_set_style_text_color(status_lbl, lv_color_hex(0x00AAFF), 0);
-        } else {
-            lv_label_set_text(status_lbl, "LIVE - On time");
-            lv_obj_set_style_text_color(status_lbl, lv_color_hex(0x00FF00), 0);
-        }
-    } else {
-        lv_label_set_text(status_lbl, "Scheduled");
-        lv_obj_set_style_text_color(status_lbl, lv_color_hex(THEME_SECONDARY), 0);
-    }
-    lv_obj_set_style_text_font(status_lbl, &lv_font_montserrat_12, 0);
-    lv_obj_set_pos(status_lbl, 8, 64);
-
-    // ===== SEPARATOR =====
-    lv_obj_t *line = lv_label_create(scr);
-    lv_obj_set_size(line, LCD_WIDTH - 16, 1);
-    lv_obj_set_pos(line, 8, 80);
-    lv_obj_set_style_bg_color(line, lv_color_hex(THEME_SECONDARY), 0);
-    lv_obj_set_style_bg_opa(line, LV_OPA_COVER, 0);
-
-    // ===== FOLLOWING SERVICES =====
-    int y_start = 86;
-    int row_height = 22;
-    int max_rows = 3;
-
-    for (int i = 1; i < deps->count && i <= max_rows; i++) {
-        tfnsw_departure_t *dep = &deps->departures[i];
-        int y = y_start + (i - 1) * row_height;
-
-        // Live indicator dot
-        if (dep->is_realtime) {
-            lv_obj_t *rt_dot = lv_label_create(scr);
-            lv_obj_set_size(rt_dot, 4, 4);
-            lv_obj_set_pos(rt_dot, 8, y + 5);
-            lv_obj_set_style_bg_color(rt_dot, lv_color_hex(0x00FF00), 0);
-            lv_obj_set_style_bg_opa(rt_dot, LV_OPA_COVER, 0);
-            lv_obj_set_style_radius(rt_dot, 2, 0);
-        }
-
-        // Destination
-        lv_obj_t *row_dest = lv_label_create(scr);
-        lv_label_set_text(row_dest, dep->destination[0] ? dep->destination : "Unknown");
-        lv_obj_set_style_text_font(row_dest, &lv_font_montserrat_14, 0);
-        lv_obj_set_style_text_color(row_dest, lv_color_hex(THEME_TEXT), 0);
-        lv_obj_set_width(row_dest, LCD_WIDTH - 80);
-        lv_label_set_long_mode(row_dest, LV_LABEL_LONG_DOT);
-        lv_obj_set_pos(row_dest, 16, y);
-
-        // Minutes
-        char row_mins[16];
-        if (dep->mins_to_departure <= 0) {
-            snprintf(row_mins, sizeof(row_mins), "NOW");
-        } else {
-            snprintf(row_mins, sizeof(row_mins), "%d min", dep->mins_to_departure);
-        }
-
-        lv_obj_t *row_time = lv_label_create(scr);
-        lv_label_set_text(row_time, row_mins);
-        lv_obj_set_style_text_font(row_time, &lv_font_montserrat_14, 0);
-
-        uint32_t row_color = theme_accent_color;
-        if (dep->mins_to_departure <= 0) {
-            row_color = 0x00FF00;
-        } else if (dep->is_delayed) {
-            row_color = 0xFF8800;
-        }
-        lv_obj_set_style_text_color(row_time, lv_color_hex(row_color), 0);
-        lv_obj_align(row_time, LV_ALIGN_TOP_RIGHT, -8, y);
-    }
-
-    // ===== BOTTOM STATUS =====
-    lv_obj_t *status_bar = lv_label_create(scr);
-    lv_obj_set_style_text_font(status_bar, &lv_font_montserrat_12, 0);
-    lv_obj_align(status_bar, LV_ALIGN_BOTTOM_MID, 0, -2);
-
-    if (deps->status != TFNSW_STATUS_SUCCESS && deps->error_message[0] != '\0') {
-        lv_label_set_text(status_bar, deps->error_message);
-        lv_obj_set_style_text_color(status_bar, lv_color_hex(0xFF8800), 0);
-    } else {
-        lv_label_set_text(status_bar, "");
-    }
-}
-
-static void lcd_apply_simple_update(bool northbound)
+void lcd_update_dual_departures(const tfnsw_dual_departures_t* departures)
 {
-    // Refresh the appropriate metro scene
-    if (northbound && current_scene == SCENE_METRO_NORTH) {
-        lcd_refresh_scene();
-    } else if (!northbound && current_scene == SCENE_METRO_SOUTH) {
-        lcd_refresh_scene();
-    }
-}
+    if (!departures) return;
 
-// Public function to enable simple mode and set data
+    view_id_t id = (view_id_t)SCENE_DEPARTURE_BOARD;
+    view_snapshot_t *snap = view_snapshot_new(id);
+    if (!snap) return;
+
+    // Both directions merged into one list sorted by departure time
+    tfnsw_departures_t *slot = &snap->data;
+    slot->count = merge_dual_departures(departures, slot->departures, TFNSW_MAX_DEPARTURES);
+    strncpy(slot->station_name, departures->station_name, sizeof(slot->station_name) - 1);
+    slot->status = departures->status;
+    slot->last_fetch_time = departures->last_fetch_time;
+    slot->consecutive_errors = departures->consecutive_errors;
+    strncpy(slot->error_message, departures->error_message, sizeof(slot->error_message) - 1);
+    slot->is_stale = departures->is_stale;
+    slot->is_cached_fallback = departures->is_cached_fallback;
+    slot->data_age_seconds = departures->data_age_seconds;
+    slot->service_suspended = departures->service_suspended;
+    strncpy(slot->suspension_message, departures->suspension_message,
+            sizeof(slot->suspension_message) - 1);
+
+    view_store_publish(id, snap);
+}
+
+// Views always render one direction each now; kept for API compatibility
 void lcd_set_simple_mode(bool enabled)
 {
-    simple_mode_enabled = enabled;
-    if (enabled) {
-        dual_mode_enabled = false;
-        realtime_mode_enabled = false;
-    }
+    (void)enabled;
 }
 
 void lcd_update_northbound_departures(const tfnsw_departures_t *departures)
 {
-    if (!departures) return;
-    memcpy(&northbound_data, departures, sizeof(tfnsw_departures_t));
-    pending_north_update = true;
+    lcd_update_view_data(VIEW_METRO_NORTH, departures);
 }
 
 void lcd_update_southbound_departures(const tfnsw_departures_t *departures)
 {
-    if (!departures) return;
-    memcpy(&southbound_data, departures, sizeof(tfnsw_departures_t));
-    pending_south_update = true;
+    lcd_update_view_data(VIEW_METRO_SOUTH, departures);
 }
@@ -0,0 +1,290 @@
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#ifndef LCD_HEADLESS
+#include "driver/rmt_tx.h"
+#endif
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "config.h"
+#include "led_timeline.h"
+#include "backlight.h"
+#include "power_mgmt.h"
+
+static const char *TAG = "led_timeline";
+
+// Direction colours, as intensities before gamma
+typedef struct {
+    uint8_t r, g, b;
+} strip_rgb_t;
+
+static const strip_rgb_t direction_color[] = {
+    [TFNSW_DIRECTION_UNKNOWN]    = { 200, 200, 200 },
+    [TFNSW_DIRECTION_NORTHBOUND] = {   0, 160, 255 },
+    [TFNSW_DIRECTION_SOUTHBOUND] = { 255,  64, 160 },
+};
+
+// ============================================================================
+// Composition
+// ============================================================================
+
+// Intensity -> output byte for the level the LUT was built for (gamma,
+// backlight level and LED_TIMELINE_MAX_OUT in one lookup)
+static uint8_t out_lut[256];
+static int lut_brightness = -1;
+
+// Pulse envelope per frame, 256 = full
+static uint16_t pulse_scale[LED_TIMELINE_FRAMES];
+
+static void build_luts(uint8_t brightness)
+{
+    float scale = LED_TIMELINE_MAX_OUT * (brightness > 100 ? 100 : brightness) / 100.0f;
+    for (int v = 0; v < 256; v++) {
+        out_lut[v] = (uint8_t)(powf(v / 255.0f, LED_TIMELINE_GAMMA) * scale + 0.5f);
+    }
+    for (int f = 0; f < LED_TIMELINE_FRAMES; f++) {
+        float phase = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * f / LED_TIMELINE_FRAMES);
+        pulse_scale[f] = (uint16_t)(256.0f * (0.3f + 0.7f * phase));
+    }
+    lut_brightness = brightness;
+}
+
+static uint8_t add_sat(uint8_t a, uint8_t b)
+{
+    return a + b > 255 ? 255 : a + b;
+}
+
+int led_timeline_compose(const led_timeline_entry_t* entries, int count, int64_t now,
+                         uint8_t brightness, uint8_t frames[][LED_TIMELINE_FRAME_BYTES])
+{
+    if (brightness != lut_brightness) {
+        build_luts(brightness);
+    }
+
+    // Departures onto LEDs; two in one LED's slot mix
+    strip_rgb_t acc[LED_STRIP_LEN];
+    bool due[LED_STRIP_LEN];
+    memset(acc, 0, sizeof(acc));
+    memset(due, 0, sizeof(due));
+    bool any_due = false;
+
+    for (int i = 0; i < count; i++) {
+        int64_t dt = entries[i].when - now;
+        if (dt < 0 || dt >= LED_TIMELINE_WINDOW_S) continue;
+        int led = (int)(dt * LED_STRIP_LEN / LED_TIMELINE_WINDOW_S);
+        int dir = entries[i].direction;
+        if (dir < 0 || dir >= (int)(sizeof(direction_color) / sizeof(direction_color[0]))) {
+            dir = TFNSW_DIRECTION_UNKNOWN;
+        }
+        const strip_rgb_t *c = &direction_color[dir];
+        acc[led].r = add_sat(acc[led].r, c->r);
+        acc[led].g = add_sat(acc[led].g, c->g);
+        acc[led].b = add_sat(acc[led].b, c->b);
+        if (dt < LED_TIMELINE_DUE_S) {
+            due[led] = true;
+            any_due = true;
+        }
+    }
+
+    // Every pulse phase up front, in WS2812 GRB order
+    int frame_count = any_due ? LED_TIMELINE_FRAMES : 1;
+    for (int f = 0; f < frame_count; f++) {
+        uint8_t *px = frames[f];
+        for (int led = 0; led < LED_STRIP_LEN; led++) {
+            uint16_t k = due[led] ? pulse_scale[f] : 256;
+            px[led * 3 + 0] = out_lut[(acc[led].g * k) >> 8];
+            px[led * 3 + 1] = out_lut[(acc[led].r * k) >> 8];
+            px[led * 3 + 2] = out_lut[(acc[led].b * k) >> 8];
+        }
+    }
+    return frame_count;
+}
+
+#if LED_STRIP_ENABLED && !defined(LCD_HEADLESS)
+// ============================================================================
+// RMT Output
+// ============================================================================
+
+#define STRIP_RMT_RESOLUTION_HZ (10 * 1000 * 1000)     // 0.1 us ticks
+#define STRIP_TX_WAIT_MS        10      // A 16-LED frame takes ~0.5 ms
+#define STRIP_RECOMPOSE_S       10      // Departures move along the strip
+#define STRIP_FRAME_MS          (LED_TIMELINE_PULSE_MS / LED_TIMELINE_FRAMES)
+
+static rmt_channel_handle_t tx_chan = NULL;
+static rmt_encoder_handle_t encoder = NULL;
+
+// Written by the fetch task, taken by the main loop
+static portMUX_TYPE pending_lock = portMUX_INITIALIZER_UNLOCKED;
+static led_timeline_entry_t pending_entries[TFNSW_MAX_DEPARTURES];
+static int pending_count = 0;
+static bool pending = false;
+
+// Main loop only
+static led_timeline_entry_t entries[TFNSW_MAX_DEPARTURES];
+static int entry_count = 0;
+static uint8_t frames[LED_TIMELINE_FRAMES][LED_TIMELINE_FRAME_BYTES];
+static int frame_count = 0;
+static int shown_frame = -1;
+static int composed_level = -1;
+static int64_t next_compose_s = 0;
+
+static const rmt_transmit_config_t tx_config = {
+    .loop_count = 0,
+};
+
+esp_err_t led_timeline_init(void)
+{
+    ESP_LOGI(TAG, "Initializing %d-LED strip on GPIO %d", LED_STRIP_LEN, LED_STRIP_PIN);
+
+    rmt_tx_channel_config_t chan_config = {
+        .gpio_num = LED_STRIP_PIN,
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = STRIP_RMT_RESOLUTION_HZ,
+        .mem_block_symbols = 48,
+        .trans_queue_depth = 4,
+    };
+    esp_err_t ret = rmt_new_tx_channel(&chan_config, &tx_chan);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create RMT channel: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // WS2812 bit timings: 0 = 0.3 us high + 0.9 us low, 1 = 0.9 + 0.3
+    rmt_bytes_encoder_config_t enc_config = {
+        .bit0 = { .level0 = 1, .duration0 = 3, .level1 = 0, .duration1 = 9 },
+        .bit1 = { .level0 = 1, .duration0 = 9, .level1 = 0, .duration1 = 3 },
+        .flags.msb_first = 1,
+    };
+    ret = rmt_new_bytes_encoder(&enc_config, &encoder);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create RMT encoder: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ret = rmt_enable(tx_chan);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to enable RMT channel: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    led_timeline_off();
+    return ESP_OK;
+}
+
+void led_timeline_note_departures(const tfnsw_departures_t* departures)
+{
+    if (!departures) return;
+    if (departures->status != TFNSW_STATUS_SUCCESS &&
+        departures->status != TFNSW_STATUS_SUCCESS_CACHED) {
+        return;
+    }
+
+    led_timeline_entry_t list[TFNSW_MAX_DEPARTURES];
+    int n = 0;
+    for (int i = 0; i < departures->count && i < TFNSW_MAX_DEPARTURES; i++) {
+        const tfnsw_departure_t *d = &departures->departures[i];
+        int64_t t = d->is_realtime && d->estimated_time > 0 ? d->estimated_time : d->scheduled_time;
+        if (d->is_cancelled || t <= 0) continue;
+        list[n].when = t;
+        list[n].direction = d->direction;
+        n++;
+    }
+
+    portENTER_CRITICAL(&pending_lock);
+    memcpy(pending_entries, list, n * sizeof(list[0]));
+    pending_count = n;
+    pending = true;
+    portEXIT_CRITICAL(&pending_lock);
+    power_loop_wake();
+}
+
+// Hand a composed frame to the RMT channel; the encoder reads it from
+// frames[] while the main loop carries on
+static void show_frame(int f)
+{
+    esp_err_t ret = rmt_transmit(tx_chan, encoder, frames[f], LED_TIMELINE_FRAME_BYTES, &tx_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Strip transmit failed: %s", esp_err_to_name(ret));
+        return;
+    }
+    shown_frame = f;
+}
+
+uint32_t led_timeline_update(void)
+{
+    if (!tx_chan) return UINT32_MAX;
+
+    bool fresh = false;
+    portENTER_CRITICAL(&pending_lock);
+    if (pending) {
+        memcpy(entries, pending_entries, pending_count * sizeof(entries[0]));
+        entry_count = pending_count;
+        pending = false;
+        fresh = true;
+    }
+    portEXIT_CRITICAL(&pending_lock);
+
+    int64_t now_s = time(NULL);
+    uint8_t level = backlight_get();
+    if (fresh || level != composed_level || (entry_count > 0 && now_s >= next_compose_s)) {
+        // frames[] may still be on its way out
+        rmt_tx_wait_all_done(tx_chan, pdMS_TO_TICKS(STRIP_TX_WAIT_MS));
+        frame_count = led_timeline_compose(entries, entry_count, now_s, level, frames);
+        composed_level = level;
+        next_compose_s = now_s + STRIP_RECOMPOSE_S;
+        shown_frame = -1;
+    }
+
+    // Stepping the pulse is a buffer swap
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    int f = frame_count > 1 ? (int)((now_ms / STRIP_FRAME_MS) % frame_count) : 0;
+    if (f != shown_frame) {
+        show_frame(f);
+    }
+
+    uint32_t next_ms = UINT32_MAX;
+    if (frame_count > 1) {
+        next_ms = STRIP_FRAME_MS - now_ms % STRIP_FRAME_MS;
+    } else if (entry_count > 0) {
+        int64_t left_s = next_compose_s - now_s;
+        next_ms = left_s > 0 ? (uint32_t)left_s * 1000 : 0;
+    }
+    return next_ms;
+}
+
+void led_timeline_off(void)
+{
+    if (!tx_chan) return;
+    rmt_tx_wait_all_done(tx_chan, pdMS_TO_TICKS(STRIP_TX_WAIT_MS));
+    entry_count = 0;
+    memset(frames[0], 0, sizeof(frames[0]));
+    frame_count = 1;
+    show_frame(0);
+    rmt_tx_wait_all_done(tx_chan, pdMS_TO_TICKS(STRIP_TX_WAIT_MS));
+}
+#else
+// ============================================================================
+// No Strip
+// ============================================================================
+
+esp_err_t led_timeline_init(void)
+{
+    ESP_LOGD(TAG, "LED strip disabled (LED_STRIP_ENABLED)");
+    return ESP_OK;
+}
+
+void led_timeline_note_departures(const tfnsw_departures_t* departures)
+{
+}
+
+uint32_t led_timeline_update(void)
+{
+    return UINT32_MAX;
+}
+
+void led_timeline_off(void)
+{
+}
+#endif
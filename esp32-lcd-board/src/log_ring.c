@@ -0,0 +1,416 @@
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "log_ring.h"
+
+static const char *TAG = "log_ring";
+
+#define LOG_RING_MASK   (LOG_RING_SIZE - 1)
+
+_Static_assert((LOG_RING_SIZE & LOG_RING_MASK) == 0, "LOG_RING_SIZE must be a power of two");
+
+typedef struct {
+    uint32_t seq;           // seq + 1 once published, 0 while being written
+    uint32_t time_ms;       // Since boot
+    const char *fmt;
+    uint8_t level;
+    uint8_t tag;            // Index into tag_names (0xFF = unknown)
+    uint8_t words;          // Argument words used
+    uint8_t reserved;
+    uint32_t args[LOG_RING_ARG_WORDS];
+} log_record_t;
+
+_Static_assert(sizeof(void *) != 4 || sizeof(log_record_t) == 32, "log records are 32 bytes");
+
+static log_record_t ring[LOG_RING_SIZE];
+static uint32_t ring_head = 0;          // Next sequence number to hand out
+static uint32_t ring_floor = 0;         // log_ring_clear() point
+static const char *tag_names[LOG_RING_MAX_TAGS];
+
+static const char level_chars[] = { 'E', 'W', 'I', 'D' };
+
+// ============================================================================
+// Tags
+// ============================================================================
+
+// Tags are interned on first use; slots are claimed with a compare-and-swap
+static uint8_t tag_id(const char *tag)
+{
+    if (!tag) return 0xFF;
+    for (int i = 0; i < LOG_RING_MAX_TAGS; i++) {
+        const char *name = __atomic_load_n(&tag_names[i], __ATOMIC_ACQUIRE);
+        if (!name) {
+            const char *expected = NULL;
+            if (__atomic_compare_exchange_n(&tag_names[i], &expected, tag, false,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                return (uint8_t)i;
+            }
+            name = expected;    // Another writer claimed it first
+        }
+        if (name == tag || strcmp(name, tag) == 0) {
+            return (uint8_t)i;
+        }
+    }
+    return 0xFF;
+}
+
+// ============================================================================
+// Format Specs
+// ============================================================================
+
+typedef enum { ARG_NONE, ARG_INT, ARG_LONG_LONG, ARG_DOUBLE, ARG_PTR } arg_kind_t;
+
+#define PTR_WORDS   ((int)((sizeof(void *) + 3) / 4))      // 1 on the target, 2 on host builds
+
+// Parse one conversion starting at the '%'. Returns the spec length and the
+// argument it takes; '*' widths are not supported and end the scan.
+static size_t parse_spec(const char *p, arg_kind_t *kind)
+{
+    const char *start = p++;
+    int longs = 0;
+
+    if (*p == '%') {
+        *kind = ARG_NONE;
+        return 2;
+    }
+    while (*p && strchr("-+ #0", *p)) p++;
+    while (*p >= '0' && *p <= '9') p++;
+    if (*p == '.') {
+        p++;
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    while (*p && strchr("hlzjt", *p)) {
+        if (*p == 'l' || *p == 'j') longs++;
+        p++;
+    }
+
+    switch (*p) {
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+            *kind = longs >= 2 ? ARG_LONG_LONG : ARG_INT;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            *kind = ARG_DOUBLE;
+            break;
+        case 's': case 'p':
+            *kind = ARG_PTR;
+            break;
+        default:
+            *kind = ARG_NONE;
+            return 0;
+    }
+    return (size_t)(p - start) + 1;
+}
+
+static int arg_words(arg_kind_t kind)
+{
+    if (kind == ARG_PTR) return PTR_WORDS;
+    return (kind == ARG_LONG_LONG || kind == ARG_DOUBLE) ? 2 : (kind == ARG_NONE ? 0 : 1);
+}
+
+// Copy the raw arguments the format asks for into words
+static uint8_t pack_args(const char *fmt, va_list args, uint32_t *words)
+{
+    int n = 0;
+    for (const char *p = fmt; *p; p++) {
+        if (*p != '%') continue;
+        arg_kind_t kind;
+        size_t len = parse_spec(p, &kind);
+        if (len == 0) break;
+        p += len - 1;
+
+        int need = arg_words(kind);
+        if (need == 0) continue;
+        if (n + need > LOG_RING_ARG_WORDS) break;
+
+        if (kind == ARG_LONG_LONG || kind == ARG_DOUBLE) {
+            uint64_t v;
+            if (kind == ARG_DOUBLE) {
+                double d = va_arg(args, double);
+                memcpy(&v, &d, sizeof(v));
+            } else {
+                v = va_arg(args, unsigned long long);
+            }
+            words[n++] = (uint32_t)v;
+            words[n++] = (uint32_t)(v >> 32);
+        } else if (kind == ARG_PTR) {
+            uint64_t v = (uintptr_t)va_arg(args, const void *);
+            for (int i = 0; i < PTR_WORDS; i++) {
+                words[n++] = (uint32_t)(v >> (32 * i));
+            }
+        } else {
+            words[n++] = va_arg(args, unsigned int);
+        }
+    }
+    return (uint8_t)n;
+}
+
+// Expand a record's format with its stored words
+static int format_message(const log_record_t *r, char *buf, int size)
+{
+    int pos = 0;
+    int w = 0;
+    const char *p = r->fmt;
+
+    while (*p && pos < size - 1) {
+        if (*p != '%') {
+            buf[pos++] = *p++;
+            continue;
+        }
+        arg_kind_t kind;
+        size_t len = parse_spec(p, &kind);
+        if (len == 0 || len >= 16) {
+            buf[pos++] = *p++;
+            continue;
+        }
+
+        char spec[16];
+        memcpy(spec, p, len);
+        spec[len] = '\0';
+        p += len;
+
+        int need = arg_words(kind);
+        int n;
+        if (kind == ARG_NONE) {
+            n = snprintf(buf + pos, size - pos, "%%");
+        } else if (w + need > r->words) {
+            n = snprintf(buf + pos, size - pos, "?");
+        } else if (kind == ARG_LONG_LONG || kind == ARG_DOUBLE) {
+            uint64_t v = (uint64_t)r->args[w] | ((uint64_t)r->args[w + 1] << 32);
+            if (kind == ARG_DOUBLE) {
+                double d;
+                memcpy(&d, &v, sizeof(d));
+                n = snprintf(buf + pos, size - pos, spec, d);
+            } else {
+                n = snprintf(buf + pos, size - pos, spec, (unsigned long long)v);
+            }
+        } else if (kind == ARG_PTR) {
+            uint64_t v = 0;
+            for (int i = 0; i < PTR_WORDS; i++) {
+                v |= (uint64_t)r->args[w + i] << (32 * i);
+            }
+            const void *ptr = (const void *)(uintptr_t)v;
+            if (spec[len - 1] == 's' && !ptr) ptr = "(null)";
+            n = snprintf(buf + pos, size - pos, spec, ptr);
+        } else {
+            n = snprintf(buf + pos, size - pos, spec, r->args[w]);
+        }
+        w += need;
+        if (n < 0) break;
+        pos += n;
+    }
+    if (pos > size - 1) pos = size - 1;
+    buf[pos] = '\0';
+    return pos;
+}
+
+// ============================================================================
+// Write
+// ============================================================================
+
+void log_ring_vwrite(log_ring_level_t level, const char *tag, const char *fmt, va_list args)
+{
+    if (!fmt) return;
+
+    uint32_t seq = __atomic_fetch_add(&ring_head, 1, __ATOMIC_RELAXED);
+    log_record_t *r = &ring[seq & LOG_RING_MASK];
+
+    // Unpublish the slot first so a reader never mixes two records
+    __atomic_store_n(&r->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    r->time_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    r->fmt = fmt;
+    r->level = (uint8_t)level;
+    r->tag = tag_id(tag);
+    r->words = pack_args(fmt, args, r->args);
+
+    __atomic_store_n(&r->seq, seq + 1, __ATOMIC_RELEASE);
+}
+
+void log_ring_write(log_ring_level_t level, const char *tag, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    log_ring_vwrite(level, tag, fmt, args);
+    va_end(args);
+}
+
+// ============================================================================
+// Read
+// ============================================================================
+
+uint32_t log_ring_head(void)
+{
+    return __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+}
+
+uint32_t log_ring_oldest(void)
+{
+    uint32_t head = log_ring_head();
+    uint32_t oldest = head > LOG_RING_SIZE ? head - LOG_RING_SIZE : 0;
+    uint32_t floor = __atomic_load_n(&ring_floor, __ATOMIC_RELAXED);
+    return (int32_t)(floor - oldest) > 0 ? floor : oldest;
+}
+
+void log_ring_clear(void)
+{
+    __atomic_store_n(&ring_floor, log_ring_head(), __ATOMIC_RELAXED);
+}
+
+size_t log_ring_read(uint32_t *cursor, char *buf, size_t size)
+{
+    if (!cursor || !buf || size < 32) return 0;
+
+    while ((int32_t)(log_ring_head() - *cursor) > 0) {
+        // Fell behind (or the ring was cleared): jump to the oldest record
+        uint32_t oldest = log_ring_oldest();
+        if ((int32_t)(oldest - *cursor) > 0) {
+            uint32_t skipped = oldest - *cursor;
+            *cursor = oldest;
+            return (size_t)snprintf(buf, size, "--- %lu lines dropped ---\n", (unsigned long)skipped);
+        }
+
+        const log_record_t *slot = &ring[*cursor & LOG_RING_MASK];
+        uint32_t stamp = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (stamp != *cursor + 1) {
+            if (stamp != 0 && (int32_t)(stamp - (*cursor + 1)) > 0) {
+                (*cursor)++;    // Already overwritten by a newer record
+                continue;
+            }
+            return 0;           // Reserved but not published yet
+        }
+
+        log_record_t r;
+        memcpy(&r, slot, sizeof(r));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != stamp) {
+            (*cursor)++;        // Overwritten while copying
+            continue;
+        }
+
+        const char *tag = r.tag < LOG_RING_MAX_TAGS ? tag_names[r.tag] : NULL;
+        int pos = snprintf(buf, size, "%lu %lu.%03lu %c %s: ", (unsigned long)*cursor,
+                           (unsigned long)(r.time_ms / 1000), (unsigned long)(r.time_ms % 1000),
+                           r.level < sizeof(level_chars) ? level_chars[r.level] : '?',
+                           tag ? tag : "?");
+        if (pos < 0 || pos >= (int)size - 2) pos = 0;
+        pos += format_message(&r, buf + pos, (int)size - pos - 1);
+        buf[pos++] = '\n';
+        buf[pos] = '\0';
+        (*cursor)++;
+        return (size_t)pos;
+    }
+    return 0;
+}
+
+// ============================================================================
+// HTTP Export
+// ============================================================================
+
+// Send every line from *cursor up to the head in ~1 KB chunks
+static esp_err_t send_lines(httpd_req_t *req, uint32_t *cursor)
+{
+    char chunk[1024];
+    size_t len = 0;
+    char line[LOG_RING_LINE_MAX];
+    size_t n;
+
+    while ((n = log_ring_read(cursor, line, sizeof(line))) > 0) {
+        if (len + n > sizeof(chunk)) {
+            esp_err_t err = httpd_resp_send_chunk(req, chunk, len);
+            if (err != ESP_OK) return err;
+            len = 0;
+        }
+        memcpy(chunk + len, line, n);
+        len += n;
+    }
+    return len > 0 ? httpd_resp_send_chunk(req, chunk, len) : ESP_OK;
+}
+
+static void set_log_headers(httpd_req_t *req)
+{
+    httpd_resp_set_type(req, "text/plain; charset=utf-8");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+}
+
+esp_err_t log_ring_export(httpd_req_t *req, uint32_t since)
+{
+    uint32_t cursor = since;
+    set_log_headers(req);
+    esp_err_t err = send_lines(req, &cursor);
+    if (err == ESP_OK) {
+        err = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    return err;
+}
+
+// Follow clients: detached requests served by one polling task
+typedef struct {
+    httpd_req_t *req;
+    uint32_t cursor;
+} log_follower_t;
+
+static portMUX_TYPE follow_lock = portMUX_INITIALIZER_UNLOCKED;
+static log_follower_t followers[LOG_FOLLOW_MAX_CLIENTS];
+static int follower_count = 0;
+static TaskHandle_t follow_task_handle = NULL;
+
+static void follow_task(void *arg)
+{
+    (void)arg;
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(LOG_FOLLOW_POLL_MS));
+        for (int i = follower_count - 1; i >= 0; i--) {
+            if (send_lines(followers[i].req, &followers[i].cursor) == ESP_OK) continue;
+
+            httpd_req_t *req = followers[i].req;
+            portENTER_CRITICAL(&follow_lock);
+            followers[i] = followers[follower_count - 1];
+            follower_count--;
+            portEXIT_CRITICAL(&follow_lock);
+            httpd_req_async_handler_complete(req);
+            ESP_LOGI(TAG, "Log follower disconnected (%d left)", follower_count);
+        }
+    }
+}
+
+esp_err_t log_ring_follow(httpd_req_t *req, uint32_t since)
+{
+    if (!follow_task_handle &&
+        xTaskCreate(follow_task, "log_follow", 3072, NULL, 2, &follow_task_handle) != pdPASS) {
+        follow_task_handle = NULL;
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Log follow not available");
+        return ESP_FAIL;
+    }
+    if (follower_count >= LOG_FOLLOW_MAX_CLIENTS) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_send(req, "Too many log followers", HTTPD_RESP_USE_STRLEN);
+        return ESP_OK;
+    }
+
+    // Backlog goes out now, on the httpd task
+    uint32_t cursor = since;
+    set_log_headers(req);
+    esp_err_t err = send_lines(req, &cursor);
+    if (err != ESP_OK) return err;
+
+    httpd_req_t *async_req = NULL;
+    err = httpd_req_async_handler_begin(req, &async_req);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to detach log request: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    portENTER_CRITICAL(&follow_lock);
+    followers[follower_count].req = async_req;
+    followers[follower_count].cursor = cursor;
+    follower_count++;
+    portEXIT_CRITICAL(&follow_lock);
+
+    ESP_LOGI(TAG, "Log follower connected (%d total)", follower_count);
+    return ESP_OK;
+}
@@ -1,15 +1,17 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/queue.h"
 #include "driver/gpio.h"
+#include "esp_sleep.h"
 #include "esp_log.h"
 #include "esp_system.h"
 #include "esp_timer.h"
 #include "esp_sntp.h"
 #include "cJSON.h"
+#include "lwip/netdb.h"
 
 #include "config.h"
 #include "lcd_driver.h"
@@ -18,12 +20,28 @@
 #include "rgb_led.h"
 #include "settings.h"
 #include "tfnsw_client.h"
+#include "lan_sync.h"
+#include "departure_cache.h"
+#include "sd_card.h"
+#include "spi_arbiter.h"
+#include "event_stream.h"
+#include "event_trace.h"
+#include "boot_pipeline.h"
+#include "power_mgmt.h"
+#include "night_mode.h"
+#include "backlight.h"
+#include "led_timeline.h"
 
 static const char *TAG = "main";
 
-// Button handling
+// Button handling: the ISR posts to a mailbox, the main loop collects
 static volatile uint32_t last_button_press = 0;
-static QueueHandle_t button_event_queue = NULL;
+static volatile uint32_t button_presses = 0;    // Written by the ISR only
+static volatile bool button_masked = false;     // Interrupt off until released
+static uint32_t button_presses_seen = 0;
+static uint32_t button_up_since_ms = 0;         // Release seen at (0 = still down)
+static int source_switch_from = -1;             // View the data source still has to leave (atomic:
+                                                // also posted by the first-fetch boot stage)
 
 // ============================================================================
 // Application State
@@ -41,9 +59,16 @@ static app_state_t current_state = APP_STATE_INIT;
 
 // Pending state transitions (set from callbacks, processed in main loop for LVGL safety)
 static volatile bool pending_wifi_connected = false;
-static volatile bool pending_ap_started = false;
+static volatile bool pending_ap_started = false;     // WiFi fell back to AP mode
 static volatile bool pending_api_key_set = false;
 
+#define AP_INFO_SHOW_MS 5000
+static uint32_t ap_info_until_ms = 0;   // AP details on screen until then
+
+// View shown once WiFi is up (saved default_scene), set by the storage stage
+static view_id_t boot_view = VIEW_HIGH_SPEED;
+static bool boot_view_shown = false;
+
 // Forward declarations
 static void on_realtime_update(const tfnsw_departures_t* departures);
 static void update_brightness_for_time(void);
@@ -57,104 +82,186 @@ static const char* get_stop_id_for_view(view_id_t view) {
     return NULL;
 }
 
-// Brightness settings
-#define BRIGHTNESS_DAY 80
-#define BRIGHTNESS_NIGHT 20
-static uint8_t current_brightness = BRIGHTNESS_DAY;
+// Brightness settings (automatic levels follow the curve in backlight.c)
+#define BRIGHTNESS_DEFAULT 80       // Until the clock is set
+#define BRIGHTNESS_CHECK_MS 10000
+#define BRIGHTNESS_STEP_MAX 5       // Larger changes use BACKLIGHT_TRANSITION_MS
+static uint8_t current_brightness = BRIGHTNESS_DEFAULT;
 static bool manual_brightness_override = false;  // When true, skip auto-adjustment
 
+// ============================================================================
+// View Data Source
+// ============================================================================
+
+// Put a realtime view's last saved departures in the view store, so it shows
+// real (age-marked) services until its first fetch lands
+static void warm_view_from_cache(view_id_t view)
+{
+    const char* stop_id = get_stop_id_for_view(view);
+    if (!stop_id) return;
+
+    tfnsw_departures_t *cached = malloc(sizeof(tfnsw_departures_t));
+    if (!cached) return;
+    if (departures_cache_load(stop_id, cached) == ESP_OK) {
+        lcd_update_view_data(view, cached);
+    }
+    free(cached);
+}
+
+// Start, retarget or stop the departure source after a view change. A LAN
+// follower subscribes through lan_sync instead of fetching, and a hub keeps
+// its fetch task alive on static views because followers depend on it.
+static void switch_view_data_source(view_id_t old_view, view_id_t new_view)
+{
+    const view_config_t* new_config = lcd_get_view_config(new_view);
+    const view_config_t* old_config = lcd_get_view_config(old_view);
+    bool new_is_realtime = new_config && new_config->data_source == VIEW_DATA_REALTIME;
+    bool old_is_realtime = old_config && old_config->data_source == VIEW_DATA_REALTIME;
+    const char* stop_id = new_is_realtime ? get_stop_id_for_view(new_view) : NULL;
+
+    if (new_is_realtime) {
+        warm_view_from_cache(new_view);
+    }
+
+    if (lan_sync_is_follower()) {
+        lan_sync_set_active_stop(stop_id);
+        return;
+    }
+
+    if (new_is_realtime && tfnsw_has_api_key()) {
+        // Switching TO realtime view
+        ESP_LOGI(TAG, "Switching to realtime view - stop: %s", stop_id ? stop_id : "(none)");
+
+        if (!tfnsw_is_background_fetch_running()) {
+            // Start single-view fetch for this stop
+            tfnsw_start_single_view_fetch(stop_id, on_realtime_update);
+        } else {
+            // Just switch the active stop
+            tfnsw_set_active_stop(stop_id);
+        }
+    } else if (old_is_realtime && !new_is_realtime) {
+        if (lan_sync_get_role() == LAN_ROLE_HUB) {
+            // Keep serving followers; only this board's own stop is dropped
+            tfnsw_set_active_stop(NULL);
+            tfnsw_clear_cached_data();
+            return;
+        }
+        // Switching AWAY from realtime view - stop fetching and clear data
+        ESP_LOGI(TAG, "Leaving realtime view - stopping fetch");
+        tfnsw_stop_background_fetch();
+        tfnsw_clear_cached_data();
+    }
+}
+
+// Ask the main loop to move the data source from from_view to whatever view
+// is current when it gets there. A switch already pending keeps its origin.
+static void post_source_switch(view_id_t from_view)
+{
+    int none = -1;
+    __atomic_compare_exchange_n(&source_switch_from, &none, (int)from_view, false,
+                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    power_loop_wake();
+}
+
 // ============================================================================
 // Button Handling
 // ============================================================================
 
+// The button interrupt is low-level (the only kind that can also wake the
+// chip from light sleep), so the ISR masks it until the main loop sees the
+// button released again. The ISR only counts the press and wakes the main
+// loop; there is no button task.
 static void IRAM_ATTR button_isr_handler(void* arg)
 {
+    gpio_intr_disable(BUTTON_PIN);
+    button_masked = true;
+
     uint32_t now = xTaskGetTickCountFromISR();
     if ((now - last_button_press) > pdMS_TO_TICKS(BUTTON_DEBOUNCE_MS)) {
         last_button_press = now;
-        uint32_t gpio_num = (uint32_t)arg;
-        xQueueSendFromISR(button_event_queue, &gpio_num, NULL);
+        button_presses = button_presses + 1;
     }
+    power_loop_wake();
 }
 
-static void button_task(void* arg)
+static void on_button_press(void)
 {
-    uint32_t gpio_num;
-    while (1) {
-        if (xQueueReceive(button_event_queue, &gpio_num, portMAX_DELAY)) {
-            (void)gpio_num;  // Unused, but kept for future use
+    trace_begin("button");
+    night_note_activity();
+    if (current_state == APP_STATE_RUNNING || current_state == APP_STATE_WIFI_AP) {
+        view_id_t old_view = lcd_get_current_view();
 
-            if (current_state == APP_STATE_RUNNING || current_state == APP_STATE_WIFI_AP) {
-                view_id_t old_view = lcd_get_current_view();
-
-                // Switch to next enabled view
-                lcd_next_view();
+        // Switch to next enabled view
+        lcd_next_view();
 
-                view_id_t new_view = lcd_get_current_view();
-                const view_config_t* new_config = lcd_get_view_config(new_view);
-                const view_config_t* old_config = lcd_get_view_config(old_view);
+        view_id_t new_view = lcd_get_current_view();
+        const view_config_t* new_config = lcd_get_view_config(new_view);
 
-                ESP_LOGI(TAG, "Button pressed - switching from view %d to %d (%s)",
-                         old_view, new_view, new_config ? new_config->name : "unknown");
+        ESP_LOGI(TAG, "Button pressed - switching from view %d to %d (%s)",
+                 old_view, new_view, new_config ? new_config->name : "unknown");
 
-                // Clear old view data when switching
-                lcd_clear_view_data(old_view);
+        // Clear old view data when switching
+        lcd_clear_view_data(old_view);
 
-                // Check if views need realtime data
-                bool new_is_realtime = new_config && new_config->data_source == VIEW_DATA_REALTIME;
-                bool old_is_realtime = old_config && old_config->data_source == VIEW_DATA_REALTIME;
+        // Fetching follows once the new view is drawn (stopping a fetch task
+        // blocks for a moment)
+        post_source_switch(old_view);
 
-                if (new_is_realtime && tfnsw_has_api_key()) {
-                    // Switching TO realtime view
-                    const char* stop_id = get_stop_id_for_view(new_view);
-                    ESP_LOGI(TAG, "Switching to realtime view - stop: %s", stop_id ? stop_id : "(none)");
+        // LED color is set by lcd_update() when view changes via view config
+        // For status view, re-enable status mode
+        if (new_view == VIEW_STATUS_INFO) {
+            ESP_LOGI(TAG, "Re-enabling status mode for status view");
+            rgb_led_set_status(rgb_led_get_status());
+        }
+    }
+    trace_end("button", (uint32_t)lcd_get_current_view());
+}
 
-                    if (!tfnsw_is_background_fetch_running()) {
-                        // Start single-view fetch for this stop
-                        tfnsw_start_single_view_fetch(stop_id, on_realtime_update);
-                    } else {
-                        // Just switch the active stop
-                        tfnsw_set_active_stop(stop_id);
-                    }
-                } else if (old_is_realtime && !new_is_realtime) {
-                    // Switching AWAY from realtime view - stop fetching and clear data
-                    ESP_LOGI(TAG, "Leaving realtime view - stopping fetch");
-                    tfnsw_stop_background_fetch();
-                    tfnsw_clear_cached_data();
-                }
+// Main loop side of the mailbox: run new presses, and re-enable the
+// interrupt once the button has been up for BUTTON_DEBOUNCE_MS. Returns how
+// long until it needs to look at the button again.
+static uint32_t process_button(uint32_t now_ms)
+{
+    uint32_t presses = button_presses;
+    while (button_presses_seen != presses) {
+        button_presses_seen++;
+        on_button_press();
+    }
 
-                // LED color is set by lcd_update() when view changes via view config
-                // For status view, re-enable status mode
-                if (new_view == VIEW_STATUS_INFO) {
-                    ESP_LOGI(TAG, "Re-enabling status mode for status view");
-                    rgb_led_set_status(rgb_led_get_status());
-                }
-            }
-        }
+    if (!button_masked) return UINT32_MAX;
+
+    if (gpio_get_level(BUTTON_PIN) == 0) {
+        button_up_since_ms = 0;
+    } else if (!button_up_since_ms) {
+        button_up_since_ms = now_ms ? now_ms : 1;
+    } else if (now_ms - button_up_since_ms >= BUTTON_DEBOUNCE_MS) {
+        button_up_since_ms = 0;
+        button_masked = false;
+        gpio_intr_enable(BUTTON_PIN);
+        return UINT32_MAX;
     }
+    return BUTTON_DEBOUNCE_MS;
 }
 
 static void init_button(void)
 {
-    // Create event queue for button presses
-    button_event_queue = xQueueCreate(10, sizeof(uint32_t));
-
     // Configure button GPIO
     gpio_config_t io_conf = {
         .pin_bit_mask = (1ULL << BUTTON_PIN),
         .mode = GPIO_MODE_INPUT,
         .pull_up_en = GPIO_PULLUP_ENABLE,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_NEGEDGE  // Trigger on falling edge (button press)
+        .intr_type = GPIO_INTR_LOW_LEVEL  // Pressed (masked by the ISR until release)
     };
     gpio_config(&io_conf);
 
     // Install GPIO ISR service and add handler
     gpio_install_isr_service(0);
-    gpio_isr_handler_add(BUTTON_PIN, button_isr_handler, (void*)BUTTON_PIN);
+    gpio_isr_handler_add(BUTTON_PIN, button_isr_handler, NULL);
 
-    // Create button handling task (8192 bytes needed for large tfnsw_dual_departures_t struct)
-    xTaskCreate(button_task, "button_task", 8192, NULL, 10, NULL);
+    // A press also ends light sleep in power-save mode
+    gpio_wakeup_enable(BUTTON_PIN, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
 
     ESP_LOGI(TAG, "Button initialized on GPIO %d", BUTTON_PIN);
 }
@@ -183,38 +290,27 @@ static void init_sntp(void)
     esp_sntp_set_time_sync_notification_cb(sntp_sync_notification_cb);
     esp_sntp_init();
 
+    sntp_sync_in_progress = true;
+}
+
+// Set at the start of app_main: after a night-mode wake the clock is already
+// right, and cached departures are shown before SNTP runs
+static void set_timezone(void)
+{
     // Set timezone to Sydney/Australia (AEST/AEDT)
     // AEST = UTC+10, AEDT = UTC+11
     // DST starts: First Sunday of October at 2:00am
     // DST ends: First Sunday of April at 3:00am
     setenv("TZ", "AEST-10AEDT,M10.1.0/2,M4.1.0/3", 1);
     tzset();
-
-    sntp_sync_in_progress = true;
-
-    // Brief initial wait (max 3 seconds), then continue anyway
-    int retry = 0;
-    const int max_initial_wait = 30;  // 3 seconds max initial wait
-    while (esp_sntp_get_sync_status() == SNTP_SYNC_STATUS_RESET && ++retry < max_initial_wait) {
-        vTaskDelay(pdMS_TO_TICKS(100));
-    }
-
-    if (esp_sntp_get_sync_status() != SNTP_SYNC_STATUS_RESET) {
-        sntp_synced = true;
-        sntp_sync_in_progress = false;
-        ESP_LOGI(TAG, "SNTP time synchronized");
-        update_brightness_for_time();
-    } else {
-        // Continue without blocking - sync will complete in background
-        ESP_LOGW(TAG, "SNTP sync pending - continuing with unsynced time");
-        ESP_LOGW(TAG, "Time will sync automatically in background");
-    }
 }
 
-// Check if time is synced (can be called from anywhere)
+// Check if time is synced (can be called from anywhere). The RTC keeps the
+// time through night-mode deep sleep, so a sync from before it still counts.
 bool is_time_synced(void)
 {
-    return sntp_synced || (esp_sntp_get_sync_status() != SNTP_SYNC_STATUS_RESET);
+    return sntp_synced || night_clock_valid() ||
+           (esp_sntp_get_sync_status() != SNTP_SYNC_STATUS_RESET);
 }
 
 // ============================================================================
@@ -225,6 +321,10 @@ static void on_realtime_update(const tfnsw_departures_t* departures)
 {
     if (!departures) return;
 
+    // Dashboard clients on /api/events get the new fetch status (the
+    // departures follow from the view store once the view is updated)
+    event_stream_publish(EVENT_TOPIC_TFNSW);
+
     view_id_t current_view = lcd_get_current_view();
     const view_config_t* config = lcd_get_view_config(current_view);
 
@@ -239,6 +339,18 @@ static void on_realtime_update(const tfnsw_departures_t* departures)
 
     // Update the current view's data (triggers refresh)
     lcd_update_view_data(current_view, departures);
+    if (departures->status == TFNSW_STATUS_SUCCESS && departures->count > 0) {
+        boot_stage_done(BOOT_STAGE_FIRST_DEPARTURE, ESP_OK);
+    }
+
+    // Keep the last good result on flash for the next boot (rate limited),
+    // and look for the overnight break in service
+    const char* stop_id = get_stop_id_for_view(current_view);
+    if (stop_id) {
+        departures_cache_save(stop_id, departures);
+        night_note_departures(stop_id, departures);
+    }
+    led_timeline_note_departures(departures);
 }
 
 // ============================================================================
@@ -250,6 +362,7 @@ static void on_wifi_connected(void)
     // Just set flag - actual LVGL operations happen in main loop for thread safety
     ESP_LOGI(TAG, "WiFi connected callback - setting pending flag");
     pending_wifi_connected = true;
+    power_loop_wake();
 }
 
 // Process WiFi connected event - called from main loop (LVGL safe)
@@ -263,25 +376,25 @@ static void process_wifi_connected(void)
     lcd_set_wifi_ssid(wifi_get_ssid());
     lcd_set_wifi_rssi(wifi_get_rssi());
 
-    // Initialize time synchronization (required for API timestamps)
-    init_sntp();
-
-    // Initialize TfNSW client
-    if (tfnsw_init() == ESP_OK) {
-        ESP_LOGI(TAG, "TfNSW client initialized");
-    } else {
-        ESP_LOGE(TAG, "Failed to initialize TfNSW client");
+    // Time sync, TfNSW, the web server and the first fetch are boot stages
+    // running in parallel (see boot_stages); reconnects only refresh the above
+    if (!boot_view_shown) {
+        boot_view_shown = true;
+        lcd_set_view(boot_view);
+        ESP_LOGI(TAG, "Starting with view %d", boot_view);
     }
+}
 
-    // Default to high speed view (static/demo data - no fetching needed)
-    lcd_set_view(VIEW_HIGH_SPEED);
-    ESP_LOGI(TAG, "Starting with High Speed view (static data)");
-
-    // Note: Background fetch will be started when user switches to a realtime view
-    // This saves memory and API calls when not needed
+// WiFi gave up during boot: show the AP details, then the loading screen
+static void process_ap_fallback(void)
+{
+    current_state = APP_STATE_WIFI_AP;
+    lcd_show_wifi_config(WIFI_AP_SSID, "192.168.4.1");
+    rgb_led_set_hex(RGB_YELLOW);  // Yellow for AP mode
 
-    // Start web server
+    // Start web server for configuration
     webserver_start();
+    ap_info_until_ms = (uint32_t)(esp_timer_get_time() / 1000) + AP_INFO_SHOW_MS;
 }
 
 static void on_ap_started(void)
@@ -298,6 +411,7 @@ static void on_api_key_set(void)
     // Just set flag - actual LVGL operations happen in main loop for thread safety
     ESP_LOGI(TAG, "API key set callback - setting pending flag");
     pending_api_key_set = true;
+    power_loop_wake();
 }
 
 // Process API key set event - called from main loop (LVGL safe)
@@ -305,6 +419,12 @@ static void process_api_key_set(void)
 {
     ESP_LOGI(TAG, "Processing API key set");
 
+    // Followers only use the key if the hub goes away
+    if (lan_sync_is_follower()) {
+        ESP_LOGI(TAG, "LAN follower - key kept for fallback fetching");
+        return;
+    }
+
     view_id_t current_view = lcd_get_current_view();
     const view_config_t* config = lcd_get_view_config(current_view);
 
@@ -323,14 +443,15 @@ static void process_api_key_set(void)
     }
 }
 
-static void handle_display_command(const char* command, const char* params)
+static esp_err_t handle_display_command(const char* command, const char* params)
 {
     ESP_LOGI(TAG, "Display command: %s", command);
+    esp_err_t ret = ESP_OK;
 
     if (strcmp(command, "hello_world") == 0) {
         lcd_show_departure_board();
     } else if (strcmp(command, "clear") == 0) {
-        lcd_clear(COLOR_BLACK);
+        ret = lcd_clear(COLOR_BLACK);
     } else if (strcmp(command, "splash") == 0) {
         lcd_show_splash();
     } else if (strcmp(command, "scene") == 0) {
@@ -350,23 +471,9 @@ static void handle_display_command(const char* command, const char* params)
                     settings_set_default_scene((uint8_t)new_view);
                     ESP_LOGI(TAG, "View set to: %d", new_view);
 
-                    // Manage background fetch based on view change
-                    const view_config_t* new_config = lcd_get_view_config(new_view);
-                    const view_config_t* old_config = lcd_get_view_config(old_view);
-                    bool new_is_realtime = new_config && new_config->data_source == VIEW_DATA_REALTIME;
-                    bool old_is_realtime = old_config && old_config->data_source == VIEW_DATA_REALTIME;
-
-                    if (new_is_realtime && tfnsw_has_api_key()) {
-                        const char* stop_id = get_stop_id_for_view(new_view);
-                        if (!tfnsw_is_background_fetch_running()) {
-                            tfnsw_start_single_view_fetch(stop_id, on_realtime_update);
-                        } else {
-                            tfnsw_set_active_stop(stop_id);
-                        }
-                    } else if (old_is_realtime && !new_is_realtime) {
-                        tfnsw_stop_background_fetch();
-                        tfnsw_clear_cached_data();
-                    }
+                    // The main loop moves the fetch over; stopping a fetch
+                    // task would hold up the HTTP server task here
+                    post_source_switch(old_view);
 
                     // LED color and theme are set by lcd_update() via view config
                     // For status view, re-enable status mode
@@ -449,13 +556,57 @@ static void handle_display_command(const char* command, const char* params)
                 int py = (y && cJSON_IsNumber(y)) ? y->valueint : 0;
                 int ps = (size && cJSON_IsNumber(size)) ? size->valueint : 2;
 
-                lcd_clear(COLOR_BLACK);
-                lcd_draw_string(px, py, text->valuestring, COLOR_WHITE, COLOR_BLACK, ps);
+                ret = lcd_clear(COLOR_BLACK);
+                if (ret == ESP_OK) {
+                    ret = lcd_draw_string(px, py, text->valuestring, COLOR_WHITE, COLOR_BLACK, ps);
+                }
             }
             cJSON_Delete(root);
         }
     }
+    return ret;
+}
+
+#if SD_LOG_TEST_ENABLED
+// SD log stress test: log continuously while the display keeps animating,
+// then report how often the bus arbiter had to hold SD back. Compare the
+// /api/perf frame times taken during the run with an idle baseline.
+#define SD_LOG_TEST_MS      30000
+#define SD_LOG_TEST_LINE_MS 5
+
+static bool sd_log_test_running = false;
+
+static void sd_log_test_task(void *pvParameters)
+{
+    (void)pvParameters;
+    spi_arbiter_stats_t before, after;
+    spi_arbiter_reset_peaks();
+    spi_arbiter_get_stats(&before);
+    uint32_t dropped_before = sd_log_dropped();
+
+    int64_t start_us = esp_timer_get_time();
+    uint32_t lines = 0;
+    while (esp_timer_get_time() - start_us < (int64_t)SD_LOG_TEST_MS * 1000) {
+        log_info("sd_test", "line %lu heap %lu view %d", (unsigned long)lines,
+                 (unsigned long)esp_get_free_heap_size(), lcd_get_current_view());
+        lines++;
+        vTaskDelay(pdMS_TO_TICKS(SD_LOG_TEST_LINE_MS));
+    }
+    sd_log_flush();
+
+    spi_arbiter_get_stats(&after);
+    uint32_t slices = after.sd_slices - before.sd_slices;
+    ESP_LOGI(TAG, "SD log test: %lu lines, %lu dropped, %lu slices (%lu forced), "
+             "%lu frames started during a slice, max wait %lu us, max slice %lu us",
+             (unsigned long)lines, (unsigned long)(sd_log_dropped() - dropped_before),
+             (unsigned long)slices,
+             (unsigned long)(after.sd_forced - before.sd_forced),
+             (unsigned long)(after.frames_delayed - before.frames_delayed),
+             (unsigned long)after.sd_wait_peak_us, (unsigned long)after.sd_hold_peak_us);
+    __atomic_store_n(&sd_log_test_running, false, __ATOMIC_RELEASE);
+    vTaskDelete(NULL);
 }
+#endif
 
 static void handle_system_command(const char* command)
 {
@@ -465,17 +616,23 @@ static void handle_system_command(const char* command)
         lcd_set_backlight(0);
     } else if (strcmp(command, "wake") == 0) {
         lcd_set_backlight(current_brightness);
+#if SD_LOG_TEST_ENABLED
+    } else if (strcmp(command, "sd_log_test") == 0) {
+        if (!sd_card_is_mounted()) {
+            ESP_LOGW(TAG, "SD log test needs a mounted card");
+        } else if (__atomic_exchange_n(&sd_log_test_running, true, __ATOMIC_ACQ_REL)) {
+            ESP_LOGW(TAG, "SD log test already running");
+        } else if (xTaskCreate(sd_log_test_task, "sd_log_test", 3072, NULL, 3, NULL) != pdPASS) {
+            __atomic_store_n(&sd_log_test_running, false, __ATOMIC_RELEASE);
+            ESP_LOGE(TAG, "Failed to start SD log test");
+        }
+#endif
     }
 }
 
-// Update brightness based on time of day (dim between 19:00 and 08:00)
-static void update_brightness_for_time(void)
+// Automatic brightness for the current time; false until the clock is set
+static bool auto_brightness(uint8_t* out)
 {
-    // Skip if user has manually set brightness
-    if (manual_brightness_override) {
-        return;
-    }
-
     time_t now;
     struct tm timeinfo;
     time(&now);
@@ -483,123 +640,289 @@ static void update_brightness_for_time(void)
 
     // Check if time is synced (year > 2020)
     if (timeinfo.tm_year < 120) {
-        return;  // Time not synced yet
+        return false;
     }
+    *out = backlight_curve_percent(timeinfo.tm_hour * 60 + timeinfo.tm_min);
+    return true;
+}
 
-    int hour = timeinfo.tm_hour;
-    uint8_t target_brightness;
+// Follow the time-of-day curve. Small steps fade over the whole check
+// interval so the ramps around sunrise and sunset are continuous.
+static void update_brightness_for_time(void)
+{
+    // Skip if user has manually set brightness
+    if (manual_brightness_override) {
+        return;
+    }
 
-    // Dim between 19:00 (7 PM) and 08:00 (8 AM)
-    if (hour >= 19 || hour < 8) {
-        target_brightness = BRIGHTNESS_NIGHT;
-    } else {
-        target_brightness = BRIGHTNESS_DAY;
+    uint8_t target_brightness;
+    if (!auto_brightness(&target_brightness)) {
+        return;  // Time not synced yet
     }
 
     // Only update if brightness changed
     if (target_brightness != current_brightness) {
+        int step = abs((int)target_brightness - (int)current_brightness);
         current_brightness = target_brightness;
-        lcd_set_backlight(current_brightness);
-        ESP_LOGI(TAG, "Brightness adjusted to %d%% (hour: %d)", current_brightness, hour);
+        backlight_set(current_brightness, step <= BRIGHTNESS_STEP_MAX ? BRIGHTNESS_CHECK_MS
+                                                                      : BACKLIGHT_TRANSITION_MS);
+        ESP_LOGD(TAG, "Brightness adjusted to %d%%", current_brightness);
+    }
+}
+
+// Deep sleep through the overnight break once the last service has gone
+// (night_mode.h). Does not return if the board goes to sleep.
+static void check_night_sleep(void)
+{
+    if (!settings_get()->night_sleep || current_state != APP_STATE_RUNNING || !is_time_synced()) {
+        return;
     }
+    // Followers keep fetching through a hub, so it stays up
+    if (lan_sync_get_role() == LAN_ROLE_HUB) return;
+
+    view_id_t view = lcd_get_current_view();
+    const char* stop_id = get_stop_id_for_view(view);
+    int64_t wake_at = night_sleep_due(stop_id);
+    if (!wake_at) return;
+
+    ESP_LOGI(TAG, "Service break at %s - night mode", stop_id);
+    settings_flush();
+    sd_log_flush();
+    rgb_led_off();
+    led_timeline_off();
+    lcd_sleep();
+    night_sleep_until(wake_at, view, stop_id, is_time_synced());
+
+    // The sleep did not start; come back up from a clean boot
+    esp_restart();
 }
 
 // ============================================================================
-// Initialization
+// Boot Stages (run by boot_pipeline)
 // ============================================================================
 
-static void init_hardware(void)
-{
-    ESP_LOGI(TAG, "================================");
-    ESP_LOGI(TAG, "%s", BOARD_NAME);
-    ESP_LOGI(TAG, "Firmware v%s", FIRMWARE_VERSION);
-    ESP_LOGI(TAG, "================================");
+#define WIFI_CONNECT_TIMEOUT_MS 30000   // Enforced by wifi_connect()
+#define SNTP_BOOT_WAIT_MS       3000    // First fetch goes ahead unsynced after this
+#define SPLASH_FRAMES           250     // 2.5 s at 10 ms per frame
 
+static esp_err_t boot_lcd(void)
+{
     // Initialize RGB LED first (for status indication)
     rgb_led_init();
-
-    // Initialize button
+    led_timeline_init();
     init_button();
-
-    // Initialize LCD
     ESP_ERROR_CHECK(lcd_init());
-    lcd_show_splash();
 
-    // Show splash for 2.5 seconds with pulsing white LED
-    for (int i = 0; i < 250; i++) {
-        lcd_update();
+    // Preload realtime views from the on-flash cache so their first frame
+    // shows the last saved departures instead of "Waiting for data..."
+    if (departures_cache_init() == ESP_OK) {
+        for (int v = 0; v < VIEW_COUNT; v++) {
+            warm_view_from_cache((view_id_t)v);
+        }
+    }
 
-        // Pulse white LED using sine wave (0-25 brightness range)
-        // One full pulse cycle over ~1.25 seconds (125 iterations)
-        float angle = (float)i * 3.14159f * 2.0f / 125.0f;
-        uint8_t brightness = (uint8_t)(12 + 12 * sinf(angle));  // Range 0-24
-        rgb_led_set_color(brightness, brightness, brightness);
+    // Night-mode wake: straight back to the board saved before sleeping,
+    // which already lists the morning's first services
+    if (night_woke_from_sleep()) {
+        tfnsw_departures_t *saved = malloc(sizeof(tfnsw_departures_t));
+        view_id_t view;
+        if (saved && night_restore_snapshot(&view, saved) == ESP_OK &&
+            view < VIEW_COUNT && lcd_is_view_enabled(view)) {
+            lcd_update_view_data(view, saved);
+            led_timeline_note_departures(saved);
+            boot_view = view;
+            boot_view_shown = true;
+            lcd_set_view(view);
+        }
+        free(saved);
 
-        vTaskDelay(pdMS_TO_TICKS(10));
+        // The backlight stays dark until boot_storage has the saved level
+    }
+    if (!boot_view_shown) {
+        lcd_show_splash();
     }
+    return ESP_OK;
+}
+
+// WiFi driver and NVS (settings and the TfNSW key are read from NVS)
+static esp_err_t boot_netif(void)
+{
+    ESP_ERROR_CHECK(wifi_init());
+    wifi_set_connected_callback(on_wifi_connected);
+    wifi_set_ap_callback(on_ap_started);
+
+    // Set up web server callbacks
+    webserver_set_display_callback(handle_display_command);
+    webserver_set_system_callback(handle_system_command);
+    webserver_set_api_key_callback(on_api_key_set);
+    return ESP_OK;
+}
 
-    // Initialize settings with defaults (NVS-based, no SD card)
+static esp_err_t boot_storage(void)
+{
     settings_init();
+    const device_settings_t* cfg = settings_get();
 
     // Apply saved brightness if available
-    const device_settings_t* cfg = settings_get();
-    if (cfg && cfg->brightness > 0) {
+    if (cfg->brightness > 0) {
         current_brightness = cfg->brightness;
         manual_brightness_override = true;  // User had set a custom brightness
-        lcd_set_backlight(current_brightness);
         ESP_LOGI(TAG, "Restored saved brightness: %d%%", current_brightness);
+    } else if (night_woke_from_sleep()) {
+        auto_brightness(&current_brightness);
     }
 
-    // SD card disabled to avoid SPI conflicts with display
-    // Settings are loaded from NVS instead
-    ESP_LOGI(TAG, "Using NVS-based settings (SD card disabled)");
+    // A night-mode wake comes up dark: fade in to the level
+    if (night_woke_from_sleep()) {
+        backlight_set(current_brightness, BACKLIGHT_TRANSITION_MS);
+    } else if (manual_brightness_override) {
+        lcd_set_backlight(current_brightness);
+    }
 
-    // Initialize WiFi
-    ESP_ERROR_CHECK(wifi_init());
-    wifi_set_connected_callback(on_wifi_connected);
-    wifi_set_ap_callback(on_ap_started);
+    // DFS and light sleep if power-save mode is on (WiFi is initialised by now)
+    power_init(cfg->power_save);
 
-    // Set up web server callbacks
-    webserver_set_display_callback(handle_display_command);
-    webserver_set_system_callback(handle_system_command);
-    webserver_set_api_key_callback(on_api_key_set);
+    // Come back up on the view last picked from the dashboard
+    if (!boot_view_shown && cfg->default_scene < VIEW_COUNT && lcd_is_view_enabled((view_id_t)cfg->default_scene)) {
+        boot_view = (view_id_t)cfg->default_scene;
+    }
+    return ESP_OK;
 }
 
-// WiFi connection timeout in milliseconds
-#define WIFI_CONNECT_TIMEOUT_MS 30000
+static esp_err_t boot_splash(void)
+{
+    if (night_woke_from_sleep()) {
+        return ESP_OK;      // Wake-to-board should not wait on an animation
+    }
+    for (int i = 0; i < SPLASH_FRAMES; i++) {
+        lcd_update();
+
+        // Pulse white LED using sine wave (0-25 brightness range)
+        // One full pulse cycle over ~1.25 seconds (125 iterations)
+        float angle = (float)i * 3.14159f * 2.0f / 125.0f;
+        uint8_t brightness = (uint8_t)(12 + 12 * sinf(angle));  // Range 0-24
+        rgb_led_set_color(brightness, brightness, brightness);
+
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return ESP_OK;
+}
 
-static void connect_network(void)
+static esp_err_t boot_sd(void)
 {
-    current_state = APP_STATE_WIFI_CONNECTING;
-    lcd_show_loading();  // Show sine wave loading instead of WiFi info
-    rgb_led_set_hex(RGB_YELLOW);  // Solid yellow during startup
+#if SD_CARD_ENABLED
+    // Optional SD card on the LCD's SPI bus (I/O is scheduled between frames)
+    esp_err_t ret = sd_card_init();
+    if (ret == ESP_OK) {
+        log_init();
+        log_info(TAG, "Boot: firmware v%s", FIRMWARE_VERSION);
+    }
+    return ret;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
 
+// Blocks its own task for up to WIFI_CONNECT_TIMEOUT_MS while the splash runs
+static esp_err_t boot_wifi(void)
+{
     ESP_LOGI(TAG, "Attempting WiFi connection (timeout: %d seconds)", WIFI_CONNECT_TIMEOUT_MS / 1000);
 
-    esp_err_t ret = wifi_connect();
-
-    if (ret == ESP_OK && wifi_is_connected()) {
-        // Connected to saved network - callback will handle the rest
-        ESP_LOGI(TAG, "WiFi connected successfully");
-        return;
+    if (wifi_connect() == ESP_OK && wifi_is_connected()) {
+        // on_wifi_connected() has queued the display side for the main loop
+        return ESP_OK;
     }
 
     // Connection failed or timed out - fall back to AP mode
     ESP_LOGW(TAG, "WiFi connection failed, starting AP mode");
-    current_state = APP_STATE_WIFI_AP;
+    pending_ap_started = true;
+    power_loop_wake();
+    return ESP_FAIL;
+}
 
-    // Show AP mode info briefly on display
-    lcd_show_wifi_config(WIFI_AP_SSID, "192.168.4.1");
-    rgb_led_set_hex(RGB_YELLOW);  // Yellow for AP mode
+static esp_err_t boot_tfnsw(void)
+{
+    esp_err_t ret = tfnsw_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize TfNSW client");
+    }
+    return ret;
+}
 
-    // Start web server for configuration
+// Resolve the API host while SNTP runs; the fetch then hits the lwIP DNS cache
+static esp_err_t boot_dns(void)
+{
+    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res = NULL;
+    int err = getaddrinfo(TFNSW_API_HOST, NULL, &hints, &res);
+    if (err != 0 || !res) {
+        // Not fatal: the fetch resolves the host again
+        ESP_LOGW(TAG, "Could not pre-resolve %s (%d)", TFNSW_API_HOST, err);
+        return ESP_OK;
+    }
+    freeaddrinfo(res);
+    return ESP_OK;
+}
+
+static esp_err_t boot_time(void)
+{
+    init_sntp();
+
+    // Brief wait so the first request carries the right date, then continue anyway
+    for (int waited = 0; !is_time_synced() && waited < SNTP_BOOT_WAIT_MS; waited += 100) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    if (is_time_synced()) {
+        sntp_synced = true;
+        sntp_sync_in_progress = false;
+        ESP_LOGI(TAG, "SNTP time synchronized");
+    } else {
+        ESP_LOGW(TAG, "SNTP sync pending - continuing with unsynced time");
+    }
+    return ESP_OK;
+}
+
+static esp_err_t boot_services(void)
+{
     webserver_start();
 
-    // After 5 seconds, go back to loading screen (cleaner look)
-    vTaskDelay(pdMS_TO_TICKS(5000));
-    lcd_show_loading();
+    // Optional LAN sharing: one hub fetches, followers subscribe to it
+    lan_role_t lan_role = (lan_role_t)settings_get()->lan_role;
+    if (lan_role != LAN_ROLE_STANDALONE && lan_sync_start(lan_role, on_realtime_update) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start LAN sync as %s", lan_sync_role_name(lan_role));
+    }
+    return ESP_OK;
 }
 
+// Runs on a boot task: the main loop starts the fetch for the view shown
+// by then (the button may have moved on from boot_view), the same way as
+// after a button press
+static esp_err_t boot_first_fetch(void)
+{
+    post_source_switch(VIEW_HIGH_SPEED);
+    return ESP_OK;
+}
+
+// LVGL stages run on the main task in this order; the rest start in their
+// own task once their dependencies are done
+static const boot_stage_t boot_stages[] = {
+    { BOOT_STAGE_LCD,       boot_lcd,       0, true },
+    { BOOT_STAGE_NETIF,     boot_netif,     0, true },
+    { BOOT_STAGE_STORAGE,   boot_storage,   BOOT_DEP(BOOT_STAGE_LCD) | BOOT_DEP(BOOT_STAGE_NETIF), true },
+    { BOOT_STAGE_SPLASH,    boot_splash,    BOOT_DEP(BOOT_STAGE_LCD), true },
+    { BOOT_STAGE_SD,        boot_sd,        BOOT_DEP(BOOT_STAGE_STORAGE), true },
+    { BOOT_STAGE_WIFI,      boot_wifi,      BOOT_DEP(BOOT_STAGE_NETIF), false },
+    { BOOT_STAGE_TFNSW,     boot_tfnsw,     BOOT_DEP(BOOT_STAGE_NETIF), false },
+    { BOOT_STAGE_DNS,       boot_dns,       BOOT_DEP(BOOT_STAGE_WIFI), false },
+    { BOOT_STAGE_TIME,      boot_time,      BOOT_DEP(BOOT_STAGE_WIFI), false },
+    { BOOT_STAGE_SERVICES,  boot_services,
+      BOOT_DEP(BOOT_STAGE_WIFI) | BOOT_DEP(BOOT_STAGE_STORAGE) | BOOT_DEP(BOOT_STAGE_TFNSW), false },
+    { BOOT_STAGE_FIRST_FETCH, boot_first_fetch,
+      BOOT_DEP(BOOT_STAGE_DNS) | BOOT_DEP(BOOT_STAGE_TIME) | BOOT_DEP(BOOT_STAGE_TFNSW) |
+      BOOT_DEP(BOOT_STAGE_SERVICES), false },
+    { BOOT_STAGE_FIRST_DEPARTURE, NULL, BOOT_DEP(BOOT_STAGE_FIRST_FETCH), false },
+};
+
 // ============================================================================
 // Main Application
 // ============================================================================
@@ -607,13 +930,30 @@ static void connect_network(void)
 void app_main(void)
 {
     ESP_LOGI(TAG, "Starting application...");
+    ESP_LOGI(TAG, "================================");
+    ESP_LOGI(TAG, "%s", BOARD_NAME);
+    ESP_LOGI(TAG, "Firmware v%s", FIRMWARE_VERSION);
+    ESP_LOGI(TAG, "================================");
+
+    night_init();
+    set_timezone();
+
+    // Returns after the splash; WiFi, SNTP and the first fetch carry on
+    current_state = APP_STATE_WIFI_CONNECTING;
+    boot_pipeline_run(boot_stages, sizeof(boot_stages) / sizeof(boot_stages[0]));
+
+    if (!wifi_is_connected() && !pending_ap_started && !boot_view_shown) {
+        lcd_show_loading();  // Show sine wave loading instead of WiFi info
+        rgb_led_set_hex(RGB_YELLOW);  // Solid yellow during startup
+    }
 
-    init_hardware();
-    connect_network();
+    // Main loop - runs when LVGL, the LED or a periodic job is due, or when
+    // another task wakes it (power_loop_wake) after setting a pending flag
+    uint32_t next_status_ms = 0;
+    uint32_t next_brightness_ms = 0;
 
-    // Main loop - 10ms tick rate for smooth animations
-    TickType_t last_wake = xTaskGetTickCount();
-    uint32_t loop_count = 0;
+    // Presses during boot are dropped, as before
+    button_presses_seen = button_presses;
 
     while (1) {
         // Process pending WiFi state changes (LVGL-safe: runs in main loop)
@@ -622,20 +962,27 @@ void app_main(void)
             process_wifi_connected();
         }
 
+        if (pending_ap_started) {
+            pending_ap_started = false;
+            process_ap_fallback();
+        }
+
+        // After 5 seconds of AP info, go back to loading screen (cleaner look)
+        uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        if (ap_info_until_ms && (int32_t)(now_ms - ap_info_until_ms) >= 0) {
+            ap_info_until_ms = 0;
+            lcd_show_loading();
+        }
+
         // Process pending API key set (LVGL-safe: runs in main loop)
         if (pending_api_key_set) {
             pending_api_key_set = false;
             process_api_key_set();
         }
 
-        // Update LVGL (handles animations, rendering, pending scene/realtime updates)
-        lcd_update();
-
-        // Update LED status animation
-        rgb_led_update();
-
         // Periodic tasks (every ~1 second)
-        if (loop_count % 100 == 0) {
+        if ((int32_t)(now_ms - next_status_ms) >= 0) {
+            next_status_ms = now_ms + 1000;
             switch (current_state) {
                 case APP_STATE_RUNNING:
                     // Update WiFi RSSI for status display
@@ -656,14 +1003,44 @@ void app_main(void)
             }
         }
 
+        // Button presses posted by the ISR
+        uint32_t button_ms = process_button(now_ms);
+
         // Check brightness every ~10 seconds
-        if (loop_count % 1000 == 0) {
+        if ((int32_t)(now_ms - next_brightness_ms) >= 0) {
+            next_brightness_ms = now_ms + BRIGHTNESS_CHECK_MS;
             update_brightness_for_time();
+            check_night_sleep();
         }
 
-        loop_count++;
+        // Update LVGL (handles animations, rendering, pending scene/realtime
+        // updates); after the jobs above so their changes draw straight away
+        uint32_t wait_ms = lcd_update();
+        if (button_ms < wait_ms) wait_ms = button_ms;
 
-        // Fixed 10ms tick for consistent animation speed
-        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(10));
+        // Start, retarget or stop fetching for the view now shown (posted by
+        // a button press or the first-fetch boot stage)
+        int switch_from = __atomic_exchange_n(&source_switch_from, -1, __ATOMIC_ACQ_REL);
+        if (switch_from >= 0) {
+            switch_view_data_source((view_id_t)switch_from, lcd_get_current_view());
+        }
+
+        // Update LED status animation
+        uint32_t led_ms = rgb_led_update();
+        if (led_ms < wait_ms) wait_ms = led_ms;
+
+        // Departure timeline on the LED strip (if fitted)
+        uint32_t strip_ms = led_timeline_update();
+        if (strip_ms < wait_ms) wait_ms = strip_ms;
+
+        // Sleep until the earliest deadline (power_loop_wait clamps it)
+        uint32_t deadlines[] = { next_status_ms, next_brightness_ms, ap_info_until_ms };
+        for (int i = 0; i < (int)(sizeof(deadlines) / sizeof(deadlines[0])); i++) {
+            if (!deadlines[i]) continue;
+            int32_t left = (int32_t)(deadlines[i] - now_ms);
+            if (left < 0) left = 0;
+            if ((uint32_t)left < wait_ms) wait_ms = (uint32_t)left;
+        }
+        power_loop_wait(wait_ms);
     }
 }
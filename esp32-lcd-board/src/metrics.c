@@ -0,0 +1,306 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+
+#include "metrics.h"
+#include "render_perf.h"
+#include "spi_arbiter.h"
+#include "boot_pipeline.h"
+#include "wifi_manager.h"
+
+typedef struct {
+    const char *name;
+    const char *labels;     // Without braces, NULL for none
+    const char *help;
+} metric_desc_t;
+
+// Entries sharing a name must be adjacent (HELP/TYPE is written once)
+static const metric_desc_t counter_desc[METRIC_COUNTER_COUNT] = {
+    [MET_TFNSW_FETCH_TOTAL]          = { "tfnsw_fetch_total", NULL, "TfNSW departure requests started" },
+    [MET_TFNSW_FETCH_ERRORS_TOTAL]   = { "tfnsw_fetch_errors_total", NULL, "TfNSW requests that failed before an HTTP status" },
+    [MET_TFNSW_HTTP_2XX]             = { "tfnsw_http_responses_total", "class=\"2xx\"", "TfNSW HTTP responses by status class" },
+    [MET_TFNSW_HTTP_3XX]             = { "tfnsw_http_responses_total", "class=\"3xx\"", NULL },
+    [MET_TFNSW_HTTP_4XX]             = { "tfnsw_http_responses_total", "class=\"4xx\"", NULL },
+    [MET_TFNSW_HTTP_5XX]             = { "tfnsw_http_responses_total", "class=\"5xx\"", NULL },
+    [MET_TFNSW_RESPONSE_BYTES_TOTAL] = { "tfnsw_response_bytes_total", NULL, "TfNSW response body bytes received" },
+    [MET_TFNSW_PARSE_FAILURES_TOTAL] = { "tfnsw_parse_failures_total", NULL, "TfNSW responses that failed to parse" },
+    [MET_WIFI_DISCONNECTS_TOTAL]     = { "wifi_disconnects_total", NULL, "Established WiFi connections lost" },
+};
+
+static const metric_desc_t gauge_desc[METRIC_GAUGE_COUNT] = {
+    [MET_TFNSW_LAST_RESPONSE_BYTES] = { "tfnsw_last_response_bytes", NULL, "Size of the last TfNSW response body" },
+};
+
+static const metric_desc_t hist_desc[METRIC_HIST_COUNT] = {
+    [MET_FETCH_CONNECT_MS]  = { "tfnsw_fetch_phase_ms", "phase=\"connect\"", "TfNSW request time by phase (ms)" },
+    [MET_FETCH_WAIT_MS]     = { "tfnsw_fetch_phase_ms", "phase=\"wait\"", NULL },
+    [MET_FETCH_DOWNLOAD_MS] = { "tfnsw_fetch_phase_ms", "phase=\"download\"", NULL },
+    [MET_FETCH_PARSE_MS]    = { "tfnsw_fetch_phase_ms", "phase=\"parse\"", NULL },
+    [MET_WIFI_CONNECT_DIRECTED_MS] = { "wifi_connect_ms", "path=\"cached\"", "WiFi connect attempt to IP address (ms)" },
+    [MET_WIFI_CONNECT_SCAN_MS]     = { "wifi_connect_ms", "path=\"scan\"", NULL },
+};
+
+static const uint32_t hist_bounds[METRIC_HIST_BUCKETS] = {
+    10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000
+};
+
+typedef struct {
+    uint32_t buckets[METRIC_HIST_BUCKETS + 1];  // Non-cumulative, last is +Inf
+    uint32_t count;
+    uint32_t sum;
+} metric_hist_data_t;
+
+static uint32_t counters[METRIC_COUNTER_COUNT];
+static int32_t gauges[METRIC_GAUGE_COUNT];
+static metric_hist_data_t hists[METRIC_HIST_COUNT];
+
+// Tasks whose stack high-water mark is reported (missing ones are skipped)
+static const char *stack_tasks[] = {
+    "main", "httpd", "tfnsw_single", "tfnsw_fetch",
+    "display_mirror", "event_stream", "lan_hub", "lan_follower",
+};
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+void metrics_inc(metric_counter_t counter)
+{
+    metrics_add(counter, 1);
+}
+
+void metrics_add(metric_counter_t counter, uint32_t value)
+{
+    if (counter >= METRIC_COUNTER_COUNT) return;
+    __atomic_fetch_add(&counters[counter], value, __ATOMIC_RELAXED);
+}
+
+void metrics_set(metric_gauge_t gauge, int32_t value)
+{
+    if (gauge >= METRIC_GAUGE_COUNT) return;
+    __atomic_store_n(&gauges[gauge], value, __ATOMIC_RELAXED);
+}
+
+void metrics_observe(metric_hist_t hist, uint32_t value_ms)
+{
+    if (hist >= METRIC_HIST_COUNT) return;
+
+    int bucket = 0;
+    while (bucket < METRIC_HIST_BUCKETS && value_ms > hist_bounds[bucket]) {
+        bucket++;
+    }
+    metric_hist_data_t *h = &hists[hist];
+    __atomic_fetch_add(&h->buckets[bucket], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->sum, value_ms, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+}
+
+void metrics_count_http_status(int status_code)
+{
+    int class = status_code / 100;
+    if (class < 2 || class > 5) return;
+    metrics_inc((metric_counter_t)(MET_TFNSW_HTTP_2XX + (class - 2)));
+}
+
+// ============================================================================
+// Prometheus Export
+// ============================================================================
+
+typedef struct {
+    httpd_req_t *req;
+    esp_err_t err;
+    size_t len;
+    char buf[512];
+} metrics_out_t;
+
+static void out_flush(metrics_out_t *out)
+{
+    if (out->len > 0 && out->err == ESP_OK) {
+        out->err = httpd_resp_send_chunk(out->req, out->buf, out->len);
+    }
+    out->len = 0;
+}
+
+static void out_printf(metrics_out_t *out, const char *fmt, ...)
+{
+    char line[160];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (n <= 0) return;
+    if (n >= (int)sizeof(line)) n = sizeof(line) - 1;
+
+    if (out->len + n > sizeof(out->buf)) {
+        out_flush(out);
+    }
+    memcpy(out->buf + out->len, line, n);
+    out->len += n;
+}
+
+static void out_header(metrics_out_t *out, const char *name, const char *type, const char *help)
+{
+    out_printf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+// Family header only for the first entry of each name
+static void out_desc_header(metrics_out_t *out, const metric_desc_t *desc, int index, const char *type)
+{
+    if (index == 0 || strcmp(desc[index - 1].name, desc[index].name) != 0) {
+        out_header(out, desc[index].name, type, desc[index].help ? desc[index].help : "");
+    }
+}
+
+static void out_sample(metrics_out_t *out, const char *name, const char *suffix,
+                       const char *labels, const char *extra, long long value)
+{
+    const char *sep = (labels && extra) ? "," : "";
+    if (labels || extra) {
+        out_printf(out, "%s%s{%s%s%s} %lld\n", name, suffix, labels ? labels : "", sep,
+                   extra ? extra : "", value);
+    } else {
+        out_printf(out, "%s%s %lld\n", name, suffix, value);
+    }
+}
+
+// Render profiler histograms use power-of-two buckets (see render_perf.h)
+static void out_perf_hist(metrics_out_t *out, const char *name, const char *labels, const perf_hist_t *h)
+{
+    uint32_t cumulative = 0;
+    for (int i = 0; i < PERF_HIST_BUCKETS; i++) {
+        cumulative += h->buckets[i];
+        uint32_t limit = render_perf_bucket_limit(i);
+        char le[24];
+        if (limit == UINT32_MAX) {
+            snprintf(le, sizeof(le), "le=\"+Inf\"");
+        } else {
+            snprintf(le, sizeof(le), "le=\"%lu\"", (unsigned long)limit);
+        }
+        out_sample(out, name, "_bucket", labels, le, cumulative);
+    }
+    out_sample(out, name, "_sum", labels, NULL, (long long)h->sum);
+    out_sample(out, name, "_count", labels, NULL, h->count);
+}
+
+esp_err_t metrics_export(httpd_req_t *req)
+{
+    metrics_out_t *out = malloc(sizeof(metrics_out_t));
+    render_perf_snapshot_t *perf = malloc(sizeof(render_perf_snapshot_t));
+    if (!out || !perf) {
+        free(out);
+        free(perf);
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        return ESP_FAIL;
+    }
+    out->req = req;
+    out->err = ESP_OK;
+    out->len = 0;
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+
+    // Registry
+    for (int i = 0; i < METRIC_COUNTER_COUNT; i++) {
+        out_desc_header(out, counter_desc, i, "counter");
+        out_sample(out, counter_desc[i].name, "", counter_desc[i].labels, NULL,
+                   __atomic_load_n(&counters[i], __ATOMIC_RELAXED));
+    }
+    for (int i = 0; i < METRIC_GAUGE_COUNT; i++) {
+        out_desc_header(out, gauge_desc, i, "gauge");
+        out_sample(out, gauge_desc[i].name, "", gauge_desc[i].labels, NULL,
+                   __atomic_load_n(&gauges[i], __ATOMIC_RELAXED));
+    }
+    for (int i = 0; i < METRIC_HIST_COUNT; i++) {
+        out_desc_header(out, hist_desc, i, "histogram");
+        const metric_hist_data_t *h = &hists[i];
+        uint32_t cumulative = 0;
+        for (int b = 0; b <= METRIC_HIST_BUCKETS; b++) {
+            char le[24];
+            cumulative += __atomic_load_n(&h->buckets[b], __ATOMIC_RELAXED);
+            if (b < METRIC_HIST_BUCKETS) {
+                snprintf(le, sizeof(le), "le=\"%lu\"", (unsigned long)hist_bounds[b]);
+            } else {
+                snprintf(le, sizeof(le), "le=\"+Inf\"");
+            }
+            out_sample(out, hist_desc[i].name, "_bucket", hist_desc[i].labels, le, cumulative);
+        }
+        out_sample(out, hist_desc[i].name, "_sum", hist_desc[i].labels, NULL,
+                   __atomic_load_n(&h->sum, __ATOMIC_RELAXED));
+        out_sample(out, hist_desc[i].name, "_count", hist_desc[i].labels, NULL,
+                   __atomic_load_n(&h->count, __ATOMIC_RELAXED));
+    }
+
+    // System gauges sampled now
+    out_header(out, "uptime_seconds", "gauge", "Time since boot");
+    out_sample(out, "uptime_seconds", "", NULL, NULL, esp_timer_get_time() / 1000000);
+    out_header(out, "heap_free_bytes", "gauge", "Free heap");
+    out_sample(out, "heap_free_bytes", "", NULL, NULL, esp_get_free_heap_size());
+    out_header(out, "heap_min_free_bytes", "gauge", "Lowest free heap since boot");
+    out_sample(out, "heap_min_free_bytes", "", NULL, NULL, esp_get_minimum_free_heap_size());
+    out_header(out, "heap_largest_block_bytes", "gauge", "Largest allocatable 8-bit block");
+    out_sample(out, "heap_largest_block_bytes", "", NULL, NULL,
+               heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+    if (wifi_is_connected()) {
+        out_header(out, "wifi_rssi_dbm", "gauge", "WiFi signal strength");
+        out_sample(out, "wifi_rssi_dbm", "", NULL, NULL, wifi_get_rssi());
+    }
+
+    out_header(out, "task_stack_free_min_bytes", "gauge", "Task stack high-water mark (unused bytes)");
+    for (size_t i = 0; i < sizeof(stack_tasks) / sizeof(stack_tasks[0]); i++) {
+        TaskHandle_t task = xTaskGetHandle(stack_tasks[i]);
+        if (!task) continue;
+        char label[40];
+        snprintf(label, sizeof(label), "task=\"%s\"", stack_tasks[i]);
+        out_sample(out, "task_stack_free_min_bytes", "", label, NULL, uxTaskGetStackHighWaterMark(task));
+    }
+
+    // Render timings from the profiler
+    render_perf_get_snapshot(perf);
+    out_header(out, "lcd_frame_us", "histogram", "LVGL frame render + flush time (us)");
+    out_perf_hist(out, "lcd_frame_us", NULL, &perf->metrics[PERF_FRAME_US]);
+    out_header(out, "lcd_flush_us", "histogram", "Single panel flush submit time (us)");
+    out_perf_hist(out, "lcd_flush_us", NULL, &perf->metrics[PERF_FLUSH_US]);
+    out_header(out, "lcd_view_rebuild_us", "histogram", "View widget tree rebuild time (us)");
+    for (int i = 0; i < VIEW_COUNT; i++) {
+        char label[16];
+        snprintf(label, sizeof(label), "view=\"%d\"", i);
+        out_perf_hist(out, "lcd_view_rebuild_us", label, &perf->view_rebuild_us[i]);
+    }
+    free(perf);
+
+    // LCD / SD bus sharing
+    spi_arbiter_stats_t arb;
+    spi_arbiter_get_stats(&arb);
+    out_header(out, "spi_sd_slices_total", "counter", "SD block I/O slices run on the shared SPI bus");
+    out_sample(out, "spi_sd_slices_total", "", NULL, NULL, arb.sd_slices);
+    out_header(out, "spi_sd_forced_slices_total", "counter", "SD slices started while the LCD was still busy");
+    out_sample(out, "spi_sd_forced_slices_total", "", NULL, NULL, arb.sd_forced);
+    out_header(out, "lcd_frames_delayed_by_sd_total", "counter", "Frames that started during an SD slice");
+    out_sample(out, "lcd_frames_delayed_by_sd_total", "", NULL, NULL, arb.frames_delayed);
+    out_header(out, "spi_sd_wait_us_total", "counter", "Time SD slices waited for a gap between frames (us)");
+    out_sample(out, "spi_sd_wait_us_total", "", NULL, NULL, (long long)arb.sd_wait_total_us);
+    out_header(out, "spi_sd_slice_max_us", "gauge", "Longest SD slice holding the bus (us)");
+    out_sample(out, "spi_sd_slice_max_us", "", NULL, NULL, arb.sd_hold_max_us);
+
+    out_header(out, "boot_stage_done_ms", "gauge", "Time since reset when each boot stage finished (ms)");
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++) {
+        boot_stage_info_t stage;
+        boot_get_stage((boot_stage_id_t)i, &stage);
+        if (stage.state != BOOT_STATE_DONE) continue;
+        char labels[40];
+        snprintf(labels, sizeof(labels), "stage=\"%s\"", boot_stage_name((boot_stage_id_t)i));
+        out_sample(out, "boot_stage_done_ms", "", labels, NULL, stage.end_us / 1000);
+    }
+
+    out_flush(out);
+    esp_err_t err = out->err;
+    if (err == ESP_OK) {
+        err = httpd_resp_send_chunk(req, NULL, 0);
+    }
+    free(out);
+    return err;
+}
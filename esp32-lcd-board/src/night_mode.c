@@ -0,0 +1,241 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "esp_rom_crc.h"
+
+#include "night_mode.h"
+#include "departure_cache.h"
+#include "lan_proto.h"
+
+static const char *TAG = "night";
+
+#define NIGHT_RTC_MAGIC     0x5448474eu     // "NGHT"
+#define NIGHT_RTC_VERSION   1
+
+// Kept in RTC memory through deep sleep. RTC data is zeroed on power-up but
+// survives resets, so it is only trusted on a timer wake with a good CRC.
+typedef struct {
+    uint32_t magic;
+    uint32_t crc;               // From version to the end of the snapshot
+    uint8_t version;
+    uint8_t view;
+    uint8_t clock_synced;
+    uint8_t reserved;
+    int64_t slept_at;           // Unix s
+    int64_t wake_at;
+    uint16_t snapshot_len;      // lan_encode_snapshot() frame, 0 if none
+    uint8_t snapshot[LAN_FRAME_MAX];
+} night_rtc_t;
+
+static RTC_DATA_ATTR night_rtc_t rtc_state;
+static RTC_DATA_ATTR uint32_t nights = 0;
+
+static bool woke = false;
+
+// Overnight break seen in the latest fetch for break_stop
+static portMUX_TYPE break_lock = portMUX_INITIALIZER_UNLOCKED;
+static char break_stop[16] = "";
+static int64_t last_service = 0;
+static int64_t first_service = 0;
+static int64_t noted_at = 0;
+static int64_t activity_at = 0;
+
+// ============================================================================
+// RTC State
+// ============================================================================
+
+static uint32_t rtc_crc(void)
+{
+    const uint8_t *start = (const uint8_t *)&rtc_state + offsetof(night_rtc_t, version);
+    size_t len = offsetof(night_rtc_t, snapshot) - offsetof(night_rtc_t, version);
+    if (rtc_state.snapshot_len <= sizeof(rtc_state.snapshot)) {
+        len += rtc_state.snapshot_len;
+    }
+    return esp_rom_crc32_le(0, start, len);
+}
+
+static bool rtc_valid(void)
+{
+    return rtc_state.magic == NIGHT_RTC_MAGIC && rtc_state.version == NIGHT_RTC_VERSION &&
+           rtc_state.snapshot_len <= sizeof(rtc_state.snapshot) && rtc_state.crc == rtc_crc();
+}
+
+void night_init(void)
+{
+    woke = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER && rtc_valid();
+    if (woke) {
+        ESP_LOGI(TAG, "Woke from night %lu after %lld min", (unsigned long)nights,
+                 (long long)((time(NULL) - rtc_state.slept_at) / 60));
+    } else {
+        // A reset during the day must not bring back last night's snapshot
+        rtc_state.magic = 0;
+    }
+}
+
+bool night_woke_from_sleep(void)
+{
+    return woke;
+}
+
+bool night_clock_valid(void)
+{
+    return woke && rtc_state.clock_synced;
+}
+
+esp_err_t night_restore_snapshot(view_id_t* view, tfnsw_departures_t* out)
+{
+    if (!view || !out) return ESP_ERR_INVALID_ARG;
+    if (!woke || rtc_state.snapshot_len < 3) return ESP_ERR_NOT_FOUND;
+
+    // Frame: u16 length, u8 type, snapshot payload
+    const uint8_t *p = rtc_state.snapshot;
+    size_t frame_len = p[0] | ((size_t)p[1] << 8);
+    char stop_id[16];
+    uint32_t version;
+    if (frame_len != (size_t)rtc_state.snapshot_len - 2 || p[2] != LAN_MSG_SNAPSHOT ||
+        !lan_decode_snapshot(p + 3, rtc_state.snapshot_len - 3, stop_id, sizeof(stop_id),
+                             &version, out)) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    *view = (view_id_t)rtc_state.view;
+
+    // The night itself does not count against the cache age limit
+    int64_t slept_s = time(NULL) - rtc_state.slept_at;
+    return departures_cache_mark(out, (slept_s > 0 ? slept_s : 0) + DEPARTURES_CACHE_MAX_AGE_S);
+}
+
+// ============================================================================
+// Service Break
+// ============================================================================
+
+void night_note_departures(const char* stop_id, const tfnsw_departures_t* departures)
+{
+    if (!stop_id || !departures || departures->status != TFNSW_STATUS_SUCCESS) return;
+
+    // Departure times in order (realtime where known, like the cache)
+    int64_t when[TFNSW_MAX_DEPARTURES];
+    int n = 0;
+    for (int i = 0; i < departures->count && i < TFNSW_MAX_DEPARTURES; i++) {
+        const tfnsw_departure_t *d = &departures->departures[i];
+        int64_t t = d->is_realtime && d->estimated_time > 0 ? d->estimated_time : d->scheduled_time;
+        if (d->is_cancelled || t <= 0) continue;
+        int j = n++;
+        while (j > 0 && when[j - 1] > t) {
+            when[j] = when[j - 1];
+            j--;
+        }
+        when[j] = t;
+    }
+
+    // First gap long enough to be the overnight break; a gap starting now
+    // means the last service has already gone
+    int64_t now = time(NULL);
+    int64_t prev = now;
+    int64_t last = 0, first = 0;
+    for (int i = 0; i < n; i++) {
+        if (when[i] - prev >= NIGHT_GAP_MIN_S) {
+            first = when[i];
+            last = i > 0 ? when[i - 1] : 0;
+            break;
+        }
+        prev = when[i];
+    }
+
+    portENTER_CRITICAL(&break_lock);
+    bool same_stop = strcmp(break_stop, stop_id) == 0;
+    if (!same_stop) {
+        strncpy(break_stop, stop_id, sizeof(break_stop) - 1);
+        break_stop[sizeof(break_stop) - 1] = '\0';
+    }
+    if (first && !last && same_stop && last_service && last_service < first) {
+        last = last_service;    // Seen before the break started
+    }
+    last_service = last;
+    first_service = first;
+    noted_at = now;
+    portEXIT_CRITICAL(&break_lock);
+}
+
+void night_note_activity(void)
+{
+    portENTER_CRITICAL(&break_lock);
+    activity_at = time(NULL);
+    portEXIT_CRITICAL(&break_lock);
+}
+
+int64_t night_sleep_due(const char* stop_id)
+{
+    if (!stop_id) return 0;
+    int64_t now = time(NULL);
+
+    portENTER_CRITICAL(&break_lock);
+    bool same_stop = strcmp(break_stop, stop_id) == 0;
+    int64_t last = last_service, first = first_service;
+    int64_t noted = noted_at, activity = activity_at;
+    portEXIT_CRITICAL(&break_lock);
+
+    if (!same_stop || !first || now - noted > NIGHT_FRESH_S) return 0;
+    if (activity && now - activity < NIGHT_ACTIVITY_HOLD_S) return 0;
+    if (last && now < last + NIGHT_AFTER_LAST_S) return 0;
+
+    int64_t wake_at = first - NIGHT_WAKE_LEAD_S;
+    return wake_at - now >= NIGHT_MIN_SLEEP_S ? wake_at : 0;
+}
+
+// ============================================================================
+// Sleep
+// ============================================================================
+
+esp_err_t night_sleep_until(int64_t wake_at, view_id_t view, const char* stop_id,
+                            bool clock_synced)
+{
+    int64_t now = time(NULL);
+    if (wake_at <= now) return ESP_ERR_INVALID_ARG;
+
+    // The fetch just before sleeping already lists the first morning services
+    rtc_state.snapshot_len = 0;
+    tfnsw_departures_t *deps = malloc(sizeof(tfnsw_departures_t));
+    if (deps && stop_id && tfnsw_get_stop_snapshot(stop_id, deps, NULL) == ESP_OK) {
+        rtc_state.snapshot_len = (uint16_t)lan_encode_snapshot(rtc_state.snapshot,
+                                                               sizeof(rtc_state.snapshot),
+                                                               stop_id, 0, deps);
+    }
+    free(deps);
+
+    rtc_state.version = NIGHT_RTC_VERSION;
+    rtc_state.view = (uint8_t)view;
+    rtc_state.clock_synced = clock_synced;
+    rtc_state.slept_at = now;
+    rtc_state.wake_at = wake_at;
+    rtc_state.crc = rtc_crc();
+    rtc_state.magic = NIGHT_RTC_MAGIC;
+
+    esp_err_t err = esp_sleep_enable_timer_wakeup((uint64_t)(wake_at - now) * 1000000ULL);
+    if (err != ESP_OK) {
+        rtc_state.magic = 0;
+        ESP_LOGE(TAG, "Cannot set wake timer: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    nights++;
+    ESP_LOGI(TAG, "Deep sleep for %lld min (snapshot %u bytes)",
+             (long long)((wake_at - now) / 60), rtc_state.snapshot_len);
+    esp_deep_sleep_start();
+    return ESP_FAIL;
+}
+
+void night_get_status(night_status_t* out)
+{
+    if (!out) return;
+    portENTER_CRITICAL(&break_lock);
+    out->last_service = last_service;
+    out->first_service = first_service;
+    portEXIT_CRITICAL(&break_lock);
+    out->woke_from_sleep = woke;
+    out->nights = nights;
+}
@@ -0,0 +1,260 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_wifi.h"
+
+#include "power_mgmt.h"
+#include "lcd_driver.h"
+#include "json_writer.h"
+
+static const char *TAG = "power";
+
+static bool light_sleep = false;
+static TaskHandle_t loop_task = NULL;
+
+// Added by the light sleep exit hook (interrupts are off there, and a
+// critical section keeps readers from seeing half an update)
+static volatile int64_t slept_us_total = 0;
+
+typedef struct {
+    int64_t total_us;
+    int64_t slept_us;
+    int64_t backlight_pct_us;   // Backlight percent x time
+} power_bucket_t;
+
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static power_bucket_t overall;
+static power_bucket_t per_view[VIEW_COUNT];
+static int current_view = -1;
+static uint8_t current_backlight = 0;
+static int64_t window_start_us = 0;
+static int64_t last_us = 0;
+static int64_t last_slept_us = 0;
+
+// ============================================================================
+// Light Sleep Accounting
+// ============================================================================
+
+#ifdef CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+static esp_err_t IRAM_ATTR on_sleep_exit(int64_t sleep_time_us, void *arg)
+{
+    (void)arg;
+    slept_us_total += sleep_time_us;
+    return ESP_OK;
+}
+#endif
+
+// Close the interval since the last call against the current view and
+// backlight level. Call with stats_lock held.
+static void account_locked(int64_t now)
+{
+    int64_t dt = now - last_us;
+    int64_t slept = slept_us_total - last_slept_us;
+    last_us = now;
+    last_slept_us = slept_us_total;
+    if (dt <= 0) return;
+    if (slept > dt) slept = dt;
+
+    power_bucket_t *buckets[2] = { &overall, NULL };
+    if (current_view >= 0 && current_view < VIEW_COUNT) {
+        buckets[1] = &per_view[current_view];
+    }
+    for (int i = 0; i < 2; i++) {
+        if (!buckets[i]) continue;
+        buckets[i]->total_us += dt;
+        buckets[i]->slept_us += slept;
+        buckets[i]->backlight_pct_us += dt * current_backlight;
+    }
+}
+
+static float estimate_ma(const power_bucket_t *b)
+{
+    if (b->total_us <= 0) return 0.0f;
+    float sleep_frac = (float)b->slept_us / (float)b->total_us;
+    float backlight_frac = (float)b->backlight_pct_us / (float)b->total_us / 100.0f;
+    return POWER_EST_AWAKE_MA * (1.0f - sleep_frac) +
+           POWER_EST_SLEEP_MA * sleep_frac +
+           POWER_EST_PANEL_MA +
+           POWER_EST_BACKLIGHT_MA * backlight_frac;
+}
+
+void power_note_view(int view)
+{
+    portENTER_CRITICAL(&stats_lock);
+    account_locked(esp_timer_get_time());
+    current_view = view;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+void power_note_backlight(uint8_t percent)
+{
+    portENTER_CRITICAL(&stats_lock);
+    account_locked(esp_timer_get_time());
+    current_backlight = percent > 100 ? 100 : percent;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+void power_reset_stats(void)
+{
+    portENTER_CRITICAL(&stats_lock);
+    memset(&overall, 0, sizeof(overall));
+    memset(per_view, 0, sizeof(per_view));
+    window_start_us = last_us = esp_timer_get_time();
+    last_slept_us = slept_us_total;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+// ============================================================================
+// Mode
+// ============================================================================
+
+static esp_err_t apply_mode(bool enable)
+{
+#ifdef CONFIG_PM_ENABLE
+    esp_pm_config_t cfg = {
+        .max_freq_mhz = POWER_CPU_MAX_MHZ,
+        .min_freq_mhz = enable ? POWER_CPU_MIN_MHZ : POWER_CPU_MAX_MHZ,
+        .light_sleep_enable = enable,
+    };
+    esp_err_t err = esp_pm_configure(&cfg);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_pm_configure failed: %s", esp_err_to_name(err));
+        return err;
+    }
+#else
+    if (enable) {
+        ESP_LOGW(TAG, "Built without CONFIG_PM_ENABLE; power save unavailable");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+#endif
+
+    if (enable) {
+        // Light sleep needs modem sleep; MIN_MODEM wakes for every DTIM beacon
+        esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+        // The backlight PWM runs from RC_FAST, which must stay up while asleep
+        esp_sleep_pd_config(ESP_PD_DOMAIN_RC_FAST, ESP_PD_OPTION_ON);
+    }
+
+    light_sleep = enable;
+    ESP_LOGI(TAG, "%s (CPU %d-%d MHz)", enable ? "Power save: light sleep + DFS" : "Full speed",
+             enable ? POWER_CPU_MIN_MHZ : POWER_CPU_MAX_MHZ, POWER_CPU_MAX_MHZ);
+    return ESP_OK;
+}
+
+esp_err_t power_init(bool enable)
+{
+#ifdef CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+    static bool hooked = false;
+    if (!hooked) {
+        esp_pm_sleep_cbs_register_config_t cbs = {
+            .exit_cb = on_sleep_exit,
+        };
+        hooked = esp_pm_light_sleep_register_cbs(&cbs) == ESP_OK;
+    }
+#endif
+    power_reset_stats();
+    return apply_mode(enable);
+}
+
+esp_err_t power_set_light_sleep(bool enable)
+{
+    if (enable == light_sleep) return ESP_OK;
+    return apply_mode(enable);
+}
+
+bool power_light_sleep_enabled(void)
+{
+    return light_sleep;
+}
+
+// ============================================================================
+// Main Loop Pacing
+// ============================================================================
+
+void power_loop_wait(uint32_t timeout_ms)
+{
+    if (!loop_task) {
+        loop_task = xTaskGetCurrentTaskHandle();
+    }
+    if (timeout_ms < POWER_LOOP_MIN_MS) timeout_ms = POWER_LOOP_MIN_MS;
+    if (timeout_ms > POWER_LOOP_MAX_MS) timeout_ms = POWER_LOOP_MAX_MS;
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms));
+}
+
+void power_loop_wake(void)
+{
+    TaskHandle_t task = loop_task;
+    if (!task) return;
+    if (xPortInIsrContext()) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(task, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        xTaskNotifyGive(task);
+    }
+}
+
+// ============================================================================
+// Export
+// ============================================================================
+
+static void write_bucket(json_writer_t *w, const power_bucket_t *b)
+{
+    jw_number(w, "seconds", (double)(b->total_us / 1000) / 1000.0);
+    jw_number(w, "sleep_pct", b->total_us > 0 ? 100.0 * (double)b->slept_us / (double)b->total_us : 0.0);
+    jw_number(w, "est_ma", estimate_ma(b));
+}
+
+esp_err_t power_export(httpd_req_t *req)
+{
+    power_bucket_t all;
+    power_bucket_t views[VIEW_COUNT];
+    int64_t window_us;
+
+    portENTER_CRITICAL(&stats_lock);
+    int64_t now = esp_timer_get_time();
+    account_locked(now);
+    all = overall;
+    memcpy(views, per_view, sizeof(views));
+    window_us = now - window_start_us;
+    portEXIT_CRITICAL(&stats_lock);
+
+    json_writer_t w;
+    jw_begin(&w, req, false);
+    jw_object_begin(&w, NULL);
+    jw_string(&w, "mode", light_sleep ? "light_sleep" : "full_speed");
+#ifdef CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+    jw_bool(&w, "sleep_measured", true);
+#else
+    jw_bool(&w, "sleep_measured", false);
+#endif
+    jw_number(&w, "window_s", (double)(window_us / 1000000));
+    write_bucket(&w, &all);
+
+    jw_object_begin(&w, "model_ma");
+    jw_number(&w, "awake", POWER_EST_AWAKE_MA);
+    jw_number(&w, "sleep", POWER_EST_SLEEP_MA);
+    jw_number(&w, "panel", POWER_EST_PANEL_MA);
+    jw_number(&w, "backlight_full", POWER_EST_BACKLIGHT_MA);
+    jw_object_end(&w);
+
+    jw_array_begin(&w, "views");
+    for (int i = 0; i < VIEW_COUNT; i++) {
+        if (views[i].total_us <= 0) continue;
+        const view_config_t *config = lcd_get_view_config((view_id_t)i);
+        jw_object_begin(&w, NULL);
+        jw_number(&w, "view", i);
+        jw_string(&w, "name", config ? config->name : "?");
+        write_bucket(&w, &views[i]);
+        jw_object_end(&w);
+    }
+    jw_array_end(&w);
+
+    jw_object_end(&w);
+    return jw_finish(&w);
+}
@@ -0,0 +1,88 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+
+#include "render_perf.h"
+
+// Stats are written from the main loop (lcd_update / flush_cb) and read from
+// the HTTP server task, so every access goes through one short critical section.
+static portMUX_TYPE perf_lock = portMUX_INITIALIZER_UNLOCKED;
+static render_perf_snapshot_t stats;
+
+static const char *metric_names[PERF_METRIC_COUNT] = {
+    [PERF_FRAME_US]   = "frame_us",
+    [PERF_FLUSH_US]   = "flush_us",
+    [PERF_FLUSH_PX]   = "flush_px",
+    [PERF_FRAME_PX]   = "frame_px",
+    [PERF_INVALID_PX] = "invalid_px",
+};
+
+// ============================================================================
+// Histogram Helpers
+// ============================================================================
+
+static inline int bucket_for(uint32_t value)
+{
+    if (value == 0) return 0;
+    int bucket = 32 - __builtin_clz(value);
+    return bucket < PERF_HIST_BUCKETS ? bucket : PERF_HIST_BUCKETS - 1;
+}
+
+static inline void hist_add(perf_hist_t *h, uint32_t value)
+{
+    if (h->count == 0 || value < h->min) h->min = value;
+    if (value > h->max) h->max = value;
+    h->count++;
+    h->sum += value;
+    h->buckets[bucket_for(value)]++;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void render_perf_record(perf_metric_t metric, uint32_t value)
+{
+    if (metric >= PERF_METRIC_COUNT) return;
+    portENTER_CRITICAL(&perf_lock);
+    hist_add(&stats.metrics[metric], value);
+    portEXIT_CRITICAL(&perf_lock);
+}
+
+void render_perf_record_view(view_id_t view, uint32_t us)
+{
+    if (view >= VIEW_COUNT) return;
+    portENTER_CRITICAL(&perf_lock);
+    hist_add(&stats.view_rebuild_us[view], us);
+    portEXIT_CRITICAL(&perf_lock);
+}
+
+void render_perf_get_snapshot(render_perf_snapshot_t *out)
+{
+    if (!out) return;
+    portENTER_CRITICAL(&perf_lock);
+    memcpy(out, &stats, sizeof(stats));
+    portEXIT_CRITICAL(&perf_lock);
+}
+
+void render_perf_reset(void)
+{
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    portENTER_CRITICAL(&perf_lock);
+    memset(&stats, 0, sizeof(stats));
+    stats.since_ms = now_ms;
+    portEXIT_CRITICAL(&perf_lock);
+}
+
+const char* render_perf_metric_name(perf_metric_t metric)
+{
+    if (metric >= PERF_METRIC_COUNT) return "unknown";
+    return metric_names[metric];
+}
+
+uint32_t render_perf_bucket_limit(int bucket)
+{
+    if (bucket <= 0) return 0;
+    if (bucket >= PERF_HIST_BUCKETS - 1) return UINT32_MAX;
+    return (1UL << bucket) - 1;
+}
@@ -13,6 +13,10 @@ static led_strip_handle_t led_strip = NULL;
 // Manual color mode - when true, rgb_led_update() does nothing
 static bool manual_color_mode = false;
 
+// Last colour sent, so unchanged colours don't cost an RMT transfer
+static uint32_t shown_rgb = 0;
+static bool shown_valid = false;
+
 esp_err_t rgb_led_init(void)
 {
     ESP_LOGI(TAG, "Initializing RGB LED on GPIO %d", RGB_LED_PIN);
@@ -50,6 +54,9 @@ void rgb_led_set_color(uint8_t red, uint8_t green, uint8_t blue)
 {
     if (!led_strip) return;
 
+    uint32_t rgb = ((uint32_t)red << 16) | ((uint32_t)green << 8) | blue;
+    if (shown_valid && rgb == shown_rgb) return;
+
     esp_err_t ret = led_strip_set_pixel(led_strip, 0, red, green, blue);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set pixel: %s", esp_err_to_name(ret));
@@ -59,7 +66,11 @@ void rgb_led_set_color(uint8_t red, uint8_t green, uint8_t blue)
     ret = led_strip_refresh(led_strip);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to refresh strip: %s", esp_err_to_name(ret));
+        shown_valid = false;
+        return;
     }
+    shown_rgb = rgb;
+    shown_valid = true;
 }
 
 void rgb_led_set_hex(uint32_t hex_color)
@@ -77,18 +88,18 @@ void rgb_led_set_hex(uint32_t hex_color)
 
 void rgb_led_off(void)
 {
-    if (!led_strip) return;
-    led_strip_clear(led_strip);
-    led_strip_refresh(led_strip);
+    rgb_led_set_color(0, 0, 0);
 }
 
 // ============================================================================
 // Status Indication Patterns
 // ============================================================================
 
+#define SUCCESS_FLASH_MS 500    // Bright green before settling to dim "live"
+
 static led_status_t current_status = LED_STATUS_OFF;
-static uint32_t animation_tick = 0;
-static uint32_t flash_end_tick = 0;
+static TickType_t status_since = 0;
+static TickType_t flash_end_tick = 0;
 static uint32_t flash_color = 0;
 static bool flash_active = false;
 
@@ -96,7 +107,7 @@ void rgb_led_set_status(led_status_t status)
 {
     ESP_LOGI(TAG, "LED status set to %d, manual_mode=false", status);
     current_status = status;
-    animation_tick = 0;
+    status_since = xTaskGetTickCount();
     manual_color_mode = false;  // Exit manual mode
 }
 
@@ -117,24 +128,25 @@ void rgb_led_flash(uint32_t color, int duration_ms)
     rgb_led_set_color(red, green, blue);
 }
 
-void rgb_led_update(void)
+uint32_t rgb_led_update(void)
 {
-    animation_tick++;
-
     // Skip status updates when in manual color mode
     if (manual_color_mode) {
-        return;
+        return UINT32_MAX;
     }
 
     // Handle flash overlay
+    TickType_t now = xTaskGetTickCount();
     if (flash_active) {
-        if (xTaskGetTickCount() >= flash_end_tick) {
+        if ((int32_t)(now - flash_end_tick) >= 0) {
             flash_active = false;
         } else {
-            return;  // Flash overrides normal status
+            return pdTICKS_TO_MS(flash_end_tick - now);  // Flash overrides normal status
         }
     }
 
+    uint32_t next_ms = UINT32_MAX;
+
     switch (current_status) {
         case LED_STATUS_OFF:
             rgb_led_off();
@@ -172,12 +184,17 @@ void rgb_led_update(void)
             rgb_led_set_color(20, 20, 0);  // Yellow
             break;
 
-        case LED_STATUS_SUCCESS_FLASH:
-            rgb_led_set_color(0, 25, 0);  // Green
-            if (animation_tick > 50) {
+        case LED_STATUS_SUCCESS_FLASH: {
+            uint32_t shown_ms = pdTICKS_TO_MS(now - status_since);
+            if (shown_ms >= SUCCESS_FLASH_MS) {
                 current_status = LED_STATUS_LIVE;
+                rgb_led_set_color(0, 15, 0);  // Dim green
+            } else {
+                rgb_led_set_color(0, 25, 0);  // Green
+                next_ms = SUCCESS_FLASH_MS - shown_ms;
             }
             break;
+        }
 
         case LED_STATUS_HIGH_SPEED:
             rgb_led_set_color(25, 0, 25);  // Purple
@@ -187,4 +204,5 @@ void rgb_led_update(void)
             rgb_led_off();
             break;
     }
+    return next_ms;
 }
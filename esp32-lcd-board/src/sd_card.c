@@ -1,20 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_vfs_fat.h"
+#include "diskio_impl.h"
+#include "diskio_sdmmc.h"
 #include "sdmmc_cmd.h"
 #include "driver/sdspi_host.h"
 #include "driver/spi_common.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #include "config.h"
 #include "sd_card.h"
+#include "spi_arbiter.h"
+#include "log_ring.h"
 
 static const char *TAG = "sd_card";
 
 static sdmmc_card_t *card = NULL;
 static bool mounted = false;
 
+// ============================================================================
+// Arbitrated Block I/O
+// ============================================================================
+
+// FATFS reaches the card through these instead of the stock sdmmc diskio:
+// every request is split into slices of SPI_ARB_SD_SLICE_SECTORS and each
+// slice waits for a gap between LCD frames.
+
+static DSTATUS sd_disk_init(unsigned char pdrv)
+{
+    (void)pdrv;
+    return 0;   // Card was initialised by the mount
+}
+
+static DSTATUS sd_disk_status(unsigned char pdrv)
+{
+    (void)pdrv;
+    return 0;
+}
+
+static DRESULT sd_disk_read(unsigned char pdrv, unsigned char *buff, uint32_t sector, unsigned count)
+{
+    (void)pdrv;
+    while (count > 0) {
+        unsigned n = count < SPI_ARB_SD_SLICE_SECTORS ? count : SPI_ARB_SD_SLICE_SECTORS;
+        if (spi_arbiter_sd_begin(SPI_ARB_SD_MAX_WAIT_MS) != ESP_OK) return RES_ERROR;
+        esp_err_t err = sdmmc_read_sectors(card, buff, sector, n);
+        spi_arbiter_sd_end();
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Read of %u sectors at %lu failed: %s", n, (unsigned long)sector,
+                     esp_err_to_name(err));
+            return RES_ERROR;
+        }
+        buff += n * card->csd.sector_size;
+        sector += n;
+        count -= n;
+    }
+    return RES_OK;
+}
+
+static DRESULT sd_disk_write(unsigned char pdrv, const unsigned char *buff, uint32_t sector, unsigned count)
+{
+    (void)pdrv;
+    while (count > 0) {
+        // Multi-sector slices go out as one CMD25 write
+        unsigned n = count < SPI_ARB_SD_SLICE_SECTORS ? count : SPI_ARB_SD_SLICE_SECTORS;
+        if (spi_arbiter_sd_begin(SPI_ARB_SD_MAX_WAIT_MS) != ESP_OK) return RES_ERROR;
+        esp_err_t err = sdmmc_write_sectors(card, buff, sector, n);
+        spi_arbiter_sd_end();
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Write of %u sectors at %lu failed: %s", n, (unsigned long)sector,
+                     esp_err_to_name(err));
+            return RES_ERROR;
+        }
+        buff += n * card->csd.sector_size;
+        sector += n;
+        count -= n;
+    }
+    return RES_OK;
+}
+
+static DRESULT sd_disk_ioctl(unsigned char pdrv, unsigned char cmd, void *buff)
+{
+    (void)pdrv;
+    switch (cmd) {
+        case CTRL_SYNC:
+            return RES_OK;      // Writes complete before sd_disk_write returns
+        case GET_SECTOR_COUNT:
+            *((DWORD *)buff) = card->csd.capacity;
+            return RES_OK;
+        case GET_SECTOR_SIZE:
+            *((WORD *)buff) = card->csd.sector_size;
+            return RES_OK;
+        default:
+            return RES_ERROR;
+    }
+}
+
+static const ff_diskio_impl_t sd_arbitrated_diskio = {
+    .init = sd_disk_init,
+    .status = sd_disk_status,
+    .read = sd_disk_read,
+    .write = sd_disk_write,
+    .ioctl = sd_disk_ioctl,
+};
+
+// ============================================================================
+// Mount
+// ============================================================================
+
 esp_err_t sd_card_init(void)
 {
     ESP_LOGI(TAG, "Initializing SD card...");
@@ -27,18 +127,25 @@ esp_err_t sd_card_init(void)
         .allocation_unit_size = 16 * 1024
     };
 
-    // Note: SD card shares SPI bus with LCD, but uses different CS pin
-    // The SPI bus should already be initialized by LCD driver with MISO pin
+    // SD card shares the LCD's SPI bus (lcd_init() adds the MISO pin) with its
+    // own CS; spi_arbiter keeps card traffic between display frames
 
     sdmmc_host_t host = SDSPI_HOST_DEFAULT();
     host.slot = LCD_HOST;  // Use same SPI host as LCD
+    host.max_freq_khz = SD_SPI_FREQ_KHZ;
 
     sdspi_device_config_t slot_config = SDSPI_DEVICE_CONFIG_DEFAULT();
     slot_config.gpio_cs = SD_PIN_CS;
     slot_config.host_id = host.slot;
 
     ESP_LOGI(TAG, "Mounting SD card at %s...", SD_MOUNT_POINT);
-    esp_err_t ret = esp_vfs_fat_sdspi_mount(SD_MOUNT_POINT, &host, &slot_config, &mount_config, &card);
+    // The mount itself runs through the stock diskio, as one long slice
+    esp_err_t ret = spi_arbiter_sd_begin(SPI_ARB_SD_MAX_WAIT_MS);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = esp_vfs_fat_sdspi_mount(SD_MOUNT_POINT, &host, &slot_config, &mount_config, &card);
+    spi_arbiter_sd_end();
 
     if (ret != ESP_OK) {
         if (ret == ESP_FAIL) {
@@ -53,6 +160,14 @@ esp_err_t sd_card_init(void)
         return ret;
     }
 
+    // From here on FATFS goes through the arbitrated block I/O
+    BYTE pdrv = ff_diskio_get_pdrv_card(card);
+    if (pdrv != 0xFF) {
+        ff_diskio_register(pdrv, &sd_arbitrated_diskio);
+    } else {
+        ESP_LOGW(TAG, "No FATFS drive for card - SD I/O is not arbitrated");
+    }
+
     mounted = true;
 
     // Print card info
@@ -66,6 +181,7 @@ esp_err_t sd_card_deinit(void)
 {
     if (!mounted) return ESP_OK;
 
+    sd_log_flush();
     esp_vfs_fat_sdcard_unmount(SD_MOUNT_POINT, card);
     card = NULL;
     mounted = false;
@@ -192,3 +308,204 @@ esp_err_t sd_delete_file(const char* path)
     ESP_LOGI(TAG, "File deleted: %s", full_path);
     return ESP_OK;
 }
+
+// ============================================================================
+// Batched Log Writer
+// ============================================================================
+
+#define SD_LOG_BATCH_SIZE   4096            // One multi-block write per batch
+#define SD_LOG_DRAIN_MS     500             // log_ring -> batch
+#define SD_LOG_IDLE_MS      5000            // Drain interval while nothing is logged
+#define SD_LOG_FLUSH_MS     5000
+#define SD_LOG_MAX_BYTES    (1024 * 1024)   // Rotated to LOG_FILE_OLD past this
+
+// The writer task drains log_ring into the active batch, then swaps it with
+// the idle one and writes it out while new lines keep arriving
+static char *log_batch[2] = {NULL, NULL};
+static size_t log_batch_len = 0;
+static int log_batch_index = 0;
+static uint32_t log_dropped = 0;
+static SemaphoreHandle_t log_mutex = NULL;          // Active batch
+static SemaphoreHandle_t log_flush_mutex = NULL;    // Log files
+static TaskHandle_t log_task_handle = NULL;
+static uint32_t ring_cursor = 0;                    // Next log_ring record for SD
+static int64_t last_write_us = 0;
+
+static esp_err_t sd_log_write(const char *data, size_t len);
+
+// Swap batches and write the full one out; caller holds log_flush_mutex
+static esp_err_t write_batch(void)
+{
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+    char *batch = log_batch[log_batch_index];
+    size_t len = log_batch_len;
+    log_batch_index ^= 1;
+    log_batch_len = 0;
+    xSemaphoreGive(log_mutex);
+
+    last_write_us = esp_timer_get_time();
+    return len > 0 ? sd_log_write(batch, len) : ESP_OK;
+}
+
+// Format new ring records into the active batch; caller holds log_flush_mutex.
+// Returns false if there was nothing new.
+static bool drain_ring(void)
+{
+    char line[LOG_RING_LINE_MAX];
+    size_t n;
+    bool any = false;
+    while ((n = log_ring_read(&ring_cursor, line, sizeof(line))) > 0) {
+        any = true;
+        if (log_batch_len + n > SD_LOG_BATCH_SIZE) {
+            write_batch();
+        }
+        xSemaphoreTake(log_mutex, portMAX_DELAY);
+        memcpy(log_batch[log_batch_index] + log_batch_len, line, n);
+        log_batch_len += n;
+        xSemaphoreGive(log_mutex);
+    }
+    return any;
+}
+
+static void sd_log_task(void *pvParameters)
+{
+    (void)pvParameters;
+    uint32_t wait_ms = SD_LOG_DRAIN_MS;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms));
+
+        // Poll slowly while the board is quiet (the ring holds far more
+        // than an idle board logs between drains)
+        xSemaphoreTake(log_flush_mutex, portMAX_DELAY);
+        wait_ms = drain_ring() ? SD_LOG_DRAIN_MS : SD_LOG_IDLE_MS;
+        if (log_batch_len >= SD_LOG_BATCH_SIZE / 2 ||
+            esp_timer_get_time() - last_write_us >= (int64_t)SD_LOG_FLUSH_MS * 1000) {
+            write_batch();
+        }
+        xSemaphoreGive(log_flush_mutex);
+    }
+}
+
+esp_err_t sd_log_start(void)
+{
+    if (log_task_handle) return ESP_OK;
+    if (!mounted) return ESP_ERR_INVALID_STATE;
+
+    log_batch[0] = malloc(SD_LOG_BATCH_SIZE);
+    log_batch[1] = malloc(SD_LOG_BATCH_SIZE);
+    log_mutex = xSemaphoreCreateMutex();
+    log_flush_mutex = xSemaphoreCreateMutex();
+    if (!log_batch[0] || !log_batch[1] || !log_mutex || !log_flush_mutex ||
+        xTaskCreate(sd_log_task, "sd_log", 3072, NULL, 2, &log_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start SD log writer");
+        free(log_batch[0]);
+        free(log_batch[1]);
+        log_batch[0] = log_batch[1] = NULL;
+        if (log_mutex) vSemaphoreDelete(log_mutex);
+        if (log_flush_mutex) vSemaphoreDelete(log_flush_mutex);
+        log_mutex = log_flush_mutex = NULL;
+        log_task_handle = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "SD log writer started (%s%s)", SD_MOUNT_POINT, LOG_FILE);
+    return ESP_OK;
+}
+
+esp_err_t sd_log_append(const char* text, size_t len)
+{
+    if (!log_task_handle) return ESP_ERR_INVALID_STATE;
+    if (len > SD_LOG_BATCH_SIZE) len = SD_LOG_BATCH_SIZE;
+
+    esp_err_t ret = ESP_OK;
+    bool write_now;
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+    if (log_batch_len + len > SD_LOG_BATCH_SIZE) {
+        // Writer is behind; drop rather than block the caller on the card
+        log_dropped++;
+        ret = ESP_ERR_NO_MEM;
+        write_now = true;
+    } else {
+        memcpy(log_batch[log_batch_index] + log_batch_len, text, len);
+        log_batch_len += len;
+        write_now = log_batch_len >= SD_LOG_BATCH_SIZE / 2;
+    }
+    xSemaphoreGive(log_mutex);
+
+    if (write_now) {
+        xTaskNotifyGive(log_task_handle);
+    }
+    return ret;
+}
+
+static esp_err_t sd_log_write(const char *data, size_t len)
+{
+    char path[64], old_path[64];
+    snprintf(path, sizeof(path), "%s%s", SD_MOUNT_POINT, LOG_FILE);
+
+    struct stat st;
+    if (stat(path, &st) == 0 && (size_t)st.st_size + len > SD_LOG_MAX_BYTES) {
+        snprintf(old_path, sizeof(old_path), "%s%s", SD_MOUNT_POINT, LOG_FILE_OLD);
+        unlink(old_path);
+        rename(path, old_path);
+    }
+
+    FILE *f = fopen(path, "a");
+    if (!f) {
+        ESP_LOGE(TAG, "Failed to open log: %s", path);
+        return ESP_FAIL;
+    }
+    // Unbuffered so the batch reaches FATFS as one write instead of 128-byte pieces
+    setvbuf(f, NULL, _IONBF, 0);
+    size_t written = fwrite(data, 1, len, f);
+    fclose(f);
+    return written == len ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t sd_log_flush(void)
+{
+    if (!log_task_handle) return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(log_flush_mutex, portMAX_DELAY);
+    drain_ring();
+    esp_err_t ret = write_batch();
+    xSemaphoreGive(log_flush_mutex);
+    return ret;
+}
+
+size_t sd_log_size(void)
+{
+    if (!log_task_handle) return 0;
+
+    char path[64];
+    snprintf(path, sizeof(path), "%s%s", SD_MOUNT_POINT, LOG_FILE);
+    struct stat st;
+    size_t size = stat(path, &st) == 0 ? (size_t)st.st_size : 0;
+    return size + log_batch_len;
+}
+
+uint32_t sd_log_dropped(void)
+{
+    return log_dropped;
+}
+
+esp_err_t sd_log_clear(void)
+{
+    if (!log_task_handle) return ESP_ERR_INVALID_STATE;
+
+    char path[64];
+    xSemaphoreTake(log_flush_mutex, portMAX_DELAY);
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+    log_batch_len = 0;
+    xSemaphoreGive(log_mutex);
+    ring_cursor = log_ring_head();
+
+    snprintf(path, sizeof(path), "%s%s", SD_MOUNT_POINT, LOG_FILE);
+    unlink(path);
+    snprintf(path, sizeof(path), "%s%s", SD_MOUNT_POINT, LOG_FILE_OLD);
+    unlink(path);
+    xSemaphoreGive(log_flush_mutex);
+
+    ESP_LOGI(TAG, "Log cleared");
+    return ESP_OK;
+}
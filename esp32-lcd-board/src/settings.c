@@ -1,24 +1,66 @@
 #include <stdio.h>
+#include <stdarg.h>
 #include <string.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
 #include "nvs_flash.h"
 #include "nvs.h"
 
 #include "config.h"
 #include "settings.h"
 #include "tfnsw_client.h"
+#include "sd_card.h"
+#include "log_ring.h"
 
 static const char *TAG = "settings";
 
 // NVS namespace and keys
 #define NVS_SETTINGS_NAMESPACE  "settings"
+#define NVS_KEY_BLOB            "blob"
+
+// Per-field keys written before the blob; read once to migrate, then erased
 #define NVS_KEY_THEME_COLOR     "theme_color"
 #define NVS_KEY_BRIGHTNESS      "brightness"
 #define NVS_KEY_DEFAULT_SCENE   "default_scene"
+#define NVS_KEY_LAN_ROLE        "lan_role"
+
+// Persisted fields as one NVS blob. New fields are appended (older, shorter
+// blobs keep defaults for them); bump the version only for layout changes
+// that cannot be read that way.
+#define SETTINGS_BLOB_VERSION   1
+
+typedef struct __attribute__((packed)) {
+    uint16_t version;
+    uint16_t size;              // sizeof(settings_blob_t) when written
+    uint32_t theme_color;
+    uint8_t brightness;
+    uint8_t default_scene;
+    uint8_t lan_role;
+    uint8_t power_save;
+    uint8_t night_sleep;
+} settings_blob_t;
 
 // Current settings instance
 static device_settings_t current_settings;
 
+// Write-behind: setters only mark the settings dirty; one commit happens
+// after SETTINGS_COMMIT_QUIET_MS without changes (or SETTINGS_COMMIT_MAX_MS
+// after the first one), on settings_save() and before a restart. The timer
+// only wakes commit_task: flash writes stall the esp_timer task, and every
+// other timer in the system with it.
+static portMUX_TYPE settings_lock = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t commit_mutex = NULL;
+static esp_timer_handle_t commit_timer = NULL;
+static TaskHandle_t commit_task_handle = NULL;
+static bool settings_dirty = false;
+static int64_t dirty_since_us = 0;
+static bool legacy_keys_present = false;
+
 // ============================================================================
 // Default Values
 // ============================================================================
@@ -27,7 +69,10 @@ static void set_defaults(void)
 {
     current_settings.theme_color = 0xFFE000;  // Teal (displays as teal due to BGR swap)
     current_settings.brightness = 20;
-    current_settings.default_scene = 1;  // High Speed
+    current_settings.default_scene = 3;  // VIEW_HIGH_SPEED
+    current_settings.lan_role = 0;       // Standalone
+    current_settings.power_save = false;
+    current_settings.night_sleep = false;
 
     // Metro departure board defaults
     strncpy(current_settings.destination, "Tallawong", sizeof(current_settings.destination));
@@ -57,54 +102,209 @@ static void set_defaults(void)
 // NVS Functions
 // ============================================================================
 
+static void blob_from_settings(settings_blob_t *blob)
+{
+    blob->version = SETTINGS_BLOB_VERSION;
+    blob->size = sizeof(settings_blob_t);
+    blob->theme_color = current_settings.theme_color;
+    blob->brightness = current_settings.brightness;
+    blob->default_scene = current_settings.default_scene;
+    blob->lan_role = current_settings.lan_role;
+    blob->power_save = current_settings.power_save;
+    blob->night_sleep = current_settings.night_sleep;
+}
+
+static void settings_from_blob(const settings_blob_t *blob)
+{
+    current_settings.theme_color = blob->theme_color;
+    current_settings.brightness = blob->brightness;
+    current_settings.default_scene = blob->default_scene;
+    current_settings.lan_role = blob->lan_role;
+    current_settings.power_save = blob->power_save != 0;
+    current_settings.night_sleep = blob->night_sleep != 0;
+}
+
+// Commit pending changes. The blob is snapshotted under the lock so setters
+// never wait on flash; a failed write leaves the settings dirty.
 static esp_err_t nvs_save_settings(void)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_SETTINGS_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(err));
-        return err;
+    if (commit_mutex && xSemaphoreTake(commit_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
     }
 
-    nvs_set_u32(handle, NVS_KEY_THEME_COLOR, current_settings.theme_color);
-    nvs_set_u8(handle, NVS_KEY_BRIGHTNESS, current_settings.brightness);
-    nvs_set_u8(handle, NVS_KEY_DEFAULT_SCENE, current_settings.default_scene);
+    settings_blob_t blob;
+    portENTER_CRITICAL(&settings_lock);
+    blob_from_settings(&blob);
+    settings_dirty = false;
+    portEXIT_CRITICAL(&settings_lock);
 
-    err = nvs_commit(handle);
-    nvs_close(handle);
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NVS_SETTINGS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(handle, NVS_KEY_BLOB, &blob, sizeof(blob));
+        if (err == ESP_OK && legacy_keys_present) {
+            nvs_erase_key(handle, NVS_KEY_THEME_COLOR);
+            nvs_erase_key(handle, NVS_KEY_BRIGHTNESS);
+            nvs_erase_key(handle, NVS_KEY_DEFAULT_SCENE);
+            nvs_erase_key(handle, NVS_KEY_LAN_ROLE);
+        }
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
 
     if (err == ESP_OK) {
+        legacy_keys_present = false;
         ESP_LOGD(TAG, "Settings saved to NVS");
+    } else {
+        ESP_LOGE(TAG, "Failed to save settings: %s", esp_err_to_name(err));
+        portENTER_CRITICAL(&settings_lock);
+        if (!settings_dirty) {
+            settings_dirty = true;
+            dirty_since_us = esp_timer_get_time();
+        }
+        portEXIT_CRITICAL(&settings_lock);
+    }
+
+    if (commit_mutex) {
+        xSemaphoreGive(commit_mutex);
     }
     return err;
 }
 
-static esp_err_t nvs_load_settings(void)
+// Settings from before the blob existed (one key per field)
+static bool nvs_load_legacy_settings(nvs_handle_t handle)
 {
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open(NVS_SETTINGS_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGD(TAG, "No NVS settings found, using defaults");
-        return err;
-    }
-
     uint32_t theme_color;
-    uint8_t brightness, default_scene;
+    uint8_t brightness, default_scene, lan_role;
+    bool found = false;
 
     if (nvs_get_u32(handle, NVS_KEY_THEME_COLOR, &theme_color) == ESP_OK) {
         current_settings.theme_color = theme_color;
+        found = true;
     }
     if (nvs_get_u8(handle, NVS_KEY_BRIGHTNESS, &brightness) == ESP_OK) {
         current_settings.brightness = brightness;
+        found = true;
     }
     if (nvs_get_u8(handle, NVS_KEY_DEFAULT_SCENE, &default_scene) == ESP_OK) {
         current_settings.default_scene = default_scene;
+        found = true;
+    }
+    if (nvs_get_u8(handle, NVS_KEY_LAN_ROLE, &lan_role) == ESP_OK) {
+        current_settings.lan_role = lan_role;
+        found = true;
+    }
+    return found;
+}
+
+static esp_err_t nvs_load_settings(void)
+{
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NVS_SETTINGS_NAMESPACE, NVS_READONLY, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGD(TAG, "No NVS settings found, using defaults");
+        return err;
+    }
+
+    // Start from the current values so fields missing from a shorter blob
+    // keep them; fields appended by newer firmware are ignored
+    settings_blob_t blob;
+    blob_from_settings(&blob);
+    uint8_t raw[64];
+    size_t len = sizeof(raw);
+    err = nvs_get_blob(handle, NVS_KEY_BLOB, raw, &len);
+    if (err == ESP_OK) {
+        memcpy(&blob, raw, len < sizeof(blob) ? len : sizeof(blob));
+    }
+
+    if (err == ESP_OK && len >= offsetof(settings_blob_t, theme_color) &&
+        blob.version == SETTINGS_BLOB_VERSION) {
+        settings_from_blob(&blob);
+        current_settings.loaded = true;
+    } else if (err == ESP_OK || err == ESP_ERR_NVS_INVALID_LENGTH) {
+        ESP_LOGW(TAG, "Unsupported settings blob (v%d, %u bytes), using defaults",
+                 err == ESP_OK ? blob.version : -1, (unsigned)len);
+    } else if (nvs_load_legacy_settings(handle)) {
+        // Rewrite as a blob and drop the old keys on the next commit
+        legacy_keys_present = true;
+        settings_dirty = true;
+        dirty_since_us = esp_timer_get_time();
+        current_settings.loaded = true;
+        ESP_LOGI(TAG, "Migrating per-key settings to blob v%d", SETTINGS_BLOB_VERSION);
     }
 
     nvs_close(handle);
-    current_settings.loaded = true;
-    ESP_LOGI(TAG, "Settings loaded from NVS");
-    return ESP_OK;
+    if (current_settings.loaded) {
+        ESP_LOGI(TAG, "Settings loaded from NVS");
+    }
+    return current_settings.loaded ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+// ============================================================================
+// Write-Behind Commit
+// ============================================================================
+
+#define SETTINGS_COMMIT_QUIET_MS    2000    // Commit once changes stop for this long
+#define SETTINGS_COMMIT_MAX_MS      10000   // ...but never hold them longer than this
+
+static void commit_task(void *pvParameters)
+{
+    (void)pvParameters;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (settings_dirty) {
+            nvs_save_settings();
+        }
+    }
+}
+
+static void commit_timer_cb(void *arg)
+{
+    (void)arg;
+    xTaskNotifyGive(commit_task_handle);
+}
+
+// Restart the quiet-period timer, cut short so changes never wait past the max
+static void schedule_commit(void)
+{
+    portENTER_CRITICAL(&settings_lock);
+    int64_t now = esp_timer_get_time();
+    if (!settings_dirty) {
+        settings_dirty = true;
+        dirty_since_us = now;
+    }
+    int64_t left_us = dirty_since_us + (int64_t)SETTINGS_COMMIT_MAX_MS * 1000 - now;
+    portEXIT_CRITICAL(&settings_lock);
+
+    if (!commit_timer) {
+        nvs_save_settings();
+        return;
+    }
+    uint64_t delay_us = (uint64_t)SETTINGS_COMMIT_QUIET_MS * 1000;
+    if (left_us < (int64_t)delay_us) {
+        delay_us = left_us > 0 ? (uint64_t)left_us : 0;
+    }
+    if (esp_timer_is_active(commit_timer)) {
+        esp_timer_restart(commit_timer, delay_us);
+    } else {
+        esp_timer_start_once(commit_timer, delay_us);
+    }
+}
+
+// esp_restart() runs this, so changes made just before a reboot survive it
+static void settings_shutdown_handler(void)
+{
+    settings_flush();
+}
+
+esp_err_t settings_flush(void)
+{
+    if (commit_timer) {
+        esp_timer_stop(commit_timer);
+    }
+    return settings_dirty ? nvs_save_settings() : ESP_OK;
 }
 
 // ============================================================================
@@ -115,7 +315,25 @@ void settings_init(void)
 {
     ESP_LOGI(TAG, "Initializing settings");
     set_defaults();
+
+    if (!commit_mutex) {
+        commit_mutex = xSemaphoreCreateMutex();
+        const esp_timer_create_args_t timer_args = {
+            .callback = commit_timer_cb,
+            .name = "settings_commit",
+        };
+        if (xTaskCreate(commit_task, "settings", 3072, NULL, 2, &commit_task_handle) != pdPASS ||
+            esp_timer_create(&timer_args, &commit_timer) != ESP_OK) {
+            ESP_LOGW(TAG, "No commit task - settings save immediately");
+            commit_timer = NULL;
+        }
+        esp_register_shutdown_handler(settings_shutdown_handler);
+    }
+
     nvs_load_settings();
+    if (settings_dirty) {
+        schedule_commit();
+    }
 }
 
 esp_err_t settings_load(void)
@@ -125,6 +343,9 @@ esp_err_t settings_load(void)
 
 esp_err_t settings_save(void)
 {
+    if (commit_timer) {
+        esp_timer_stop(commit_timer);
+    }
     return nvs_save_settings();
 }
 
@@ -140,7 +361,19 @@ bool settings_is_loaded(void)
 
 void settings_reset(void)
 {
+    if (commit_timer) {
+        esp_timer_stop(commit_timer);
+    }
+
+    // Wait out a commit in flight, or it writes the old blob back after the erase
+    if (commit_mutex) {
+        xSemaphoreTake(commit_mutex, portMAX_DELAY);
+    }
+    portENTER_CRITICAL(&settings_lock);
     set_defaults();
+    settings_dirty = false;
+    portEXIT_CRITICAL(&settings_lock);
+    legacy_keys_present = false;
 
     // Clear NVS settings
     nvs_handle_t handle;
@@ -149,6 +382,9 @@ void settings_reset(void)
         nvs_commit(handle);
         nvs_close(handle);
     }
+    if (commit_mutex) {
+        xSemaphoreGive(commit_mutex);
+    }
 
     ESP_LOGI(TAG, "Settings reset to defaults");
 }
@@ -159,20 +395,50 @@ void settings_reset(void)
 
 void settings_set_theme_color(uint32_t color)
 {
+    portENTER_CRITICAL(&settings_lock);
     current_settings.theme_color = color;
-    nvs_save_settings();
+    portEXIT_CRITICAL(&settings_lock);
+    schedule_commit();
 }
 
 void settings_set_brightness(uint8_t brightness)
 {
+    portENTER_CRITICAL(&settings_lock);
     current_settings.brightness = brightness;
-    nvs_save_settings();
+    portEXIT_CRITICAL(&settings_lock);
+    schedule_commit();
 }
 
 void settings_set_default_scene(uint8_t scene)
 {
+    portENTER_CRITICAL(&settings_lock);
     current_settings.default_scene = scene;
-    nvs_save_settings();
+    portEXIT_CRITICAL(&settings_lock);
+    schedule_commit();
+}
+
+void settings_set_lan_role(uint8_t role)
+{
+    portENTER_CRITICAL(&settings_lock);
+    current_settings.lan_role = role;
+    portEXIT_CRITICAL(&settings_lock);
+    schedule_commit();
+}
+
+void settings_set_power_save(bool enabled)
+{
+    portENTER_CRITICAL(&settings_lock);
+    current_settings.power_save = enabled;
+    portEXIT_CRITICAL(&settings_lock);
+    schedule_commit();
+}
+
+void settings_set_night_sleep(bool enabled)
+{
+    portENTER_CRITICAL(&settings_lock);
+    current_settings.night_sleep = enabled;
+    portEXIT_CRITICAL(&settings_lock);
+    schedule_commit();
 }
 
 void settings_set_departure(const char* dest, const char* calling,
@@ -206,16 +472,37 @@ void settings_set_high_speed(const char* dest, const char* calling,
 }
 
 // ============================================================================
-// Stub functions (previously SD-dependent, now no-ops)
+// Log (log_ring in RAM, drained to SD by sd_card.c)
 // ============================================================================
 
-esp_err_t log_init(void) { return ESP_OK; }
-void log_info(const char* tag, const char* format, ...) { (void)tag; (void)format; }
-void log_error(const char* tag, const char* format, ...) { (void)tag; (void)format; }
-size_t log_get_size(void) { return 0; }
-esp_err_t log_clear(void) { return ESP_OK; }
+esp_err_t log_init(void)
+{
+    return sd_log_start();
+}
 
-bool departures_cache_is_valid(void) { return false; }
-esp_err_t departures_cache_save(const tfnsw_departures_t* departures) { (void)departures; return ESP_OK; }
-esp_err_t departures_cache_load(tfnsw_departures_t* out_departures) { (void)out_departures; return ESP_ERR_NOT_FOUND; }
-esp_err_t departures_cache_clear(void) { return ESP_OK; }
+void log_info(const char* tag, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    log_ring_vwrite(LOG_RING_INFO, tag, format, args);
+    va_end(args);
+}
+
+void log_error(const char* tag, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    log_ring_vwrite(LOG_RING_ERROR, tag, format, args);
+    va_end(args);
+}
+
+size_t log_get_size(void)
+{
+    return sd_log_size();
+}
+
+esp_err_t log_clear(void)
+{
+    log_ring_clear();
+    return sd_log_clear();
+}
\ No newline at end of file
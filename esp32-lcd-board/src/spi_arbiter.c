@@ -0,0 +1,130 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "spi_arbiter.h"
+
+static const char *TAG = "spi_arb";
+
+// Waiters re-check at least this often (transfers drain without a wakeup)
+#define SPI_ARB_POLL_TICKS  (pdMS_TO_TICKS(2) > 0 ? pdMS_TO_TICKS(2) : 1)
+
+// Panel colour transfers queued vs completed (completion counted in the ISR)
+static uint32_t lcd_tx_queued = 0;
+static volatile uint32_t lcd_tx_done = 0;
+
+static volatile bool frame_active = false;
+static volatile bool sd_active = false;
+static int64_t sd_slice_start_us = 0;
+
+static SemaphoreHandle_t sd_mutex = NULL;   // One SD slice at a time
+static SemaphoreHandle_t gap_sem = NULL;    // Given when a frame ends
+
+static spi_arbiter_stats_t stats = {0};
+
+esp_err_t spi_arbiter_init(void)
+{
+    if (sd_mutex) return ESP_OK;
+    sd_mutex = xSemaphoreCreateMutex();
+    gap_sem = xSemaphoreCreateBinary();
+    if (!sd_mutex || !gap_sem) {
+        ESP_LOGE(TAG, "Failed to create arbiter semaphores");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+// ============================================================================
+// LCD Side
+// ============================================================================
+
+void spi_arbiter_frame_begin(void)
+{
+    frame_active = true;
+    if (sd_active) {
+        stats.frames_delayed++;
+    }
+}
+
+void spi_arbiter_frame_end(void)
+{
+    frame_active = false;
+    if (gap_sem) {
+        xSemaphoreGive(gap_sem);
+    }
+}
+
+void spi_arbiter_lcd_queued(void)
+{
+    lcd_tx_queued++;
+}
+
+void IRAM_ATTR spi_arbiter_lcd_done(void)
+{
+    __atomic_fetch_add(&lcd_tx_done, 1, __ATOMIC_RELAXED);
+}
+
+static bool lcd_busy(void)
+{
+    return frame_active || (int32_t)(lcd_tx_queued - lcd_tx_done) > 0;
+}
+
+// ============================================================================
+// SD Side
+// ============================================================================
+
+esp_err_t spi_arbiter_sd_begin(uint32_t max_wait_ms)
+{
+    if (!sd_mutex) return ESP_ERR_INVALID_STATE;
+
+    int64_t start_us = esp_timer_get_time();
+    if (xSemaphoreTake(sd_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    // Wait for a gap between frames, but never starve SD completely
+    bool forced = false;
+    while (lcd_busy()) {
+        if (esp_timer_get_time() - start_us >= (int64_t)max_wait_ms * 1000) {
+            forced = true;
+            break;
+        }
+        xSemaphoreTake(gap_sem, SPI_ARB_POLL_TICKS);
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    uint32_t waited_us = (uint32_t)(now_us - start_us);
+    stats.sd_slices++;
+    stats.sd_wait_total_us += waited_us;
+    if (waited_us > stats.sd_wait_max_us) stats.sd_wait_max_us = waited_us;
+    if (waited_us > stats.sd_wait_peak_us) stats.sd_wait_peak_us = waited_us;
+    if (forced) stats.sd_forced++;
+
+    sd_slice_start_us = now_us;
+    sd_active = true;
+    return ESP_OK;
+}
+
+void spi_arbiter_sd_end(void)
+{
+    uint32_t held_us = (uint32_t)(esp_timer_get_time() - sd_slice_start_us);
+    if (held_us > stats.sd_hold_max_us) stats.sd_hold_max_us = held_us;
+    if (held_us > stats.sd_hold_peak_us) stats.sd_hold_peak_us = held_us;
+    sd_active = false;
+    xSemaphoreGive(sd_mutex);
+}
+
+void spi_arbiter_get_stats(spi_arbiter_stats_t *out)
+{
+    if (!out) return;
+    memcpy(out, &stats, sizeof(*out));
+}
+
+void spi_arbiter_reset_peaks(void)
+{
+    stats.sd_wait_peak_us = 0;
+    stats.sd_hold_peak_us = 0;
+}
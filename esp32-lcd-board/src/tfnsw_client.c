@@ -3,6 +3,7 @@
 #include "esp_heap_caps.h"
 #include "esp_http_client.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_tls.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
@@ -16,6 +17,8 @@
 
 #include "config.h"
 #include "tfnsw_client.h"
+#include "metrics.h"
+#include "event_trace.h"
 
 static const char *TAG = "tfnsw";
 
@@ -44,10 +47,7 @@ static void (*dual_update_callback)(const tfnsw_dual_departures_t *departures) =
     NULL;
 static bool dual_mode_enabled = false;
 
-// Simple mode - separate northbound/southbound/artarmon data
-static tfnsw_departures_t northbound_departures = {0};
-static tfnsw_departures_t southbound_departures = {0};
-static tfnsw_departures_t artarmon_departures = {0};
+// Simple mode - northbound/southbound/artarmon (data in the stop snapshots)
 static void (*north_update_callback)(const tfnsw_departures_t *departures) = NULL;
 static void (*south_update_callback)(const tfnsw_departures_t *departures) = NULL;
 static void (*artarmon_update_callback)(const tfnsw_departures_t *departures) = NULL;
@@ -58,7 +58,6 @@ static volatile bool is_currently_fetching = false;
 static char active_stop_id[16] = {0};
 static volatile bool single_view_mode_enabled = false;
 static void (*single_view_callback)(const tfnsw_departures_t *departures) = NULL;
-static tfnsw_departures_t single_view_departures = {0};
 
 // HTTP response buffer - Metro responses are ~1KB, but Sydney Trains vary wildly (15-35KB per departure!)
 // 32KB balances train support with heap requirements (mbedTLS needs ~16KB for TLS read buffer)
@@ -79,8 +78,39 @@ static bool has_cached_data = false;
 // Debug info tracking
 static tfnsw_debug_info_t debug_info = {0};
 
-// Forward declaration
+// Per-stop snapshots for /api/departures (heap, allocated on first success)
+typedef struct {
+  char stop_id[16];
+  uint32_t version;
+  TickType_t stored_tick; // Last store, changed or not (eviction order)
+  tfnsw_departures_t *data;
+} stop_snapshot_t;
+static stop_snapshot_t stop_snapshots[TFNSW_STOP_CACHE_SLOTS] = {0};
+static uint32_t stop_snapshot_version = 0;
+
+// Extra stops the single-view task keeps fresh for LAN followers (lan_sync)
+#define WATCHED_STOP_SLOTS 3
+typedef struct {
+  char stop_id[16];
+  TickType_t expires;         // Lease end (refreshed by tfnsw_watch_stop)
+  TickType_t last_fetch;
+  bool fetched;
+} watched_stop_t;
+static watched_stop_t watched_stops[WATCHED_STOP_SLOTS] = {0};
+
+// Forward declarations
 static int64_t get_current_time_ms(void);
+static void stop_snapshot_store(const char *stop_id,
+                                const tfnsw_departures_t *deps);
+static void fetch_watched_stop(void);
+
+// Fetch tasks sleep until their next deadline; this cuts the wait short
+// (forced refresh, new stop, new watch, stop request)
+static void wake_fetch_task(void) {
+  TaskHandle_t task = fetch_task_handle;
+  if (task)
+    xTaskNotifyGive(task);
+}
 
 // ============================================================================
 // Quiet Hours Check (reduced fetching between 01:00 and 04:00)
@@ -140,8 +170,23 @@ static bool is_time_synced(void) {
 // HTTP Event Handler
 // ============================================================================
 
+// Request phase timestamps for the fetch latency metrics (us, 0 = not seen)
+static int64_t fetch_start_us = 0;
+static int64_t fetch_connected_us = 0;
+static int64_t fetch_first_header_us = 0;
+
 static esp_err_t http_event_handler(esp_http_client_event_t *evt) {
   switch (evt->event_id) {
+  case HTTP_EVENT_ON_CONNECTED:
+    fetch_connected_us = esp_timer_get_time();
+    trace_instant("tls_connected", 0);
+    break;
+  case HTTP_EVENT_ON_HEADER:
+    if (fetch_first_header_us == 0) {
+      fetch_first_header_us = esp_timer_get_time();
+      trace_instant("first_header", 0);
+    }
+    break;
   case HTTP_EVENT_ON_DATA:
     // Handle both chunked and non-chunked responses
     if (http_buffer) {
@@ -253,6 +298,11 @@ void tfnsw_deinit(void) {
     http_buffer = NULL;
   }
 
+  for (int i = 0; i < TFNSW_STOP_CACHE_SLOTS; i++) {
+    free(stop_snapshots[i].data);
+  }
+  memset(stop_snapshots, 0, sizeof(stop_snapshots));
+
   if (data_mutex) {
     vSemaphoreDelete(data_mutex);
     data_mutex = NULL;
@@ -775,8 +825,8 @@ static esp_err_t parse_response(const char *json_str,
 // HTTP Fetch
 // ============================================================================
 
-esp_err_t tfnsw_fetch_departures(const char *stop_id,
-                                 tfnsw_departures_t *out_departures) {
+static esp_err_t fetch_departures(const char *stop_id,
+                                  tfnsw_departures_t *out_departures) {
   if (!initialized) {
     return ESP_ERR_INVALID_STATE;
   }
@@ -901,9 +951,22 @@ esp_err_t tfnsw_fetch_departures(const char *stop_id,
 
   // Perform request
   out_departures->status = TFNSW_STATUS_FETCHING;
+  metrics_inc(MET_TFNSW_FETCH_TOTAL);
+  fetch_start_us = esp_timer_get_time();
+  fetch_connected_us = 0;
+  fetch_first_header_us = 0;
+  trace_begin("http");
   esp_err_t err = esp_http_client_perform(client);
+  int64_t fetch_done_us = esp_timer_get_time();
+  trace_end("http", (uint32_t)http_buffer_len);
+
+  if (fetch_connected_us) {
+    metrics_observe(MET_FETCH_CONNECT_MS,
+                    (uint32_t)((fetch_connected_us - fetch_start_us) / 1000));
+  }
 
   if (err != ESP_OK) {
+    metrics_inc(MET_TFNSW_FETCH_ERRORS_TOTAL);
     ESP_LOGE(TAG, "HTTP request failed: %s (0x%x)", esp_err_to_name(err), err);
     ESP_LOGE(TAG, "URL was: %s", url);
 
@@ -934,6 +997,16 @@ esp_err_t tfnsw_fetch_departures(const char *stop_id,
   ESP_LOGI(TAG, "HTTP status: %d, response length: %d", status_code,
            http_buffer_len);
 
+  metrics_count_http_status(status_code);
+  metrics_add(MET_TFNSW_RESPONSE_BYTES_TOTAL, http_buffer_len);
+  metrics_set(MET_TFNSW_LAST_RESPONSE_BYTES, http_buffer_len);
+  if (fetch_connected_us && fetch_first_header_us) {
+    metrics_observe(MET_FETCH_WAIT_MS,
+                    (uint32_t)((fetch_first_header_us - fetch_connected_us) / 1000));
+    metrics_observe(MET_FETCH_DOWNLOAD_MS,
+                    (uint32_t)((fetch_done_us - fetch_first_header_us) / 1000));
+  }
+
   esp_http_client_cleanup(client);
 
   // Handle HTTP status codes
@@ -1014,7 +1087,15 @@ esp_err_t tfnsw_fetch_departures(const char *stop_id,
              HTTP_BUFFER_SIZE, actual_size, esp_get_free_heap_size());
   }
 
+  int64_t parse_start_us = esp_timer_get_time();
+  trace_begin("parse");
   err = parse_response(http_buffer, out_departures);
+  trace_end("parse", (uint32_t)out_departures->count);
+  metrics_observe(MET_FETCH_PARSE_MS,
+                  (uint32_t)((esp_timer_get_time() - parse_start_us) / 1000));
+  if (err != ESP_OK) {
+    metrics_inc(MET_TFNSW_PARSE_FAILURES_TOTAL);
+  }
 
   // Restore full buffer size for next request
   char *full_buffer = realloc(http_buffer, HTTP_BUFFER_SIZE);
@@ -1047,10 +1128,20 @@ esp_err_t tfnsw_fetch_departures(const char *stop_id,
 
   out_departures->last_fetch_time = get_current_time_ms();
   out_departures->consecutive_errors = 0;
+  stop_snapshot_store(stop_id, out_departures);
 
   return ESP_OK;
 }
 
+// Traced as one span covering connect, TLS, download and parse
+esp_err_t tfnsw_fetch_departures(const char *stop_id,
+                                 tfnsw_departures_t *out_departures) {
+  trace_begin("tfnsw_fetch");
+  esp_err_t err = fetch_departures(stop_id, out_departures);
+  trace_end("tfnsw_fetch", (uint32_t)err);
+  return err;
+}
+
 esp_err_t tfnsw_fetch_victoria_cross(tfnsw_departures_t *out_departures) {
   return tfnsw_fetch_departures(TFNSW_VICTORIA_CROSS_STOP_ID, out_departures);
 }
@@ -1232,6 +1323,7 @@ void tfnsw_stop_background_fetch(void) {
   single_view_mode_enabled = false;
   single_view_callback = NULL;
   active_stop_id[0] = '\0';
+  wake_fetch_task();
 
   // Wait for task to finish
   vTaskDelay(pdMS_TO_TICKS(100));
@@ -1389,7 +1481,10 @@ esp_err_t tfnsw_start_dual_background_fetch(
   return ESP_OK;
 }
 
-void tfnsw_force_refresh(void) { force_refresh_flag = true; }
+void tfnsw_force_refresh(void) {
+  force_refresh_flag = true;
+  wake_fetch_task();
+}
 
 bool tfnsw_is_fetching(void) {
   return fetch_task_running &&
@@ -1398,6 +1493,151 @@ bool tfnsw_is_fetching(void) {
 
 bool tfnsw_is_background_fetch_running(void) { return fetch_task_running; }
 
+// ============================================================================
+// Per-Stop Snapshots
+// ============================================================================
+
+// Field by field: mins_to_departure follows the clock, not the timetable,
+// and a memcmp would also compare struct padding
+static bool departure_changed(const tfnsw_departure_t *a,
+                              const tfnsw_departure_t *b) {
+  return strcmp(a->destination, b->destination) != 0 ||
+         strcmp(a->platform, b->platform) != 0 ||
+         strcmp(a->line_name, b->line_name) != 0 ||
+         strcmp(a->calling_stations, b->calling_stations) != 0 ||
+         a->scheduled_time != b->scheduled_time ||
+         a->estimated_time != b->estimated_time ||
+         a->delay_seconds != b->delay_seconds ||
+         a->direction != b->direction ||
+         a->is_realtime != b->is_realtime ||
+         a->is_cancelled != b->is_cancelled ||
+         a->is_delayed != b->is_delayed ||
+         a->occupancy_available != b->occupancy_available ||
+         a->occupancy_percent != b->occupancy_percent ||
+         a->alert_severity != b->alert_severity ||
+         strcmp(a->alert_message, b->alert_message) != 0;
+}
+
+// True if anything a consumer would render differs (fetch timestamps aside)
+static bool stop_snapshot_changed(const tfnsw_departures_t *a,
+                                  const tfnsw_departures_t *b) {
+  if (a->count != b->count ||
+      a->service_suspended != b->service_suspended ||
+      strcmp(a->station_name, b->station_name) != 0 ||
+      strcmp(a->suspension_message, b->suspension_message) != 0)
+    return true;
+  for (int i = 0; i < a->count && i < TFNSW_MAX_DEPARTURES; i++) {
+    if (departure_changed(&a->departures[i], &b->departures[i]))
+      return true;
+  }
+  return false;
+}
+
+// Keep the latest successful fetch per stop. The version only moves when
+// the data changes, so repeated identical fetches still produce a 304.
+static void stop_snapshot_store(const char *stop_id,
+                                const tfnsw_departures_t *deps) {
+  if (!stop_id || !stop_id[0] || !data_mutex)
+    return;
+  if (xSemaphoreTake(data_mutex, pdMS_TO_TICKS(100)) != pdTRUE)
+    return;
+
+  // Reuse the stop's slot, else an empty one, else the one stored longest
+  // ago. Not the lowest version: a stop fetched every pass whose departures
+  // rarely change keeps an old version but is the last one to evict.
+  TickType_t now = xTaskGetTickCount();
+  stop_snapshot_t *slot = NULL;
+  for (int i = 0; i < TFNSW_STOP_CACHE_SLOTS && !slot; i++) {
+    if (strcmp(stop_snapshots[i].stop_id, stop_id) == 0)
+      slot = &stop_snapshots[i];
+  }
+  if (!slot) {
+    slot = &stop_snapshots[0];
+    for (int i = 0; i < TFNSW_STOP_CACHE_SLOTS; i++) {
+      if (!stop_snapshots[i].data) {
+        slot = &stop_snapshots[i];
+        break;
+      }
+      if (now - stop_snapshots[i].stored_tick > now - slot->stored_tick)
+        slot = &stop_snapshots[i];
+    }
+    if (slot->data)
+      ESP_LOGI(TAG, "Snapshot cache: evicting stop %s", slot->stop_id);
+    strncpy(slot->stop_id, stop_id, sizeof(slot->stop_id) - 1);
+    slot->stop_id[sizeof(slot->stop_id) - 1] = '\0';
+    slot->version = 0;
+  }
+
+  if (!slot->data) {
+    slot->data = calloc(1, sizeof(tfnsw_departures_t));
+    if (!slot->data) {
+      ESP_LOGW(TAG, "Snapshot cache: no memory for stop %s", stop_id);
+      slot->stop_id[0] = '\0';
+      xSemaphoreGive(data_mutex);
+      return;
+    }
+  }
+
+  if (slot->version == 0 || stop_snapshot_changed(slot->data, deps)) {
+    slot->version = ++stop_snapshot_version;
+  }
+  memcpy(slot->data, deps, sizeof(tfnsw_departures_t));
+  slot->stored_tick = now;
+  xSemaphoreGive(data_mutex);
+}
+
+void tfnsw_store_stop_snapshot(const char *stop_id,
+                               const tfnsw_departures_t *departures) {
+  if (departures)
+    stop_snapshot_store(stop_id, departures);
+}
+
+esp_err_t tfnsw_get_stop_snapshot(const char *stop_id,
+                                  tfnsw_departures_t *out_departures,
+                                  uint32_t *out_version) {
+  if (!stop_id)
+    return ESP_ERR_INVALID_ARG;
+  if (!data_mutex ||
+      xSemaphoreTake(data_mutex, pdMS_TO_TICKS(100)) != pdTRUE)
+    return ESP_ERR_TIMEOUT;
+
+  esp_err_t ret = ESP_ERR_NOT_FOUND;
+  for (int i = 0; i < TFNSW_STOP_CACHE_SLOTS; i++) {
+    if (stop_snapshots[i].data && strcmp(stop_snapshots[i].stop_id, stop_id) == 0) {
+      if (out_departures)
+        memcpy(out_departures, stop_snapshots[i].data, sizeof(tfnsw_departures_t));
+      if (out_version)
+        *out_version = stop_snapshots[i].version;
+      ret = ESP_OK;
+      break;
+    }
+  }
+
+  xSemaphoreGive(data_mutex);
+  return ret;
+}
+
+int tfnsw_list_stop_snapshots(tfnsw_stop_version_t *out, int max) {
+  int n = 0;
+  if (!out || !data_mutex ||
+      xSemaphoreTake(data_mutex, pdMS_TO_TICKS(100)) != pdTRUE)
+    return 0;
+
+  for (int i = 0; i < TFNSW_STOP_CACHE_SLOTS && n < max; i++) {
+    if (stop_snapshots[i].data) {
+      memcpy(out[n].stop_id, stop_snapshots[i].stop_id, sizeof(out[n].stop_id));
+      strncpy(out[n].station_name, stop_snapshots[i].data->station_name,
+              sizeof(out[n].station_name) - 1);
+      out[n].station_name[sizeof(out[n].station_name) - 1] = '\0';
+      out[n].version = stop_snapshots[i].version;
+      n++;
+    }
+  }
+
+  xSemaphoreGive(data_mutex);
+  return n;
+}
+
 // ============================================================================
 // Data Access
 // ============================================================================
@@ -1517,28 +1757,24 @@ void tfnsw_get_debug_info(tfnsw_debug_info_t *out_info) {
 // Simple Mode - Single Platform Fetch
 // ============================================================================
 
-void tfnsw_get_northbound_departures(tfnsw_departures_t *out_departures) {
+// Simple-mode results live in the per-stop snapshots; empty until fetched
+static void get_simple_departures(const char *stop_id,
+                                  tfnsw_departures_t *out_departures) {
   if (!out_departures) return;
-  if (data_mutex && xSemaphoreTake(data_mutex, pdMS_TO_TICKS(100))) {
-    memcpy(out_departures, &northbound_departures, sizeof(tfnsw_departures_t));
-    xSemaphoreGive(data_mutex);
-  }
+  if (tfnsw_get_stop_snapshot(stop_id, out_departures, NULL) != ESP_OK)
+    memset(out_departures, 0, sizeof(tfnsw_departures_t));
+}
+
+void tfnsw_get_northbound_departures(tfnsw_departures_t *out_departures) {
+  get_simple_departures(TFNSW_VICTORIA_CROSS_NORTHBOUND, out_departures);
 }
 
 void tfnsw_get_southbound_departures(tfnsw_departures_t *out_departures) {
-  if (!out_departures) return;
-  if (data_mutex && xSemaphoreTake(data_mutex, pdMS_TO_TICKS(100))) {
-    memcpy(out_departures, &southbound_departures, sizeof(tfnsw_departures_t));
-    xSemaphoreGive(data_mutex);
-  }
+  get_simple_departures(TFNSW_CROWS_NEST_SOUTHBOUND, out_departures);
 }
 
 void tfnsw_get_artarmon_departures(tfnsw_departures_t *out_departures) {
-  if (!out_departures) return;
-  if (data_mutex && xSemaphoreTake(data_mutex, pdMS_TO_TICKS(100))) {
-    memcpy(out_departures, &artarmon_departures, sizeof(tfnsw_departures_t));
-    xSemaphoreGive(data_mutex);
-  }
+  get_simple_departures(TFNSW_ARTARMON_STOP_ID, out_departures);
 }
 
 static void simple_fetch_task(void *arg) {
@@ -1570,10 +1806,7 @@ static void simple_fetch_task(void *arg) {
         strncpy(artarmon_data.station_name, "Artarmon", sizeof(artarmon_data.station_name) - 1);
 
         if (artarmon_err == ESP_OK && artarmon_data.status == TFNSW_STATUS_SUCCESS) {
-          if (data_mutex && xSemaphoreTake(data_mutex, pdMS_TO_TICKS(100))) {
-            memcpy(&artarmon_departures, &artarmon_data, sizeof(tfnsw_departures_t));
-            xSemaphoreGive(data_mutex);
-          }
+          stop_snapshot_store(TFNSW_ARTARMON_STOP_ID, &artarmon_data);
           ESP_LOGI(TAG, "Artarmon: %d departures", artarmon_data.count);
           backoff_multiplier = 1;
         } else {
@@ -1600,10 +1833,7 @@ static void simple_fetch_task(void *arg) {
           north_data.departures[i].direction = TFNSW_DIRECTION_NORTHBOUND;
         }
 
-        if (data_mutex && xSemaphoreTake(data_mutex, pdMS_TO_TICKS(100))) {
-          memcpy(&northbound_departures, &north_data, sizeof(tfnsw_departures_t));
-          xSemaphoreGive(data_mutex);
-        }
+        stop_snapshot_store(TFNSW_VICTORIA_CROSS_NORTHBOUND, &north_data);
 
         ESP_LOGI(TAG, "Northbound: %d departures", north_data.count);
       } else {
@@ -1631,10 +1861,7 @@ static void simple_fetch_task(void *arg) {
           south_data.departures[i].direction = TFNSW_DIRECTION_SOUTHBOUND;
         }
 
-        if (data_mutex && xSemaphoreTake(data_mutex, pdMS_TO_TICKS(100))) {
-          memcpy(&southbound_departures, &south_data, sizeof(tfnsw_departures_t));
-          xSemaphoreGive(data_mutex);
-        }
+        stop_snapshot_store(TFNSW_CROWS_NEST_SOUTHBOUND, &south_data);
 
         ESP_LOGI(TAG, "Southbound: %d departures", south_data.count);
       } else {
@@ -1699,6 +1926,116 @@ esp_err_t tfnsw_start_simple_background_fetch(
 // Single-View Mode - Only fetch for active view
 // ============================================================================
 
+// Fetch at most one due watched stop per pass (least recently fetched
+// first), so the active stop never waits behind a queue of TLS requests.
+// The result reaches followers through the per-stop snapshot store.
+static void fetch_watched_stop(void) {
+  char stop_id[16] = "";
+  TickType_t now = xTaskGetTickCount();
+
+  if (!data_mutex || xSemaphoreTake(data_mutex, pdMS_TO_TICKS(100)) != pdTRUE)
+    return;
+  watched_stop_t *due = NULL;
+  for (int i = 0; i < WATCHED_STOP_SLOTS; i++) {
+    watched_stop_t *w = &watched_stops[i];
+    if (!w->stop_id[0])
+      continue;
+    if ((int32_t)(now - w->expires) >= 0) {
+      ESP_LOGI(TAG, "Watch on stop %s expired", w->stop_id);
+      w->stop_id[0] = '\0';
+      continue;
+    }
+    if (strcmp(w->stop_id, active_stop_id) == 0)
+      continue;  // Already fetched as the active stop
+    if (w->fetched && now - w->last_fetch < pdMS_TO_TICKS(TFNSW_FETCH_INTERVAL_MS))
+      continue;
+    if (!due || !w->fetched || (due->fetched && w->last_fetch < due->last_fetch))
+      due = w;
+  }
+  if (due) {
+    memcpy(stop_id, due->stop_id, sizeof(stop_id));
+    due->last_fetch = now;
+    due->fetched = true;
+  }
+  xSemaphoreGive(data_mutex);
+
+  if (!stop_id[0])
+    return;
+
+  // Heap, not stack: the caller already holds one departures struct
+  tfnsw_departures_t *deps = calloc(1, sizeof(tfnsw_departures_t));
+  if (!deps)
+    return;
+  ESP_LOGI(TAG, "Fetching watched stop: %s", stop_id);
+  is_currently_fetching = true;
+  if (tfnsw_fetch_departures(stop_id, deps) != ESP_OK) {
+    ESP_LOGW(TAG, "Watched stop %s fetch failed: %s", stop_id, deps->error_message);
+  }
+  is_currently_fetching = false;
+  free(deps);
+}
+
+void tfnsw_watch_stop(const char *stop_id, uint32_t lease_ms) {
+  if (!stop_id || !stop_id[0] || !data_mutex)
+    return;
+  if (xSemaphoreTake(data_mutex, pdMS_TO_TICKS(100)) != pdTRUE)
+    return;
+
+  TickType_t now = xTaskGetTickCount();
+  watched_stop_t *slot = NULL;
+  for (int i = 0; i < WATCHED_STOP_SLOTS && !slot; i++) {
+    if (strcmp(watched_stops[i].stop_id, stop_id) == 0)
+      slot = &watched_stops[i];
+  }
+  if (!slot) {
+    // Free slot, else the lease closest to running out
+    slot = &watched_stops[0];
+    for (int i = 0; i < WATCHED_STOP_SLOTS; i++) {
+      if (!watched_stops[i].stop_id[0]) {
+        slot = &watched_stops[i];
+        break;
+      }
+      if ((int32_t)(watched_stops[i].expires - slot->expires) < 0)
+        slot = &watched_stops[i];
+    }
+    memset(slot, 0, sizeof(*slot));
+    strncpy(slot->stop_id, stop_id, sizeof(slot->stop_id) - 1);
+    ESP_LOGI(TAG, "Watching stop %s for LAN followers", slot->stop_id);
+    wake_fetch_task();
+  }
+  slot->expires = now + pdMS_TO_TICKS(lease_ms);
+  xSemaphoreGive(data_mutex);
+}
+
+// Ticks until the single-view task next has work: the active stop's next
+// fetch or the first watched stop coming due (portMAX_DELAY if neither)
+static TickType_t single_view_wait(TickType_t last_fetch, TickType_t interval) {
+  TickType_t now = xTaskGetTickCount();
+  TickType_t wait = portMAX_DELAY;
+
+  if (active_stop_id[0]) {
+    TickType_t since = now - last_fetch;
+    wait = since >= interval ? 0 : interval - since;
+  }
+
+  if (data_mutex && xSemaphoreTake(data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+    for (int i = 0; i < WATCHED_STOP_SLOTS; i++) {
+      const watched_stop_t *w = &watched_stops[i];
+      if (!w->stop_id[0] || strcmp(w->stop_id, active_stop_id) == 0)
+        continue;
+      TickType_t since = now - w->last_fetch;
+      TickType_t due = (!w->fetched || since >= pdMS_TO_TICKS(TFNSW_FETCH_INTERVAL_MS))
+                           ? 0 : pdMS_TO_TICKS(TFNSW_FETCH_INTERVAL_MS) - since;
+      if (due < wait)
+        wait = due;
+    }
+    xSemaphoreGive(data_mutex);
+  }
+  return wait;
+}
+
+#define QUIET_HOURS_POLL_MS 60000   // Quiet-hours check while fetches are held back
+
 static void single_view_fetch_task(void *arg) {
   ESP_LOGI(TAG, "Single-view background fetch task started");
 
@@ -1712,20 +2049,21 @@ static void single_view_fetch_task(void *arg) {
     // Check for forced refresh or interval elapsed
     bool should_fetch = force_refresh_flag || (now - last_fetch >= interval);
 
-    // Skip if no active stop
-    if (active_stop_id[0] == '\0') {
-      vTaskDelay(pdMS_TO_TICKS(500));
-      continue;
-    }
-
     // During quiet hours, fetch less frequently
     if (is_quiet_hours() && !force_refresh_flag) {
       if (!should_fetch_during_quiet_hours()) {
-        vTaskDelay(pdMS_TO_TICKS(1000));
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(QUIET_HOURS_POLL_MS));
         continue;
       }
     }
 
+    // No active stop: only stops watched for LAN followers are fetched
+    if (active_stop_id[0] == '\0') {
+      fetch_watched_stop();
+      ulTaskNotifyTake(pdTRUE, single_view_wait(last_fetch, interval));
+      continue;
+    }
+
     if (should_fetch) {
       force_refresh_flag = false;
       is_currently_fetching = true;
@@ -1744,21 +2082,22 @@ static void single_view_fetch_task(void *arg) {
         ESP_LOGW(TAG, "Fetch failed: %s (backoff: %dx)", fetch_data.error_message, backoff_multiplier);
       }
 
-      // Store and callback
-      if (data_mutex && xSemaphoreTake(data_mutex, pdMS_TO_TICKS(100))) {
-        memcpy(&single_view_departures, &fetch_data, sizeof(tfnsw_departures_t));
-        xSemaphoreGive(data_mutex);
-      }
-
+      // Successes are already in the stop's snapshot
       is_currently_fetching = false;
 
       // Always call callback so UI can update status
       if (single_view_callback) {
         single_view_callback(&fetch_data);
       }
+    } else {
+      fetch_watched_stop();
     }
 
-    vTaskDelay(pdMS_TO_TICKS(500));
+    // Sleep until the next fetch is due (or a wake_fetch_task())
+    interval = pdMS_TO_TICKS(TFNSW_FETCH_INTERVAL_MS * backoff_multiplier);
+    if (!force_refresh_flag) {
+      ulTaskNotifyTake(pdTRUE, single_view_wait(last_fetch, interval));
+    }
   }
 
   ESP_LOGI(TAG, "Single-view background fetch task stopped");
@@ -1797,9 +2136,6 @@ esp_err_t tfnsw_start_single_view_fetch(
   fetch_task_running = true;
   force_refresh_flag = true;
 
-  // Clear any old data
-  memset(&single_view_departures, 0, sizeof(single_view_departures));
-
   BaseType_t ret = xTaskCreate(single_view_fetch_task, "tfnsw_single",
                                16384, NULL, 5, &fetch_task_handle);
   if (ret != pdPASS) {
@@ -1815,9 +2151,6 @@ esp_err_t tfnsw_start_single_view_fetch(
 
 void tfnsw_set_active_stop(const char* stop_id) {
   if (data_mutex && xSemaphoreTake(data_mutex, pdMS_TO_TICKS(100))) {
-    // Clear old data
-    memset(&single_view_departures, 0, sizeof(single_view_departures));
-
     // Set new stop
     if (stop_id && stop_id[0]) {
       strncpy(active_stop_id, stop_id, sizeof(active_stop_id) - 1);
@@ -1833,14 +2166,11 @@ void tfnsw_set_active_stop(const char* stop_id) {
 
   // Force immediate refresh for new stop
   force_refresh_flag = true;
+  wake_fetch_task();
 }
 
 void tfnsw_clear_cached_data(void) {
   if (data_mutex && xSemaphoreTake(data_mutex, pdMS_TO_TICKS(100))) {
-    memset(&single_view_departures, 0, sizeof(single_view_departures));
-    memset(&northbound_departures, 0, sizeof(northbound_departures));
-    memset(&southbound_departures, 0, sizeof(southbound_departures));
-    memset(&artarmon_departures, 0, sizeof(artarmon_departures));
     memset(&current_departures, 0, sizeof(current_departures));
     memset(&current_dual_departures, 0, sizeof(current_dual_departures));
     xSemaphoreGive(data_mutex);
@@ -0,0 +1,318 @@
+let currentView = 0;
+let currentViewName = '';
+let currentTheme = 16769024;
+let viewsData = [];
+let viewsLoaded = false;
+function rgbToHex(rgb) {
+    // Convert RGB888 to CSS hex (handles BGR swap)
+    const r = (rgb >> 16) & 0xFF;
+    const g = (rgb >> 8) & 0xFF;
+    const b = rgb & 0xFF;
+    return '#' + [b,g,r].map(x => x.toString(16).padStart(2,'0')).join('');
+}
+async function fetchViews() {
+    try {
+        const res = await fetch('/api/views');
+        const data = await res.json();
+        viewsData = data.views || [];
+        currentView = data.current;
+        currentViewName = data.current_name;
+        const container = document.getElementById('view-btns');
+        container.innerHTML = viewsData.filter(v => v.enabled).map(v => {
+            const colorHex = rgbToHex(v.accent_color);
+            const sourceLabel = v.data_source === 'realtime' ? '● Live' : '◆ Demo';
+            const sourceClass = v.data_source;
+            return `<div class="view-btn${v.active ? ' active' : ''}" data-view="${v.id}" onclick="setView(${v.id})">
+                <div class="color-dot" style="background:${colorHex}"></div>
+                <span class="view-name">${v.name}</span>
+                <span class="view-source ${sourceClass}">${sourceLabel}</span>
+            </div>`;
+        }).join('');
+        viewsLoaded = true;
+        document.getElementById('current-view-name').textContent = currentViewName;
+    } catch(e) {
+        document.getElementById('view-btns').innerHTML = '<span style="color:#f44336">Error loading views</span>';
+    }
+}
+let lastStatus = null;
+async function fetchStatus() {
+    try {
+        const res = await fetch('/api/status');
+        lastStatus = await res.json();
+        renderStatus(lastStatus);
+    } catch(e) { document.getElementById('status').innerHTML = '<p style="color:#f44336">Error loading status</p>'; }
+}
+function renderStatus(d) {
+    const newView = d.view !== undefined ? d.view : (d.scene || 0);
+    if (newView !== currentView) {
+        currentView = newView;
+        updateViewButtons();
+    }
+    currentTheme = d.theme_color || 16769024;
+    updateThemeButtons();
+    if (d.settings && d.settings.brightness) {
+        document.getElementById('brightness').value = d.settings.brightness;
+        document.getElementById('brightness-value').textContent = d.settings.brightness;
+    }
+    const viewInfo = viewsData.find(v => v.id === newView);
+    const viewName = viewInfo ? viewInfo.name : 'View ' + newView;
+    document.getElementById('status').innerHTML = `
+        <div class="status-row"><span class="status-label">Board</span><span class="status-value">${d.board}</span></div>
+        <div class="status-row"><span class="status-label">Version</span><span class="status-value">${d.version}</span></div>
+        <div class="status-row"><span class="status-label">Current View</span><span class="status-value" style="color:#ffe000">${viewName}</span></div>
+        <div class="status-row"><span class="status-label">Uptime</span><span class="status-value">${Math.floor(d.uptime/60)}m ${d.uptime%60}s</span></div>
+        <div class="status-row"><span class="status-label">WiFi</span><span class="status-value">${d.wifi_connected ? d.ssid + ' (' + d.rssi + ' dBm)' : 'AP Mode'}</span></div>
+        <div class="status-row"><span class="status-label">IP</span><span class="status-value">${d.ip}</span></div>
+        <div class="status-row"><span class="status-label">Free Heap</span><span class="status-value">${(d.free_heap/1024).toFixed(1)} KB</span></div>
+    `;
+    // SD Card status
+    const sd = d.sd_card;
+    if (sd && sd.mounted) {
+        const usedPct = ((sd.used_mb / sd.total_mb) * 100).toFixed(0);
+        document.getElementById('sd-status').innerHTML = `
+            <div class="status-row"><span class="status-label">Status</span><span class="status-value">Mounted <span class="badge badge-green">OK</span></span></div>
+            <div class="status-row"><span class="status-label">Capacity</span><span class="status-value">${sd.total_mb.toFixed(0)} MB</span></div>
+            <div class="status-row"><span class="status-label">Used</span><span class="status-value">${sd.used_mb.toFixed(1)} MB (${usedPct}%)</span></div>
+            <div class="progress-bar"><div class="progress-fill" style="width:${usedPct}%"></div></div>
+            <div class="status-row"><span class="status-label">Settings</span><span class="status-value">${sd.settings_loaded ? '<span class="badge badge-green">Loaded</span>' : '<span class="badge badge-yellow">Defaults</span>'}</span></div>
+            <div class="status-row"><span class="status-label">Log Size</span><span class="status-value">${(sd.log_size/1024).toFixed(1)} KB</span></div>
+        `;
+    } else {
+        document.getElementById('sd-status').innerHTML = `
+            <div class="status-row"><span class="status-label">Status</span><span class="status-value">Not Mounted <span class="badge badge-red">N/A</span></span></div>
+            <div class="sd-info">Insert SD card and restart to enable persistent settings</div>
+        `;
+    }
+    // TfNSW status
+    const tfnsw = d.tfnsw;
+    if (tfnsw) {
+        const statusBadge = tfnsw.has_api_key ?
+            (tfnsw.status === 'Live' ? '<span class="badge badge-green">Live</span>' : '<span class="badge badge-yellow">' + tfnsw.status + '</span>') :
+            '<span class="badge badge-red">No Key</span>';
+        let depHtml = '';
+        if (tfnsw.departures && tfnsw.departures.length > 0) {
+            depHtml = '<div style="margin-top:10px;font-size:12px;color:#888">Next departures:</div>';
+            tfnsw.departures.forEach(d => {
+                const rtBadge = d.realtime ? '<span style="color:#4caf50">●</span>' : '';
+                depHtml += `<div class="status-row"><span class="status-label">${d.destination}</span><span class="status-value">${rtBadge} ${d.mins}</span></div>`;
+            });
+        }
+        document.getElementById('tfnsw-status').innerHTML = `
+            <div class="status-row"><span class="status-label">Status</span><span class="status-value">${statusBadge}</span></div>
+            <div class="status-row"><span class="status-label">API Key</span><span class="status-value">${tfnsw.has_api_key ? 'Configured' : 'Not set'}</span></div>
+            <div class="status-row"><span class="status-label">Station</span><span class="status-value">${tfnsw.station || 'Victoria Cross'}</span></div>
+            ${depHtml}
+        `;
+    } else {
+        document.getElementById('tfnsw-status').innerHTML = '<div class="status-row"><span class="status-label">Status</span><span class="status-value">Not initialized</span></div>';
+    }
+}
+let statusPoll = null;
+function startEvents() {
+    // Deltas from /api/events patch the last /api/status payload;
+    // polling only runs while the stream is down
+    const es = new EventSource('/api/events');
+    const patch = (fn) => (e) => {
+        if (!lastStatus) return;
+        fn(JSON.parse(e.data));
+        renderStatus(lastStatus);
+    };
+    es.addEventListener('view', patch(v => { lastStatus.view = v.view; }));
+    es.addEventListener('tfnsw', patch(t => { lastStatus.tfnsw = t; }));
+    es.addEventListener('wifi', patch(w => Object.assign(lastStatus, w)));
+    es.addEventListener('heap', patch(h => Object.assign(lastStatus, h)));
+    es.onopen = () => { clearInterval(statusPoll); statusPoll = setInterval(fetchStatus, 60000); };
+    es.onerror = () => { clearInterval(statusPoll); statusPoll = setInterval(fetchStatus, 5000); };
+}
+function updateViewButtons() {
+    if (!viewsLoaded) return;
+    document.querySelectorAll('#view-btns .view-btn').forEach(btn => {
+        btn.classList.toggle('active', parseInt(btn.dataset.view) === currentView);
+    });
+    // Update current view name display
+    const view = viewsData.find(v => v.id === currentView);
+    if (view) {
+        document.getElementById('current-view-name').textContent = view.name;
+    }
+}
+function updateThemeButtons() {
+    document.querySelectorAll('.color-btn').forEach(btn => {
+        btn.classList.toggle('active', parseInt(btn.dataset.color) === currentTheme);
+    });
+}
+async function setView(viewId) {
+    await fetch('/api/display', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({command: 'scene', scene: viewId}) });
+    currentView = viewId;
+    updateViewButtons();
+    // Refresh views to get updated active state
+    setTimeout(fetchViews, 300);
+}
+async function setTheme(color) {
+    await fetch('/api/display', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({command: 'theme', color: color}) });
+    currentTheme = color;
+    updateThemeButtons();
+}
+async function sendCmd(cmd) {
+    await fetch('/api/display', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({command: cmd}) });
+}
+async function setBrightness() {
+    const b = document.getElementById('brightness').value;
+    await fetch('/api/display', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({command: 'brightness', level: parseInt(b)}) });
+}
+async function sysCmd(cmd) {
+    if (!confirm('Are you sure?')) return;
+    await fetch('/api/system', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({command: cmd}) });
+}
+async function settingsAction(action) {
+    if (!confirm('Are you sure?')) return;
+    const res = await fetch('/api/settings', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({action: action}) });
+    const data = await res.json();
+    alert(data.message);
+    fetchStatus();
+}
+document.getElementById('wifi-form').addEventListener('submit', async (e) => {
+    e.preventDefault();
+    const ssid = document.getElementById('wifi-ssid').value;
+    const pass = document.getElementById('wifi-pass').value;
+    await fetch('/api/wifi', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({ssid, password: pass}) });
+    alert('Credentials saved. Device will restart.');
+});
+document.getElementById('apikey-form').addEventListener('submit', async (e) => {
+    e.preventDefault();
+    const apikey = document.getElementById('apikey').value;
+    if (!apikey) { alert('Please enter an API key'); return; }
+    const res = await fetch('/api/tfnsw', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({action: 'set_key', api_key: apikey}) });
+    const data = await res.json();
+    alert(data.message);
+    document.getElementById('apikey').value = '';
+    fetchStatus();
+});
+async function clearApiKey() {
+    if (!confirm('Clear API key?')) return;
+    const res = await fetch('/api/tfnsw', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({action: 'clear_key'}) });
+    const data = await res.json();
+    alert(data.message);
+    fetchStatus();
+}
+async function refreshDepartures() {
+    const res = await fetch('/api/tfnsw', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({action: 'refresh'}) });
+    const data = await res.json();
+    fetchStatus();
+}
+let ledAutoMode = true;
+let currentLedColor = 0;
+function updateLedButtons() {
+    document.querySelectorAll('#led-grid .color-btn').forEach(btn => {
+        btn.classList.toggle('active', !ledAutoMode && parseInt(btn.dataset.led) === currentLedColor);
+    });
+    document.getElementById('led-auto-btn').classList.toggle('btn-primary', ledAutoMode);
+    document.getElementById('led-auto-btn').classList.toggle('btn-secondary', !ledAutoMode);
+}
+async function setLed(color) {
+    await fetch('/api/led', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({action: 'set_color', color: color}) });
+    ledAutoMode = false;
+    currentLedColor = color;
+    updateLedButtons();
+}
+async function setLedAuto() {
+    await fetch('/api/led', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({action: 'auto'}) });
+    ledAutoMode = true;
+    updateLedButtons();
+}
+async function setLedOff() {
+    await fetch('/api/led', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({action: 'off'}) });
+    ledAutoMode = false;
+    currentLedColor = 0;
+    updateLedButtons();
+}
+async function fetchDebug() {
+    try {
+        const res = await fetch('/api/debug');
+        const d = await res.json();
+        const t = d.tfnsw || {};
+        const errCtx = t.parse_error_context || 'None';
+        const respStart = (t.response_start || '').substring(0, 50);
+        const respEnd = (t.response_end || '').substring(0, 50);
+        document.getElementById('debug-info').innerHTML = `
+            <div class="status-row"><span class="status-label">Free Heap</span><span class="status-value">${(d.free_heap/1024).toFixed(1)} KB</span></div>
+            <div class="status-row"><span class="status-label">Min Free Heap</span><span class="status-value">${(d.min_free_heap/1024).toFixed(1)} KB</span></div>
+            <div class="status-row"><span class="status-label">Largest Block</span><span class="status-value">${(d.largest_free_block/1024).toFixed(1)} KB</span></div>
+            <div class="status-row"><span class="status-label">API Status</span><span class="status-value">${t.status}</span></div>
+            <div class="status-row"><span class="status-label">Last Response</span><span class="status-value">${(t.last_response_size/1024).toFixed(1)} KB</span></div>
+            <div class="status-row"><span class="status-label">Buffer Size</span><span class="status-value">${(t.buffer_size/1024).toFixed(0)} KB ${t.buffer_overflow ? '<span class="badge badge-red">OVERFLOW</span>' : ''}</span></div>
+            <div class="status-row"><span class="status-label">Heap Before Parse</span><span class="status-value">${(t.heap_before_parse/1024).toFixed(1)} KB</span></div>
+            <div class="status-row"><span class="status-label">Heap After Parse</span><span class="status-value">${(t.heap_after_parse/1024).toFixed(1)} KB</span></div>
+            <div class="status-row"><span class="status-label">Parse Stats</span><span class="status-value">${t.parse_success_count} OK / ${t.parse_fail_count} fail</span></div>
+            <div class="status-row"><span class="status-label">Parse Error</span><span class="status-value" style="font-size:11px;word-break:break-all">${errCtx}</span></div>
+            <div class="status-row"><span class="status-label">Response Start</span><span class="status-value" style="font-size:10px;word-break:break-all">${respStart}...</span></div>
+            <div class="status-row"><span class="status-label">Response End</span><span class="status-value" style="font-size:10px;word-break:break-all">...${respEnd}</span></div>
+            <div class="status-row"><span class="status-label">Data Status</span><span class="status-value">${t.northbound_count}N/${t.southbound_count}S ${t.is_stale ? '<span class="badge badge-yellow">STALE</span>' : ''} ${t.is_cached_fallback ? '<span class="badge badge-yellow">CACHED</span>' : ''}</span></div>
+            <div class="status-row"><span class="status-label">Error Msg</span><span class="status-value" style="font-size:11px">${t.error_message || 'None'}</span></div>
+        `;
+    } catch(e) { document.getElementById('debug-info').innerHTML = '<p style="color:#f44336">Error loading debug info</p>'; }
+}
+let mirrorWs = null;
+let mirrorImg = null;
+function mirrorDecode(buf) {
+    // Records: HELLO (1) or RECT (2) + PackBits RLE of big-endian BGR565 pixels
+    const v = new DataView(buf);
+    const ctx = document.getElementById('mirror').getContext('2d');
+    let p = 0;
+    while (p < v.byteLength) {
+        const type = v.getUint8(p);
+        if (type === 1) {
+            const c = document.getElementById('mirror');
+            c.width = v.getUint16(p + 1, true);
+            c.height = v.getUint16(p + 3, true);
+            mirrorImg = ctx.createImageData(c.width, c.height);
+            p += 6;
+            continue;
+        }
+        if (type !== 2 || !mirrorImg) return;
+        const x = v.getUint16(p + 1, true), y = v.getUint16(p + 3, true);
+        const w = v.getUint16(p + 5, true), h = v.getUint16(p + 7, true);
+        p += 9;
+        const d = mirrorImg.data, stride = mirrorImg.width;
+        let i = 0;
+        const put = (px) => {
+            const o = ((y + Math.floor(i / w)) * stride + x + (i % w)) * 4;
+            d[o] = (px & 0x1F) << 3;
+            d[o + 1] = ((px >> 5) & 0x3F) << 2;
+            d[o + 2] = (px >> 11) << 3;
+            d[o + 3] = 255;
+            i++;
+        };
+        while (i < w * h) {
+            const c = v.getUint8(p++);
+            if (c & 0x80) {
+                const px = v.getUint16(p, false);
+                p += 2;
+                for (let n = (c & 0x7F) + 1; n > 0; n--) put(px);
+            } else {
+                for (let n = c + 1; n > 0; n--) { put(v.getUint16(p, false)); p += 2; }
+            }
+        }
+    }
+    ctx.putImageData(mirrorImg, 0, 0);
+}
+function toggleMirror() {
+    if (mirrorWs) { mirrorWs.close(); return; }
+    mirrorWs = new WebSocket('ws://' + location.host + '/ws/display');
+    mirrorWs.binaryType = 'arraybuffer';
+    mirrorWs.onmessage = (e) => mirrorDecode(e.data);
+    mirrorWs.onopen = () => {
+        document.getElementById('mirror-btn').textContent = 'Stop Mirror';
+        document.getElementById('mirror-info').textContent = 'Live';
+    };
+    mirrorWs.onclose = () => {
+        mirrorWs = null;
+        document.getElementById('mirror-btn').textContent = 'Start Mirror';
+        document.getElementById('mirror-info').textContent = 'Disconnected';
+    };
+}
+fetchViews();
+fetchStatus();
+fetchDebug();
+statusPoll = setInterval(fetchStatus, 5000);
+startEvents();
+setInterval(fetchDebug, 10000);
@@ -1,9 +1,14 @@
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include "esp_http_server.h"
 #include "esp_log.h"
 #include "esp_system.h"
 #include "esp_timer.h"
 #include "esp_heap_caps.h"
+#include "esp_random.h"
+#include "sdkconfig.h"
 #include "cJSON.h"
 
 #include "config.h"
@@ -13,586 +18,186 @@
 #include "settings.h"
 #include "tfnsw_client.h"
 #include "rgb_led.h"
+#include "render_perf.h"
+#include "display_mirror.h"
+#include "event_stream.h"
+#include "json_writer.h"
+#include "cbor_writer.h"
+#include "metrics.h"
+#include "lan_sync.h"
+#include "log_ring.h"
+#include "event_trace.h"
+#include "boot_pipeline.h"
+#include "power_mgmt.h"
+#include "night_mode.h"
+#include "sd_card.h"
 
 static const char *TAG = "web_server";
 
+// Streams (SSE, /ws/display, log follow) hold their sockets for as long as
+// the page is open; ordinary requests get the rest. httpd keeps 3 sockets of
+// CONFIG_LWIP_MAX_SOCKETS for itself, and lan_sync and the TfNSW client need
+// a few more.
+#define WEB_STREAM_SOCKETS  (EVENT_STREAM_MAX_CLIENTS + MIRROR_MAX_CLIENTS + LOG_FOLLOW_MAX_CLIENTS)
+#define WEB_MAX_OPEN_SOCKETS (WEB_STREAM_SOCKETS + 6)
+_Static_assert(WEB_MAX_OPEN_SOCKETS + 3 + LAN_SYNC_MAX_PEERS + 2 <= CONFIG_LWIP_MAX_SOCKETS,
+               "CONFIG_LWIP_MAX_SOCKETS too small for the web server");
+
 static httpd_handle_t server = NULL;
 static display_cmd_cb_t display_callback = NULL;
 static system_cmd_cb_t system_callback = NULL;
 static api_key_set_cb_t api_key_callback = NULL;
 
 // ============================================================================
-// HTML Content
+// Dashboard Assets
 // ============================================================================
 
-static const char INDEX_HTML[] = R"rawliteral(
-<!DOCTYPE html>
-<html>
-<head>
-    <meta charset="UTF-8">
-    <meta name="viewport" content="width=device-width, initial-scale=1.0">
-    <title>ESP32 LCD Control</title>
-    <style>
-        * { box-sizing: border-box; margin: 0; padding: 0; }
-        body {
-            font-family: -apple-system, BlinkMacSystemFont, 'Segoe UI', Roboto, sans-serif;
-            background: #1a1a2e;
-            color: #eee;
-            min-height: 100vh;
-            padding: 20px;
-        }
-        .container { max-width: 600px; margin: 0 auto; }
-        h1 { color: #ffe000; margin-bottom: 20px; text-align: center; }
-        .card {
-            background: #16213e;
-            border-radius: 12px;
-            padding: 20px;
-            margin-bottom: 20px;
-        }
-        .card h2 { color: #ffe000; margin-bottom: 15px; font-size: 1.2em; }
-        .status-row {
-            display: flex;
-            justify-content: space-between;
-            padding: 8px 0;
-            border-bottom: 1px solid #2a3f5f;
-        }
-        .status-row:last-child { border-bottom: none; }
-        .status-label { color: #888; }
-        .status-value { color: #fff; font-weight: 500; }
-        .badge { display: inline-block; padding: 2px 8px; border-radius: 4px; font-size: 11px; margin-left: 8px; }
-        .badge-green { background: #4caf50; color: #fff; }
-        .badge-red { background: #f44336; color: #fff; }
-        .badge-yellow { background: #ffe000; color: #000; }
-        .btn {
-            display: inline-block;
-            padding: 12px 24px;
-            border: none;
-            border-radius: 8px;
-            cursor: pointer;
-            font-size: 14px;
-            font-weight: 500;
-            margin: 5px;
-        }
-        .btn:hover { opacity: 0.85; transform: scale(0.98); }
-        .btn-primary { background: #ffe000; color: #000; }
-        .btn-danger { background: #f44336; color: #fff; }
-        .btn-success { background: #4caf50; color: #fff; }
-        .btn-secondary { background: #2a3f5f; color: #fff; }
-        .btn-scene { background: #2a3f5f; color: #fff; flex: 1; }
-        .btn-scene.active { background: #ffe000; color: #000; }
-        .btn-group { display: flex; flex-wrap: wrap; gap: 10px; margin-top: 15px; }
-        input[type="range"] { width: 100%; margin: 10px 0; accent-color: #ffe000; }
-        .slider-label { display: flex; justify-content: space-between; }
-        .form-group { margin-bottom: 15px; }
-        input[type="text"], input[type="password"] {
-            width: 100%;
-            padding: 10px;
-            border: 1px solid #2a3f5f;
-            border-radius: 6px;
-            background: #1a1a2e;
-            color: #fff;
-            margin-top: 5px;
-        }
-        input[type="text"]:focus, input[type="password"]:focus {
-            border-color: #ffe000;
-            outline: none;
-        }
-        label { color: #888; }
-        .color-grid { display: grid; grid-template-columns: repeat(7, 1fr); gap: 8px; margin-top: 10px; }
-        .color-btn {
-            width: 100%;
-            aspect-ratio: 1;
-            border: 2px solid transparent;
-            border-radius: 8px;
-            cursor: pointer;
-            transition: transform 0.1s, border-color 0.1s;
-        }
-        .color-btn:hover { transform: scale(1.1); }
-        .color-btn.active { border-color: #fff; }
-        .scene-info { font-size: 12px; color: #666; margin-top: 8px; text-align: center; }
-        .view-grid { display: grid; grid-template-columns: repeat(2, 1fr); gap: 10px; }
-        .view-btn {
-            display: flex; flex-direction: column; align-items: center; justify-content: center;
-            padding: 12px 8px; border: 2px solid #2a3f5f; border-radius: 10px;
-            background: #1a1a2e; cursor: pointer; transition: all 0.2s;
-        }
-        .view-btn:hover { border-color: #ffe000; transform: scale(0.98); }
-        .view-btn.active { border-color: #ffe000; background: #2a3f5f; }
-        .view-btn .color-dot { width: 10px; height: 10px; border-radius: 50%; margin-bottom: 6px; }
-        .view-btn .view-name { color: #fff; font-weight: 500; font-size: 14px; }
-        .view-btn .view-source { font-size: 10px; color: #888; margin-top: 4px; }
-        .view-btn .view-source.realtime { color: #4caf50; }
-        .view-btn .view-source.static { color: #ff9800; }
-        .progress-bar { background: #2a3f5f; border-radius: 4px; height: 8px; margin-top: 8px; overflow: hidden; }
-        .progress-fill { background: #ffe000; height: 100%; transition: width 0.3s; }
-        .sd-info { font-size: 12px; color: #888; margin-top: 4px; }
-    </style>
-</head>
-<body>
-    <div class="container">
-        <h1>Departure Board</h1>
-        <div class="card">
-            <h2>System Status</h2>
-            <div id="status">Loading...</div>
-        </div>
-        <div class="card">
-            <h2>SD Card Storage</h2>
-            <div id="sd-status">Checking...</div>
-        </div>
-        <div class="card">
-            <h2>TfNSW Live Data</h2>
-            <div id="tfnsw-status">Checking...</div>
-            <form id="apikey-form" style="margin-top: 15px;">
-                <div class="form-group">
-                    <label>TfNSW API Key</label>
-                    <input type="password" id="apikey" placeholder="Enter your API key">
-                </div>
-                <div class="btn-group">
-                    <button type="submit" class="btn btn-primary">Save API Key</button>
-                    <button type="button" class="btn btn-secondary" onclick="clearApiKey()">Clear</button>
-                    <button type="button" class="btn btn-success" onclick="refreshDepartures()">Refresh</button>
-                </div>
-            </form>
-            <div class="scene-info">Get your free API key from <a href="https://opendata.transport.nsw.gov.au" target="_blank" style="color:#ffe000">opendata.transport.nsw.gov.au</a></div>
-        </div>
-        <div class="card">
-            <h2>Display View</h2>
-            <div id="current-view-info" style="margin-bottom:12px;padding:10px;background:#1a1a2e;border-radius:8px;text-align:center;">
-                <span style="color:#888">Current:</span> <span id="current-view-name" style="color:#ffe000;font-weight:600">Loading...</span>
-            </div>
-            <div class="view-grid" id="view-btns">Loading views...</div>
-            <div class="scene-info">Press the button on device to cycle views</div>
-        </div>
-        <div class="card">
-            <h2>Theme Color</h2>
-            <div class="color-grid" id="color-grid">
-                <button class="color-btn" style="background:#00e0ff" data-color="16769024" onclick="setTheme(16769024)" title="Teal"></button>
-                <button class="color-btn" style="background:#0080ff" data-color="16744448" onclick="setTheme(16744448)" title="Blue"></button>
-                <button class="color-btn" style="background:#4444ff" data-color="16729156" onclick="setTheme(16729156)" title="Purple"></button>
-                <button class="color-btn" style="background:#ff00ff" data-color="16711935" onclick="setTheme(16711935)" title="Magenta"></button>
-                <button class="color-btn" style="background:#ffd400" data-color="54527" onclick="setTheme(54527)" title="Yellow"></button>
-                <button class="color-btn" style="background:#80ff00" data-color="65408" onclick="setTheme(65408)" title="Lime"></button>
-                <button class="color-btn" style="background:#ffffff" data-color="16777215" onclick="setTheme(16777215)" title="White"></button>
-            </div>
-        </div>
-        <div class="card">
-            <h2>Status LED</h2>
-            <div class="color-grid" id="led-grid">
-                <button class="color-btn" style="background:#00ffff" data-led="65535" onclick="setLed(65535)" title="Teal"></button>
-                <button class="color-btn" style="background:#ffff00" data-led="16776960" onclick="setLed(16776960)" title="Yellow"></button>
-                <button class="color-btn" style="background:#00ff00" data-led="65280" onclick="setLed(65280)" title="Green"></button>
-                <button class="color-btn" style="background:#ff8000" data-led="16744448" onclick="setLed(16744448)" title="Orange"></button>
-                <button class="color-btn" style="background:#ff0000" data-led="16711680" onclick="setLed(16711680)" title="Red"></button>
-                <button class="color-btn" style="background:#ff00ff" data-led="16711935" onclick="setLed(16711935)" title="Magenta"></button>
-                <button class="color-btn" style="background:#0000ff" data-led="255" onclick="setLed(255)" title="Blue"></button>
-            </div>
-            <div class="btn-group" style="margin-top:10px">
-                <button class="btn btn-secondary" onclick="setLedAuto()" id="led-auto-btn">Auto (Follow View)</button>
-                <button class="btn btn-secondary" onclick="setLedOff()">Off</button>
-            </div>
-            <div class="scene-info">Auto mode: LED color follows current view's accent color</div>
-        </div>
-        <div class="card">
-            <h2>Display Control</h2>
-            <div class="slider-label">
-                <span>Brightness</span>
-                <span id="brightness-value">20</span>%
-            </div>
-            <input type="range" id="brightness" min="0" max="100" value="20"
-                   oninput="document.getElementById('brightness-value').textContent=this.value"
-                   onchange="setBrightness()">
-            <div class="btn-group">
-                <button class="btn btn-primary" onclick="sendCmd('clear')">Clear Display</button>
-                <button class="btn btn-primary" onclick="sendCmd('splash')">Show Splash</button>
-            </div>
-        </div>
-        <div class="card">
-            <h2>WiFi Configuration</h2>
-            <form id="wifi-form">
-                <div class="form-group">
-                    <label>SSID</label>
-                    <input type="text" id="wifi-ssid" placeholder="Network name">
-                </div>
-                <div class="form-group">
-                    <label>Password</label>
-                    <input type="password" id="wifi-pass" placeholder="Password">
-                </div>
-                <button type="submit" class="btn btn-primary">Save & Connect</button>
-            </form>
-        </div>
-        <div class="card">
-            <h2>System</h2>
-            <div class="btn-group">
-                <button class="btn btn-secondary" onclick="settingsAction('clear_log')">Clear Log</button>
-                <button class="btn btn-danger" onclick="settingsAction('reset')">Reset Settings</button>
-                <button class="btn btn-danger" onclick="sysCmd('restart')">Restart</button>
-                <button class="btn btn-danger" onclick="sysCmd('reset_wifi')">Reset WiFi</button>
-            </div>
-        </div>
-        <div class="card">
-            <h2>Debug Info</h2>
-            <div id="debug-info">Loading...</div>
-            <div class="btn-group" style="margin-top:10px">
-                <button class="btn btn-secondary" onclick="fetchDebug()">Refresh Debug</button>
-            </div>
-        </div>
-    </div>
-    <script>
-        let currentView = 0;
-        let currentViewName = '';
-        let currentTheme = 16769024;
-        let viewsData = [];
-        let viewsLoaded = false;
-        function rgbToHex(rgb) {
-            // Convert RGB888 to CSS hex (handles BGR swap)
-            const r = (rgb >> 16) & 0xFF;
-            const g = (rgb >> 8) & 0xFF;
-            const b = rgb & 0xFF;
-            return '#' + [b,g,r].map(x => x.toString(16).padStart(2,'0')).join('');
-        }
-        async function fetchViews() {
-            try {
-                const res = await fetch('/api/views');
-                const data = await res.json();
-                viewsData = data.views || [];
-                currentView = data.current;
-                currentViewName = data.current_name;
-                const container = document.getElementById('view-btns');
-                container.innerHTML = viewsData.filter(v => v.enabled).map(v => {
-                    const colorHex = rgbToHex(v.accent_color);
-                    const sourceLabel = v.data_source === 'realtime' ? '● Live' : '◆ Demo';
-                    const sourceClass = v.data_source;
-                    return `<div class="view-btn${v.active ? ' active' : ''}" data-view="${v.id}" onclick="setView(${v.id})">
-                        <div class="color-dot" style="background:${colorHex}"></div>
-                        <span class="view-name">${v.name}</span>
-                        <span class="view-source ${sourceClass}">${sourceLabel}</span>
-                    </div>`;
-                }).join('');
-                viewsLoaded = true;
-                document.getElementById('current-view-name').textContent = currentViewName;
-            } catch(e) {
-                document.getElementById('view-btns').innerHTML = '<span style="color:#f44336">Error loading views</span>';
-            }
-        }
-        async function fetchStatus() {
-            try {
-                const res = await fetch('/api/status');
-                const d = await res.json();
-                const newView = d.view !== undefined ? d.view : (d.scene || 0);
-                if (newView !== currentView) {
-                    currentView = newView;
-                    updateViewButtons();
-                }
-                currentTheme = d.theme_color || 16769024;
-                updateThemeButtons();
-                if (d.settings && d.settings.brightness) {
-                    document.getElementById('brightness').value = d.settings.brightness;
-                    document.getElementById('brightness-value').textContent = d.settings.brightness;
-                }
-                const viewInfo = viewsData.find(v => v.id === newView);
-                const viewName = viewInfo ? viewInfo.name : 'View ' + newView;
-                document.getElementById('status').innerHTML = `
-                    <div class="status-row"><span class="status-label">Board</span><span class="status-value">${d.board}</span></div>
-                    <div class="status-row"><span class="status-label">Version</span><span class="status-value">${d.version}</span></div>
-                    <div class="status-row"><span class="status-label">Current View</span><span class="status-value" style="color:#ffe000">${viewName}</span></div>
-                    <div class="status-row"><span class="status-label">Uptime</span><span class="status-value">${Math.floor(d.uptime/60)}m ${d.uptime%60}s</span></div>
-                    <div class="status-row"><span class="status-label">WiFi</span><span class="status-value">${d.wifi_connected ? d.ssid + ' (' + d.rssi + ' dBm)' : 'AP Mode'}</span></div>
-                    <div class="status-row"><span class="status-label">IP</span><span class="status-value">${d.ip}</span></div>
-                    <div class="status-row"><span class="status-label">Free Heap</span><span class="status-value">${(d.free_heap/1024).toFixed(1)} KB</span></div>
-                `;
-                // SD Card status
-                const sd = d.sd_card;
-                if (sd && sd.mounted) {
-                    const usedPct = ((sd.used_mb / sd.total_mb) * 100).toFixed(0);
-                    document.getElementById('sd-status').innerHTML = `
-                        <div class="status-row"><span class="status-label">Status</span><span class="status-value">Mounted <span class="badge badge-green">OK</span></span></div>
-                        <div class="status-row"><span class="status-label">Capacity</span><span class="status-value">${sd.total_mb.toFixed(0)} MB</span></div>
-                        <div class="status-row"><span class="status-label">Used</span><span class="status-value">${sd.used_mb.toFixed(1)} MB (${usedPct}%)</span></div>
-                        <div class="progress-bar"><div class="progress-fill" style="width:${usedPct}%"></div></div>
-                        <div class="status-row"><span class="status-label">Settings</span><span class="status-value">${sd.settings_loaded ? '<span class="badge badge-green">Loaded</span>' : '<span class="badge badge-yellow">Defaults</span>'}</span></div>
-                        <div class="status-row"><span class="status-label">Log Size</span><span class="status-value">${(sd.log_size/1024).toFixed(1)} KB</span></div>
-                    `;
-                } else {
-                    document.getElementById('sd-status').innerHTML = `
-                        <div class="status-row"><span class="status-label">Status</span><span class="status-value">Not Mounted <span class="badge badge-red">N/A</span></span></div>
-                        <div class="sd-info">Insert SD card and restart to enable persistent settings</div>
-                    `;
-                }
-                // TfNSW status
-                const tfnsw = d.tfnsw;
-                if (tfnsw) {
-                    const statusBadge = tfnsw.has_api_key ?
-                        (tfnsw.status === 'Live' ? '<span class="badge badge-green">Live</span>' : '<span class="badge badge-yellow">' + tfnsw.status + '</span>') :
-                        '<span class="badge badge-red">No Key</span>';
-                    let depHtml = '';
-                    if (tfnsw.departures && tfnsw.departures.length > 0) {
-                        depHtml = '<div style="margin-top:10px;font-size:12px;color:#888">Next departures:</div>';
-                        tfnsw.departures.forEach(d => {
-                            const rtBadge = d.realtime ? '<span style="color:#4caf50">●</span>' : '';
-                            depHtml += `<div class="status-row"><span class="status-label">${d.destination}</span><span class="status-value">${rtBadge} ${d.mins}</span></div>`;
-                        });
-                    }
-                    document.getElementById('tfnsw-status').innerHTML = `
-                        <div class="status-row"><span class="status-label">Status</span><span class="status-value">${statusBadge}</span></div>
-                        <div class="status-row"><span class="status-label">API Key</span><span class="status-value">${tfnsw.has_api_key ? 'Configured' : 'Not set'}</span></div>
-                        <div class="status-row"><span class="status-label">Station</span><span class="status-value">${tfnsw.station || 'Victoria Cross'}</span></div>
-                        ${depHtml}
-                    `;
-                } else {
-                    document.getElementById('tfnsw-status').innerHTML = '<div class="status-row"><span class="status-label">Status</span><span class="status-value">Not initialized</span></div>';
-                }
-            } catch(e) { document.getElementById('status').innerHTML = '<p style="color:#f44336">Error loading status</p>'; }
-        }
-        function updateViewButtons() {
-            if (!viewsLoaded) return;
-            document.querySelectorAll('#view-btns .view-btn').forEach(btn => {
-                btn.classList.toggle('active', parseInt(btn.dataset.view) === currentView);
-            });
-            // Update current view name display
-            const view = viewsData.find(v => v.id === currentView);
-            if (view) {
-                document.getElementById('current-view-name').textContent = view.name;
-            }
-        }
-        function updateThemeButtons() {
-            document.querySelectorAll('.color-btn').forEach(btn => {
-                btn.classList.toggle('active', parseInt(btn.dataset.color) === currentTheme);
-            });
-        }
-        async function setView(viewId) {
-            await fetch('/api/display', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({command: 'scene', scene: viewId}) });
-            currentView = viewId;
-            updateViewButtons();
-            // Refresh views to get updated active state
-            setTimeout(fetchViews, 300);
-        }
-        async function setTheme(color) {
-            await fetch('/api/display', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({command: 'theme', color: color}) });
-            currentTheme = color;
-            updateThemeButtons();
-        }
-        async function sendCmd(cmd) {
-            await fetch('/api/display', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({command: cmd}) });
-        }
-        async function setBrightness() {
-            const b = document.getElementById('brightness').value;
-            await fetch('/api/display', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({command: 'brightness', level: parseInt(b)}) });
-        }
-        async function sysCmd(cmd) {
-            if (!confirm('Are you sure?')) return;
-            await fetch('/api/system', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({command: cmd}) });
-        }
-        async function settingsAction(action) {
-            if (!confirm('Are you sure?')) return;
-            const res = await fetch('/api/settings', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({action: action}) });
-            const data = await res.json();
-            alert(data.message);
-            fetchStatus();
-        }
-        document.getElementById('wifi-form').addEventListener('submit', async (e) => {
-            e.preventDefault();
-            const ssid = document.getElementById('wifi-ssid').value;
-            const pass = document.getElementById('wifi-pass').value;
-            await fetch('/api/wifi', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({ssid, password: pass}) });
-            alert('Credentials saved. Device will restart.');
-        });
-        document.getElementById('apikey-form').addEventListener('submit', async (e) => {
-            e.preventDefault();
-            const apikey = document.getElementById('apikey').value;
-            if (!apikey) { alert('Please enter an API key'); return; }
-            const res = await fetch('/api/tfnsw', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({action: 'set_key', api_key: apikey}) });
-            const data = await res.json();
-            alert(data.message);
-            document.getElementById('apikey').value = '';
-            fetchStatus();
-        });
-        async function clearApiKey() {
-            if (!confirm('Clear API key?')) return;
-            const res = await fetch('/api/tfnsw', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({action: 'clear_key'}) });
-            const data = await res.json();
-            alert(data.message);
-            fetchStatus();
-        }
-        async function refreshDepartures() {
-            const res = await fetch('/api/tfnsw', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({action: 'refresh'}) });
-            const data = await res.json();
-            fetchStatus();
-        }
-        let ledAutoMode = true;
-        let currentLedColor = 0;
-        function updateLedButtons() {
-            document.querySelectorAll('#led-grid .color-btn').forEach(btn => {
-                btn.classList.toggle('active', !ledAutoMode && parseInt(btn.dataset.led) === currentLedColor);
-            });
-            document.getElementById('led-auto-btn').classList.toggle('btn-primary', ledAutoMode);
-            document.getElementById('led-auto-btn').classList.toggle('btn-secondary', !ledAutoMode);
-        }
-        async function setLed(color) {
-            await fetch('/api/led', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({action: 'set_color', color: color}) });
-            ledAutoMode = false;
-            currentLedColor = color;
-            updateLedButtons();
-        }
-        async function setLedAuto() {
-            await fetch('/api/led', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({action: 'auto'}) });
-            ledAutoMode = true;
-            updateLedButtons();
-        }
-        async function setLedOff() {
-            await fetch('/api/led', { method: 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify({action: 'off'}) });
-            ledAutoMode = false;
-            currentLedColor = 0;
-            updateLedButtons();
-        }
-        async function fetchDebug() {
-            try {
-                const res = await fetch('/api/debug');
-                const d = await res.json();
-                const t = d.tfnsw || {};
-                const errCtx = t.parse_error_context || 'None';
-                const respStart = (t.response_start || '').substring(0, 50);
-                const respEnd = (t.response_end || '').substring(0, 50);
-                document.getElementById('debug-info').innerHTML = `
-                    <div class="status-row"><span class="status-label">Free Heap</span><span class="status-value">${(d.free_heap/1024).toFixed(1)} KB</span></div>
-                    <div class="status-row"><span class="status-label">Min Free Heap</span><span class="status-value">${(d.min_free_heap/1024).toFixed(1)} KB</span></div>
-                    <div class="status-row"><span class="status-label">Largest Block</span><span class="status-value">${(d.largest_free_block/1024).toFixed(1)} KB</span></div>
-                    <div class="status-row"><span class="status-label">API Status</span><span class="status-value">${t.status}</span></div>
-                    <div class="status-row"><span class="status-label">Last Response</span><span class="status-value">${(t.last_response_size/1024).toFixed(1)} KB</span></div>
-                    <div class="status-row"><span class="status-label">Buffer Size</span><span class="status-value">${(t.buffer_size/1024).toFixed(0)} KB ${t.buffer_overflow ? '<span class="badge badge-red">OVERFLOW</span>' : ''}</span></div>
-                    <div class="status-row"><span class="status-label">Heap Before Parse</span><span class="status-value">${(t.heap_before_parse/1024).toFixed(1)} KB</span></div>
-                    <div class="status-row"><span class="status-label">Heap After Parse</span><span class="status-value">${(t.heap_after_parse/1024).toFixed(1)} KB</span></div>
-                    <div class="status-row"><span class="status-label">Parse Stats</span><span class="status-value">${t.parse_success_count} OK / ${t.parse_fail_count} fail</span></div>
-                    <div class="status-row"><span class="status-label">Parse Error</span><span class="status-value" style="font-size:11px;word-break:break-all">${errCtx}</span></div>
-                    <div class="status-row"><span class="status-label">Response Start</span><span class="status-value" style="font-size:10px;word-break:break-all">${respStart}...</span></div>
-                    <div class="status-row"><span class="status-label">Response End</span><span class="status-value" style="font-size:10px;word-break:break-all">...${respEnd}</span></div>
-                    <div class="status-row"><span class="status-label">Data Status</span><span class="status-value">${t.northbound_count}N/${t.southbound_count}S ${t.is_stale ? '<span class="badge badge-yellow">STALE</span>' : ''} ${t.is_cached_fallback ? '<span class="badge badge-yellow">CACHED</span>' : ''}</span></div>
-                    <div class="status-row"><span class="status-label">Error Msg</span><span class="status-value" style="font-size:11px">${t.error_message || 'None'}</span></div>
-                `;
-            } catch(e) { document.getElementById('debug-info').innerHTML = '<p style="color:#f44336">Error loading debug info</p>'; }
-        }
-        fetchViews();
-        fetchStatus();
-        fetchDebug();
-        setInterval(fetchStatus, 5000);
-        setInterval(fetchDebug, 10000);
-    </script>
-</body>
-</html>
-)rawliteral";
+// Minified + gzipped by tools/pack_dashboard.py at build time (see CMakeLists.txt)
+extern const uint8_t index_html_gz_start[] asm("_binary_index_html_gz_start");
+extern const uint8_t index_html_gz_end[] asm("_binary_index_html_gz_end");
+extern const char index_html_etag[] asm("_binary_index_html_etag_start");
+extern const uint8_t app_css_gz_start[] asm("_binary_app_css_gz_start");
+extern const uint8_t app_css_gz_end[] asm("_binary_app_css_gz_end");
+extern const char app_css_etag[] asm("_binary_app_css_etag_start");
+extern const uint8_t app_js_gz_start[] asm("_binary_app_js_gz_start");
+extern const uint8_t app_js_gz_end[] asm("_binary_app_js_gz_end");
+extern const char app_js_etag[] asm("_binary_app_js_etag_start");
+
+typedef struct {
+    const char *type;
+    const uint8_t *start;
+    const uint8_t *end;
+    const char *etag;
+    const char *cache_control;
+} static_asset_t;
+
+// The page is revalidated on every load (a 304 is ~150 bytes); the CSS/JS
+// URLs carry their content hash, so they never need revalidating.
+static const static_asset_t asset_index = {
+    "text/html", index_html_gz_start, index_html_gz_end, index_html_etag, "no-cache"
+};
+static const static_asset_t asset_css = {
+    "text/css", app_css_gz_start, app_css_gz_end, app_css_etag, "public, max-age=31536000, immutable"
+};
+static const static_asset_t asset_js = {
+    "application/javascript", app_js_gz_start, app_js_gz_end, app_js_etag, "public, max-age=31536000, immutable"
+};
 
 // ============================================================================
 // Request Handlers
 // ============================================================================
 
-static esp_err_t root_handler(httpd_req_t *req)
+static esp_err_t static_asset_handler(httpd_req_t *req)
 {
-    httpd_resp_set_type(req, "text/html");
-    httpd_resp_send(req, INDEX_HTML, strlen(INDEX_HTML));
-    return ESP_OK;
+    const static_asset_t *asset = (const static_asset_t *)req->user_ctx;
+
+    httpd_resp_set_hdr(req, "ETag", asset->etag);
+    httpd_resp_set_hdr(req, "Cache-Control", asset->cache_control);
+
+    char if_none_match[40];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK &&
+        strcmp(if_none_match, asset->etag) == 0) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    httpd_resp_set_type(req, asset->type);
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    return httpd_resp_send(req, (const char *)asset->start, asset->end - asset->start);
 }
 
 static esp_err_t api_status_handler(httpd_req_t *req)
 {
-    cJSON *root = cJSON_CreateObject();
-
-    cJSON_AddStringToObject(root, "board", BOARD_NAME);
-    cJSON_AddStringToObject(root, "version", FIRMWARE_VERSION);
-    cJSON_AddNumberToObject(root, "uptime", esp_timer_get_time() / 1000000);
-    cJSON_AddBoolToObject(root, "wifi_connected", wifi_is_connected());
-    cJSON_AddStringToObject(root, "ip", wifi_get_ip());
-    cJSON_AddStringToObject(root, "ssid", wifi_get_ssid());
-    cJSON_AddNumberToObject(root, "rssi", wifi_get_rssi());
-    cJSON_AddNumberToObject(root, "free_heap", esp_get_free_heap_size());
-    cJSON_AddNumberToObject(root, "view", lcd_get_current_view());
-    cJSON_AddNumberToObject(root, "scene", lcd_get_current_scene());  // Legacy
-    cJSON_AddNumberToObject(root, "theme_color", lcd_get_theme_accent());
-
-    // Storage info (SD card disabled)
-    cJSON *storage = cJSON_CreateObject();
-    cJSON_AddBoolToObject(storage, "mounted", false);
-    cJSON_AddStringToObject(storage, "type", "nvs");
-    cJSON_AddItemToObject(root, "storage", storage);
+    json_writer_t w;
+    jw_begin(&w, req, false);
+    jw_object_begin(&w, NULL);
+
+    jw_string(&w, "board", BOARD_NAME);
+    jw_string(&w, "version", FIRMWARE_VERSION);
+    jw_number(&w, "uptime", esp_timer_get_time() / 1000000);
+    jw_bool(&w, "wifi_connected", wifi_is_connected());
+    jw_string(&w, "ip", wifi_get_ip());
+    jw_string(&w, "ssid", wifi_get_ssid());
+    jw_number(&w, "rssi", wifi_get_rssi());
+    jw_number(&w, "free_heap", esp_get_free_heap_size());
+    jw_number(&w, "view", lcd_get_current_view());
+    jw_number(&w, "scene", lcd_get_current_scene());  // Legacy
+    jw_number(&w, "theme_color", lcd_get_theme_accent());
+
+    jw_object_begin(&w, "lan");
+    jw_string(&w, "role", lan_sync_role_name(lan_sync_get_role()));
+    jw_string(&w, "state", lan_sync_state_name());
+    if (lan_sync_get_role() == LAN_ROLE_HUB) {
+        jw_number(&w, "followers", lan_sync_peer_count());
+    }
+    jw_object_end(&w);
+
+    // Storage info
+    jw_object_begin(&w, "storage");
+    jw_bool(&w, "mounted", sd_card_is_mounted());
+    jw_string(&w, "type", "sd");
+    jw_object_end(&w);
 
     // Current settings summary
     const device_settings_t* cfg = settings_get();
-    cJSON *settings = cJSON_CreateObject();
-    cJSON_AddNumberToObject(settings, "brightness", cfg->brightness);
-    cJSON_AddNumberToObject(settings, "default_scene", cfg->default_scene);
-    cJSON_AddStringToObject(settings, "destination", cfg->destination);
-    cJSON_AddItemToObject(root, "settings", settings);
-
-    // TfNSW status
-    cJSON *tfnsw = cJSON_CreateObject();
-    cJSON_AddBoolToObject(tfnsw, "has_api_key", tfnsw_has_api_key());
-    cJSON_AddStringToObject(tfnsw, "status", tfnsw_status_to_string(tfnsw_get_status()));
-
-    // Add current departures if available
-    tfnsw_departures_t deps;
-    tfnsw_get_current_departures(&deps);
-    if (deps.count > 0) {
-        cJSON_AddStringToObject(tfnsw, "station", deps.station_name);
-        cJSON *departures = cJSON_CreateArray();
-        for (int i = 0; i < deps.count && i < 3; i++) {
-            cJSON *dep = cJSON_CreateObject();
-            cJSON_AddStringToObject(dep, "destination", deps.departures[i].destination);
-            char mins_str[16];
-            tfnsw_format_departure_time(deps.departures[i].mins_to_departure, mins_str, sizeof(mins_str));
-            cJSON_AddStringToObject(dep, "mins", mins_str);
-            cJSON_AddBoolToObject(dep, "realtime", deps.departures[i].is_realtime);
-            cJSON_AddItemToArray(departures, dep);
-        }
-        cJSON_AddItemToObject(tfnsw, "departures", departures);
+    jw_object_begin(&w, "settings");
+    jw_number(&w, "brightness", cfg->brightness);
+    jw_number(&w, "default_scene", cfg->default_scene);
+    jw_string(&w, "destination", cfg->destination);
+    jw_object_end(&w);
+
+    // TfNSW status: the same bytes as the /api/events "tfnsw" topic, so a
+    // poll never disagrees with what the stream sent
+    tfnsw_departures_t *deps = malloc(sizeof(tfnsw_departures_t));
+    char tfnsw_json[768];
+    int tfnsw_len = deps ? event_stream_format_tfnsw(tfnsw_json, sizeof(tfnsw_json), deps) : -1;
+    free(deps);
+    if (tfnsw_len > 0 && tfnsw_len < (int)sizeof(tfnsw_json)) {
+        jw_raw(&w, "tfnsw", tfnsw_json, (size_t)tfnsw_len);
+    } else {
+        jw_object_begin(&w, "tfnsw");
+        jw_bool(&w, "has_api_key", tfnsw_has_api_key());
+        jw_object_end(&w);
     }
-    cJSON_AddItemToObject(root, "tfnsw", tfnsw);
-
-    const char *json = cJSON_PrintUnformatted(root);
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, json, strlen(json));
 
-    free((void*)json);
-    cJSON_Delete(root);
-    return ESP_OK;
+    jw_object_end(&w);
+    return jw_finish(&w);
 }
-
 static esp_err_t api_views_handler(httpd_req_t *req)
 {
-    cJSON *root = cJSON_CreateObject();
-    cJSON *views = cJSON_CreateArray();
+    json_writer_t w;
+    jw_begin(&w, req, false);
+    jw_object_begin(&w, NULL);
 
     // Get current view info
     view_id_t current = lcd_get_current_view();
     const view_config_t* current_config = lcd_get_view_config(current);
-    cJSON_AddNumberToObject(root, "current", current);
-    cJSON_AddStringToObject(root, "current_name", current_config ? current_config->name : "Unknown");
+    jw_number(&w, "current", current);
+    jw_string(&w, "current_name", current_config ? current_config->name : "Unknown");
 
     // Get all views from the view registry
+    jw_array_begin(&w, "views");
     uint8_t view_count = lcd_get_view_count();
     for (uint8_t i = 0; i < view_count; i++) {
         const view_config_t* config = lcd_get_view_config((view_id_t)i);
         if (config) {
-            cJSON *view = cJSON_CreateObject();
-            cJSON_AddNumberToObject(view, "id", config->id);
-            cJSON_AddStringToObject(view, "name", config->name);
-            cJSON_AddStringToObject(view, "header", config->header_title);
-            cJSON_AddNumberToObject(view, "accent_color", config->accent_color);
-            cJSON_AddNumberToObject(view, "led_color", config->led_color);
-            cJSON_AddStringToObject(view, "data_source", config->data_source == VIEW_DATA_REALTIME ? "realtime" : "static");
-            cJSON_AddBoolToObject(view, "enabled", config->enabled);
-            cJSON_AddBoolToObject(view, "active", i == current);
-            cJSON_AddItemToArray(views, view);
+            jw_object_begin(&w, NULL);
+            jw_number(&w, "id", config->id);
+            jw_string(&w, "name", config->name);
+            jw_string(&w, "header", config->header_title);
+            jw_number(&w, "accent_color", config->accent_color);
+            jw_number(&w, "led_color", config->led_color);
+            jw_string(&w, "data_source", config->data_source == VIEW_DATA_REALTIME ? "realtime" : "static");
+            jw_bool(&w, "enabled", config->enabled);
+            jw_bool(&w, "active", i == current);
+            jw_object_end(&w);
         }
     }
-    cJSON_AddItemToObject(root, "views", views);
+    jw_array_end(&w);
 
-    const char *json = cJSON_PrintUnformatted(root);
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, json, strlen(json));
-
-    free((void*)json);
-    cJSON_Delete(root);
-    return ESP_OK;
+    jw_object_end(&w);
+    return jw_finish(&w);
 }
-
 static esp_err_t api_display_handler(httpd_req_t *req)
 {
     char buf[256];
@@ -619,13 +224,20 @@ static esp_err_t api_display_handler(httpd_req_t *req)
     const char *command = cmd_item->valuestring;
     ESP_LOGI(TAG, "Display command: %s", command);
 
+    esp_err_t ret = ESP_OK;
     if (display_callback) {
-        display_callback(command, buf);
+        ret = display_callback(command, buf);
     }
 
     cJSON_Delete(root);
 
     httpd_resp_set_type(req, "application/json");
+    if (ret != ESP_OK) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "1");
+        httpd_resp_sendstr(req, "{\"success\":false,\"error\":\"display busy\"}");
+        return ESP_OK;
+    }
     httpd_resp_sendstr(req, "{\"success\":true}");
     return ESP_OK;
 }
@@ -722,51 +334,270 @@ static esp_err_t api_wifi_handler(httpd_req_t *req)
 
 static esp_err_t api_debug_handler(httpd_req_t *req)
 {
-    cJSON *root = cJSON_CreateObject();
+    json_writer_t w;
+    jw_begin(&w, req, true);
+    jw_object_begin(&w, NULL);
 
     // System memory info
-    cJSON_AddNumberToObject(root, "free_heap", esp_get_free_heap_size());
-    cJSON_AddNumberToObject(root, "min_free_heap", esp_get_minimum_free_heap_size());
-    cJSON_AddNumberToObject(root, "largest_free_block", heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+    jw_number(&w, "free_heap", esp_get_free_heap_size());
+    jw_number(&w, "min_free_heap", esp_get_minimum_free_heap_size());
+    jw_number(&w, "largest_free_block", heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
 
     // TfNSW debug info
     tfnsw_debug_info_t dbg;
     tfnsw_get_debug_info(&dbg);
 
-    cJSON *tfnsw = cJSON_CreateObject();
-    cJSON_AddNumberToObject(tfnsw, "last_response_size", dbg.last_response_size);
-    cJSON_AddNumberToObject(tfnsw, "heap_before_parse", dbg.last_parse_heap_before);
-    cJSON_AddNumberToObject(tfnsw, "heap_after_parse", dbg.last_parse_heap_after);
-    cJSON_AddNumberToObject(tfnsw, "parse_error_offset", dbg.parse_error_offset);
-    cJSON_AddStringToObject(tfnsw, "parse_error_context", dbg.parse_error_context);
-    cJSON_AddStringToObject(tfnsw, "response_start", dbg.response_start);
-    cJSON_AddStringToObject(tfnsw, "response_end", dbg.response_end);
-    cJSON_AddNumberToObject(tfnsw, "fetch_count", dbg.fetch_count);
-    cJSON_AddNumberToObject(tfnsw, "parse_success_count", dbg.parse_success_count);
-    cJSON_AddNumberToObject(tfnsw, "parse_fail_count", dbg.parse_fail_count);
-    cJSON_AddNumberToObject(tfnsw, "buffer_size", dbg.buffer_size);
-    cJSON_AddBoolToObject(tfnsw, "buffer_overflow", dbg.buffer_overflow);
-    cJSON_AddStringToObject(tfnsw, "status", tfnsw_status_to_string(tfnsw_get_status()));
+    jw_object_begin(&w, "tfnsw");
+    jw_number(&w, "last_response_size", dbg.last_response_size);
+    jw_number(&w, "heap_before_parse", dbg.last_parse_heap_before);
+    jw_number(&w, "heap_after_parse", dbg.last_parse_heap_after);
+    jw_number(&w, "parse_error_offset", dbg.parse_error_offset);
+    jw_string(&w, "parse_error_context", dbg.parse_error_context);
+    jw_string(&w, "response_start", dbg.response_start);
+    jw_string(&w, "response_end", dbg.response_end);
+    jw_number(&w, "fetch_count", dbg.fetch_count);
+    jw_number(&w, "parse_success_count", dbg.parse_success_count);
+    jw_number(&w, "parse_fail_count", dbg.parse_fail_count);
+    jw_number(&w, "buffer_size", dbg.buffer_size);
+    jw_bool(&w, "buffer_overflow", dbg.buffer_overflow);
+    jw_string(&w, "status", tfnsw_status_to_string(tfnsw_get_status()));
 
     // Current departure data status
     tfnsw_dual_departures_t deps;
     tfnsw_get_current_dual_departures(&deps);
-    cJSON_AddNumberToObject(tfnsw, "northbound_count", deps.northbound_count);
-    cJSON_AddNumberToObject(tfnsw, "southbound_count", deps.southbound_count);
-    cJSON_AddBoolToObject(tfnsw, "is_stale", deps.is_stale);
-    cJSON_AddBoolToObject(tfnsw, "is_cached_fallback", deps.is_cached_fallback);
-    cJSON_AddNumberToObject(tfnsw, "data_age_seconds", deps.data_age_seconds);
-    cJSON_AddStringToObject(tfnsw, "error_message", deps.error_message);
+    jw_number(&w, "northbound_count", deps.northbound_count);
+    jw_number(&w, "southbound_count", deps.southbound_count);
+    jw_bool(&w, "is_stale", deps.is_stale);
+    jw_bool(&w, "is_cached_fallback", deps.is_cached_fallback);
+    jw_number(&w, "data_age_seconds", deps.data_age_seconds);
+    jw_string(&w, "error_message", deps.error_message);
 
-    cJSON_AddItemToObject(root, "tfnsw", tfnsw);
+    jw_object_end(&w);
 
-    const char *json = cJSON_Print(root);
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, json, strlen(json));
+    jw_object_end(&w);
+    return jw_finish(&w);
+}
 
-    free((void*)json);
-    cJSON_Delete(root);
-    return ESP_OK;
+// ============================================================================
+// Render Performance Handler
+// ============================================================================
+
+// Histogram fields (caller opens and closes the enclosing object)
+static void perf_hist_write(json_writer_t *w, const perf_hist_t *h)
+{
+    jw_number(w, "count", h->count);
+    jw_number(w, "min", h->min);
+    jw_number(w, "max", h->max);
+    jw_number(w, "avg", h->count ? (double)h->sum / h->count : 0);
+    jw_number(w, "sum", (double)h->sum);
+
+    // Sparse buckets: [[upper_bound, count], ...], -1 marks the overflow bucket
+    jw_array_begin(w, "buckets");
+    for (int i = 0; i < PERF_HIST_BUCKETS; i++) {
+        if (h->buckets[i] == 0) continue;
+        uint32_t limit = render_perf_bucket_limit(i);
+        jw_array_begin(w, NULL);
+        jw_number(w, NULL, limit == UINT32_MAX ? -1 : (double)limit);
+        jw_number(w, NULL, h->buckets[i]);
+        jw_array_end(w);
+    }
+    jw_array_end(w);
+}
+static esp_err_t api_perf_handler(httpd_req_t *req)
+{
+    // Snapshot is ~1KB, keep it off the httpd stack
+    render_perf_snapshot_t *snap = malloc(sizeof(render_perf_snapshot_t));
+    if (!snap) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        return ESP_FAIL;
+    }
+    render_perf_get_snapshot(snap);
+
+    // ?reset=1 clears the histograms after reading them
+    char query[32];
+    char reset[4] = "";
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        httpd_query_key_value(query, "reset", reset, sizeof(reset));
+    }
+
+    json_writer_t w;
+    jw_begin(&w, req, false);
+    jw_object_begin(&w, NULL);
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    jw_number(&w, "window_ms", now_ms - snap->since_ms);
+
+    for (int i = 0; i < PERF_METRIC_COUNT; i++) {
+        jw_object_begin(&w, render_perf_metric_name((perf_metric_t)i));
+        perf_hist_write(&w, &snap->metrics[i]);
+        jw_object_end(&w);
+    }
+
+    jw_array_begin(&w, "view_rebuild_us");
+    for (int i = 0; i < VIEW_COUNT; i++) {
+        const view_config_t* config = lcd_get_view_config((view_id_t)i);
+        jw_object_begin(&w, NULL);
+        perf_hist_write(&w, &snap->view_rebuild_us[i]);
+        jw_number(&w, "id", i);
+        jw_string(&w, "name", config ? config->name : "Unknown");
+        jw_object_end(&w);
+    }
+    jw_array_end(&w);
+    jw_object_end(&w);
+    free(snap);
+
+    if (reset[0] == '1') {
+        render_perf_reset();
+    }
+
+    return jw_finish(&w);
+}
+
+// ============================================================================
+// Prometheus Metrics Handler
+// ============================================================================
+
+static esp_err_t metrics_handler(httpd_req_t *req)
+{
+    return metrics_export(req);
+}
+
+// ============================================================================
+// Server-Sent Events Handler
+// ============================================================================
+
+static esp_err_t api_events_handler(httpd_req_t *req)
+{
+    return event_stream_add_client(req);
+}
+
+// ============================================================================
+// Trace Export Handler
+// ============================================================================
+
+// GET /api/trace[?reset=1] - Chrome Trace Event JSON for Perfetto
+static esp_err_t api_trace_handler(httpd_req_t *req)
+{
+    char query[32];
+    char reset[4] = "";
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        httpd_query_key_value(query, "reset", reset, sizeof(reset));
+    }
+
+    esp_err_t ret = trace_export(req);
+    if (reset[0] == '1') {
+        trace_clear();
+    }
+    return ret;
+}
+
+// ============================================================================
+// Boot Timeline Handler
+// ============================================================================
+
+// GET /api/boot - per-stage state and start/end times (ms since reset)
+static esp_err_t api_boot_handler(httpd_req_t *req)
+{
+    static const char *state_names[] = { "pending", "running", "done", "failed" };
+
+    json_writer_t w;
+    jw_begin(&w, req, false);
+    jw_object_begin(&w, NULL);
+    jw_array_begin(&w, "stages");
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++) {
+        boot_stage_info_t stage;
+        boot_get_stage((boot_stage_id_t)i, &stage);
+        jw_object_begin(&w, NULL);
+        jw_string(&w, "name", boot_stage_name((boot_stage_id_t)i));
+        jw_string(&w, "state", state_names[stage.state]);
+        if (stage.state != BOOT_STATE_PENDING) {
+            jw_number(&w, "start_ms", (double)(stage.start_us / 1000));
+        }
+        if (stage.state == BOOT_STATE_DONE || stage.state == BOOT_STATE_FAILED) {
+            jw_number(&w, "end_ms", (double)(stage.end_us / 1000));
+            jw_number(&w, "duration_ms", (double)((stage.end_us - stage.start_us) / 1000));
+        }
+        if (stage.state == BOOT_STATE_FAILED) {
+            jw_string(&w, "error", esp_err_to_name(stage.result));
+        }
+        jw_object_end(&w);
+    }
+    jw_array_end(&w);
+    jw_object_end(&w);
+    return jw_finish(&w);
+}
+
+// ============================================================================
+// Power Handler
+// ============================================================================
+
+// GET /api/power[?reset=1] - sleep share and estimated draw per view
+static esp_err_t api_power_handler(httpd_req_t *req)
+{
+    char query[32];
+    char reset[4] = "";
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        httpd_query_key_value(query, "reset", reset, sizeof(reset));
+    }
+
+    esp_err_t ret = power_export(req);
+    if (reset[0] == '1') {
+        power_reset_stats();
+    }
+    return ret;
+}
+
+// ============================================================================
+// Log Stream Handler
+// ============================================================================
+
+// GET /api/logs[?since=<seq>][&follow=1]
+static esp_err_t api_logs_handler(httpd_req_t *req)
+{
+    char query[48];
+    char since_str[12] = "";
+    char follow[4] = "";
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        httpd_query_key_value(query, "since", since_str, sizeof(since_str));
+        httpd_query_key_value(query, "follow", follow, sizeof(follow));
+    }
+    uint32_t since = (uint32_t)strtoul(since_str, NULL, 10);
+
+    if (strcmp(follow, "1") == 0) {
+        return log_ring_follow(req, since);
+    }
+    return log_ring_export(req, since);
+}
+
+// ============================================================================
+// Display Mirror WebSocket Handler
+// ============================================================================
+
+// Every socket close (client close frame, TCP reset, LRU purge) passes here,
+// so a viewer is forgotten before lwIP can hand its fd to a new connection
+static void session_close_handler(httpd_handle_t hd, int sockfd)
+{
+    display_mirror_remove_client(sockfd);
+    close(sockfd);
+}
+
+static esp_err_t ws_display_handler(httpd_req_t *req)
+{
+    // The GET is the handshake: register the socket with the mirror
+    if (req->method == HTTP_GET) {
+        return display_mirror_add_client(req->handle, httpd_req_to_sockfd(req));
+    }
+
+    // Viewers never send data; read and discard anything that arrives
+    uint8_t buf[16];
+    httpd_ws_frame_t frame = { .payload = buf };
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, 0);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (frame.len > 0 && frame.len <= sizeof(buf)) {
+        ret = httpd_ws_recv_frame(req, &frame, frame.len);
+    }
+    return ret;
 }
 
 // ============================================================================
@@ -831,6 +662,194 @@ static esp_err_t api_tfnsw_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
+// ============================================================================
+// Departures API Handler
+// ============================================================================
+
+// Snapshot versions restart at 1 on boot, so ETags carry a per-boot epoch
+// to stop a client's old tag matching new data after a reset
+static uint32_t departures_etag_epoch = 0;
+
+static const char *direction_name(tfnsw_direction_t dir)
+{
+    switch (dir) {
+        case TFNSW_DIRECTION_NORTHBOUND: return "northbound";
+        case TFNSW_DIRECTION_SOUTHBOUND: return "southbound";
+        default: return "unknown";
+    }
+}
+
+static void departures_write_json(json_writer_t *w, const char *stop_id, uint32_t version,
+                                  const tfnsw_departures_t *deps)
+{
+    jw_object_begin(w, NULL);
+    jw_string(w, "stop", stop_id);
+    jw_number(w, "version", version);
+    jw_string(w, "station", deps->station_name);
+    jw_string(w, "status", tfnsw_status_to_string(deps->status));
+    jw_number(w, "fetched_ms", (double)deps->last_fetch_time);
+    jw_bool(w, "suspended", deps->service_suspended);
+    if (deps->service_suspended) {
+        jw_string(w, "suspension_message", deps->suspension_message);
+    }
+
+    jw_array_begin(w, "departures");
+    for (int i = 0; i < deps->count; i++) {
+        const tfnsw_departure_t *d = &deps->departures[i];
+        jw_object_begin(w, NULL);
+        jw_string(w, "destination", d->destination);
+        jw_string(w, "platform", d->platform);
+        jw_string(w, "line", d->line_name);
+        jw_string(w, "calling", d->calling_stations);
+        jw_number(w, "scheduled", (double)d->scheduled_time);
+        if (d->estimated_time) {
+            jw_number(w, "estimated", (double)d->estimated_time);
+        }
+        jw_number(w, "mins", d->mins_to_departure);
+        jw_number(w, "delay_s", d->delay_seconds);
+        jw_string(w, "direction", direction_name(d->direction));
+        jw_bool(w, "realtime", d->is_realtime);
+        jw_bool(w, "cancelled", d->is_cancelled);
+        jw_bool(w, "delayed", d->is_delayed);
+        if (d->occupancy_available) {
+            jw_number(w, "occupancy", d->occupancy_percent);
+        }
+        if (d->alert_severity != TFNSW_ALERT_NONE) {
+            jw_number(w, "alert_severity", d->alert_severity);
+            jw_string(w, "alert", d->alert_message);
+        }
+        jw_object_end(w);
+    }
+    jw_array_end(w);
+    jw_object_end(w);
+}
+
+// Same keys as the JSON form; every field is always present (null when the
+// JSON form would omit it) so map sizes are fixed
+static void departures_write_cbor(cbor_writer_t *w, const char *stop_id, uint32_t version,
+                                  const tfnsw_departures_t *deps)
+{
+    cw_map(w, 8);
+    cw_text(w, "stop");                 cw_text(w, stop_id);
+    cw_text(w, "version");              cw_uint(w, version);
+    cw_text(w, "station");              cw_text(w, deps->station_name);
+    cw_text(w, "status");               cw_text(w, tfnsw_status_to_string(deps->status));
+    cw_text(w, "fetched_ms");           cw_int(w, deps->last_fetch_time);
+    cw_text(w, "suspended");            cw_bool(w, deps->service_suspended);
+    cw_text(w, "suspension_message");
+    cw_text(w, deps->service_suspended ? deps->suspension_message : NULL);
+
+    cw_text(w, "departures");
+    cw_array(w, deps->count);
+    for (int i = 0; i < deps->count; i++) {
+        const tfnsw_departure_t *d = &deps->departures[i];
+        bool alert = d->alert_severity != TFNSW_ALERT_NONE;
+        cw_map(w, 15);
+        cw_text(w, "destination");      cw_text(w, d->destination);
+        cw_text(w, "platform");         cw_text(w, d->platform);
+        cw_text(w, "line");             cw_text(w, d->line_name);
+        cw_text(w, "calling");          cw_text(w, d->calling_stations);
+        cw_text(w, "scheduled");        cw_int(w, d->scheduled_time);
+        cw_text(w, "estimated");
+        if (d->estimated_time) cw_int(w, d->estimated_time); else cw_null(w);
+        cw_text(w, "mins");             cw_int(w, d->mins_to_departure);
+        cw_text(w, "delay_s");          cw_int(w, d->delay_seconds);
+        cw_text(w, "direction");        cw_text(w, direction_name(d->direction));
+        cw_text(w, "realtime");         cw_bool(w, d->is_realtime);
+        cw_text(w, "cancelled");        cw_bool(w, d->is_cancelled);
+        cw_text(w, "delayed");          cw_bool(w, d->is_delayed);
+        cw_text(w, "occupancy");
+        if (d->occupancy_available) cw_uint(w, d->occupancy_percent); else cw_null(w);
+        cw_text(w, "alert_severity");
+        if (alert) cw_uint(w, d->alert_severity); else cw_null(w);
+        cw_text(w, "alert");            cw_text(w, alert ? d->alert_message : NULL);
+    }
+}
+
+// No ?stop= lists the cached stops and their versions
+static esp_err_t departures_index(httpd_req_t *req)
+{
+    tfnsw_stop_version_t stops[TFNSW_STOP_CACHE_SLOTS];
+    int count = tfnsw_list_stop_snapshots(stops, TFNSW_STOP_CACHE_SLOTS);
+
+    json_writer_t w;
+    jw_begin(&w, req, false);
+    jw_object_begin(&w, NULL);
+    jw_array_begin(&w, "stops");
+    for (int i = 0; i < count; i++) {
+        jw_object_begin(&w, NULL);
+        jw_string(&w, "stop", stops[i].stop_id);
+        jw_string(&w, "station", stops[i].station_name);
+        jw_number(&w, "version", stops[i].version);
+        jw_object_end(&w);
+    }
+    jw_array_end(&w);
+    jw_object_end(&w);
+    return jw_finish(&w);
+}
+
+static esp_err_t api_departures_handler(httpd_req_t *req)
+{
+    char query[48];
+    char stop_id[16] = "";
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        httpd_query_key_value(query, "stop", stop_id, sizeof(stop_id));
+    }
+    if (stop_id[0] == '\0') {
+        return departures_index(req);
+    }
+
+    // Version check first, so a 304 never copies the snapshot
+    uint32_t version = 0;
+    esp_err_t err = tfnsw_get_stop_snapshot(stop_id, NULL, &version);
+    if (err == ESP_ERR_NOT_FOUND) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Stop not cached");
+        return ESP_FAIL;
+    } else if (err != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Snapshot busy");
+        return ESP_FAIL;
+    }
+
+    char accept[64] = "";
+    httpd_req_get_hdr_value_str(req, "Accept", accept, sizeof(accept));
+    bool cbor = strstr(accept, "application/cbor") != NULL;
+
+    // The two encodings are different representations, so they get distinct tags
+    char etag[40];
+    snprintf(etag, sizeof(etag), "\"%08lx-%lu%s\"", (unsigned long)departures_etag_epoch,
+             (unsigned long)version, cbor ? "-c" : "");
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    httpd_resp_set_hdr(req, "Vary", "Accept");
+
+    char if_none_match[80];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK &&
+        strstr(if_none_match, etag) != NULL) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    // Data may have moved on since the version check; the body reports the
+    // version it was built from, and a stale ETag only costs one extra 200
+    tfnsw_departures_t deps;
+    if (tfnsw_get_stop_snapshot(stop_id, &deps, &version) != ESP_OK) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Snapshot busy");
+        return ESP_FAIL;
+    }
+
+    if (cbor) {
+        cbor_writer_t w;
+        cw_begin(&w, req);
+        departures_write_cbor(&w, stop_id, version, &deps);
+        return cw_finish(&w);
+    }
+
+    json_writer_t w;
+    jw_begin(&w, req, false);
+    departures_write_json(&w, stop_id, version, &deps);
+    return jw_finish(&w);
+}
+
 // ============================================================================
 // LED API Handler
 // ============================================================================
@@ -902,44 +921,62 @@ static esp_err_t api_settings_get_handler(httpd_req_t *req)
 {
     const device_settings_t* cfg = settings_get();
 
-    cJSON *root = cJSON_CreateObject();
+    json_writer_t w;
+    jw_begin(&w, req, true);
+    jw_object_begin(&w, NULL);
 
     // Display settings
-    cJSON *display = cJSON_CreateObject();
-    cJSON_AddNumberToObject(display, "theme_color", cfg->theme_color);
-    cJSON_AddNumberToObject(display, "brightness", cfg->brightness);
-    cJSON_AddNumberToObject(display, "default_scene", cfg->default_scene);
-    cJSON_AddItemToObject(root, "display", display);
+    jw_object_begin(&w, "display");
+    jw_number(&w, "theme_color", cfg->theme_color);
+    jw_number(&w, "brightness", cfg->brightness);
+    jw_number(&w, "default_scene", cfg->default_scene);
+    jw_object_end(&w);
 
     // Metro settings
-    cJSON *metro = cJSON_CreateObject();
-    cJSON_AddStringToObject(metro, "destination", cfg->destination);
-    cJSON_AddStringToObject(metro, "calling", cfg->calling_stations);
-    cJSON_AddStringToObject(metro, "time", cfg->departure_time);
-    cJSON_AddNumberToObject(metro, "mins", cfg->departure_mins);
-    cJSON_AddStringToObject(metro, "next_dest", cfg->next_dest);
-    cJSON_AddStringToObject(metro, "next_time", cfg->next_time);
-    cJSON_AddStringToObject(metro, "next2_dest", cfg->next2_dest);
-    cJSON_AddStringToObject(metro, "next2_time", cfg->next2_time);
-    cJSON_AddItemToObject(root, "metro", metro);
+    jw_object_begin(&w, "metro");
+    jw_string(&w, "destination", cfg->destination);
+    jw_string(&w, "calling", cfg->calling_stations);
+    jw_string(&w, "time", cfg->departure_time);
+    jw_number(&w, "mins", cfg->departure_mins);
+    jw_string(&w, "next_dest", cfg->next_dest);
+    jw_string(&w, "next_time", cfg->next_time);
+    jw_string(&w, "next2_dest", cfg->next2_dest);
+    jw_string(&w, "next2_time", cfg->next2_time);
+    jw_object_end(&w);
 
     // High speed settings
-    cJSON *highspeed = cJSON_CreateObject();
-    cJSON_AddStringToObject(highspeed, "destination", cfg->hs_destination);
-    cJSON_AddStringToObject(highspeed, "calling", cfg->hs_calling);
-    cJSON_AddStringToObject(highspeed, "time", cfg->hs_time);
-    cJSON_AddNumberToObject(highspeed, "mins", cfg->hs_mins);
-    cJSON_AddItemToObject(root, "highspeed", highspeed);
-
-    cJSON_AddBoolToObject(root, "loaded_from_sd", cfg->loaded);
-
-    const char *json = cJSON_Print(root);
-    httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, json, strlen(json));
-
-    free((void*)json);
-    cJSON_Delete(root);
-    return ESP_OK;
+    jw_object_begin(&w, "highspeed");
+    jw_string(&w, "destination", cfg->hs_destination);
+    jw_string(&w, "calling", cfg->hs_calling);
+    jw_string(&w, "time", cfg->hs_time);
+    jw_number(&w, "mins", cfg->hs_mins);
+    jw_object_end(&w);
+
+    // LAN sharing (takes effect after restart)
+    jw_object_begin(&w, "lan");
+    jw_string(&w, "role", lan_sync_role_name((lan_role_t)cfg->lan_role));
+    jw_object_end(&w);
+
+    jw_object_begin(&w, "power");
+    jw_bool(&w, "save", cfg->power_save);
+    jw_bool(&w, "light_sleep", power_light_sleep_enabled());
+    jw_object_end(&w);
+
+    // Overnight break from the latest fetch (Unix s, 0 = none seen)
+    night_status_t night;
+    night_get_status(&night);
+    jw_object_begin(&w, "night");
+    jw_bool(&w, "sleep", cfg->night_sleep);
+    jw_number(&w, "last_service", (double)night.last_service);
+    jw_number(&w, "first_service", (double)night.first_service);
+    jw_bool(&w, "woke_from_sleep", night.woke_from_sleep);
+    jw_number(&w, "nights", night.nights);
+    jw_object_end(&w);
+
+    jw_bool(&w, "loaded_from_sd", cfg->loaded);
+
+    jw_object_end(&w);
+    return jw_finish(&w);
 }
 
 static esp_err_t api_settings_post_handler(httpd_req_t *req)
@@ -979,6 +1016,37 @@ static esp_err_t api_settings_post_handler(httpd_req_t *req)
         } else {
             httpd_resp_sendstr(req, "{\"success\":false,\"message\":\"Failed to save settings\"}");
         }
+    } else if (strcmp(action_str, "set_lan_role") == 0) {
+        cJSON *role_item = cJSON_GetObjectItem(root, "role");
+        lan_role_t role;
+        httpd_resp_set_type(req, "application/json");
+        if (!role_item || !cJSON_IsString(role_item) ||
+            !lan_sync_role_from_name(role_item->valuestring, &role)) {
+            httpd_resp_sendstr(req, "{\"success\":false,\"message\":\"Role must be standalone, hub or follower\"}");
+        } else {
+            settings_set_lan_role((uint8_t)role);
+            httpd_resp_sendstr(req, "{\"success\":true,\"message\":\"LAN role saved. Restart to apply\"}");
+        }
+    } else if (strcmp(action_str, "set_power_save") == 0) {
+        cJSON *enabled = cJSON_GetObjectItem(root, "enabled");
+        httpd_resp_set_type(req, "application/json");
+        if (!enabled || !cJSON_IsBool(enabled)) {
+            httpd_resp_sendstr(req, "{\"success\":false,\"message\":\"enabled must be true or false\"}");
+        } else if (power_set_light_sleep(cJSON_IsTrue(enabled)) != ESP_OK) {
+            httpd_resp_sendstr(req, "{\"success\":false,\"message\":\"Power save not supported by this build\"}");
+        } else {
+            settings_set_power_save(cJSON_IsTrue(enabled));
+            httpd_resp_sendstr(req, "{\"success\":true,\"message\":\"Power mode saved\"}");
+        }
+    } else if (strcmp(action_str, "set_night_sleep") == 0) {
+        cJSON *enabled = cJSON_GetObjectItem(root, "enabled");
+        httpd_resp_set_type(req, "application/json");
+        if (!enabled || !cJSON_IsBool(enabled)) {
+            httpd_resp_sendstr(req, "{\"success\":false,\"message\":\"enabled must be true or false\"}");
+        } else {
+            settings_set_night_sleep(cJSON_IsTrue(enabled));
+            httpd_resp_sendstr(req, "{\"success\":true,\"message\":\"Night mode saved\"}");
+        }
     } else if (strcmp(action_str, "clear_log") == 0) {
         esp_err_t ret = log_clear();
         httpd_resp_set_type(req, "application/json");
@@ -1008,11 +1076,17 @@ esp_err_t webserver_start(void)
         return ESP_OK;
     }
 
+    if (departures_etag_epoch == 0) {
+        departures_etag_epoch = esp_random();
+    }
+
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = WEB_SERVER_PORT;
     config.lru_purge_enable = true;
+    config.close_fn = session_close_handler;
+    config.max_open_sockets = WEB_MAX_OPEN_SOCKETS;
     config.stack_size = 8192;  // Increase stack for cJSON operations
-    config.max_uri_handlers = 16;  // Increase from default 8 to support all endpoints
+    config.max_uri_handlers = 24;  // Increase from default 8 to support all endpoints
 
     ESP_LOGI(TAG, "Starting web server on port %d", config.server_port);
 
@@ -1025,10 +1099,27 @@ esp_err_t webserver_start(void)
     httpd_uri_t root_uri = {
         .uri = "/",
         .method = HTTP_GET,
-        .handler = root_handler
+        .handler = static_asset_handler,
+        .user_ctx = (void *)&asset_index
     };
     httpd_register_uri_handler(server, &root_uri);
 
+    httpd_uri_t css_uri = {
+        .uri = "/app.css",
+        .method = HTTP_GET,
+        .handler = static_asset_handler,
+        .user_ctx = (void *)&asset_css
+    };
+    httpd_register_uri_handler(server, &css_uri);
+
+    httpd_uri_t js_uri = {
+        .uri = "/app.js",
+        .method = HTTP_GET,
+        .handler = static_asset_handler,
+        .user_ctx = (void *)&asset_js
+    };
+    httpd_register_uri_handler(server, &js_uri);
+
     httpd_uri_t status_uri = {
         .uri = "/api/status",
         .method = HTTP_GET,
@@ -1099,6 +1190,72 @@ esp_err_t webserver_start(void)
     };
     httpd_register_uri_handler(server, &debug_uri);
 
+    httpd_uri_t perf_uri = {
+        .uri = "/api/perf",
+        .method = HTTP_GET,
+        .handler = api_perf_handler
+    };
+    httpd_register_uri_handler(server, &perf_uri);
+
+    httpd_uri_t departures_uri = {
+        .uri = "/api/departures",
+        .method = HTTP_GET,
+        .handler = api_departures_handler
+    };
+    httpd_register_uri_handler(server, &departures_uri);
+
+    httpd_uri_t metrics_uri = {
+        .uri = "/metrics",
+        .method = HTTP_GET,
+        .handler = metrics_handler
+    };
+    httpd_register_uri_handler(server, &metrics_uri);
+
+    httpd_uri_t events_uri = {
+        .uri = "/api/events",
+        .method = HTTP_GET,
+        .handler = api_events_handler
+    };
+    httpd_register_uri_handler(server, &events_uri);
+    event_stream_init();
+
+    httpd_uri_t logs_uri = {
+        .uri = "/api/logs",
+        .method = HTTP_GET,
+        .handler = api_logs_handler
+    };
+    httpd_register_uri_handler(server, &logs_uri);
+
+    httpd_uri_t trace_uri = {
+        .uri = "/api/trace",
+        .method = HTTP_GET,
+        .handler = api_trace_handler
+    };
+    httpd_register_uri_handler(server, &trace_uri);
+
+    httpd_uri_t boot_uri = {
+        .uri = "/api/boot",
+        .method = HTTP_GET,
+        .handler = api_boot_handler
+    };
+    httpd_register_uri_handler(server, &boot_uri);
+
+    httpd_uri_t power_uri = {
+        .uri = "/api/power",
+        .method = HTTP_GET,
+        .handler = api_power_handler
+    };
+    httpd_register_uri_handler(server, &power_uri);
+
+    httpd_uri_t ws_display_uri = {
+        .uri = "/ws/display",
+        .method = HTTP_GET,
+        .handler = ws_display_handler,
+        .is_websocket = true
+    };
+    httpd_register_uri_handler(server, &ws_display_uri);
+    display_mirror_init();
+
     ESP_LOGI(TAG, "Web server started");
     return ESP_OK;
 }
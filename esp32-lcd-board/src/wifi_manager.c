@@ -6,10 +6,13 @@
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_netif.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
 #include "nvs_flash.h"
 
 #include "config.h"
 #include "wifi_manager.h"
+#include "metrics.h"
 
 static const char *TAG = "wifi_manager";
 
@@ -29,6 +32,159 @@ static int retry_count = 0;
 static wifi_event_cb_t connected_callback = NULL;
 static wifi_event_cb_t ap_callback = NULL;
 
+// ============================================================================
+// Fast Reconnect
+// ============================================================================
+//
+// The last AP's BSSID and channel are kept in NVS so a connect can go
+// straight to one channel and one BSSID instead of scanning all of them.
+// If that directed attempt fails the cache is ignored and a normal scan
+// runs. The DHCP lease is restored by lwIP (CONFIG_LWIP_DHCP_RESTORE_LAST_IP),
+// which asks for the previous address in a single request. The cache lives
+// in RTC memory as well, so a wake from deep sleep skips the NVS read.
+
+#define WIFI_FAST_CACHE_VERSION 1
+#define WIFI_BOOT_RETRIES       5       // Before wifi_connect() falls back to AP mode
+#define WIFI_RETRY_BASE_MS      250     // Backoff doubles from here...
+#define WIFI_RETRY_MAX_MS       30000   // ...up to this
+
+typedef struct __attribute__((packed)) {
+    uint8_t version;
+    uint8_t channel;
+    uint8_t bssid[6];
+    char ssid[33];
+} wifi_fast_cache_t;
+
+static RTC_DATA_ATTR wifi_fast_cache_t fast_cache;     // Kept through deep sleep
+static bool fast_cache_valid = false;
+static bool fast_attempt = false;       // Current attempt uses the cached BSSID/channel
+static bool sta_active = false;         // Cleared before stopping STA (no retries)
+static bool ever_connected = false;     // After the first IP, retry forever
+static int64_t connect_start_us = 0;
+static esp_timer_handle_t retry_timer = NULL;
+
+static void load_fast_cache(const char *ssid)
+{
+    // Still in RTC memory after a deep sleep (zeroed on power-up)
+    fast_cache_valid = fast_cache.version == WIFI_FAST_CACHE_VERSION && fast_cache.channel > 0 &&
+                       strncmp(fast_cache.ssid, ssid, sizeof(fast_cache.ssid)) == 0;
+    if (fast_cache_valid) return;
+
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) return;
+
+    size_t len = sizeof(fast_cache);
+    if (nvs_get_blob(nvs_handle, NVS_KEY_FAST_CONN, &fast_cache, &len) == ESP_OK &&
+        len == sizeof(fast_cache) && fast_cache.version == WIFI_FAST_CACHE_VERSION &&
+        fast_cache.channel > 0 && strncmp(fast_cache.ssid, ssid, sizeof(fast_cache.ssid)) == 0) {
+        fast_cache_valid = true;
+    }
+    nvs_close(nvs_handle);
+}
+
+// Remember the AP we just joined (written only when it changed)
+static void save_fast_cache(const wifi_ap_record_t *ap)
+{
+    if (fast_cache_valid && fast_cache.channel == ap->primary &&
+        memcmp(fast_cache.bssid, ap->bssid, sizeof(fast_cache.bssid)) == 0 &&
+        strncmp(fast_cache.ssid, (const char *)ap->ssid, sizeof(fast_cache.ssid)) == 0) {
+        return;
+    }
+
+    memset(&fast_cache, 0, sizeof(fast_cache));
+    fast_cache.version = WIFI_FAST_CACHE_VERSION;
+    fast_cache.channel = ap->primary;
+    memcpy(fast_cache.bssid, ap->bssid, sizeof(fast_cache.bssid));
+    strncpy(fast_cache.ssid, (const char *)ap->ssid, sizeof(fast_cache.ssid) - 1);
+
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle) != ESP_OK) return;
+    if (nvs_set_blob(nvs_handle, NVS_KEY_FAST_CONN, &fast_cache, sizeof(fast_cache)) == ESP_OK &&
+        nvs_commit(nvs_handle) == ESP_OK) {
+        fast_cache_valid = true;
+        ESP_LOGI(TAG, "Cached AP " MACSTR " on channel %d", MAC2STR(fast_cache.bssid), fast_cache.channel);
+    }
+    nvs_close(nvs_handle);
+}
+
+// Point the STA config at the cached AP, or back to a normal scan
+static void set_directed(bool directed)
+{
+    wifi_config_t cfg;
+    if (esp_wifi_get_config(WIFI_IF_STA, &cfg) != ESP_OK) return;
+    directed = directed && fast_cache_valid;
+    cfg.sta.bssid_set = directed;
+    cfg.sta.channel = directed ? fast_cache.channel : 0;
+    if (directed) {
+        memcpy(cfg.sta.bssid, fast_cache.bssid, sizeof(cfg.sta.bssid));
+    }
+    esp_wifi_set_config(WIFI_IF_STA, &cfg);
+    fast_attempt = directed;
+}
+
+static void start_connect(void)
+{
+    connect_start_us = esp_timer_get_time();
+    esp_wifi_connect();
+}
+
+static void retry_timer_cb(void *arg)
+{
+    (void)arg;
+    if (sta_active && !is_connected) {
+        start_connect();
+    }
+}
+
+static uint32_t retry_delay_ms(int attempt)
+{
+    uint32_t delay = WIFI_RETRY_BASE_MS;
+    for (int i = 0; i < attempt && delay < WIFI_RETRY_MAX_MS; i++) {
+        delay *= 2;
+    }
+    return delay < WIFI_RETRY_MAX_MS ? delay : WIFI_RETRY_MAX_MS;
+}
+
+static void handle_disconnect(const wifi_event_sta_disconnected_t *event)
+{
+    bool was_connected = is_connected;
+    is_connected = false;
+    if (!sta_active) return;
+
+    if (was_connected) {
+        metrics_inc(MET_WIFI_DISCONNECTS_TOTAL);
+        ESP_LOGW(TAG, "Disconnected (reason %d)", event->reason);
+        // A blip: the AP is almost certainly still where it was
+        retry_count = 0;
+        set_directed(true);
+        start_connect();
+        return;
+    }
+
+    if (fast_attempt) {
+        ESP_LOGW(TAG, "Directed connect failed (reason %d), scanning all channels", event->reason);
+        set_directed(false);
+        start_connect();
+        return;
+    }
+
+    if (!ever_connected && retry_count >= WIFI_BOOT_RETRIES) {
+        ESP_LOGI(TAG, "Connection failed after retries");
+        xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
+        return;
+    }
+
+    uint32_t delay_ms = retry_delay_ms(retry_count++);
+    ESP_LOGI(TAG, "Retry connecting to AP in %lu ms (attempt %d)...", (unsigned long)delay_ms, retry_count);
+    if (!retry_timer || esp_timer_start_once(retry_timer, (uint64_t)delay_ms * 1000) != ESP_OK) {
+        start_connect();
+    }
+}
+
+// ============================================================================
+// Events
+// ============================================================================
+
 static void wifi_event_handler(void* arg, esp_event_base_t event_base,
                                int32_t event_id, void* event_data)
 {
@@ -36,19 +192,13 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
         switch (event_id) {
             case WIFI_EVENT_STA_START:
                 ESP_LOGI(TAG, "WiFi STA started");
-                esp_wifi_connect();
+                if (sta_active) {
+                    start_connect();
+                }
                 break;
 
             case WIFI_EVENT_STA_DISCONNECTED:
-                is_connected = false;
-                if (retry_count < 5) {
-                    ESP_LOGI(TAG, "Retry connecting to AP...");
-                    esp_wifi_connect();
-                    retry_count++;
-                } else {
-                    ESP_LOGI(TAG, "Connection failed after retries");
-                    xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
-                }
+                handle_disconnect((wifi_event_sta_disconnected_t*) event_data);
                 break;
 
             case WIFI_EVENT_AP_STACONNECTED: {
@@ -68,16 +218,21 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
         snprintf(current_ip, sizeof(current_ip), IPSTR, IP2STR(&event->ip_info.ip));
-        ESP_LOGI(TAG, "Got IP: %s", current_ip);
+        uint32_t connect_ms = (uint32_t)((esp_timer_get_time() - connect_start_us) / 1000);
+        ESP_LOGI(TAG, "Got IP: %s (%lu ms, %s)", current_ip, (unsigned long)connect_ms,
+                 fast_attempt ? "cached AP" : "scan");
+        metrics_observe(fast_attempt ? MET_WIFI_CONNECT_DIRECTED_MS : MET_WIFI_CONNECT_SCAN_MS, connect_ms);
         retry_count = 0;
         is_connected = true;
+        ever_connected = true;
         xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
 
-        // Get RSSI
+        // Get RSSI, and remember the AP for the next connect
         wifi_ap_record_t ap_info;
         if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
             current_rssi = ap_info.rssi;
             strncpy(current_ssid, (char*)ap_info.ssid, sizeof(current_ssid) - 1);
+            save_fast_cache(&ap_info);
         }
 
         if (connected_callback) connected_callback();
@@ -110,6 +265,18 @@ esp_err_t wifi_init(void)
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
 
+    // Credentials live in our own namespace; don't rewrite the driver's copy
+    // in flash every time the directed/scan config is switched
+    esp_wifi_set_storage(WIFI_STORAGE_RAM);
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = retry_timer_cb,
+        .name = "wifi_retry",
+    };
+    if (esp_timer_create(&timer_args, &retry_timer) != ESP_OK) {
+        retry_timer = NULL;     // Retries then go out immediately
+    }
+
     // Register event handlers
     ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID,
                                                         &wifi_event_handler, NULL, NULL));
@@ -138,6 +305,19 @@ esp_err_t wifi_connect(void)
     strncpy((char*)wifi_config.sta.password, password, sizeof(wifi_config.sta.password) - 1);
     wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
 
+    // Go straight to the last AP if we have one for this network
+    load_fast_cache(ssid);
+    fast_attempt = fast_cache_valid;
+    if (fast_attempt) {
+        wifi_config.sta.bssid_set = true;
+        memcpy(wifi_config.sta.bssid, fast_cache.bssid, sizeof(wifi_config.sta.bssid));
+        wifi_config.sta.channel = fast_cache.channel;
+        ESP_LOGI(TAG, "Trying cached AP " MACSTR " on channel %d",
+                 MAC2STR(fast_cache.bssid), fast_cache.channel);
+    }
+
+    retry_count = 0;
+    sta_active = true;
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
     ESP_ERROR_CHECK(esp_wifi_start());
@@ -157,6 +337,8 @@ esp_err_t wifi_connect(void)
     }
 
     // Connection failed, start AP mode
+    sta_active = false;
+    if (retry_timer) esp_timer_stop(retry_timer);
     esp_wifi_stop();
     return wifi_start_ap();
 }
@@ -235,6 +417,9 @@ esp_err_t wifi_clear_credentials(void)
 
     nvs_erase_key(nvs_handle, NVS_KEY_SSID);
     nvs_erase_key(nvs_handle, NVS_KEY_PASS);
+    nvs_erase_key(nvs_handle, NVS_KEY_FAST_CONN);
+    memset(&fast_cache, 0, sizeof(fast_cache));
+    fast_cache_valid = false;
     nvs_commit(nvs_handle);
     nvs_close(nvs_handle);
 
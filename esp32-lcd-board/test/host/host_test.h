@@ -0,0 +1,55 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+// ============================================================================
+// Host Test Checks
+// ============================================================================
+//
+// Each test is a plain program: CHECK* print the failing expression and
+// carry on, and main() returns host_test_result(). Exit code 77 marks a
+// test that could not run (ctest SKIP_RETURN_CODE).
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#define HOST_TEST_SKIP 77
+
+static int host_test_failures = 0;
+
+#define CHECK(cond) do {                                                    \
+        if (!(cond)) {                                                      \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            host_test_failures++;                                           \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_INT(actual, expected) do {                                    \
+        long long a_ = (long long)(actual), e_ = (long long)(expected);     \
+        if (a_ != e_) {                                                     \
+            fprintf(stderr, "%s:%d: %s == %lld, expected %lld\n",           \
+                    __FILE__, __LINE__, #actual, a_, e_);                   \
+            host_test_failures++;                                           \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_STR(actual, expected) do {                                    \
+        const char *a_ = (actual), *e_ = (expected);                        \
+        if (!a_ || strcmp(a_, e_) != 0) {                                   \
+            fprintf(stderr, "%s:%d: %s\n  got:      %s\n  expected: %s\n",  \
+                    __FILE__, __LINE__, #actual, a_ ? a_ : "(null)", e_);   \
+            host_test_failures++;                                           \
+        }                                                                   \
+    } while (0)
+
+static inline int host_test_result(const char* name)
+{
+    if (host_test_failures) {
+        fprintf(stderr, "%s: %d check(s) failed\n", name, host_test_failures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
+
+#endif // HOST_TEST_H
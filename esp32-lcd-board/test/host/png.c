@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "png.h"
+
+#define STORED_BLOCK_MAX 65535
+
+static const uint8_t png_signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+static uint32_t crc_table[256];
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t* p, size_t len)
+{
+    if (!crc_table[1]) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            crc_table[n] = c;
+        }
+    }
+    crc = ~crc;
+    while (len--) crc = crc_table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void put_be32(uint8_t* p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static uint32_t get_be32(const uint8_t* p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static bool write_chunk(FILE* f, const char* type, const uint8_t* data, uint32_t len)
+{
+    uint8_t head[8];
+    put_be32(head, len);
+    memcpy(head + 4, type, 4);
+    uint32_t crc = crc32_update(0, head + 4, 4);
+    crc = crc32_update(crc, data, len);
+    uint8_t tail[4];
+    put_be32(tail, crc);
+    return fwrite(head, 1, 8, f) == 8 &&
+           (len == 0 || fwrite(data, 1, len, f) == len) &&
+           fwrite(tail, 1, 4, f) == 4;
+}
+
+bool png_write(const char* path, const uint8_t* rgb, int width, int height)
+{
+    // Raw scanlines: filter byte 0, then the row
+    size_t row = (size_t)width * 3 + 1;
+    size_t raw_len = row * height;
+    size_t blocks = (raw_len + STORED_BLOCK_MAX - 1) / STORED_BLOCK_MAX;
+    size_t z_len = 2 + raw_len + blocks * 5 + 4;
+    uint8_t* raw = malloc(raw_len);
+    uint8_t* z = malloc(z_len);
+    if (!raw || !z) {
+        free(raw);
+        free(z);
+        return false;
+    }
+    for (int y = 0; y < height; y++) {
+        raw[y * row] = 0;
+        memcpy(&raw[y * row + 1], &rgb[(size_t)y * width * 3], (size_t)width * 3);
+    }
+
+    // zlib stream of stored blocks
+    uint8_t* p = z;
+    *p++ = 0x78;
+    *p++ = 0x01;
+    uint32_t a = 1, b = 0;
+    for (size_t off = 0; off < raw_len; off += STORED_BLOCK_MAX) {
+        size_t n = raw_len - off < STORED_BLOCK_MAX ? raw_len - off : STORED_BLOCK_MAX;
+        *p++ = off + n == raw_len ? 1 : 0;
+        *p++ = n & 0xff;
+        *p++ = n >> 8;
+        *p++ = ~n & 0xff;
+        *p++ = (~n >> 8) & 0xff;
+        memcpy(p, raw + off, n);
+        p += n;
+        for (size_t i = 0; i < n; i++) {
+            a = (a + raw[off + i]) % 65521;
+            b = (b + a) % 65521;
+        }
+    }
+    put_be32(p, b << 16 | a);
+
+    uint8_t ihdr[13];
+    put_be32(ihdr, width);
+    put_be32(ihdr + 4, height);
+    ihdr[8] = 8;        // Bit depth
+    ihdr[9] = 2;        // RGB
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+
+    FILE* f = fopen(path, "wb");
+    bool ok = f &&
+              fwrite(png_signature, 1, 8, f) == 8 &&
+              write_chunk(f, "IHDR", ihdr, 13) &&
+              write_chunk(f, "IDAT", z, (uint32_t)z_len) &&
+              write_chunk(f, "IEND", NULL, 0);
+    if (f && fclose(f) != 0) ok = false;
+    free(raw);
+    free(z);
+    return ok;
+}
+
+bool png_read(const char* path, uint8_t** out_rgb, int* out_width, int* out_height)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* file = malloc(size);
+    bool ok = file && fread(file, 1, size, f) == (size_t)size;
+    fclose(f);
+    if (!ok || size < 8 || memcmp(file, png_signature, 8) != 0) {
+        free(file);
+        return false;
+    }
+
+    // Gather IHDR and the IDAT stream
+    int width = 0, height = 0;
+    uint8_t* z = NULL;
+    size_t z_len = 0;
+    for (long off = 8; off + 12 <= size; ) {
+        uint32_t len = get_be32(file + off);
+        const uint8_t* type = file + off + 4;
+        const uint8_t* data = file + off + 8;
+        if (off + 12 + (long)len > size) break;
+        if (memcmp(type, "IHDR", 4) == 0 && len == 13) {
+            width = (int)get_be32(data);
+            height = (int)get_be32(data + 4);
+            if (data[8] != 8 || data[9] != 2 || data[12] != 0) width = 0;
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            uint8_t* grown = realloc(z, z_len + len);
+            if (!grown) break;
+            z = grown;
+            memcpy(z + z_len, data, len);
+            z_len += len;
+        }
+        off += 12 + len;
+    }
+    free(file);
+
+    // Unpack the stored blocks
+    size_t row = (size_t)width * 3 + 1;
+    size_t raw_len = row * height;
+    uint8_t* raw = width > 0 && height > 0 ? malloc(raw_len) : NULL;
+    size_t got = 0;
+    size_t pos = 2;
+    bool last = false;
+    while (raw && !last && pos + 5 <= z_len) {
+        last = z[pos] & 1;
+        if ((z[pos] >> 1) & 3) break;      // Compressed: not one of ours
+        size_t n = z[pos + 1] | (size_t)z[pos + 2] << 8;
+        pos += 5;
+        if (pos + n > z_len || got + n > raw_len) break;
+        memcpy(raw + got, z + pos, n);
+        got += n;
+        pos += n;
+    }
+    free(z);
+    if (!raw || got != raw_len) {
+        free(raw);
+        return false;
+    }
+
+    uint8_t* rgb = malloc((size_t)width * height * 3);
+    for (int y = 0; rgb && y < height; y++) {
+        if (raw[y * row] != 0) {
+            free(rgb);
+            rgb = NULL;
+            break;
+        }
+        memcpy(&rgb[(size_t)y * width * 3], &raw[y * row + 1], (size_t)width * 3);
+    }
+    free(raw);
+    if (!rgb) return false;
+    *out_rgb = rgb;
+    *out_width = width;
+    *out_height = height;
+    return true;
+}
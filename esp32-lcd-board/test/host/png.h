@@ -0,0 +1,21 @@
+#ifndef HOST_PNG_H
+#define HOST_PNG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ============================================================================
+// Minimal PNG (golden images)
+// ============================================================================
+//
+// 8-bit RGB, unfiltered rows in stored (uncompressed) deflate blocks: the
+// same pixels always give the same bytes. png_read() only reads files in
+// that form, i.e. ones png_write() produced.
+
+// Write width x height RGB888 pixels (3 bytes each, row-major)
+bool png_write(const char* path, const uint8_t* rgb, int width, int height);
+
+// Read a file png_write() produced; *out_rgb is malloc'd (caller frees)
+bool png_read(const char* path, uint8_t** out_rgb, int* out_width, int* out_height);
+
+#endif // HOST_PNG_H
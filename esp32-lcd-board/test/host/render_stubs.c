@@ -0,0 +1,42 @@
+// Modules lcd_driver.c calls that have no place in a host render: their
+// hardware, network or HTTP side is out of scope, so they do nothing here.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "tfnsw_client.h"
+#include "rgb_led.h"
+#include "display_mirror.h"
+#include "event_stream.h"
+#include "spi_arbiter.h"
+#include "power_mgmt.h"
+
+bool tfnsw_is_fetching(void) { return false; }
+bool tfnsw_has_api_key(void) { return true; }
+
+void rgb_led_set_hex(uint32_t hex_color) { (void)hex_color; }
+void rgb_led_set_status(led_status_t status) { (void)status; }
+led_status_t rgb_led_get_status(void) { return LED_STATUS_OFF; }
+
+void display_mirror_feed(int x1, int y1, int x2, int y2, const void *pixels)
+{
+    (void)x1; (void)y1; (void)x2; (void)y2; (void)pixels;
+}
+
+bool display_mirror_take_resync(int *x1, int *y1, int *x2, int *y2)
+{
+    (void)x1; (void)y1; (void)x2; (void)y2;
+    return false;
+}
+
+void event_stream_publish(uint32_t topics) { (void)topics; }
+
+esp_err_t spi_arbiter_init(void) { return ESP_OK; }
+void spi_arbiter_frame_begin(void) {}
+void spi_arbiter_frame_end(void) {}
+void spi_arbiter_lcd_queued(void) {}
+void spi_arbiter_lcd_done(void) {}
+
+void power_loop_wake(void) {}
+void power_note_view(int view) { (void)view; }
+void power_note_backlight(uint8_t percent) { (void)percent; }
@@ -0,0 +1,305 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_rom_crc.h"
+#include "esp_spiffs.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "host_clock.h"
+
+// ============================================================================
+// Errors
+// ============================================================================
+
+const char* esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK:                    return "ESP_OK";
+    case ESP_FAIL:                  return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:            return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:       return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:     return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:      return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:         return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:     return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:           return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_RESPONSE:  return "ESP_ERR_INVALID_RESPONSE";
+    case ESP_ERR_INVALID_CRC:       return "ESP_ERR_INVALID_CRC";
+    case ESP_ERR_INVALID_VERSION:   return "ESP_ERR_INVALID_VERSION";
+    case ESP_ERR_NOT_FINISHED:      return "ESP_ERR_NOT_FINISHED";
+    case ESP_ERR_NOT_ALLOWED:       return "ESP_ERR_NOT_ALLOWED";
+    default:                        return "ESP_ERR_UNKNOWN";
+    }
+}
+
+// ============================================================================
+// Logging
+// ============================================================================
+
+static vprintf_like_t log_vprintf = vprintf;
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...)
+{
+    static int verbose = -1;
+    if (verbose < 0) verbose = getenv("HOST_LOG_VERBOSE") != NULL;
+    if (level > ESP_LOG_WARN && !verbose) return;
+
+    static const char letters[] = "NEWIDV";
+    char line[512];
+    va_list args;
+    va_start(args, format);
+    int n = snprintf(line, sizeof(line), "%c (%s) ", letters[level], tag);
+    vsnprintf(line + n, sizeof(line) - n, format, args);
+    va_end(args);
+    fputs(line, stderr);
+}
+
+void esp_log_level_set(const char* tag, esp_log_level_t level)
+{
+    (void)tag;
+    (void)level;
+}
+
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func)
+{
+    vprintf_like_t old = log_vprintf;
+    log_vprintf = func;
+    return old;
+}
+
+uint32_t esp_log_timestamp(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// ============================================================================
+// Random
+// ============================================================================
+
+uint32_t esp_random(void)
+{
+    static uint32_t state = 0x2545f491u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// ============================================================================
+// ROM CRC
+// ============================================================================
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len)
+{
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+// ============================================================================
+// SPIFFS
+// ============================================================================
+
+esp_err_t esp_vfs_spiffs_register(const esp_vfs_spiffs_conf_t* conf)
+{
+    if (!conf || !conf->base_path) return ESP_ERR_INVALID_ARG;
+    if (mkdir(conf->base_path, 0755) != 0 && errno != EEXIST) return ESP_FAIL;
+    return ESP_OK;
+}
+
+esp_err_t esp_spiffs_info(const char* partition_label, size_t* total_bytes, size_t* used_bytes)
+{
+    (void)partition_label;
+    *total_bytes = 0;
+    *used_bytes = 0;
+    return ESP_OK;
+}
+
+// ============================================================================
+// Shutdown Handlers
+// ============================================================================
+
+#define SHUTDOWN_HANDLERS_MAX 8
+
+static shutdown_handler_t shutdown_handlers[SHUTDOWN_HANDLERS_MAX];
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handle)
+{
+    for (int i = 0; i < SHUTDOWN_HANDLERS_MAX; i++) {
+        if (shutdown_handlers[i] == handle) return ESP_ERR_INVALID_STATE;
+        if (!shutdown_handlers[i]) {
+            shutdown_handlers[i] = handle;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_unregister_shutdown_handler(shutdown_handler_t handle)
+{
+    for (int i = 0; i < SHUTDOWN_HANDLERS_MAX; i++) {
+        if (shutdown_handlers[i] == handle) {
+            shutdown_handlers[i] = NULL;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_INVALID_STATE;
+}
+
+// Last registered runs first, as in ESP-IDF
+void host_run_shutdown_handlers(void)
+{
+    for (int i = SHUTDOWN_HANDLERS_MAX - 1; i >= 0; i--) {
+        if (shutdown_handlers[i]) shutdown_handlers[i]();
+    }
+}
+
+// ============================================================================
+// Fake Clock and Timers
+// ============================================================================
+
+struct host_timer {
+    esp_timer_cb_t callback;
+    void* arg;
+    bool active;
+    int64_t due_us;
+    uint64_t period_us;         // 0 = one-shot
+    struct host_timer* next;
+};
+
+static int64_t clock_us = 0;
+static time_t wall_s = 0;
+static struct host_timer* timers = NULL;
+
+int64_t esp_timer_get_time(void)
+{
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    portENTER_CRITICAL(&mux);
+    int64_t now = clock_us;
+    portEXIT_CRITICAL(&mux);
+    return now;
+}
+
+// Earliest due active timer at or before until_us
+static struct host_timer* next_due(int64_t until_us)
+{
+    struct host_timer* best = NULL;
+    for (struct host_timer* t = timers; t; t = t->next) {
+        if (t->active && t->due_us <= until_us && (!best || t->due_us < best->due_us)) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+void host_clock_set_us(int64_t us)
+{
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    struct host_timer* t;
+    while ((t = next_due(us)) != NULL) {
+        portENTER_CRITICAL(&mux);
+        if (t->due_us > clock_us) clock_us = t->due_us;
+        if (t->period_us) {
+            t->due_us += t->period_us;
+        } else {
+            t->active = false;
+        }
+        portEXIT_CRITICAL(&mux);
+        t->callback(t->arg);
+    }
+    portENTER_CRITICAL(&mux);
+    if (us > clock_us) clock_us = us;
+    portEXIT_CRITICAL(&mux);
+}
+
+void host_clock_advance_us(int64_t us)
+{
+    host_clock_set_us(esp_timer_get_time() + us);
+}
+
+void host_clock_set_wall(time_t t)
+{
+    wall_s = t;
+}
+
+// Linked with -Wl,--wrap=time: the wall clock follows host_clock_set_wall
+time_t __wrap_time(time_t* out)
+{
+    if (out) *out = wall_s;
+    return wall_s;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out_handle)
+{
+    if (!args || !args->callback || !out_handle) return ESP_ERR_INVALID_ARG;
+    struct host_timer* t = calloc(1, sizeof(*t));
+    t->callback = args->callback;
+    t->arg = args->arg;
+    t->next = timers;
+    timers = t;
+    *out_handle = t;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t timeout_us)
+{
+    if (t->active) return ESP_ERR_INVALID_STATE;
+    t->due_us = esp_timer_get_time() + (int64_t)timeout_us;
+    t->period_us = 0;
+    t->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t t, uint64_t period)
+{
+    if (t->active) return ESP_ERR_INVALID_STATE;
+    t->due_us = esp_timer_get_time() + (int64_t)period;
+    t->period_us = period;
+    t->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_restart(esp_timer_handle_t t, uint64_t timeout_us)
+{
+    if (!t->active) return ESP_ERR_INVALID_STATE;
+    t->due_us = esp_timer_get_time() + (int64_t)timeout_us;
+    if (t->period_us) t->period_us = timeout_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t t)
+{
+    if (!t->active) return ESP_ERR_INVALID_STATE;
+    t->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t t)
+{
+    for (struct host_timer** p = &timers; *p; p = &(*p)->next) {
+        if (*p == t) {
+            *p = t->next;
+            free(t);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t t)
+{
+    return t->active;
+}
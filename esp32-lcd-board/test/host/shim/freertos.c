@@ -0,0 +1,445 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/message_buffer.h"
+#include "esp_timer.h"
+
+// ============================================================================
+// Waiting
+// ============================================================================
+
+// Absolute CLOCK_REALTIME deadline ticks (real ms) from now
+static void deadline(struct timespec* ts, TickType_t ticks)
+{
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec += ticks / 1000;
+    ts->tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+// Wait on cond until pred() holds; false on timeout. Caller holds lock.
+#define WAIT_UNTIL(cond, lock, ticks, pred) ({                              \
+        bool ok_ = true;                                                    \
+        struct timespec ts_;                                                \
+        if ((ticks) != portMAX_DELAY) deadline(&ts_, (ticks));              \
+        while (!(pred)) {                                                   \
+            if ((ticks) == 0) { ok_ = false; break; }                       \
+            if ((ticks) == portMAX_DELAY) {                                 \
+                pthread_cond_wait((cond), (lock));                          \
+            } else if (pthread_cond_timedwait((cond), (lock), &ts_) == ETIMEDOUT) { \
+                ok_ = (pred);                                               \
+                break;                                                      \
+            }                                                               \
+        }                                                                   \
+        ok_;                                                                \
+    })
+
+// ============================================================================
+// Critical Sections
+// ============================================================================
+
+static pthread_mutex_t critical_lock;
+static pthread_once_t critical_once = PTHREAD_ONCE_INIT;
+
+static void critical_init(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&critical_lock, &attr);
+}
+
+void host_critical_enter(void)
+{
+    pthread_once(&critical_once, critical_init);
+    pthread_mutex_lock(&critical_lock);
+}
+
+void host_critical_exit(void)
+{
+    pthread_mutex_unlock(&critical_lock);
+}
+
+// ============================================================================
+// Tasks
+// ============================================================================
+
+struct host_task {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void* arg;
+    char name[16];
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify_value;
+    bool notified;
+};
+
+static __thread struct host_task* current_task = NULL;
+
+static struct host_task* task_alloc(const char* name)
+{
+    struct host_task* t = calloc(1, sizeof(*t));
+    strncpy(t->name, name ? name : "", sizeof(t->name) - 1);
+    pthread_mutex_init(&t->lock, NULL);
+    pthread_cond_init(&t->cond, NULL);
+    return t;
+}
+
+static void* task_main(void* p)
+{
+    struct host_task* t = p;
+    current_task = t;
+    t->fn(t->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack_depth,
+                       void* arg, UBaseType_t priority, TaskHandle_t* out_handle)
+{
+    (void)stack_depth;
+    (void)priority;
+    struct host_task* t = task_alloc(name);
+    t->fn = fn;
+    t->arg = arg;
+    if (out_handle) *out_handle = t;
+    if (pthread_create(&t->thread, NULL, task_main, t) != 0) {
+        if (out_handle) *out_handle = NULL;
+        free(t);
+        return pdFAIL;
+    }
+    pthread_detach(t->thread);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_depth,
+                                   void* arg, UBaseType_t priority, TaskHandle_t* out_handle,
+                                   BaseType_t core)
+{
+    (void)core;
+    return xTaskCreate(fn, name, stack_depth, arg, priority, out_handle);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    // Only self-deletion is used; the handle is leaked like a zombie TCB
+    if (task == NULL || task == current_task) {
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    usleep((useconds_t)ticks * 1000);
+}
+
+void vTaskDelayUntil(TickType_t* prev_wake, TickType_t increment)
+{
+    *prev_wake += increment;
+    vTaskDelay(increment);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(esp_timer_get_time() / 1000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    if (!current_task) {
+        current_task = task_alloc("main");
+        current_task->thread = pthread_self();
+    }
+    return current_task;
+}
+
+char* pcTaskGetName(TaskHandle_t task)
+{
+    if (!task) task = xTaskGetCurrentTaskHandle();
+    return task->name;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t t, uint32_t value, eNotifyAction action)
+{
+    pthread_mutex_lock(&t->lock);
+    switch (action) {
+    case eSetBits:                  t->notify_value |= value; break;
+    case eIncrement:                t->notify_value++; break;
+    case eSetValueWithOverwrite:    t->notify_value = value; break;
+    case eSetValueWithoutOverwrite:
+        if (!t->notified) t->notify_value = value;
+        break;
+    case eNoAction:                 break;
+    }
+    t->notified = true;
+    pthread_cond_broadcast(&t->cond);
+    pthread_mutex_unlock(&t->lock);
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    return xTaskNotify(task, 0, eIncrement);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken)
+{
+    xTaskNotify(task, 0, eIncrement);
+    if (woken) *woken = pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    struct host_task* t = xTaskGetCurrentTaskHandle();
+    pthread_mutex_lock(&t->lock);
+    uint32_t value = 0;
+    if (WAIT_UNTIL(&t->cond, &t->lock, ticks, t->notify_value != 0)) {
+        value = t->notify_value;
+        t->notify_value = clear_on_exit ? 0 : value - 1;
+    }
+    t->notified = false;
+    pthread_mutex_unlock(&t->lock);
+    return value;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit,
+                           uint32_t* value, TickType_t ticks)
+{
+    struct host_task* t = xTaskGetCurrentTaskHandle();
+    pthread_mutex_lock(&t->lock);
+    if (!t->notified) t->notify_value &= ~clear_on_entry;
+    bool ok = WAIT_UNTIL(&t->cond, &t->lock, ticks, t->notified);
+    if (value) *value = t->notify_value;
+    if (ok) {
+        t->notify_value &= ~clear_on_exit;
+        t->notified = false;
+    }
+    pthread_mutex_unlock(&t->lock);
+    return ok ? pdPASS : pdFAIL;
+}
+
+// ============================================================================
+// Semaphores
+// ============================================================================
+
+struct host_sem {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    UBaseType_t count;
+    UBaseType_t max;
+};
+
+static struct host_sem* sem_new(UBaseType_t max, UBaseType_t initial)
+{
+    struct host_sem* s = calloc(1, sizeof(*s));
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->cond, NULL);
+    s->max = max;
+    s->count = initial;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return sem_new(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return sem_new(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial)
+{
+    return sem_new(max, initial);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks)
+{
+    pthread_mutex_lock(&s->lock);
+    bool ok = WAIT_UNTIL(&s->cond, &s->lock, ticks, s->count > 0);
+    if (ok) s->count--;
+    pthread_mutex_unlock(&s->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s)
+{
+    pthread_mutex_lock(&s->lock);
+    bool ok = s->count < s->max;
+    if (ok) {
+        s->count++;
+        pthread_cond_signal(&s->cond);
+    }
+    pthread_mutex_unlock(&s->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t s)
+{
+    if (!s) return;
+    pthread_mutex_destroy(&s->lock);
+    pthread_cond_destroy(&s->cond);
+    free(s);
+}
+
+// ============================================================================
+// Queues
+// ============================================================================
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t* items;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct host_queue* q = calloc(1, sizeof(*q));
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->cond, NULL);
+    q->length = length;
+    q->item_size = item_size;
+    q->items = calloc(length, item_size);
+    return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks)
+{
+    pthread_mutex_lock(&q->lock);
+    bool ok = WAIT_UNTIL(&q->cond, &q->lock, ticks, q->count < q->length);
+    if (ok) {
+        UBaseType_t tail = (q->head + q->count) % q->length;
+        memcpy(q->items + tail * q->item_size, item, q->item_size);
+        q->count++;
+        pthread_cond_broadcast(&q->cond);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok ? pdPASS : pdFAIL;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks)
+{
+    pthread_mutex_lock(&q->lock);
+    bool ok = WAIT_UNTIL(&q->cond, &q->lock, ticks, q->count > 0);
+    if (ok) {
+        memcpy(item, q->items + q->head * q->item_size, q->item_size);
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+        pthread_cond_broadcast(&q->cond);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok ? pdPASS : pdFAIL;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t n = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return n;
+}
+
+void xQueueReset(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->lock);
+    q->head = 0;
+    q->count = 0;
+    pthread_cond_broadcast(&q->cond);
+    pthread_mutex_unlock(&q->lock);
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+    if (!q) return;
+    free(q->items);
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->cond);
+    free(q);
+}
+
+// ============================================================================
+// Message Buffers
+// ============================================================================
+
+#define MSGBUF_HDR 4            // Per-message overhead on the target
+
+struct host_msgbuf {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    size_t size;
+    size_t used;                // Target accounting: lengths plus headers
+    size_t stored;              // Bytes in data
+    uint8_t* data;              // size_t length, then the message, repeated
+};
+
+MessageBufferHandle_t xMessageBufferCreate(size_t size)
+{
+    struct host_msgbuf* b = calloc(1, sizeof(*b));
+    pthread_mutex_init(&b->lock, NULL);
+    pthread_cond_init(&b->cond, NULL);
+    b->size = size;
+    b->data = malloc(size / MSGBUF_HDR * (sizeof(size_t) + MSGBUF_HDR));
+    return b;
+}
+
+size_t xMessageBufferSend(MessageBufferHandle_t b, const void* data, size_t len, TickType_t ticks)
+{
+    pthread_mutex_lock(&b->lock);
+    size_t cost = len + MSGBUF_HDR;
+    bool ok = cost <= b->size && WAIT_UNTIL(&b->cond, &b->lock, ticks, b->used + cost <= b->size);
+    if (ok) {
+        memcpy(b->data + b->stored, &len, sizeof(len));
+        memcpy(b->data + b->stored + sizeof(len), data, len);
+        b->stored += sizeof(len) + len;
+        b->used += cost;
+        pthread_cond_broadcast(&b->cond);
+    }
+    pthread_mutex_unlock(&b->lock);
+    return ok ? len : 0;
+}
+
+size_t xMessageBufferReceive(MessageBufferHandle_t b, void* out, size_t max_len, TickType_t ticks)
+{
+    pthread_mutex_lock(&b->lock);
+    size_t len = 0;
+    if (WAIT_UNTIL(&b->cond, &b->lock, ticks, b->used > 0)) {
+        memcpy(&len, b->data, sizeof(len));
+        if (len > max_len) {
+            len = 0;            // Left in the buffer, as on the target
+        } else {
+            size_t first = sizeof(len) + len;
+            memcpy(out, b->data + sizeof(len), len);
+            memmove(b->data, b->data + first, b->stored - first);
+            b->stored -= first;
+            b->used -= len + MSGBUF_HDR;
+            pthread_cond_broadcast(&b->cond);
+        }
+    }
+    pthread_mutex_unlock(&b->lock);
+    return len;
+}
+
+void vMessageBufferDelete(MessageBufferHandle_t b)
+{
+    if (!b) return;
+    free(b->data);
+    pthread_mutex_destroy(&b->lock);
+    pthread_cond_destroy(&b->cond);
+    free(b);
+}
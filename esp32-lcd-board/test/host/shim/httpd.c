@@ -0,0 +1,145 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_http_server.h"
+
+void host_req_init(httpd_req_t* r, int fd)
+{
+    memset(r, 0, sizeof(*r));
+    r->fd = fd;
+    strcpy(r->status, "200 OK");
+}
+
+void host_req_free(httpd_req_t* r)
+{
+    free(r->body);
+    r->body = NULL;
+    r->body_len = r->body_cap = 0;
+}
+
+static esp_err_t append(httpd_req_t* r, const char* buf, size_t len)
+{
+    if (r->body_len + len + 1 > r->body_cap) {
+        size_t cap = r->body_cap ? r->body_cap : 256;
+        while (cap < r->body_len + len + 1) cap *= 2;
+        char* grown = realloc(r->body, cap);
+        if (!grown) return ESP_ERR_NO_MEM;
+        r->body = grown;
+        r->body_cap = cap;
+    }
+    memcpy(r->body + r->body_len, buf, len);
+    r->body_len += len;
+    r->body[r->body_len] = '\0';
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t* r, const char* type)
+{
+    strncpy(r->type, type, sizeof(r->type) - 1);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t* r, const char* field, const char* value)
+{
+    (void)r;
+    (void)field;
+    (void)value;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t* r, const char* status)
+{
+    strncpy(r->status, status, sizeof(r->status) - 1);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t* r, const char* buf, ssize_t len)
+{
+    if (r->finished) return ESP_ERR_INVALID_STATE;
+    if (len == HTTPD_RESP_USE_STRLEN) len = buf ? (ssize_t)strlen(buf) : 0;
+    r->finished = true;
+    return len > 0 ? append(r, buf, (size_t)len) : ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t* r, const char* buf, ssize_t len)
+{
+    if (r->finished) return ESP_ERR_INVALID_STATE;
+    if (len == HTTPD_RESP_USE_STRLEN) len = buf ? (ssize_t)strlen(buf) : 0;
+    if (!buf || len == 0) {
+        r->finished = true;
+        return ESP_OK;
+    }
+    r->chunks++;
+    return append(r, buf, (size_t)len);
+}
+
+esp_err_t httpd_resp_sendstr(httpd_req_t* r, const char* str)
+{
+    return httpd_resp_send(r, str, HTTPD_RESP_USE_STRLEN);
+}
+
+esp_err_t httpd_resp_sendstr_chunk(httpd_req_t* r, const char* str)
+{
+    return httpd_resp_send_chunk(r, str, HTTPD_RESP_USE_STRLEN);
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t* r, httpd_err_code_t error, const char* msg)
+{
+    static const char* statuses[] = {
+        [HTTPD_400_BAD_REQUEST] = "400 Bad Request",
+        [HTTPD_404_NOT_FOUND] = "404 Not Found",
+        [HTTPD_500_INTERNAL_SERVER_ERROR] = "500 Internal Server Error",
+    };
+    httpd_resp_set_status(r, statuses[error]);
+    return httpd_resp_send(r, msg, HTTPD_RESP_USE_STRLEN);
+}
+
+int httpd_req_to_sockfd(httpd_req_t* r)
+{
+    return r->fd;
+}
+
+esp_err_t httpd_req_async_handler_begin(httpd_req_t* r, httpd_req_t** out)
+{
+    *out = r;
+    return ESP_OK;
+}
+
+esp_err_t httpd_req_async_handler_complete(httpd_req_t* r)
+{
+    r->finished = true;
+    return ESP_OK;
+}
+
+// ============================================================================
+// WebSocket
+// ============================================================================
+
+#define HOST_WS_FDS 64
+
+static bool ws_open[HOST_WS_FDS];
+static host_ws_sink_t ws_sink = NULL;
+
+void host_ws_set_open(int fd, bool open)
+{
+    if (fd >= 0 && fd < HOST_WS_FDS) ws_open[fd] = open;
+}
+
+void host_ws_set_sink(host_ws_sink_t sink)
+{
+    ws_sink = sink;
+}
+
+httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t hd, int fd)
+{
+    (void)hd;
+    if (fd < 0 || fd >= HOST_WS_FDS) return HTTPD_WS_CLIENT_INVALID;
+    return ws_open[fd] ? HTTPD_WS_CLIENT_WEBSOCKET : HTTPD_WS_CLIENT_INVALID;
+}
+
+esp_err_t httpd_ws_send_data(httpd_handle_t hd, int fd, httpd_ws_frame_t* frame)
+{
+    if (httpd_ws_get_fd_info(hd, fd) != HTTPD_WS_CLIENT_WEBSOCKET) return ESP_FAIL;
+    if (ws_sink) ws_sink(fd, frame->payload, frame->len);
+    return ESP_OK;
+}
@@ -0,0 +1,45 @@
+#ifndef HOST_ESP_HEAP_CAPS_H
+#define HOST_ESP_HEAP_CAPS_H
+
+#include <stdlib.h>
+
+// Host shim: every capability is plain malloc
+
+#define MALLOC_CAP_EXEC     (1 << 0)
+#define MALLOC_CAP_32BIT    (1 << 1)
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT  (1 << 12)
+
+static inline void* heap_caps_malloc(size_t size, unsigned caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+static inline void* heap_caps_calloc(size_t n, size_t size, unsigned caps)
+{
+    (void)caps;
+    return calloc(n, size);
+}
+
+static inline void heap_caps_free(void* ptr)
+{
+    free(ptr);
+}
+
+static inline size_t heap_caps_get_free_size(unsigned caps)
+{
+    (void)caps;
+    return 256 * 1024;
+}
+
+static inline size_t heap_caps_get_largest_free_block(unsigned caps)
+{
+    (void)caps;
+    return 128 * 1024;
+}
+
+#endif // HOST_ESP_HEAP_CAPS_H
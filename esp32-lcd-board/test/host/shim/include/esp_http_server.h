@@ -0,0 +1,98 @@
+#ifndef HOST_ESP_HTTP_SERVER_H
+#define HOST_ESP_HTTP_SERVER_H
+
+// Host shim: request and response types only. Responses are collected in
+// the request (host_req_*) so tests can compare the bytes a handler sends.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include "esp_err.h"
+
+typedef void* httpd_handle_t;
+
+typedef enum {
+    HTTP_GET = 1,
+    HTTP_POST = 3,
+} httpd_method_t;
+
+typedef enum {
+    HTTPD_400_BAD_REQUEST,
+    HTTPD_404_NOT_FOUND,
+    HTTPD_500_INTERNAL_SERVER_ERROR,
+} httpd_err_code_t;
+
+#define HTTPD_RESP_USE_STRLEN -1
+
+typedef struct httpd_req {
+    httpd_handle_t handle;
+    int method;
+    const char uri[64];
+    size_t content_len;
+    void* user_ctx;
+    void* sess_ctx;
+
+    // Host side: what the handler sent
+    int fd;
+    char* body;
+    size_t body_len;
+    size_t body_cap;
+    int chunks;
+    bool finished;              // Zero-length chunk or httpd_resp_send seen
+    char type[48];
+    char status[48];
+} httpd_req_t;
+
+esp_err_t httpd_resp_set_type(httpd_req_t* r, const char* type);
+esp_err_t httpd_resp_set_hdr(httpd_req_t* r, const char* field, const char* value);
+esp_err_t httpd_resp_set_status(httpd_req_t* r, const char* status);
+esp_err_t httpd_resp_send(httpd_req_t* r, const char* buf, ssize_t len);
+esp_err_t httpd_resp_send_chunk(httpd_req_t* r, const char* buf, ssize_t len);
+esp_err_t httpd_resp_sendstr(httpd_req_t* r, const char* str);
+esp_err_t httpd_resp_sendstr_chunk(httpd_req_t* r, const char* str);
+esp_err_t httpd_resp_send_err(httpd_req_t* r, httpd_err_code_t error, const char* msg);
+int httpd_req_to_sockfd(httpd_req_t* r);
+
+// Host: the detached request is the original one, so its captured body keeps
+// growing; completing it marks it finished
+esp_err_t httpd_req_async_handler_begin(httpd_req_t* r, httpd_req_t** out);
+esp_err_t httpd_req_async_handler_complete(httpd_req_t* r);
+
+// WebSocket sends go to a host sink instead of a socket
+typedef enum {
+    HTTPD_WS_TYPE_CONTINUE = 0x0,
+    HTTPD_WS_TYPE_TEXT = 0x1,
+    HTTPD_WS_TYPE_BINARY = 0x2,
+    HTTPD_WS_TYPE_CLOSE = 0x8,
+    HTTPD_WS_TYPE_PING = 0x9,
+    HTTPD_WS_TYPE_PONG = 0xA,
+} httpd_ws_type_t;
+
+typedef struct {
+    bool final;
+    bool fragmented;
+    httpd_ws_type_t type;
+    uint8_t* payload;
+    size_t len;
+} httpd_ws_frame_t;
+
+typedef enum {
+    HTTPD_WS_CLIENT_INVALID = 0x0,
+    HTTPD_WS_CLIENT_HTTP = 0x1,
+    HTTPD_WS_CLIENT_WEBSOCKET = 0x2,
+} httpd_ws_client_info_t;
+
+esp_err_t httpd_ws_send_data(httpd_handle_t hd, int fd, httpd_ws_frame_t* frame);
+httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t hd, int fd);
+
+// Host only: which fds are open WebSockets, and where their frames go
+typedef void (*host_ws_sink_t)(int fd, const uint8_t* data, size_t len);
+void host_ws_set_open(int fd, bool open);
+void host_ws_set_sink(host_ws_sink_t sink);
+
+// Host only: a fresh request, and freeing what it collected
+void host_req_init(httpd_req_t* r, int fd);
+void host_req_free(httpd_req_t* r);
+
+#endif // HOST_ESP_HTTP_SERVER_H
@@ -0,0 +1,33 @@
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+// Host shim: logs go to stderr, errors and warnings only unless
+// HOST_LOG_VERBOSE is set in the environment
+
+#include <stdarg.h>
+#include <stdint.h>
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+typedef int (*vprintf_like_t)(const char*, va_list);
+
+void esp_log_write(esp_log_level_t level, const char* tag, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+void esp_log_level_set(const char* tag, esp_log_level_t level);
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func);
+uint32_t esp_log_timestamp(void);
+
+#define ESP_LOGE(tag, fmt, ...) esp_log_write(ESP_LOG_ERROR, tag, fmt "\n", ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) esp_log_write(ESP_LOG_WARN, tag, fmt "\n", ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) esp_log_write(ESP_LOG_INFO, tag, fmt "\n", ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) esp_log_write(ESP_LOG_DEBUG, tag, fmt "\n", ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) esp_log_write(ESP_LOG_VERBOSE, tag, fmt "\n", ##__VA_ARGS__)
+
+#endif // HOST_ESP_LOG_H
@@ -0,0 +1,9 @@
+#ifndef HOST_ESP_RANDOM_H
+#define HOST_ESP_RANDOM_H
+
+#include <stdint.h>
+
+// Host shim: a fixed-seed generator, so runs repeat
+uint32_t esp_random(void);
+
+#endif // HOST_ESP_RANDOM_H
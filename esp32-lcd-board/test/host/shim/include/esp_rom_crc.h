@@ -0,0 +1,10 @@
+#ifndef HOST_ESP_ROM_CRC_H
+#define HOST_ESP_ROM_CRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Host shim: the ROM's CRC32 (IEEE 802.3, same results as zlib's crc32())
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len);
+
+#endif // HOST_ESP_ROM_CRC_H
@@ -0,0 +1,21 @@
+#ifndef HOST_ESP_SPIFFS_H
+#define HOST_ESP_SPIFFS_H
+
+// Host shim: "mounting" makes base_path a plain directory on the host, so
+// the firmware's stdio calls land in real files
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef struct {
+    const char* base_path;
+    const char* partition_label;
+    size_t max_files;
+    bool format_if_mount_failed;
+} esp_vfs_spiffs_conf_t;
+
+esp_err_t esp_vfs_spiffs_register(const esp_vfs_spiffs_conf_t* conf);
+esp_err_t esp_spiffs_info(const char* partition_label, size_t* total_bytes, size_t* used_bytes);
+
+#endif // HOST_ESP_SPIFFS_H
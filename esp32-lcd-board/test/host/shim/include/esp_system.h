@@ -0,0 +1,18 @@
+#ifndef HOST_ESP_SYSTEM_H
+#define HOST_ESP_SYSTEM_H
+
+// Host shim: shutdown handlers are kept; a test runs them in place of
+// esp_restart()
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef void (*shutdown_handler_t)(void);
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handle);
+esp_err_t esp_unregister_shutdown_handler(shutdown_handler_t handle);
+
+// Host only: what esp_restart() does before resetting
+void host_run_shutdown_handlers(void);
+
+#endif // HOST_ESP_SYSTEM_H
@@ -0,0 +1,56 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+// Host shim: FreeRTOS on pthreads. Ticks are ms on the fake clock
+// (host_clock.h); blocking waits time out in real ms.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_attr.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdTRUE              1
+#define pdFALSE             0
+#define pdPASS              pdTRUE
+#define pdFAIL              pdFALSE
+#define portMAX_DELAY       ((TickType_t)0xffffffffu)
+#define portTICK_PERIOD_MS  1
+#define configTICK_RATE_HZ  1000
+#define configMAX_TASK_NAME_LEN 16
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+#define tskIDLE_PRIORITY    0
+#define tskNO_AFFINITY      0x7fffffff
+
+#define configASSERT(x)     do { if (!(x)) abort(); } while (0)
+
+// One lock for every critical section; recursive, like nesting on a core
+typedef struct {
+    int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { 0 }
+
+void host_critical_enter(void);
+void host_critical_exit(void);
+
+#define portENTER_CRITICAL(mux)         ((void)(mux), host_critical_enter())
+#define portEXIT_CRITICAL(mux)          ((void)(mux), host_critical_exit())
+#define portENTER_CRITICAL_ISR(mux)     portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)      portEXIT_CRITICAL(mux)
+#define taskENTER_CRITICAL(mux)         portENTER_CRITICAL(mux)
+#define taskEXIT_CRITICAL(mux)          portEXIT_CRITICAL(mux)
+#define portYIELD_FROM_ISR(x)           ((void)(x))
+
+static inline BaseType_t xPortInIsrContext(void)
+{
+    return pdFALSE;
+}
+
+#include <stdlib.h>
+#include "esp_heap_caps.h"
+
+#endif // HOST_FREERTOS_H
@@ -0,0 +1,14 @@
+#ifndef HOST_FREERTOS_MESSAGE_BUFFER_H
+#define HOST_FREERTOS_MESSAGE_BUFFER_H
+
+#include "freertos/FreeRTOS.h"
+
+// Each message costs its length plus a 4-byte header, as on the target
+typedef struct host_msgbuf* MessageBufferHandle_t;
+
+MessageBufferHandle_t xMessageBufferCreate(size_t size);
+size_t xMessageBufferSend(MessageBufferHandle_t buf, const void* data, size_t len, TickType_t ticks);
+size_t xMessageBufferReceive(MessageBufferHandle_t buf, void* out, size_t max_len, TickType_t ticks);
+void vMessageBufferDelete(MessageBufferHandle_t buf);
+
+#endif // HOST_FREERTOS_MESSAGE_BUFFER_H
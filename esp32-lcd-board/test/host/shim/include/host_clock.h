@@ -0,0 +1,24 @@
+#ifndef HOST_CLOCK_H
+#define HOST_CLOCK_H
+
+#include <stdint.h>
+#include <time.h>
+
+// ============================================================================
+// Host Fake Clock
+// ============================================================================
+//
+// esp_timer_get_time(), xTaskGetTickCount() and (for targets linked with
+// -Wl,--wrap=time) time() all read this clock. It only moves when a test
+// moves it, so renders and timeouts are repeatable.
+
+// Set the esp_timer clock (us since boot); runs timers that come due
+void host_clock_set_us(int64_t us);
+
+// Move the esp_timer clock forward, running due timers in order
+void host_clock_advance_us(int64_t us);
+
+// Wall clock returned by the time() wrapper (Unix s)
+void host_clock_set_wall(time_t t);
+
+#endif // HOST_CLOCK_H
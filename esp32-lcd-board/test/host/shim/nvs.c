@@ -0,0 +1,324 @@
+#include <pthread.h>
+#include <string.h>
+
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// ============================================================================
+// Store
+// ============================================================================
+
+#define NVS_MAX_ENTRIES     64
+#define NVS_MAX_HANDLES     8
+#define NVS_MAX_VALUE       512
+
+typedef enum {
+    ENTRY_U8 = 1,
+    ENTRY_U32,
+    ENTRY_STR,
+    ENTRY_BLOB,
+} entry_type_t;
+
+typedef struct {
+    bool used;
+    char ns[16];
+    char key[16];
+    entry_type_t type;
+    size_t len;
+    uint8_t value[NVS_MAX_VALUE];
+} entry_t;
+
+typedef struct {
+    bool open;
+    bool writable;
+    char ns[16];
+} handle_t;
+
+static pthread_mutex_t nvs_lock = PTHREAD_MUTEX_INITIALIZER;
+static entry_t entries[NVS_MAX_ENTRIES];
+static handle_t handles[NVS_MAX_HANDLES];
+static int commits = 0;
+static char last_commit_task[32];
+static bool fail_writes = false;
+static pthread_cond_t hold_cond = PTHREAD_COND_INITIALIZER;
+static bool hold_writes = false;
+static int held_writes = 0;
+
+// Handles are index + 1 so 0 is never valid
+static handle_t* handle_get(nvs_handle_t h)
+{
+    if (h == 0 || h > NVS_MAX_HANDLES || !handles[h - 1].open) return NULL;
+    return &handles[h - 1];
+}
+
+static entry_t* entry_find(const char* ns, const char* key)
+{
+    for (int i = 0; i < NVS_MAX_ENTRIES; i++) {
+        if (entries[i].used && strcmp(entries[i].ns, ns) == 0 && strcmp(entries[i].key, key) == 0) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+static bool ns_exists(const char* ns)
+{
+    for (int i = 0; i < NVS_MAX_ENTRIES; i++) {
+        if (entries[i].used && strcmp(entries[i].ns, ns) == 0) return true;
+    }
+    return false;
+}
+
+static esp_err_t entry_set(nvs_handle_t h, const char* key, entry_type_t type,
+                           const void* value, size_t len)
+{
+    pthread_mutex_lock(&nvs_lock);
+    held_writes++;
+    while (hold_writes) pthread_cond_wait(&hold_cond, &nvs_lock);
+    held_writes--;
+    handle_t* hd = handle_get(h);
+    esp_err_t err = ESP_OK;
+    if (!hd || !hd->writable) {
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+    } else if (fail_writes) {
+        err = ESP_FAIL;
+    } else if (strlen(key) >= sizeof(entries[0].key) || len > NVS_MAX_VALUE) {
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        entry_t* e = entry_find(hd->ns, key);
+        for (int i = 0; !e && i < NVS_MAX_ENTRIES; i++) {
+            if (!entries[i].used) e = &entries[i];
+        }
+        if (!e) {
+            err = ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+        } else {
+            e->used = true;
+            strcpy(e->ns, hd->ns);
+            strcpy(e->key, key);
+            e->type = type;
+            e->len = len;
+            memcpy(e->value, value, len);
+        }
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+// Copies up to *len bytes; *len is set to the stored size
+static esp_err_t entry_get(nvs_handle_t h, const char* key, entry_type_t type,
+                           void* out, size_t* len, bool exact)
+{
+    pthread_mutex_lock(&nvs_lock);
+    handle_t* hd = handle_get(h);
+    entry_t* e = hd ? entry_find(hd->ns, key) : NULL;
+    esp_err_t err = ESP_OK;
+    if (!hd) {
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+    } else if (!e) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else if (e->type != type) {
+        err = ESP_ERR_NVS_TYPE_MISMATCH;
+    } else if (out && (exact ? *len != e->len : *len < e->len)) {
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        if (out) memcpy(out, e->value, e->len);
+        *len = e->len;
+    }
+    if (err == ESP_ERR_NVS_INVALID_LENGTH) *len = e->len;
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+// ============================================================================
+// API
+// ============================================================================
+
+esp_err_t nvs_flash_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    host_nvs_reset();
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char* name, nvs_open_mode_t open_mode, nvs_handle_t* out_handle)
+{
+    if (!name || strlen(name) >= sizeof(handles[0].ns)) return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&nvs_lock);
+    esp_err_t err = ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    if (open_mode == NVS_READONLY && !ns_exists(name)) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else {
+        for (int i = 0; i < NVS_MAX_HANDLES; i++) {
+            if (!handles[i].open) {
+                handles[i].open = true;
+                handles[i].writable = open_mode == NVS_READWRITE;
+                strcpy(handles[i].ns, name);
+                *out_handle = (nvs_handle_t)(i + 1);
+                err = ESP_OK;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    pthread_mutex_lock(&nvs_lock);
+    handle_t* hd = handle_get(handle);
+    if (hd) hd->open = false;
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    pthread_mutex_lock(&nvs_lock);
+    handle_t* hd = handle_get(handle);
+    esp_err_t err = ESP_OK;
+    if (!hd) {
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+    } else if (fail_writes) {
+        err = ESP_FAIL;
+    } else {
+        commits++;
+        snprintf(last_commit_task, sizeof(last_commit_task), "%s", pcTaskGetName(NULL));
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char* key, uint8_t value)
+{
+    return entry_set(handle, key, ENTRY_U8, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char* key, uint32_t value)
+{
+    return entry_set(handle, key, ENTRY_U32, &value, sizeof(value));
+}
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char* key, const char* value)
+{
+    return entry_set(handle, key, ENTRY_STR, value, strlen(value) + 1);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t length)
+{
+    return entry_set(handle, key, ENTRY_BLOB, value, length);
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char* key, uint8_t* out_value)
+{
+    size_t len = sizeof(*out_value);
+    return entry_get(handle, key, ENTRY_U8, out_value, &len, true);
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char* key, uint32_t* out_value)
+{
+    size_t len = sizeof(*out_value);
+    return entry_get(handle, key, ENTRY_U32, out_value, &len, true);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char* key, char* out_value, size_t* length)
+{
+    return entry_get(handle, key, ENTRY_STR, out_value, length, false);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out_value, size_t* length)
+{
+    return entry_get(handle, key, ENTRY_BLOB, out_value, length, false);
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char* key)
+{
+    pthread_mutex_lock(&nvs_lock);
+    handle_t* hd = handle_get(handle);
+    entry_t* e = hd ? entry_find(hd->ns, key) : NULL;
+    esp_err_t err = !hd || !hd->writable ? ESP_ERR_NVS_INVALID_HANDLE
+                  : !e ? ESP_ERR_NVS_NOT_FOUND : ESP_OK;
+    if (err == ESP_OK) e->used = false;
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_erase_all(nvs_handle_t handle)
+{
+    pthread_mutex_lock(&nvs_lock);
+    handle_t* hd = handle_get(handle);
+    esp_err_t err = !hd || !hd->writable ? ESP_ERR_NVS_INVALID_HANDLE : ESP_OK;
+    for (int i = 0; err == ESP_OK && i < NVS_MAX_ENTRIES; i++) {
+        if (entries[i].used && strcmp(entries[i].ns, hd->ns) == 0) entries[i].used = false;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+// ============================================================================
+// Host Hooks
+// ============================================================================
+
+void host_nvs_reset(void)
+{
+    pthread_mutex_lock(&nvs_lock);
+    memset(entries, 0, sizeof(entries));
+    commits = 0;
+    last_commit_task[0] = '\0';
+    fail_writes = false;
+    hold_writes = false;
+    pthread_cond_broadcast(&hold_cond);
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+int host_nvs_commits(void)
+{
+    pthread_mutex_lock(&nvs_lock);
+    int n = commits;
+    pthread_mutex_unlock(&nvs_lock);
+    return n;
+}
+
+int host_nvs_key_count(const char* name)
+{
+    pthread_mutex_lock(&nvs_lock);
+    int n = 0;
+    for (int i = 0; i < NVS_MAX_ENTRIES; i++) {
+        if (entries[i].used && strcmp(entries[i].ns, name) == 0) n++;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return n;
+}
+
+const char* host_nvs_last_commit_task(void)
+{
+    return last_commit_task;
+}
+
+void host_nvs_fail_writes(bool fail)
+{
+    pthread_mutex_lock(&nvs_lock);
+    fail_writes = fail;
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+void host_nvs_hold_writes(bool hold)
+{
+    pthread_mutex_lock(&nvs_lock);
+    hold_writes = hold;
+    pthread_cond_broadcast(&hold_cond);
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+int host_nvs_held_writes(void)
+{
+    pthread_mutex_lock(&nvs_lock);
+    int n = held_writes;
+    pthread_mutex_unlock(&nvs_lock);
+    return n;
+}
@@ -0,0 +1,273 @@
+// cw_* output matches the RFC 8949 Appendix A examples, uses the shortest
+// argument at every size boundary, and a nested document several times the
+// writer buffer decodes back item for item.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cbor_writer.h"
+#include "host_test.h"
+
+static httpd_req_t req;
+static cbor_writer_t w;
+
+static void begin(void)
+{
+    host_req_init(&req, 1);
+    cw_begin(&w, &req);
+}
+
+// Finish and compare with the expected bytes, given as hex
+static void expect_hex(const char *what, const char *hex)
+{
+    CHECK_INT(cw_finish(&w), ESP_OK);
+    size_t n = strlen(hex) / 2;
+    uint8_t expected[64];
+    for (size_t i = 0; i < n; i++) {
+        unsigned byte;
+        sscanf(hex + i * 2, "%2x", &byte);
+        expected[i] = (uint8_t)byte;
+    }
+    if (req.body_len != n || memcmp(req.body, expected, n) != 0) {
+        fprintf(stderr, "%s: got ", what);
+        for (size_t i = 0; i < req.body_len; i++) {
+            fprintf(stderr, "%02x", (uint8_t)req.body[i]);
+        }
+        fprintf(stderr, ", expected %s\n", hex);
+        host_test_failures++;
+    }
+    host_req_free(&req);
+}
+
+// ============================================================================
+// Decoder
+// ============================================================================
+
+// Just enough of a decoder to walk what cw_* writes: reads one item (and
+// everything inside it) and checks it against the next expected item
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+    bool bad;
+} reader_t;
+
+static uint64_t read_head(reader_t *r, int *major)
+{
+    if (r->p >= r->end) {
+        r->bad = true;
+        return 0;
+    }
+    uint8_t ib = *r->p++;
+    *major = ib >> 5;
+    uint8_t info = ib & 0x1F;
+    if (info < 24) return info;
+
+    int len = info == 24 ? 1 : info == 25 ? 2 : info == 26 ? 4 : info == 27 ? 8 : 0;
+    if (len == 0 || r->end - r->p < len) {
+        r->bad = true;
+        return 0;
+    }
+    uint64_t v = 0;
+    for (int i = 0; i < len; i++) {
+        v = v << 8 | *r->p++;
+    }
+    // Shortest form only
+    uint64_t min = len == 1 ? 24 : len == 2 ? 0x100 : len == 4 ? 0x10000 : 0x100000000ull;
+    if (v < min) r->bad = true;
+    return v;
+}
+
+static bool read_text(reader_t *r, const char *expected)
+{
+    int major;
+    uint64_t len = read_head(r, &major);
+    if (r->bad || major != 3 || len != strlen(expected) || (uint64_t)(r->end - r->p) < len) {
+        return false;
+    }
+    bool same = memcmp(r->p, expected, len) == 0;
+    r->p += len;
+    return same;
+}
+
+static bool read_uint(reader_t *r, uint64_t expected)
+{
+    int major;
+    uint64_t v = read_head(r, &major);
+    return !r->bad && major == 0 && v == expected;
+}
+
+static bool read_int(reader_t *r, int64_t expected)
+{
+    int major;
+    uint64_t v = read_head(r, &major);
+    if (r->bad) return false;
+    if (expected < 0) return major == 1 && v == (uint64_t)(-1 - expected);
+    return major == 0 && v == (uint64_t)expected;
+}
+
+static bool read_container(reader_t *r, int major_expected, uint64_t count)
+{
+    int major;
+    uint64_t v = read_head(r, &major);
+    return !r->bad && major == major_expected && v == count;
+}
+
+static bool read_simple(reader_t *r, uint8_t value)
+{
+    int major;
+    uint64_t v = read_head(r, &major);
+    return !r->bad && major == 7 && v == value;
+}
+
+// ============================================================================
+// Document
+// ============================================================================
+
+#define DOC_ITEMS 40
+
+static void doc_text(int i, char *out, size_t size)
+{
+    // Lengths around the 23/24 and 255/256 argument boundaries
+    static const int lens[] = { 0, 1, 23, 24, 255, 256, 300 };
+    int len = lens[i % 7];
+    if ((size_t)len >= size) len = (int)size - 1;
+    for (int k = 0; k < len; k++) out[k] = (char)('a' + (i + k) % 26);
+    out[len] = '\0';
+}
+
+// Shaped like the /api/departures list: a map holding an array of maps
+static void write_doc(void)
+{
+    char text[512];
+    cw_map(&w, 2);
+    cw_text(&w, "stop");
+    cw_text(&w, "2060270");
+    cw_text(&w, "departures");
+    cw_array(&w, DOC_ITEMS);
+    for (int i = 0; i < DOC_ITEMS; i++) {
+        cw_map(&w, 4);
+        cw_text(&w, "dest");
+        doc_text(i, text, sizeof(text));
+        cw_text(&w, text);
+        cw_text(&w, "when");
+        cw_uint(&w, 1700000000ull + (uint64_t)i * 97);
+        cw_text(&w, "delay");
+        cw_int(&w, (i % 3 - 1) * (int64_t)i * 30);
+        cw_text(&w, "rt");
+        if (i % 5 == 0) {
+            cw_text(&w, NULL);
+        } else {
+            cw_bool(&w, i % 2);
+        }
+    }
+}
+
+static bool read_doc(reader_t *r)
+{
+    char text[512];
+    bool ok = read_container(r, 5, 2) &&
+              read_text(r, "stop") && read_text(r, "2060270") &&
+              read_text(r, "departures") && read_container(r, 4, DOC_ITEMS);
+    for (int i = 0; i < DOC_ITEMS && ok; i++) {
+        doc_text(i, text, sizeof(text));
+        ok = read_container(r, 5, 4) &&
+             read_text(r, "dest") && read_text(r, text) &&
+             read_text(r, "when") && read_uint(r, 1700000000ull + (uint64_t)i * 97) &&
+             read_text(r, "delay") && read_int(r, (i % 3 - 1) * (int64_t)i * 30) &&
+             read_text(r, "rt") &&
+             (i % 5 == 0 ? read_simple(r, 22) : read_simple(r, i % 2 ? 21 : 20));
+    }
+    return ok && r->p == r->end;
+}
+
+int main(void)
+{
+    // RFC 8949 Appendix A
+    static const struct {
+        uint64_t value;
+        const char *hex;
+    } uints[] = {
+        { 0, "00" }, { 1, "01" }, { 10, "0a" }, { 23, "17" }, { 24, "1818" },
+        { 25, "1819" }, { 100, "1864" }, { 255, "18ff" }, { 256, "190100" },
+        { 1000, "1903e8" }, { 65535, "19ffff" }, { 65536, "1a00010000" },
+        { 1000000, "1a000f4240" }, { 4294967295ull, "1affffffff" },
+        { 4294967296ull, "1b0000000100000000" },
+        { 1000000000000ull, "1b000000e8d4a51000" },
+        { 18446744073709551615ull, "1bffffffffffffffff" },
+    };
+    for (size_t i = 0; i < sizeof(uints) / sizeof(uints[0]); i++) {
+        begin();
+        cw_uint(&w, uints[i].value);
+        expect_hex("uint", uints[i].hex);
+    }
+
+    static const struct {
+        int64_t value;
+        const char *hex;
+    } ints[] = {
+        { 0, "00" }, { 1000, "1903e8" }, { -1, "20" }, { -10, "29" },
+        { -24, "37" }, { -25, "3818" }, { -100, "3863" }, { -1000, "3903e7" },
+        { INT64_MIN, "3b7fffffffffffffff" }, { INT64_MAX, "1b7fffffffffffffff" },
+    };
+    for (size_t i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+        begin();
+        cw_int(&w, ints[i].value);
+        expect_hex("int", ints[i].hex);
+    }
+
+    begin(); cw_bool(&w, false); expect_hex("false", "f4");
+    begin(); cw_bool(&w, true); expect_hex("true", "f5");
+    begin(); cw_null(&w); expect_hex("null", "f6");
+    begin(); cw_text(&w, NULL); expect_hex("NULL text", "f6");
+    begin(); cw_text(&w, ""); expect_hex("empty text", "60");
+    begin(); cw_text(&w, "a"); expect_hex("text", "6161");
+    begin(); cw_text(&w, "IETF"); expect_hex("text", "6449455446");
+    begin(); cw_text(&w, "\"\\"); expect_hex("text", "62225c");
+    begin(); cw_text(&w, "\xc3\xbc"); expect_hex("utf-8", "62c3bc");
+    begin(); cw_array(&w, 0); expect_hex("[]", "80");
+    begin(); cw_map(&w, 0); expect_hex("{}", "a0");
+
+    begin();
+    cw_array(&w, 3);
+    cw_uint(&w, 1);
+    cw_array(&w, 2);
+    cw_uint(&w, 2);
+    cw_uint(&w, 3);
+    cw_array(&w, 2);
+    cw_uint(&w, 4);
+    cw_uint(&w, 5);
+    expect_hex("[1,[2,3],[4,5]]", "8301820203820405");
+
+    begin();
+    cw_map(&w, 2);
+    cw_text(&w, "a");
+    cw_uint(&w, 1);
+    cw_text(&w, "b");
+    cw_array(&w, 2);
+    cw_uint(&w, 2);
+    cw_uint(&w, 3);
+    expect_hex("{a:1,b:[2,3]}", "a26161016162820203");
+
+    // 25 items needs the one-byte count
+    begin();
+    cw_array(&w, 25);
+    for (int i = 1; i <= 25; i++) cw_uint(&w, (uint64_t)i);
+    CHECK_INT(cw_finish(&w), ESP_OK);
+    CHECK_INT(req.body_len, 2 + 23 + 2 * 2);
+    CHECK((uint8_t)req.body[0] == 0x98 && (uint8_t)req.body[1] == 25);
+    host_req_free(&req);
+
+    // A document several buffers long goes out in chunks and reads back
+    begin();
+    write_doc();
+    CHECK_INT(cw_finish(&w), ESP_OK);
+    CHECK(req.finished);
+    CHECK(req.chunks > 1);
+    reader_t r = { (const uint8_t *)req.body, (const uint8_t *)req.body + req.body_len, false };
+    CHECK(read_doc(&r));
+    CHECK(!r.bad);
+    host_req_free(&req);
+
+    return host_test_result("test_cbor_writer");
+}
@@ -0,0 +1,278 @@
+// departure_cache on plain files: a save loads back marked as cached, the
+// per-stop rate limit, files with a bad CRC, format or length discarded,
+// departures that have left dropped by age, and a reset between the save's
+// remove() and rename() recovered from the .tmp copy.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "departure_cache.h"
+#include "host_clock.h"
+#include "host_test.h"
+
+#define WALL_NOW    1760000000      // Oct 2025
+#define HEADER_LEN  12              // cache_header_t
+
+static tfnsw_departures_t deps, loaded;
+
+static void fixture(int first_mins)
+{
+    memset(&deps, 0, sizeof(deps));
+    deps.status = TFNSW_STATUS_SUCCESS;
+    deps.last_fetch_time = (int64_t)WALL_NOW * 1000;
+    strcpy(deps.station_name, "Victoria Cross");
+    deps.count = 4;
+    for (int i = 0; i < deps.count; i++) {
+        tfnsw_departure_t *d = &deps.departures[i];
+        snprintf(d->destination, sizeof(d->destination), "Dest %d", i);
+        d->scheduled_time = WALL_NOW + (first_mins + i * 5) * 60;
+        d->mins_to_departure = first_mins + i * 5;
+        d->direction = TFNSW_DIRECTION_NORTHBOUND;
+    }
+}
+
+static void path_for(const char *stop_id, const char *suffix, char *out, size_t size)
+{
+    snprintf(out, size, "%s/dep_%s.bin%s", DEPARTURES_CACHE_BASE_PATH, stop_id, suffix);
+}
+
+static bool exists(const char *stop_id, const char *suffix)
+{
+    char path[96];
+    path_for(stop_id, suffix, path, sizeof(path));
+    FILE *f = fopen(path, "rb");
+    if (f) fclose(f);
+    return f != NULL;
+}
+
+// Read, change and write back a stop's file
+static size_t read_file(const char *stop_id, uint8_t *buf, size_t cap)
+{
+    char path[96];
+    path_for(stop_id, "", path, sizeof(path));
+    FILE *f = fopen(path, "rb");
+    if (!f) return 0;
+    size_t n = fread(buf, 1, cap, f);
+    fclose(f);
+    return n;
+}
+
+static void write_file(const char *stop_id, const char *suffix, const uint8_t *buf, size_t n)
+{
+    char path[96];
+    path_for(stop_id, suffix, path, sizeof(path));
+    FILE *f = fopen(path, "wb");
+    CHECK(f != NULL);
+    if (!f) return;
+    fwrite(buf, 1, n, f);
+    fclose(f);
+}
+
+// Save a fresh copy of the fixture past the rate limit
+static void save_fresh(const char *stop_id)
+{
+    host_clock_advance_us((int64_t)DEPARTURES_CACHE_WRITE_INTERVAL_MS * 1000);
+    CHECK_INT(departures_cache_save(stop_id, &deps), ESP_OK);
+    CHECK(exists(stop_id, ""));
+}
+
+static void test_round_trip(void)
+{
+    fixture(3);
+    save_fresh("2060270");
+    CHECK(!exists("2060270", ".tmp"));
+
+    host_clock_set_wall(WALL_NOW + 90);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_OK);
+    CHECK_INT(loaded.status, TFNSW_STATUS_SUCCESS_CACHED);
+    CHECK(loaded.is_cached_fallback && loaded.is_stale);
+    CHECK_INT(loaded.data_age_seconds, 90);
+    CHECK_INT(loaded.count, 4);
+    CHECK_STR(loaded.station_name, "Victoria Cross");
+    CHECK_STR(loaded.departures[3].destination, "Dest 3");
+    CHECK_INT(loaded.departures[0].scheduled_time, deps.departures[0].scheduled_time);
+    // Minutes are recounted from the stored times
+    CHECK_INT(loaded.departures[0].mins_to_departure, 1);
+    CHECK_INT(loaded.departures[1].mins_to_departure, 6);
+    CHECK(departures_cache_is_valid("2060270"));
+
+    // Nothing saved for another stop; bad stop IDs never reach the filesystem
+    CHECK_INT(departures_cache_load("2065163", &loaded), ESP_ERR_NOT_FOUND);
+    CHECK_INT(departures_cache_load("../x", &loaded), ESP_ERR_INVALID_ARG);
+    CHECK_INT(departures_cache_save("a/b", &deps), ESP_ERR_INVALID_ARG);
+    CHECK_INT(departures_cache_load("0123456789abcdef", &loaded), ESP_ERR_INVALID_ARG);
+
+    // Failed or empty fetches never replace a good file
+    tfnsw_departures_t empty = deps;
+    empty.count = 0;
+    host_clock_advance_us((int64_t)DEPARTURES_CACHE_WRITE_INTERVAL_MS * 1000);
+    CHECK_INT(departures_cache_save("2060270", &empty), ESP_OK);
+    empty = deps;
+    empty.status = TFNSW_STATUS_ERROR_NETWORK;
+    CHECK_INT(departures_cache_save("2060270", &empty), ESP_OK);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_OK);
+    CHECK_INT(loaded.count, 4);
+}
+
+static void test_age(void)
+{
+    fixture(3);
+    save_fresh("2060270");
+
+    // Departures more than a minute gone are dropped
+    host_clock_set_wall(WALL_NOW + 3 * 60 + 5 * 60 + 61);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_OK);
+    CHECK_INT(loaded.count, 2);
+    CHECK_STR(loaded.departures[0].destination, "Dest 2");
+
+    // All gone, or past the age limit: too old to show (the file stays)
+    host_clock_set_wall(WALL_NOW + 40 * 60);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_ERR_TIMEOUT);
+    fixture(600);
+    save_fresh("2060270");
+    host_clock_set_wall(WALL_NOW + DEPARTURES_CACHE_MAX_AGE_S + 1);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_ERR_TIMEOUT);
+    CHECK(exists("2060270", ""));
+
+    // Before SNTP the age is unknown and the stored minutes are shown as is
+    host_clock_set_wall(1000);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_OK);
+    CHECK_INT(loaded.data_age_seconds, -1);
+    CHECK_INT(loaded.count, 4);
+    CHECK_INT(loaded.departures[0].mins_to_departure, 600);
+    host_clock_set_wall(WALL_NOW);
+}
+
+static void test_rate_limit(void)
+{
+    fixture(3);
+    save_fresh("2060270");
+
+    // A second save inside the interval is skipped (and still reports OK)
+    fixture(4);
+    host_clock_advance_us((int64_t)(DEPARTURES_CACHE_WRITE_INTERVAL_MS - 1000) * 1000);
+    CHECK_INT(departures_cache_save("2060270", &deps), ESP_OK);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_OK);
+    CHECK_INT(loaded.departures[0].mins_to_departure, 3);
+
+    // Other stops have their own limit
+    CHECK_INT(departures_cache_save("2065163", &deps), ESP_OK);
+    CHECK_INT(departures_cache_load("2065163", &loaded), ESP_OK);
+    CHECK_INT(loaded.departures[0].mins_to_departure, 4);
+
+    // Once the interval is up the new copy goes out
+    host_clock_advance_us(1000 * 1000);
+    CHECK_INT(departures_cache_save("2060270", &deps), ESP_OK);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_OK);
+    CHECK_INT(loaded.departures[0].mins_to_departure, 4);
+
+    // More stops than rate-limit slots: the oldest slot is reused, so that
+    // stop can write again straight away
+    fixture(5);
+    static const char *stops[] = { "1001", "1002", "1003", "1004" };
+    for (int i = 0; i < 4; i++) {
+        host_clock_advance_us(1000);
+        CHECK_INT(departures_cache_save(stops[i], &deps), ESP_OK);
+    }
+    CHECK_INT(departures_cache_save("2060270", &deps), ESP_OK);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_OK);
+    CHECK_INT(loaded.departures[0].mins_to_departure, 5);
+}
+
+static void test_corrupt(void)
+{
+    static uint8_t good[4096], buf[4096];
+    fixture(3);
+    save_fresh("2060270");
+    size_t n = read_file("2060270", good, sizeof(good));
+    CHECK(n > HEADER_LEN + 3);
+
+    // One flipped bit anywhere in header or payload is caught
+    static const size_t at[] = { 0, 4, 6, 8, HEADER_LEN, HEADER_LEN + 3, SIZE_MAX };
+    for (size_t i = 0; i < sizeof(at) / sizeof(at[0]); i++) {
+        size_t pos = at[i] == SIZE_MAX ? n - 1 : at[i];
+        memcpy(buf, good, n);
+        buf[pos] ^= 0x10;
+        write_file("2060270", "", buf, n);
+        esp_err_t ret = departures_cache_load("2060270", &loaded);
+        CHECK(ret == ESP_ERR_INVALID_CRC || ret == ESP_ERR_INVALID_VERSION ||
+              ret == ESP_ERR_INVALID_SIZE);
+        // And the file is deleted
+        CHECK(!exists("2060270", ""));
+    }
+
+    // A format bump is a version error, not a CRC one
+    memcpy(buf, good, n);
+    buf[4] = DEPARTURES_CACHE_FORMAT + 1;
+    write_file("2060270", "", buf, n);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_ERR_INVALID_VERSION);
+
+    // Cut short, or shorter than a header
+    write_file("2060270", "", good, n - 1);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_ERR_INVALID_CRC);
+    write_file("2060270", "", good, 5);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_ERR_INVALID_CRC);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_ERR_NOT_FOUND);
+
+    // A valid file saved for another stop is not served under this one
+    write_file("2065163", "", good, n);
+    CHECK_INT(departures_cache_load("2065163", &loaded), ESP_ERR_INVALID_RESPONSE);
+}
+
+static void test_interrupted_save(void)
+{
+    static uint8_t good[4096];
+    fixture(3);
+    save_fresh("2060270");
+    size_t n = read_file("2060270", good, sizeof(good));
+
+    // Reset after remove(path), before rename(): only the .tmp is left
+    char path[96], tmp_path[96];
+    path_for("2060270", "", path, sizeof(path));
+    path_for("2060270", ".tmp", tmp_path, sizeof(tmp_path));
+    CHECK_INT(rename(path, tmp_path), 0);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_OK);
+    CHECK_INT(loaded.count, 4);
+    // ...and it takes the file's place
+    CHECK(exists("2060270", ""));
+    CHECK(!exists("2060270", ".tmp"));
+
+    // Reset during the first write: a partial .tmp and no file
+    remove(path);
+    write_file("2060270", ".tmp", good, n / 2);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_ERR_INVALID_CRC);
+    CHECK(!exists("2060270", ".tmp"));
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_ERR_NOT_FOUND);
+
+    // A partial .tmp beside a good file is left alone; the file is served
+    // and the next save overwrites the .tmp
+    write_file("2060270", "", good, n);
+    write_file("2060270", ".tmp", good, n / 2);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_OK);
+    fixture(7);
+    save_fresh("2060270");
+    CHECK(!exists("2060270", ".tmp"));
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_OK);
+    CHECK_INT(loaded.departures[0].mins_to_departure, 7);
+}
+
+int main(void)
+{
+    host_clock_set_wall(WALL_NOW);
+    CHECK_INT(departures_cache_load("2060270", &loaded), ESP_ERR_INVALID_STATE);
+    CHECK_INT(departures_cache_init(), ESP_OK);
+    CHECK_INT(departures_cache_clear(), ESP_OK);
+
+    test_round_trip();
+    test_age();
+    test_rate_limit();
+    test_corrupt();
+    test_interrupted_save();
+
+    CHECK_INT(departures_cache_clear(), ESP_OK);
+    CHECK(!exists("2060270", ""));
+    CHECK(!exists("2065163", ""));
+    return host_test_result("test_departure_cache");
+}
@@ -0,0 +1,221 @@
+// The display mirror stream decodes back to the pixels fed in: PackBits runs
+// and literals, areas split across records, dropped areas coming back as a
+// resync, and viewers forgotten when their socket closes so a reused fd is a
+// new viewer. The real sender task runs; frames land in a host WebSocket sink.
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "display_mirror.h"
+#include "host_test.h"
+
+void power_loop_wake(void) {}
+
+// What one viewer has decoded
+typedef struct {
+    int hellos;
+    int rects;
+    int errors;
+    uint16_t fb[LCD_HEIGHT][LCD_WIDTH];
+} viewer_t;
+
+#define VIEWER_FDS 8
+
+static viewer_t viewers[VIEWER_FDS];
+static pthread_mutex_t viewer_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int get_u16(const uint8_t *p)
+{
+    return p[0] | p[1] << 8;
+}
+
+// Decode one WebSocket frame of packed records into the viewer's framebuffer
+static void decode_rect(viewer_t *v, const uint8_t *data, size_t len, size_t *at)
+{
+    size_t i = *at;
+    int x = get_u16(&data[i + 1]);
+    int y = get_u16(&data[i + 3]);
+    int w = get_u16(&data[i + 5]);
+    int h = get_u16(&data[i + 7]);
+    i += 9;
+    if (w <= 0 || h <= 0 || x + w > LCD_WIDTH || y + h > LCD_HEIGHT) {
+        v->errors++;
+        *at = len;
+        return;
+    }
+
+    int n = w * h;
+    int k = 0;
+    while (k < n && i < len) {
+        uint8_t c = data[i++];
+        bool repeat = c & 0x80;
+        int count = (c & 0x7F) + 1;
+        size_t bytes = repeat ? 2 : (size_t)count * 2;
+        if (k + count > n || i + bytes > len) break;
+        for (int j = 0; j < count; j++) {
+            uint16_t px;
+            memcpy(&px, &data[repeat ? i : i + j * 2], 2);
+            v->fb[y + (k + j) / w][x + (k + j) % w] = px;
+        }
+        i += bytes;
+        k += count;
+    }
+    if (k != n) {
+        v->errors++;
+        *at = len;
+        return;
+    }
+    v->rects++;
+    *at = i;
+}
+
+static void viewer_sink(int fd, const uint8_t *data, size_t len)
+{
+    if (fd < 0 || fd >= VIEWER_FDS) return;
+    viewer_t *v = &viewers[fd];
+
+    pthread_mutex_lock(&viewer_lock);
+    size_t i = 0;
+    while (i < len) {
+        if (data[i] == MIRROR_REC_HELLO && i + 6 <= len) {
+            if (get_u16(&data[i + 1]) != LCD_WIDTH || get_u16(&data[i + 3]) != LCD_HEIGHT ||
+                data[i + 5] != MIRROR_FORMAT_RGB565_BE) {
+                v->errors++;
+            }
+            v->hellos++;
+            i += 6;
+        } else if (data[i] == MIRROR_REC_RECT && i + 9 <= len) {
+            decode_rect(v, data, len, &i);
+        } else {
+            v->errors++;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&viewer_lock);
+}
+
+static int hellos(int fd)
+{
+    pthread_mutex_lock(&viewer_lock);
+    int n = viewers[fd].hellos;
+    pthread_mutex_unlock(&viewer_lock);
+    return n;
+}
+
+static int rects(int fd)
+{
+    pthread_mutex_lock(&viewer_lock);
+    int n = viewers[fd].rects;
+    pthread_mutex_unlock(&viewer_lock);
+    return n;
+}
+
+// Wait (real time, the sender runs every MIRROR_INTERVAL_MS) for cond
+#define WAIT_FOR(cond) ({                                               \
+        bool ok_;                                                       \
+        for (int ms_ = 0; !(ok_ = (cond)) && ms_ < 2000; ms_ += 5) {    \
+            usleep(5000);                                               \
+        }                                                               \
+        ok_;                                                            \
+    })
+
+// The resync a new viewer asks for, once the sender has refilled the budget
+static bool take_resync(int *x1, int *y1, int *x2, int *y2)
+{
+    return WAIT_FOR(display_mirror_take_resync(x1, y1, x2, y2));
+}
+
+static bool region_matches(int fd, int x, int y, int w, int h, const uint16_t *px)
+{
+    bool same = true;
+    pthread_mutex_lock(&viewer_lock);
+    for (int r = 0; r < h && same; r++) {
+        same = memcmp(&viewers[fd].fb[y + r][x], &px[r * w], (size_t)w * 2) == 0;
+    }
+    pthread_mutex_unlock(&viewer_lock);
+    return same;
+}
+
+int main(void)
+{
+    host_ws_set_sink(viewer_sink);
+    CHECK_INT(display_mirror_init(), ESP_OK);
+    CHECK(!display_mirror_active());
+
+    // Nothing is encoded without a viewer
+    static uint16_t area[LCD_WIDTH * 16];
+    display_mirror_feed(0, 0, 4, 4, area);
+
+    host_ws_set_open(5, true);
+    CHECK_INT(display_mirror_add_client(NULL, 5), ESP_OK);
+    CHECK(display_mirror_active());
+
+    // A new viewer starts from a full repaint
+    int x1 = -1, y1 = -1, x2 = -1, y2 = -1;
+    CHECK(take_resync(&x1, &y1, &x2, &y2));
+    CHECK(x1 == 0 && y1 == 0 && x2 == LCD_WIDTH && y2 == LCD_HEIGHT);
+
+    // Runs (short, exactly 128, longer than 128), literals and a lone pixel
+    // at the end, in one 40x10 record
+    const int aw = 40, ah = 10;
+    int n = 0;
+    for (int i = 0; i < 2; i++) area[n++] = 0x1111;
+    for (int i = 0; i < 5; i++) area[n++] = (uint16_t)(0x2000 + i);
+    for (int i = 0; i < 128; i++) area[n++] = 0x3333;
+    for (int i = 0; i < 200; i++) area[n++] = 0x4444;
+    while (n < aw * ah - 1) {
+        area[n] = (uint16_t)(0x5000 + n);
+        n++;
+    }
+    area[n++] = 0x6666;
+    display_mirror_feed(30, 20, 30 + aw, 20 + ah, area);
+    CHECK(WAIT_FOR(rects(5) >= 1));
+    CHECK_INT(hellos(5), 1);
+    CHECK(region_matches(5, 30, 20, aw, ah, area));
+
+    // A full-width area of literals is split into several records
+    const int bw = LCD_WIDTH, bh = 8;
+    for (int i = 0; i < bw * bh; i++) area[i] = (uint16_t)(i * 2654435761u >> 16);
+    int before = rects(5);
+    display_mirror_feed(0, 100, bw, 100 + bh, area);
+    CHECK(WAIT_FOR(region_matches(5, 0, 100, bw, bh, area)));
+    CHECK(rects(5) - before > 1);
+
+    // More than the budget and buffer take at once: the rest comes back as
+    // a resync covering what was dropped
+    for (int i = 0; i < 10; i++) {
+        display_mirror_feed(0, i * 16, LCD_WIDTH, i * 16 + 16, area);
+    }
+    CHECK(take_resync(&x1, &y1, &x2, &y2));
+    CHECK(x1 == 0 && x2 == LCD_WIDTH && y2 == 160 && y1 < y2);
+
+    // Closing forgets the viewer (and the sender frees the buffers)
+    host_ws_set_open(5, false);
+    display_mirror_remove_client(5);
+    CHECK(!display_mirror_active());
+    usleep(4 * MIRROR_INTERVAL_MS * 1000);
+
+    // The fd comes back as a new connection: a fresh HELLO and stream
+    host_ws_set_open(5, true);
+    CHECK_INT(display_mirror_add_client(NULL, 5), ESP_OK);
+    CHECK(WAIT_FOR(hellos(5) == 2));
+    CHECK(take_resync(&x1, &y1, &x2, &y2));
+    for (int i = 0; i < aw * ah; i++) area[i] = (uint16_t)(0x7000 + i / 3);
+    display_mirror_feed(200, 50, 200 + aw, 50 + ah, area);
+    CHECK(WAIT_FOR(region_matches(5, 200, 50, aw, ah, area)));
+
+    // A reused fd registered again without a close still takes one slot
+    CHECK_INT(display_mirror_add_client(NULL, 5), ESP_OK);
+    host_ws_set_open(6, true);
+    CHECK_INT(display_mirror_add_client(NULL, 6), ESP_OK);
+    host_ws_set_open(7, true);
+    CHECK_INT(display_mirror_add_client(NULL, 7), ESP_ERR_NO_MEM);
+
+    for (int fd = 0; fd < VIEWER_FDS; fd++) {
+        CHECK_INT(viewers[fd].errors, 0);
+    }
+    return host_test_result("test_display_mirror");
+}
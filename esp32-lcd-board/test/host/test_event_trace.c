@@ -0,0 +1,373 @@
+// event_trace: the /api/trace export is valid JSON (checked by a strict
+// validator here, so it runs without cJSON) in Chrome Trace Event layout,
+// timestamps are widened correctly across the 32-bit microsecond wrap,
+// events keep their task and order, and an overrun or trace_clear() only
+// exports what the ring still holds. The esp_timer clock is fake.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "host_clock.h"
+#include "event_trace.h"
+#include "host_test.h"
+
+// ============================================================================
+// JSON Validator (RFC 8259)
+// ============================================================================
+
+static const char *skip_ws(const char *p)
+{
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+    return p;
+}
+
+static const char *parse_value(const char *p, int depth);
+
+static const char *parse_string(const char *p)
+{
+    if (*p++ != '"') return NULL;
+    while (*p != '"') {
+        if ((unsigned char)*p < 0x20) return NULL;      // Includes the terminator
+        if (*p == '\\') {
+            p++;
+            if (*p == 'u') {
+                for (int i = 1; i <= 4; i++) {
+                    if (!strchr("0123456789abcdefABCDEF", p[i]) || !p[i]) return NULL;
+                }
+                p += 4;
+            } else if (!*p || !strchr("\"\\/bfnrt", *p)) {
+                return NULL;
+            }
+        }
+        p++;
+    }
+    return p + 1;
+}
+
+static const char *parse_digits(const char *p)
+{
+    if (*p < '0' || *p > '9') return NULL;
+    while (*p >= '0' && *p <= '9') p++;
+    return p;
+}
+
+static const char *parse_number(const char *p)
+{
+    if (*p == '-') p++;
+    if (*p == '0') {
+        p++;
+    } else if (!(p = parse_digits(p))) {
+        return NULL;
+    }
+    if (*p == '.' && !(p = parse_digits(p + 1))) return NULL;
+    if (*p == 'e' || *p == 'E') {
+        p++;
+        if (*p == '+' || *p == '-') p++;
+        if (!(p = parse_digits(p))) return NULL;
+    }
+    return p;
+}
+
+static const char *parse_members(const char *p, char close, int depth)
+{
+    p = skip_ws(p);
+    if (*p == close) return p + 1;
+    while (1) {
+        if (close == '}') {
+            if (!(p = parse_string(p))) return NULL;
+            p = skip_ws(p);
+            if (*p++ != ':') return NULL;
+        }
+        if (!(p = parse_value(p, depth + 1))) return NULL;
+        p = skip_ws(p);
+        if (*p == close) return p + 1;
+        if (*p++ != ',') return NULL;
+        p = skip_ws(p);
+    }
+}
+
+static const char *parse_value(const char *p, int depth)
+{
+    if (depth > 32) return NULL;
+    p = skip_ws(p);
+    switch (*p) {
+        case '{': return parse_members(p + 1, '}', depth);
+        case '[': return parse_members(p + 1, ']', depth);
+        case '"': return parse_string(p);
+        case 't': return strncmp(p, "true", 4) == 0 ? p + 4 : NULL;
+        case 'f': return strncmp(p, "false", 5) == 0 ? p + 5 : NULL;
+        case 'n': return strncmp(p, "null", 4) == 0 ? p + 4 : NULL;
+        default:  return parse_number(p);
+    }
+}
+
+static bool json_valid(const char *text)
+{
+    const char *end = text ? parse_value(text, 0) : NULL;
+    return end && *skip_ws(end) == '\0';
+}
+
+// ============================================================================
+// Export Helpers
+// ============================================================================
+
+typedef struct {
+    char name[32];
+    char ph;
+    double ts;
+    int tid;
+    long long v;            // -1 without args
+} event_t;
+
+#define MAX_EVENTS  (TRACE_RING_SIZE + 64)
+
+static event_t events[MAX_EVENTS];
+static int event_count;
+static char body[256 * 1024];
+
+// Export the ring, validate it and pull out the (non-metadata) events
+static bool export_trace(void)
+{
+    httpd_req_t req;
+    host_req_init(&req, 1);
+    esp_err_t err = trace_export(&req);
+    bool ok = err == ESP_OK && req.finished && req.body && req.body_len < sizeof(body);
+    if (ok) memcpy(body, req.body, req.body_len + 1);
+    host_req_free(&req);
+    CHECK(ok);
+    if (!ok) return false;
+
+    CHECK(json_valid(body));
+    CHECK(strncmp(body, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 39) == 0);
+
+    event_count = 0;
+    for (const char *p = strstr(body, "{\"name\":\""); p; p = strstr(p + 1, "{\"name\":\"")) {
+        event_t e = { .v = -1 };
+        char ph[2];
+        if (sscanf(p, "{\"name\":\"%31[^\"]\",\"ph\":\"%1[^\"]\",\"ts\":%lf,\"pid\":1,\"tid\":%d",
+                   e.name, ph, &e.ts, &e.tid) != 4) {
+            continue;           // Metadata (thread names)
+        }
+        e.ph = ph[0];
+        const char *args = strstr(p, "\"args\":{\"v\":");
+        const char *next = strstr(p + 1, "{\"name\":\"");
+        if (args && (!next || args < next)) e.v = strtoll(args + 12, NULL, 10);
+        if (event_count < MAX_EVENTS) events[event_count++] = e;
+    }
+    return true;
+}
+
+// "tid" of the thread_name metadata entry for name, -1 if none
+static int thread_tid(const char *name)
+{
+    char pattern[96];
+    snprintf(pattern, sizeof(pattern), "\"args\":{\"name\":\"%s\"}", name);
+    const char *args = strstr(body, pattern);
+    if (!args) return -1;
+
+    // Walk back to this entry's "tid"
+    const char *tid = NULL;
+    for (const char *p = strstr(body, "\"tid\":"); p && p < args; p = strstr(p + 1, "\"tid\":")) {
+        tid = p;
+    }
+    return tid ? atoi(tid + 6) : -1;
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+static void test_basic(void)
+{
+    host_clock_set_us(1000000);
+    trace_begin("outer");
+    host_clock_advance_us(100);
+    trace_begin("inner");
+    host_clock_advance_us(50);
+    trace_end("inner", 7);
+    trace_instant("tick", 3);
+    host_clock_advance_us(25);
+    trace_end("outer", 0);
+    trace_span("flush", 1000010, 4096);
+
+    CHECK(export_trace());
+    CHECK_INT(event_count, 7);
+    if (event_count != 7) return;
+
+    static const struct { const char *name; char ph; double ts; long long v; } expected[] = {
+        { "outer", 'B', 1000000, -1 },
+        { "inner", 'B', 1000100, -1 },
+        { "inner", 'E', 1000150, 7 },
+        { "tick",  'i', 1000150, 3 },
+        { "outer", 'E', 1000175, 0 },
+        { "flush", 'B', 1000010, -1 },
+        { "flush", 'E', 1000175, 4096 },
+    };
+    int main_tid = thread_tid("main");
+    CHECK(main_tid >= 0);
+    for (int i = 0; i < 7; i++) {
+        CHECK_STR(events[i].name, expected[i].name);
+        CHECK_INT(events[i].ph, expected[i].ph);
+        CHECK_INT((long long)events[i].ts, (long long)expected[i].ts);
+        CHECK_INT(events[i].v, expected[i].v);
+        CHECK_INT(events[i].tid, main_tid);
+    }
+    CHECK(strstr(body, "\"ph\":\"i\",\"ts\":1000150,\"pid\":1,\"tid\":") != NULL);
+    CHECK(strstr(body, "\"s\":\"t\"") != NULL);
+
+    // Metadata for the overflow and ISR lanes is always there
+    CHECK_INT(thread_tid("other"), 0xFE);
+    CHECK_INT(thread_tid("isr"), 0xFF);
+}
+
+// The stored timestamp is the low 32 bits of esp_timer_get_time()
+static void test_wrap(void)
+{
+    const int64_t wrap = (int64_t)1 << 32;
+
+    // Before, across and after the wrap, exported after it
+    trace_clear();
+    host_clock_set_us(wrap - 1500);
+    trace_begin("wrap");
+    host_clock_set_us(wrap - 1);
+    trace_instant("edge", 1);
+    host_clock_set_us(wrap + 20);
+    trace_end("wrap", 2);
+    host_clock_set_us(wrap + 500);
+    trace_span("late", wrap - 200, 9);
+    host_clock_set_us(wrap + 1000);
+
+    CHECK(export_trace());
+    CHECK_INT(event_count, 5);
+    if (event_count == 5) {
+        CHECK_INT((long long)events[0].ts, wrap - 1500);
+        CHECK_INT((long long)events[1].ts, wrap - 1);
+        CHECK_INT((long long)events[2].ts, wrap + 20);
+        CHECK_INT((long long)events[3].ts, wrap - 200);
+        CHECK_INT((long long)events[4].ts, wrap + 500);
+    }
+
+    // Exported again much later in the same wrap period: unchanged
+    host_clock_set_us(wrap + 60LL * 1000000);
+    CHECK(export_trace());
+    CHECK_INT(event_count, 5);
+    if (event_count == 5) {
+        CHECK_INT((long long)events[0].ts, wrap - 1500);
+        CHECK_INT((long long)events[4].ts, wrap + 500);
+    }
+
+    // Several wraps into uptime
+    trace_clear();
+    host_clock_set_us(5 * wrap - 10);
+    trace_begin("fifth");
+    host_clock_set_us(5 * wrap + 10);
+    trace_end("fifth", 0);
+    CHECK(export_trace());
+    CHECK_INT(event_count, 2);
+    if (event_count == 2) {
+        CHECK_INT((long long)events[0].ts, 5 * wrap - 10);
+        CHECK_INT((long long)events[1].ts, 5 * wrap + 10);
+    }
+}
+
+static void *traced_task_done;
+
+static void traced_task(void *arg)
+{
+    (void)arg;
+    trace_begin("worker_job");
+    trace_end("worker_job", 11);
+    __atomic_store_n(&traced_task_done, (void *)1, __ATOMIC_RELEASE);
+    vTaskDelete(NULL);
+}
+
+static void test_tasks(void)
+{
+    trace_clear();
+    trace_instant("from_main", 0);
+    CHECK(xTaskCreate(traced_task, "worker \"q\"", 2048, NULL, 2, NULL) == pdPASS);
+    for (int i = 0; i < 1000 && !__atomic_load_n(&traced_task_done, __ATOMIC_ACQUIRE); i++) {
+        usleep(1000);
+    }
+    CHECK(__atomic_load_n(&traced_task_done, __ATOMIC_ACQUIRE));
+
+    // A task name that needs escaping still gives valid JSON, and the
+    // task keeps its own lane after it is deleted
+    CHECK(export_trace());
+    CHECK_INT(event_count, 3);
+    int worker_tid = thread_tid("worker \\\"q\\\"");
+    CHECK(worker_tid >= 0 && worker_tid != thread_tid("main"));
+    if (event_count == 3) {
+        CHECK_INT(events[0].tid, thread_tid("main"));
+        CHECK_INT(events[1].tid, worker_tid);
+        CHECK_INT(events[2].tid, worker_tid);
+        CHECK_INT(events[2].v, 11);
+    }
+}
+
+static void test_overrun_and_clear(void)
+{
+    // More than a ring's worth: only the newest TRACE_RING_SIZE, in order
+    trace_clear();
+    const int64_t start = 6LL << 32;
+    host_clock_set_us(start);
+    for (int i = 0; i < TRACE_RING_SIZE + 100; i++) {
+        trace_instant("burst", (uint32_t)i);
+        host_clock_advance_us(1);
+    }
+    CHECK(export_trace());
+    CHECK_INT(event_count, TRACE_RING_SIZE);
+    if (event_count == TRACE_RING_SIZE) {
+        CHECK_INT(events[0].v, 100);
+        CHECK_INT(events[TRACE_RING_SIZE - 1].v, TRACE_RING_SIZE + 99);
+        CHECK_INT((long long)events[0].ts, start + 100);
+    }
+
+    // Cleared: an empty but valid event list
+    trace_clear();
+    CHECK(export_trace());
+    CHECK_INT(event_count, 0);
+
+    // Names past the table print as "?"
+    static const char *const extra[] = {
+        "n00", "n01", "n02", "n03", "n04", "n05", "n06", "n07", "n08", "n09",
+        "n10", "n11", "n12", "n13", "n14", "n15", "n16", "n17", "n18", "n19",
+        "n20", "n21", "n22", "n23", "n24", "n25", "n26", "n27", "n28", "n29",
+        "n30", "n31",
+    };
+    for (size_t i = 0; i < sizeof(extra) / sizeof(extra[0]); i++) {
+        trace_instant(extra[i], 0);
+    }
+    trace_instant(NULL, 0);
+    CHECK(export_trace());
+    CHECK_INT(event_count, (int)(sizeof(extra) / sizeof(extra[0])) + 1);
+    if (event_count > 0) CHECK_STR(events[event_count - 1].name, "?");
+}
+
+static void test_validator(void)
+{
+    // The validator itself rejects what it should
+    CHECK(json_valid("{\"a\":[1,-2.5e+3,true,null,\"x\\n\\u00e9\"]}"));
+    CHECK(!json_valid("{\"a\":1,}"));
+    CHECK(!json_valid("[1,2"));
+    CHECK(!json_valid("{\"a\":01}"));
+    CHECK(!json_valid("{\"a\":\"\x01\"}"));
+    CHECK(!json_valid("{\"a\":1}}"));
+    CHECK(!json_valid("{\"a\":nan}"));
+}
+
+int main(void)
+{
+    test_validator();
+    test_basic();
+    test_wrap();
+    test_tasks();
+    test_overrun_and_clear();
+
+    return host_test_result("test_event_trace");
+}
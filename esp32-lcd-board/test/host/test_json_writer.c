@@ -0,0 +1,345 @@
+// jw_* output is byte-identical to cJSON_PrintUnformatted() / cJSON_Print()
+// for the same document: the /api/status and /api/debug shapes, escaping,
+// number formatting edge cases, empty and nested containers, and documents
+// longer than the writer's buffer.
+
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cJSON.h"
+#include "json_writer.h"
+#include "host_test.h"
+
+// ============================================================================
+// Twin Builder
+// ============================================================================
+
+// One document built both ways: through jw_* into a host request, and as a
+// cJSON tree printed at the end
+typedef struct {
+    httpd_req_t req;
+    json_writer_t w;
+    cJSON *root;
+    cJSON *stack[JSON_WRITER_MAX_DEPTH];
+    int depth;
+} twin_t;
+
+static void twin_begin(twin_t *t, bool pretty)
+{
+    memset(t, 0, sizeof(*t));
+    host_req_init(&t->req, 1);
+    jw_begin(&t->w, &t->req, pretty);
+}
+
+static void twin_attach(twin_t *t, const char *key, cJSON *item)
+{
+    if (t->depth == 0) {
+        t->root = item;
+    } else if (cJSON_IsArray(t->stack[t->depth - 1])) {
+        cJSON_AddItemToArray(t->stack[t->depth - 1], item);
+    } else {
+        cJSON_AddItemToObject(t->stack[t->depth - 1], key ? key : "", item);
+    }
+}
+
+static void t_open(twin_t *t, const char *key, bool array)
+{
+    if (array) {
+        jw_array_begin(&t->w, key);
+    } else {
+        jw_object_begin(&t->w, key);
+    }
+    cJSON *item = array ? cJSON_CreateArray() : cJSON_CreateObject();
+    twin_attach(t, key, item);
+    t->stack[t->depth++] = item;
+}
+
+static void t_close(twin_t *t, bool array)
+{
+    if (array) {
+        jw_array_end(&t->w);
+    } else {
+        jw_object_end(&t->w);
+    }
+    t->depth--;
+}
+
+#define t_object(t, key)    t_open(t, key, false)
+#define t_object_end(t)     t_close(t, false)
+#define t_array(t, key)     t_open(t, key, true)
+#define t_array_end(t)      t_close(t, true)
+
+static void t_string(twin_t *t, const char *key, const char *value)
+{
+    jw_string(&t->w, key, value);
+    // As cJSON_AddStringToObject(): a NULL string adds nothing
+    if (value) twin_attach(t, key, cJSON_CreateString(value));
+}
+
+static void t_number(twin_t *t, const char *key, double value)
+{
+    jw_number(&t->w, key, value);
+    twin_attach(t, key, cJSON_CreateNumber(value));
+}
+
+static void t_bool(twin_t *t, const char *key, bool value)
+{
+    jw_bool(&t->w, key, value);
+    twin_attach(t, key, cJSON_CreateBool(value));
+}
+
+static void t_raw(twin_t *t, const char *key, const char *json)
+{
+    jw_raw(&t->w, key, json, strlen(json));
+    twin_attach(t, key, cJSON_CreateRaw(json));
+}
+
+// Finish both and compare the bytes
+static void twin_check(twin_t *t, const char *what)
+{
+    CHECK_INT(jw_finish(&t->w), ESP_OK);
+    CHECK(t->req.finished);
+
+    char *expected = t->w.pretty ? cJSON_Print(t->root) : cJSON_PrintUnformatted(t->root);
+    const char *got = t->req.body ? t->req.body : "";
+    if (!expected || strcmp(got, expected) != 0) {
+        fprintf(stderr, "%s (%s)\n  jw:    %s\n  cJSON: %s\n", what,
+                t->w.pretty ? "pretty" : "compact", got, expected ? expected : "(null)");
+        host_test_failures++;
+    }
+    cJSON_free(expected);
+    cJSON_Delete(t->root);
+    host_req_free(&t->req);
+}
+
+// ============================================================================
+// Documents
+// ============================================================================
+
+// GET /api/status
+static void doc_status(twin_t *t)
+{
+    t_object(t, NULL);
+    t_string(t, "board", "ESP32-C6-LCD-1.47");
+    t_string(t, "version", "1.0.0");
+    t_number(t, "uptime", 86523);
+    t_bool(t, "wifi_connected", true);
+    t_string(t, "ip", "192.168.1.42");
+    t_string(t, "ssid", "Home \"5G\"");
+    t_number(t, "rssi", -67);
+    t_number(t, "free_heap", 143212);
+    t_number(t, "view", 2);
+    t_number(t, "scene", 2);
+    t_number(t, "theme_color", 0x00A3E0);
+
+    t_object(t, "lan");
+    t_string(t, "role", "hub");
+    t_string(t, "state", "serving");
+    t_number(t, "followers", 3);
+    t_object_end(t);
+
+    t_object(t, "storage");
+    t_bool(t, "mounted", false);
+    t_string(t, "type", "sd");
+    t_object_end(t);
+
+    t_object(t, "settings");
+    t_number(t, "brightness", 80);
+    t_number(t, "default_scene", 0);
+    t_string(t, "destination", "Tallawong");
+    t_object_end(t);
+
+    // Shared with the /api/events "tfnsw" topic, inserted as formatted
+    t_raw(t, "tfnsw", "{\"has_api_key\":true,\"status\":\"OK\",\"station\":\"Victoria Cross\","
+                      "\"departures\":[{\"destination\":\"Tallawong\",\"mins\":\"Now\",\"realtime\":true},"
+                      "{\"destination\":\"Sydenham\",\"mins\":\"4 min\",\"realtime\":true},"
+                      "{\"destination\":\"Chatswood\",\"mins\":\"12 min\",\"realtime\":false}]}");
+
+    t_object_end(t);
+}
+
+// GET /api/debug (served pretty)
+static void doc_debug(twin_t *t)
+{
+    t_object(t, NULL);
+    t_number(t, "free_heap", 143212);
+    t_number(t, "min_free_heap", 98304);
+    t_number(t, "largest_free_block", 65536);
+
+    t_object(t, "tfnsw");
+    t_number(t, "last_response_size", 24817);
+    t_number(t, "heap_before_parse", 141000);
+    t_number(t, "heap_after_parse", 139500);
+    t_number(t, "parse_error_offset", -1);
+    t_string(t, "parse_error_context", "");
+    t_string(t, "response_start", "{\"version\":\"1.0\",\n\t\"stopEvents\":[");
+    t_string(t, "response_end", "}]}\r\n");
+    t_number(t, "fetch_count", 412);
+    t_number(t, "parse_success_count", 410);
+    t_number(t, "parse_fail_count", 2);
+    t_number(t, "buffer_size", 32768);
+    t_bool(t, "buffer_overflow", false);
+    t_string(t, "status", "Cached");
+    t_number(t, "northbound_count", 4);
+    t_number(t, "southbound_count", 0);
+    t_bool(t, "is_stale", true);
+    t_bool(t, "is_cached_fallback", true);
+    t_number(t, "data_age_seconds", 93);
+    t_string(t, "error_message", "HTTP 503");
+    t_object_end(t);
+
+    // Histogram rows as in /api/perf: arrays of arrays
+    t_array(t, "buckets");
+    for (int i = 0; i < 3; i++) {
+        t_array(t, NULL);
+        t_number(t, NULL, i == 2 ? -1 : 1000 << i);
+        t_number(t, NULL, 7 * i);
+        t_array_end(t);
+    }
+    t_array_end(t);
+
+    t_object_end(t);
+}
+
+// print_number() edge cases, inside an array and as object members
+static const double numbers[] = {
+    0.0, -0.0, 1, -1, 42, 1.5, -2.25, 0.1, 0.1 + 0.2, 1.0 / 3.0, 2.0 / 3.0,
+    1e-7, 123456789.123, 1e15 + 0.3, 2.5e15, 9007199254740993.0,
+    INT_MAX, (double)INT_MAX + 1, INT_MIN, (double)INT_MIN - 1, 3e9, -3e9,
+    4294967295.0, 1e21, 1e300, 5e-324, DBL_MIN, DBL_MAX, -DBL_MAX,
+    NAN, INFINITY, -INFINITY,
+};
+
+static void doc_numbers(twin_t *t)
+{
+    t_object(t, NULL);
+    t_array(t, "list");
+    for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++) {
+        t_number(t, NULL, numbers[i]);
+    }
+    t_array_end(t);
+    for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++) {
+        char key[8];
+        snprintf(key, sizeof(key), "n%zu", i);
+        t_number(t, key, numbers[i]);
+    }
+    t_object_end(t);
+}
+
+// Escapes, control characters, UTF-8, empty and NULL strings
+static void doc_strings(twin_t *t)
+{
+    t_object(t, NULL);
+    t_string(t, "plain", "Victoria Cross");
+    t_string(t, "empty", "");
+    t_string(t, "null", NULL);
+    t_string(t, "quotes", "say \"hi\" \\ bye");
+    t_string(t, "short", "\b\f\n\r\t");
+    t_string(t, "control", "\x01\x02\x1f\x7f");
+    t_string(t, "utf8", "Barangaroo \xe2\x86\x92 Crows Nest \xc2\xb7 caf\xc3\xa9");
+    t_string(t, "slash", "a/b");
+    t_string(t, "ke\"y\n", "escaped key");
+    t_object_end(t);
+}
+
+// Empty containers at every position, and the nesting limit
+static void doc_containers(twin_t *t)
+{
+    t_object(t, NULL);
+    t_object(t, "empty_object");
+    t_object_end(t);
+    t_array(t, "empty_array");
+    t_array_end(t);
+    t_array(t, "mixed");
+    t_object(t, NULL);
+    t_object_end(t);
+    t_array(t, NULL);
+    t_array_end(t);
+    t_object(t, NULL);
+    t_bool(t, "x", false);
+    t_object_end(t);
+    t_string(t, NULL, "s");
+    t_bool(t, NULL, true);
+    t_array_end(t);
+
+    // JSON_WRITER_MAX_DEPTH levels including the root
+    for (int d = 1; d < JSON_WRITER_MAX_DEPTH; d++) {
+        if (d % 2) {
+            t_object(t, "deep");
+        } else {
+            t_array(t, "deep");
+        }
+    }
+    t_number(t, "leaf", 1);
+    for (int d = JSON_WRITER_MAX_DEPTH - 1; d >= 1; d--) {
+        if (d % 2) {
+            t_object_end(t);
+        } else {
+            t_array_end(t);
+        }
+    }
+    t_object_end(t);
+}
+
+// Several times JSON_WRITER_BUF, so values straddle chunk boundaries
+static void doc_long(twin_t *t)
+{
+    char text[3 * JSON_WRITER_BUF];
+    for (size_t i = 0; i < sizeof(text) - 1; i++) {
+        text[i] = (i % 37 == 0) ? '\n' : (char)('a' + i % 26);
+    }
+    text[sizeof(text) - 1] = '\0';
+
+    t_array(t, NULL);
+    for (int i = 0; i < 20; i++) {
+        t_object(t, NULL);
+        t_number(t, "i", i * 1.25);
+        t_string(t, "text", text + i * 13);
+        t_object_end(t);
+    }
+    t_array_end(t);
+}
+
+// Root values that are not containers
+static void doc_scalar(twin_t *t)
+{
+    t_number(t, NULL, 0.1 + 0.2);
+}
+
+int main(void)
+{
+    static const struct {
+        const char *name;
+        void (*build)(twin_t *t);
+    } docs[] = {
+        { "status", doc_status },
+        { "debug", doc_debug },
+        { "numbers", doc_numbers },
+        { "strings", doc_strings },
+        { "containers", doc_containers },
+        { "long", doc_long },
+        { "scalar", doc_scalar },
+    };
+
+    static twin_t t;
+    for (size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+        for (int pretty = 0; pretty < 2; pretty++) {
+            twin_begin(&t, pretty);
+            docs[i].build(&t);
+            twin_check(&t, docs[i].name);
+        }
+    }
+
+    // Past the nesting limit the writer reports an error instead of output
+    twin_begin(&t, false);
+    for (int d = 0; d <= JSON_WRITER_MAX_DEPTH; d++) {
+        jw_array_begin(&t.w, NULL);
+    }
+    CHECK_INT(jw_finish(&t.w), ESP_ERR_INVALID_SIZE);
+    host_req_free(&t.req);
+
+    return host_test_result("test_json_writer");
+}
@@ -0,0 +1,608 @@
+// lan_proto: codec round trips, truncated and oversized frames, and a hub
+// and a follower wired back to back on a simulated clock: failover when the
+// hub goes silent, the hub taking over again when it returns, lease expiry,
+// and a snapshot for the previous stop arriving after a view switch.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lan_proto.h"
+#include "host_test.h"
+
+// ============================================================================
+// Fixtures
+// ============================================================================
+
+static void fill_str(char *dst, size_t size, char base, int salt)
+{
+    for (size_t i = 0; i + 1 < size; i++) {
+        dst[i] = (char)(base + (i + (size_t)salt) % 26);
+    }
+    dst[size - 1] = '\0';
+}
+
+// Every string at its longest, every field set: the worst-case snapshot
+static void fixture_full(tfnsw_departures_t *d)
+{
+    memset(d, 0, sizeof(*d));
+    d->count = TFNSW_MAX_DEPARTURES;
+    d->status = TFNSW_STATUS_SUCCESS;
+    d->last_fetch_time = 1760000000123LL;
+    d->service_suspended = true;
+    fill_str(d->station_name, sizeof(d->station_name), 'A', 0);
+    fill_str(d->suspension_message, sizeof(d->suspension_message), 'a', 1);
+    for (int i = 0; i < d->count; i++) {
+        tfnsw_departure_t *x = &d->departures[i];
+        fill_str(x->destination, sizeof(x->destination), 'a', i);
+        fill_str(x->platform, sizeof(x->platform), 'A', i);
+        fill_str(x->line_name, sizeof(x->line_name), 'a', i + 3);
+        fill_str(x->calling_stations, sizeof(x->calling_stations), 'A', i + 5);
+        x->scheduled_time = 1760000000LL + i * 180;
+        x->estimated_time = x->scheduled_time + (i % 3) * 60;
+        x->mins_to_departure = i * 3 - 1;
+        x->delay_seconds = (i % 2 ? -1 : 1) * i * 45;
+        x->direction = (tfnsw_direction_t)(i % 3);
+        x->is_realtime = i % 2;
+        x->is_cancelled = i == 5;
+        x->is_delayed = i % 3 == 1;
+        x->occupancy_available = i > 2;
+        x->occupancy_percent = (uint8_t)(i * 12);
+        x->alert_severity = (tfnsw_alert_severity_t)(i % 4);
+        if (x->alert_severity != TFNSW_ALERT_NONE) {
+            fill_str(x->alert_message, sizeof(x->alert_message), 'a', i + 7);
+        }
+    }
+}
+
+static void fixture_small(tfnsw_departures_t *d, const char *station, int first_mins)
+{
+    memset(d, 0, sizeof(*d));
+    d->count = 2;
+    d->status = TFNSW_STATUS_SUCCESS;
+    strcpy(d->station_name, station);
+    for (int i = 0; i < d->count; i++) {
+        strcpy(d->departures[i].destination, i ? "Sydenham" : "Tallawong");
+        d->departures[i].mins_to_departure = first_mins + i * 4;
+        d->departures[i].is_realtime = true;
+    }
+}
+
+// What the snapshot carries, field by field
+static bool same_snapshot(const tfnsw_departures_t *a, const tfnsw_departures_t *b)
+{
+    if (a->count != b->count || a->status != b->status ||
+        a->last_fetch_time != b->last_fetch_time ||
+        a->service_suspended != b->service_suspended ||
+        strcmp(a->station_name, b->station_name) != 0 ||
+        strcmp(a->suspension_message, b->suspension_message) != 0) {
+        return false;
+    }
+    for (int i = 0; i < a->count; i++) {
+        const tfnsw_departure_t *x = &a->departures[i];
+        const tfnsw_departure_t *y = &b->departures[i];
+        if (strcmp(x->destination, y->destination) || strcmp(x->platform, y->platform) ||
+            strcmp(x->line_name, y->line_name) ||
+            strcmp(x->calling_stations, y->calling_stations) ||
+            x->scheduled_time != y->scheduled_time || x->estimated_time != y->estimated_time ||
+            x->mins_to_departure != y->mins_to_departure ||
+            x->delay_seconds != y->delay_seconds || x->direction != y->direction ||
+            x->is_realtime != y->is_realtime || x->is_cancelled != y->is_cancelled ||
+            x->is_delayed != y->is_delayed || x->occupancy_available != y->occupancy_available ||
+            x->occupancy_percent != y->occupancy_percent ||
+            x->alert_severity != y->alert_severity ||
+            strcmp(x->alert_message, y->alert_message)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Codec
+// ============================================================================
+
+static uint8_t frame[LAN_FRAME_MAX];
+static tfnsw_departures_t deps_a, deps_b, decoded;
+
+static void test_codec(void)
+{
+    char stop[16];
+    uint32_t version = 0, node = 0;
+
+    // HELLO, SUBSCRIBE, PING
+    size_t n = lan_encode_hello(frame, sizeof(frame), 0xA1B2C3D4u);
+    CHECK_INT(n, 2 + 1 + 9);
+    CHECK_INT(frame[0] | frame[1] << 8, n - 2);
+    CHECK_INT(frame[2], LAN_MSG_HELLO);
+    CHECK(lan_decode_hello(frame + 3, n - 3, &node));
+    CHECK_INT(node, 0xA1B2C3D4u);
+
+    n = lan_encode_subscribe(frame, sizeof(frame), "2060270", 77);
+    CHECK(n > 0 && n <= LAN_SMALL_FRAME_MAX);
+    CHECK(lan_decode_subscribe(frame + 3, n - 3, stop, sizeof(stop), &version));
+    CHECK_STR(stop, "2060270");
+    CHECK_INT(version, 77);
+
+    n = lan_encode_ping(frame, sizeof(frame));
+    CHECK_INT(n, 3);
+    CHECK_INT(frame[2], LAN_MSG_PING);
+
+    // The worst-case snapshot fits a frame and survives the trip
+    fixture_full(&deps_a);
+    n = lan_encode_snapshot(frame, sizeof(frame), "2155384", 0xFFFFFFF0u, &deps_a);
+    CHECK(n > 0 && n <= LAN_FRAME_MAX);
+    CHECK(lan_decode_snapshot(frame + 3, n - 3, stop, sizeof(stop), &version, &decoded));
+    CHECK_STR(stop, "2155384");
+    CHECK_INT(version, 0xFFFFFFF0u);
+    CHECK(same_snapshot(&deps_a, &decoded));
+
+    // Re-encoding what was decoded gives the same bytes
+    static uint8_t again[LAN_FRAME_MAX];
+    CHECK_INT(lan_encode_snapshot(again, sizeof(again), stop, version, &decoded), n);
+    CHECK(memcmp(frame, again, n) == 0);
+
+    // Fields only sent when they apply: the message of an unsuspended
+    // service and the text of an alert with no severity are left out
+    deps_a.service_suspended = false;
+    deps_a.departures[0].alert_severity = TFNSW_ALERT_NONE;
+    strcpy(deps_a.departures[0].alert_message, "stale");
+    n = lan_encode_snapshot(frame, sizeof(frame), "2155384", 1, &deps_a);
+    CHECK(lan_decode_snapshot(frame + 3, n - 3, stop, sizeof(stop), &version, &decoded));
+    CHECK_STR(decoded.suspension_message, "");
+    CHECK_STR(decoded.departures[0].alert_message, "");
+
+    // An encoder given too little room writes nothing usable
+    CHECK_INT(lan_encode_snapshot(frame, 100, "2155384", 1, &deps_a), 0);
+    CHECK_INT(lan_encode_hello(frame, 11, 1), 0);
+
+    // Bad magic or protocol version
+    n = lan_encode_hello(frame, sizeof(frame), 5);
+    frame[3] ^= 0xFF;
+    CHECK(!lan_decode_hello(frame + 3, n - 3, NULL));
+    n = lan_encode_hello(frame, sizeof(frame), 5);
+    frame[7] = LAN_PROTO_VERSION + 1;
+    CHECK(!lan_decode_hello(frame + 3, n - 3, NULL));
+}
+
+static void test_truncated(void)
+{
+    char stop[16];
+    uint32_t version;
+
+    // Every cut of a snapshot payload is rejected, as is a trailing byte
+    fixture_full(&deps_a);
+    size_t n = lan_encode_snapshot(frame, sizeof(frame), "2155384", 9, &deps_a);
+    int accepted = 0;
+    for (size_t cut = 0; cut < n - 3; cut++) {
+        if (lan_decode_snapshot(frame + 3, cut, stop, sizeof(stop), &version, &decoded)) {
+            accepted++;
+        }
+    }
+    CHECK_INT(accepted, 0);
+    CHECK(!lan_decode_snapshot(frame + 3, n - 3 + 1, stop, sizeof(stop), &version, &decoded));
+
+    // More departures than the struct holds
+    fixture_small(&deps_b, "Crows Nest", 1);
+    n = lan_encode_snapshot(frame, sizeof(frame), "X", 1, &deps_b);
+    size_t count_at = 3 + 2 + 4 + 8 + 1 + 1 + 1 + strlen("Crows Nest") + 1;
+    CHECK_INT(frame[count_at], 2);
+    frame[count_at] = TFNSW_MAX_DEPARTURES + 1;
+    CHECK(!lan_decode_snapshot(frame + 3, n - 3, stop, sizeof(stop), &version, &decoded));
+
+    size_t cut_hello = lan_encode_hello(frame, sizeof(frame), 1) - 3 - 1;
+    CHECK(!lan_decode_hello(frame + 3, cut_hello, NULL));
+    n = lan_encode_subscribe(frame, sizeof(frame), "2060270", 3);
+    CHECK(!lan_decode_subscribe(frame + 3, n - 3 - 1, stop, sizeof(stop), &version));
+    CHECK(!lan_decode_subscribe(frame + 3, 4, stop, sizeof(stop), &version));
+}
+
+static void test_reassembly(void)
+{
+    static uint8_t stream[2 * LAN_FRAME_MAX];
+    static uint8_t rx_buf[LAN_FRAME_MAX];
+    lan_rx_t rx;
+    uint8_t type;
+    const uint8_t *payload;
+    size_t len;
+
+    // HELLO, SNAPSHOT, PING back to back, fed one byte at a time
+    fixture_full(&deps_a);
+    size_t total = lan_encode_hello(stream, sizeof(stream), 42);
+    total += lan_encode_snapshot(stream + total, sizeof(stream) - total, "2155384", 3, &deps_a);
+    total += lan_encode_ping(stream + total, sizeof(stream) - total);
+
+    lan_rx_init(&rx, rx_buf, sizeof(rx_buf));
+    uint8_t types[4] = { 0 };
+    int frames = 0;
+    for (size_t i = 0; i < total; i++) {
+        rx.buf[rx.len++] = stream[i];
+        int ret;
+        while ((ret = lan_rx_next(&rx, &type, &payload, &len)) == 1) {
+            if (frames < 4) types[frames] = type;
+            frames++;
+            if (type == LAN_MSG_SNAPSHOT) {
+                char stop[16];
+                uint32_t version;
+                CHECK(lan_decode_snapshot(payload, len, stop, sizeof(stop), &version, &decoded));
+                CHECK(same_snapshot(&deps_a, &decoded));
+            }
+        }
+        CHECK_INT(ret, 0);
+    }
+    CHECK_INT(frames, 3);
+    CHECK(types[0] == LAN_MSG_HELLO && types[1] == LAN_MSG_SNAPSHOT && types[2] == LAN_MSG_PING);
+    CHECK_INT(rx.len - rx.consumed, 0);
+
+    // A length over the buffer is refused before any payload arrives
+    lan_rx_init(&rx, rx_buf, sizeof(rx_buf));
+    rx.buf[0] = (uint8_t)(LAN_FRAME_MAX & 0xFF);
+    rx.buf[1] = (uint8_t)(LAN_FRAME_MAX >> 8);
+    rx.len = 2;
+    CHECK_INT(lan_rx_next(&rx, &type, &payload, &len), -1);
+
+    // So is a zero-length frame (no type byte)
+    lan_rx_init(&rx, rx_buf, sizeof(rx_buf));
+    rx.buf[0] = 0;
+    rx.buf[1] = 0;
+    rx.len = 2;
+    CHECK_INT(lan_rx_next(&rx, &type, &payload, &len), -1);
+
+    // The largest frame the buffer holds is still accepted
+    lan_rx_init(&rx, rx_buf, sizeof(rx_buf));
+    size_t body = sizeof(rx_buf) - 2;
+    rx.buf[0] = (uint8_t)(body & 0xFF);
+    rx.buf[1] = (uint8_t)(body >> 8);
+    rx.buf[2] = 0x7F;               // Unknown type
+    rx.len = sizeof(rx_buf);
+    CHECK_INT(lan_rx_next(&rx, &type, &payload, &len), 1);
+    CHECK_INT(len, body - 1);
+}
+
+// ============================================================================
+// Two Nodes
+// ============================================================================
+
+// One TCP connection: bytes written at one end come out at the other
+typedef struct {
+    uint8_t buf[4 * LAN_FRAME_MAX];
+    size_t len;
+} pipe_t;
+
+typedef struct {
+    // Hub side: what it has fetched, and its view of the follower
+    bool up;                        // Hub running and answering
+    const char *stops[2];
+    uint32_t versions[2];
+    const tfnsw_departures_t *deps[2];
+    lan_hub_peer_t peer;
+    lan_rx_t rx;
+    uint8_t rx_buf[LAN_FRAME_MAX];
+    int watches;
+
+    // Follower side
+    lan_follower_t f;
+    lan_rx_t frx;
+    uint8_t frx_buf[LAN_FRAME_MAX];
+    tfnsw_departures_t out;
+    int delivered;
+    char delivered_stop[16];
+    int fallback_starts;
+    int fallback_stops;
+    uint32_t fallback_since;
+
+    // The link
+    bool linked;
+    pipe_t to_hub;
+    pipe_t to_follower;
+    uint32_t now;
+} net_t;
+
+static net_t net;
+
+static void pipe_write(pipe_t *p, const uint8_t *data, size_t n)
+{
+    CHECK(n > 0 && p->len + n <= sizeof(p->buf));
+    if (n == 0 || p->len + n > sizeof(p->buf)) return;
+    memcpy(p->buf + p->len, data, n);
+    p->len += n;
+}
+
+// Move what is in the pipe into a receiver (the whole lot; TCP may split it
+// anywhere, which test_reassembly covers)
+static void pipe_drain(pipe_t *p, lan_rx_t *rx)
+{
+    size_t room = rx->cap - rx->len;
+    size_t n = p->len < room ? p->len : room;
+    memcpy(rx->buf + rx->len, p->buf, n);
+    rx->len += n;
+    memmove(p->buf, p->buf + n, p->len - n);
+    p->len -= n;
+}
+
+static void link_down(void)
+{
+    net.linked = false;
+    net.to_hub.len = 0;
+    net.to_follower.len = 0;
+}
+
+static int hub_stop_index(const char *stop_id)
+{
+    for (int i = 0; i < 2; i++) {
+        if (strcmp(net.stops[i], stop_id) == 0) return i;
+    }
+    return -1;
+}
+
+static void hub_send_snapshot(const char *stop_id)
+{
+    int i = hub_stop_index(stop_id);
+    if (i < 0) return;
+    size_t n = lan_encode_snapshot(frame, sizeof(frame), stop_id, net.versions[i], net.deps[i]);
+    pipe_write(&net.to_follower, frame, n);
+}
+
+// The hub's accept path: init the peer and greet
+static void hub_accept(void)
+{
+    lan_hub_peer_init(&net.peer, net.now);
+    lan_rx_init(&net.rx, net.rx_buf, sizeof(net.rx_buf));
+    size_t n = lan_encode_hello(frame, sizeof(frame), 0x4855);
+    pipe_write(&net.to_follower, frame, n);
+}
+
+static void hub_step(void)
+{
+    if (!net.up || !net.linked) return;
+
+    uint8_t type;
+    const uint8_t *payload;
+    size_t len;
+    pipe_drain(&net.to_hub, &net.rx);
+    while (lan_rx_next(&net.rx, &type, &payload, &len) == 1) {
+        uint32_t act = lan_hub_peer_on_frame(&net.peer, type, payload, len, net.now);
+        if (act & LAN_ACT_DISCONNECT) {
+            link_down();
+            return;
+        }
+        if (act & LAN_ACT_WATCH) net.watches++;
+    }
+
+    int i = net.peer.stop_id[0] ? hub_stop_index(net.peer.stop_id) : -1;
+    uint32_t version = i >= 0 ? net.versions[i] : 0;
+    uint32_t act = lan_hub_peer_tick(&net.peer, version, net.now);
+    if (act & LAN_ACT_DISCONNECT) {
+        link_down();
+    } else if (act & LAN_ACT_SEND_SNAPSHOT) {
+        hub_send_snapshot(net.peer.stop_id);
+        lan_hub_peer_sent(&net.peer, version, net.now);
+    } else if (act & LAN_ACT_SEND_PING) {
+        pipe_write(&net.to_follower, frame, lan_encode_ping(frame, sizeof(frame)));
+        lan_hub_peer_sent(&net.peer, 0, net.now);
+    }
+}
+
+// lan_sync's follower_apply()
+static void follower_apply(uint32_t act)
+{
+    if (act & LAN_ACT_DELIVER) {
+        net.delivered++;
+        strcpy(net.delivered_stop, net.f.stop_id);
+    }
+    if (act & LAN_ACT_DISCONNECT) {
+        link_down();
+        lan_follower_disconnected(&net.f, net.now);
+        return;
+    }
+    if ((act & LAN_ACT_SEND_HELLO) && net.linked) {
+        pipe_write(&net.to_hub, frame, lan_encode_hello(frame, sizeof(frame), 0x464F));
+    }
+    if ((act & LAN_ACT_SEND_SUBSCRIBE) && net.linked) {
+        size_t n = lan_encode_subscribe(frame, sizeof(frame), net.f.stop_id, net.f.have_version);
+        pipe_write(&net.to_hub, frame, n);
+    }
+    if (act & LAN_ACT_START_FALLBACK) {
+        net.fallback_starts++;
+        net.fallback_since = net.now;
+    }
+    if (act & LAN_ACT_STOP_FALLBACK) {
+        net.fallback_stops++;
+    }
+    if ((act & LAN_ACT_DISCOVER) && !net.linked && net.up) {
+        net.linked = true;
+        lan_rx_init(&net.frx, net.frx_buf, sizeof(net.frx_buf));
+        hub_accept();
+        follower_apply(lan_follower_connected(&net.f, net.now));
+    }
+}
+
+static void follower_step(void)
+{
+    if (net.linked && net.up) {
+        uint8_t type;
+        const uint8_t *payload;
+        size_t len;
+        pipe_drain(&net.to_follower, &net.frx);
+        while (net.linked && lan_rx_next(&net.frx, &type, &payload, &len) == 1) {
+            follower_apply(lan_follower_on_frame(&net.f, type, payload, len, net.now, &net.out));
+        }
+    }
+    follower_apply(lan_follower_tick(&net.f, net.now));
+}
+
+#define STEP_MS 100
+
+// Run both nodes until the clock reaches until_ms
+static void run_until(uint32_t until_ms)
+{
+    while ((int32_t)(until_ms - net.now) > 0) {
+        net.now += STEP_MS;
+        hub_step();
+        follower_step();
+    }
+}
+
+static void net_init(uint32_t start_ms)
+{
+    memset(&net, 0, sizeof(net));
+    net.now = start_ms;
+    net.up = true;
+    fixture_small(&deps_a, "Victoria Cross", 2);
+    fixture_small(&deps_b, "Crows Nest", 5);
+    net.stops[0] = "2060270";
+    net.stops[1] = "2065163";
+    net.versions[0] = 10;
+    net.versions[1] = 20;
+    net.deps[0] = &deps_a;
+    net.deps[1] = &deps_b;
+    lan_follower_init(&net.f, net.now);
+    follower_apply(lan_follower_set_stop(&net.f, "2060270", net.now));
+}
+
+static void test_follow_and_failover(uint32_t start_ms)
+{
+    net_init(start_ms);
+    uint32_t t0 = net.now;
+
+    // Discovered on the first tick; the snapshot arrives right after
+    run_until(t0 + 1000);
+    CHECK_INT(net.f.state, LAN_FOLLOWER_FOLLOWING);
+    CHECK_INT(net.f.hub_id, 0x4855);
+    CHECK_INT(net.delivered, 1);
+    CHECK_STR(net.delivered_stop, "2060270");
+    CHECK_INT(net.f.have_version, 10);
+    CHECK(same_snapshot(&net.out, &deps_a));
+    CHECK(net.watches >= 1);
+
+    // A new version goes out once; an unchanged one never again
+    net.versions[0] = 11;
+    deps_a.departures[0].mins_to_departure = 1;
+    run_until(t0 + 2000);
+    CHECK_INT(net.delivered, 2);
+    CHECK_INT(net.f.have_version, 11);
+    CHECK_INT(net.out.departures[0].mins_to_departure, 1);
+
+    // Pings and subscription renewals keep both sides up for a long time
+    run_until(t0 + 120000);
+    CHECK_INT(net.delivered, 2);
+    CHECK(net.linked);
+    CHECK_INT(net.f.state, LAN_FOLLOWER_FOLLOWING);
+    CHECK_INT(net.fallback_starts, 0);
+
+    // The hub goes silent: the follower gives up after LAN_HUB_TIMEOUT_MS
+    // and fetches for itself LAN_FAILOVER_MS later, not before
+    net.up = false;
+    uint32_t silent = net.now;
+    uint32_t last_rx = net.f.last_rx_ms;
+    run_until(last_rx + LAN_HUB_TIMEOUT_MS - STEP_MS);
+    CHECK(net.linked);
+    run_until(last_rx + LAN_HUB_TIMEOUT_MS);
+    CHECK(!net.linked);
+    CHECK_INT(net.f.state, LAN_FOLLOWER_SEARCHING);
+    uint32_t lost = net.now;
+    CHECK(lost - silent <= LAN_HUB_TIMEOUT_MS);
+
+    run_until(lost + LAN_FAILOVER_MS - STEP_MS);
+    CHECK_INT(net.fallback_starts, 0);
+    run_until(lost + LAN_FAILOVER_MS);
+    CHECK_INT(net.fallback_starts, 1);
+    CHECK_INT(net.fallback_since, lost + LAN_FAILOVER_MS);
+    CHECK(net.f.fallback);
+
+    // Still no hub: fallback is started once, discovery keeps retrying
+    run_until(lost + 60000);
+    CHECK_INT(net.fallback_starts, 1);
+    CHECK(!net.linked);
+
+    // The hub returns: picked up on the next discovery, fallback stops and
+    // the snapshot we hold is not resent
+    net.up = true;
+    uint32_t back = net.now;
+    run_until(back + LAN_DISCOVER_MS + 1000);
+    CHECK(net.linked);
+    CHECK_INT(net.f.state, LAN_FOLLOWER_FOLLOWING);
+    CHECK_INT(net.fallback_stops, 1);
+    CHECK(!net.f.fallback);
+    CHECK_INT(net.delivered, 2);
+
+    // And a change after that is delivered again
+    net.versions[0] = 12;
+    run_until(net.now + 1000);
+    CHECK_INT(net.delivered, 3);
+    CHECK_INT(net.f.have_version, 12);
+}
+
+static void test_stale_snapshot(void)
+{
+    net_init(5000);
+    run_until(net.now + 1000);
+    CHECK_INT(net.delivered, 1);
+
+    // The hub has just sent a new snapshot for the old stop when the
+    // follower switches to another stop
+    net.versions[0] = 15;
+    hub_step();
+    CHECK(net.to_follower.len > 0);
+    follower_apply(lan_follower_set_stop(&net.f, "2065163", net.now));
+    CHECK_INT(net.f.have_version, 0);
+
+    // The old stop's snapshot is skipped, the new stop's delivered
+    net.now += STEP_MS;
+    follower_step();
+    CHECK_INT(net.delivered, 1);
+    CHECK_INT(net.f.have_version, 0);
+
+    run_until(net.now + 1000);
+    CHECK_INT(net.delivered, 2);
+    CHECK_STR(net.delivered_stop, "2065163");
+    CHECK_INT(net.f.have_version, 20);
+    CHECK(same_snapshot(&net.out, &deps_b));
+    CHECK_STR(net.peer.stop_id, "2065163");
+}
+
+static void test_hub_peer(void)
+{
+    lan_hub_peer_t p;
+
+    // SUBSCRIBE before HELLO drops the connection
+    lan_hub_peer_init(&p, 0);
+    size_t n = lan_encode_subscribe(frame, sizeof(frame), "2060270", 0);
+    CHECK_INT(lan_hub_peer_on_frame(&p, frame[2], frame + 3, n - 3, 10), LAN_ACT_DISCONNECT);
+
+    // So does a HELLO that does not decode
+    lan_hub_peer_init(&p, 0);
+    n = lan_encode_hello(frame, sizeof(frame), 1);
+    CHECK_INT(lan_hub_peer_on_frame(&p, frame[2], frame + 3, n - 4, 10), LAN_ACT_DISCONNECT);
+
+    // A follower that stops renewing loses its lease after LAN_LEASE_MS
+    lan_hub_peer_init(&p, 1000);
+    n = lan_encode_hello(frame, sizeof(frame), 1);
+    CHECK_INT(lan_hub_peer_on_frame(&p, frame[2], frame + 3, n - 3, 1000), 0);
+    n = lan_encode_subscribe(frame, sizeof(frame), "2060270", 4);
+    CHECK_INT(lan_hub_peer_on_frame(&p, frame[2], frame + 3, n - 3, 2000), LAN_ACT_WATCH);
+    lan_hub_peer_sent(&p, 0, 2000 + LAN_LEASE_MS - 1);
+    CHECK_INT(lan_hub_peer_tick(&p, 4, 2000 + LAN_LEASE_MS - 1), 0);
+    CHECK_INT(lan_hub_peer_tick(&p, 4, 2000 + LAN_LEASE_MS), LAN_ACT_DISCONNECT);
+
+    // Unknown frame types are ignored on both sides
+    lan_hub_peer_init(&p, 0);
+    n = lan_encode_hello(frame, sizeof(frame), 1);
+    lan_hub_peer_on_frame(&p, frame[2], frame + 3, n - 3, 0);
+    CHECK_INT(lan_hub_peer_on_frame(&p, 0x7F, NULL, 0, 0), 0);
+    lan_follower_t f;
+    lan_follower_init(&f, 0);
+    CHECK_INT(lan_follower_on_frame(&f, 0x7F, NULL, 0, 0, &decoded), 0);
+}
+
+int main(void)
+{
+    test_codec();
+    test_truncated();
+    test_reassembly();
+    test_follow_and_failover(1000);
+    // Again across the 32-bit millisecond wrap
+    test_follow_and_failover(UINT32_MAX - 90000);
+    test_stale_snapshot();
+    test_hub_peer();
+    return host_test_result("test_lan_proto");
+}
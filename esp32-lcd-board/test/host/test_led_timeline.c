@@ -0,0 +1,207 @@
+// led_timeline_compose: departures land on the LED for their slot of the
+// window (and nowhere outside it), two in one slot mix with saturation,
+// only due departures pulse and only then are LED_TIMELINE_FRAMES frames
+// composed, and pixels come out in GRB order through gamma and the
+// brightness level. Composition needs no hardware, so no strip is faked.
+
+#include <math.h>
+#include <string.h>
+
+#include "led_timeline.h"
+#include "host_test.h"
+
+#define NOW         1700000000LL
+#define SLOT_S      (LED_TIMELINE_WINDOW_S / LED_STRIP_LEN)
+
+static uint8_t frames[LED_TIMELINE_FRAMES][LED_TIMELINE_FRAME_BYTES];
+
+// Intensity -> output byte, as the header describes it
+static uint8_t out_ref(int v, int brightness)
+{
+    if (v > 255) v = 255;
+    if (brightness > 100) brightness = 100;
+    float scale = LED_TIMELINE_MAX_OUT * brightness / 100.0f;
+    return (uint8_t)(powf(v / 255.0f, LED_TIMELINE_GAMMA) * scale + 0.5f);
+}
+
+// Pulse envelope for frame f, 256 = full
+static int pulse_ref(int f)
+{
+    float phase = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * f / LED_TIMELINE_FRAMES);
+    return (int)(256.0f * (0.3f + 0.7f * phase));
+}
+
+static int compose(const led_timeline_entry_t *entries, int count, uint8_t brightness)
+{
+    memset(frames, 0xAA, sizeof(frames));
+    return led_timeline_compose(entries, count, NOW, brightness, frames);
+}
+
+// Check one LED of a frame against intensities r, g, b
+static void check_led(int f, int led, int r, int g, int b, int brightness)
+{
+    const uint8_t *px = &frames[f][led * 3];
+    CHECK_INT(px[0], out_ref(g, brightness));
+    CHECK_INT(px[1], out_ref(r, brightness));
+    CHECK_INT(px[2], out_ref(b, brightness));
+}
+
+static int lit_leds(int f)
+{
+    int lit = 0;
+    for (int led = 0; led < LED_STRIP_LEN; led++) {
+        const uint8_t *px = &frames[f][led * 3];
+        if (px[0] || px[1] || px[2]) lit++;
+    }
+    return lit;
+}
+
+// ============================================================================
+// Slot Mapping
+// ============================================================================
+
+static void test_slots(void)
+{
+    // Northbound: { 0, 160, 255 }; none of these is due
+    static const struct { int64_t dt; int led; } cases[] = {
+        { LED_TIMELINE_DUE_S, LED_TIMELINE_DUE_S / SLOT_S },
+        { SLOT_S * 2 - 1, 1 },
+        { SLOT_S * 2, 2 },
+        { SLOT_S * 7 + 30, 7 },
+        { LED_TIMELINE_WINDOW_S - SLOT_S, LED_STRIP_LEN - 1 },
+        { LED_TIMELINE_WINDOW_S - 1, LED_STRIP_LEN - 1 },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        led_timeline_entry_t e = { NOW + cases[i].dt, TFNSW_DIRECTION_NORTHBOUND };
+        CHECK_INT(compose(&e, 1, 100), 1);
+        CHECK_INT(lit_leds(0), 1);
+        check_led(0, cases[i].led, 0, 160, 255, 100);
+    }
+
+    // Slot 0 starts now (and is due)
+    led_timeline_entry_t first = { NOW, TFNSW_DIRECTION_NORTHBOUND };
+    compose(&first, 1, 100);
+    CHECK_INT(lit_leds(LED_TIMELINE_FRAMES / 2), 1);
+    check_led(LED_TIMELINE_FRAMES / 2, 0, 0, 160, 255, 100);
+
+    // Gone, or past the end of the window: nothing lit, nothing pulses
+    led_timeline_entry_t outside[] = {
+        { NOW - 1, TFNSW_DIRECTION_NORTHBOUND },
+        { NOW - 600, TFNSW_DIRECTION_SOUTHBOUND },
+        { NOW + LED_TIMELINE_WINDOW_S, TFNSW_DIRECTION_NORTHBOUND },
+        { NOW + LED_TIMELINE_WINDOW_S * 3, TFNSW_DIRECTION_UNKNOWN },
+    };
+    CHECK_INT(compose(outside, 4, 100), 1);
+    CHECK_INT(lit_leds(0), 0);
+
+    // No departures at all
+    CHECK_INT(compose(NULL, 0, 100), 1);
+    CHECK_INT(lit_leds(0), 0);
+}
+
+static void test_mixing(void)
+{
+    // North { 0, 160, 255 } + south { 255, 64, 160 } in slot 3: blue saturates
+    led_timeline_entry_t pair[] = {
+        { NOW + SLOT_S * 3 + 5, TFNSW_DIRECTION_NORTHBOUND },
+        { NOW + SLOT_S * 4 - 5, TFNSW_DIRECTION_SOUTHBOUND },
+        { NOW + SLOT_S * 9, TFNSW_DIRECTION_SOUTHBOUND },
+    };
+    CHECK_INT(compose(pair, 3, 100), 1);
+    CHECK_INT(lit_leds(0), 2);
+    check_led(0, 3, 255, 224, 255, 100);
+    check_led(0, 9, 255, 64, 160, 100);
+
+    // Two unknowns { 200, 200, 200 } saturate every channel
+    led_timeline_entry_t grey[] = {
+        { NOW + SLOT_S * 5, TFNSW_DIRECTION_UNKNOWN },
+        { NOW + SLOT_S * 5 + 1, TFNSW_DIRECTION_UNKNOWN },
+    };
+    compose(grey, 2, 100);
+    check_led(0, 5, 255, 255, 255, 100);
+
+    // A direction outside the table draws as unknown
+    led_timeline_entry_t odd = { NOW + SLOT_S * 6, (tfnsw_direction_t)7 };
+    compose(&odd, 1, 100);
+    check_led(0, 6, 200, 200, 200, 100);
+}
+
+// ============================================================================
+// Pulse
+// ============================================================================
+
+static void test_pulse(void)
+{
+    // Due (slot 1 at 90 s) next to one that is not (slot 4)
+    led_timeline_entry_t entries[] = {
+        { NOW + 90, TFNSW_DIRECTION_SOUTHBOUND },
+        { NOW + SLOT_S * 4, TFNSW_DIRECTION_NORTHBOUND },
+    };
+    CHECK_INT(compose(entries, 2, 100), LED_TIMELINE_FRAMES);
+    for (int f = 0; f < LED_TIMELINE_FRAMES; f++) {
+        int k = pulse_ref(f);
+        check_led(f, 1, (255 * k) >> 8, (64 * k) >> 8, (160 * k) >> 8, 100);
+        check_led(f, 4, 0, 160, 255, 100);      // Steady
+        CHECK_INT(lit_leds(f), 2);
+    }
+
+    // The envelope runs 30% -> 100% -> back
+    check_led(0, 1, (255 * 76) >> 8, (64 * 76) >> 8, (160 * 76) >> 8, 100);
+    check_led(LED_TIMELINE_FRAMES / 2, 1, 255, 64, 160, 100);
+    CHECK(frames[0][1 * 3 + 1] < frames[LED_TIMELINE_FRAMES / 4][1 * 3 + 1]);
+    CHECK(frames[LED_TIMELINE_FRAMES / 4][1 * 3 + 1] < frames[LED_TIMELINE_FRAMES / 2][1 * 3 + 1]);
+
+    // Due up to LED_TIMELINE_DUE_S, not at it
+    led_timeline_entry_t edge = { NOW + LED_TIMELINE_DUE_S - 1, TFNSW_DIRECTION_UNKNOWN };
+    CHECK_INT(compose(&edge, 1, 100), LED_TIMELINE_FRAMES);
+    edge.when = NOW + LED_TIMELINE_DUE_S;
+    CHECK_INT(compose(&edge, 1, 100), 1);
+
+    // A single static frame leaves the rest of the buffer alone
+    CHECK_INT(frames[1][0], 0xAA);
+    CHECK_INT(frames[LED_TIMELINE_FRAMES - 1][LED_TIMELINE_FRAME_BYTES - 1], 0xAA);
+}
+
+// ============================================================================
+// Brightness
+// ============================================================================
+
+static void test_brightness(void)
+{
+    // South { 255, 64, 160 } in GRB order: byte 0 is green
+    led_timeline_entry_t e = { NOW + SLOT_S * 2, TFNSW_DIRECTION_SOUTHBOUND };
+    const uint8_t *px = &frames[0][2 * 3];
+
+    compose(&e, 1, 100);
+    CHECK_INT(px[1], LED_TIMELINE_MAX_OUT);     // Full red is full scale
+    CHECK(px[0] > 0 && px[0] < px[2] && px[2] < px[1]);
+    check_led(0, 2, 255, 64, 160, 100);
+
+    compose(&e, 1, 50);
+    CHECK_INT(px[1], LED_TIMELINE_MAX_OUT / 2);
+    check_led(0, 2, 255, 64, 160, 50);
+
+    compose(&e, 1, 10);
+    check_led(0, 2, 255, 64, 160, 10);
+
+    // Off, and clamped above 100%
+    compose(&e, 1, 0);
+    CHECK_INT(lit_leds(0), 0);
+    compose(&e, 1, 250);
+    CHECK_INT(px[1], LED_TIMELINE_MAX_OUT);
+    check_led(0, 2, 255, 64, 160, 100);
+
+    // Back to a level used before (the LUT is rebuilt on change)
+    compose(&e, 1, 50);
+    CHECK_INT(px[1], LED_TIMELINE_MAX_OUT / 2);
+}
+
+int main(void)
+{
+    test_slots();
+    test_mixing();
+    test_pulse();
+    test_brightness();
+
+    return host_test_result("test_led_timeline");
+}
@@ -0,0 +1,299 @@
+// log_ring: deferred formatting of every argument kind, the line prefix,
+// reader cursors (caught up, overrun by writers, log_ring_clear), tag
+// interning, the chunked /api/logs export, and writers on several threads
+// racing a reader. The esp_timer clock is fake; the writers are real threads.
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_clock.h"
+#include "log_ring.h"
+#include "host_test.h"
+
+// Read one line, "" when caught up
+static const char *next_line(uint32_t *cursor)
+{
+    static char line[LOG_RING_LINE_MAX];
+    if (log_ring_read(cursor, line, sizeof(line)) == 0) line[0] = '\0';
+    return line;
+}
+
+// The message part of the next line (after "<seq> <time> <level> <tag>: ")
+static const char *next_message(uint32_t *cursor)
+{
+    const char *line = next_line(cursor);
+    const char *msg = strstr(line, ": ");
+    return msg ? msg + 2 : line;
+}
+
+// ============================================================================
+// Format
+// ============================================================================
+
+static void test_format(void)
+{
+    uint32_t cursor = log_ring_head();
+
+    host_clock_set_us(12345678);
+    log_ring_write(LOG_RING_INFO, "fmt", "plain");
+    char expected[64];
+    snprintf(expected, sizeof(expected), "%lu 12.345 I fmt: plain\n", (unsigned long)cursor);
+    CHECK_STR(next_line(&cursor), expected);
+    CHECK_STR(next_line(&cursor), "");
+
+    log_ring_write(LOG_RING_ERROR, "fmt", "%d %u %x %c %%", -42, 7u, 0xBEEFu, 'z');
+    CHECK_STR(next_message(&cursor), "-42 7 beef z %\n");
+
+    log_ring_write(LOG_RING_WARN, "fmt", "[%5d|%-4s|%08x]", 12, "ab", 0x1234u);
+    CHECK_STR(next_message(&cursor), "[   12|ab  |00001234]\n");
+
+    log_ring_write(LOG_RING_DEBUG, "fmt", "%lld %llu", -5000000000LL, 0xFFFFFFFF00000001ULL);
+    CHECK_STR(next_message(&cursor), "-5000000000 18446744069414584321\n");
+
+    log_ring_write(LOG_RING_INFO, "fmt", "%.2f %s", 3.14159, "pi");
+    CHECK_STR(next_message(&cursor), "3.14 pi\n");
+
+    const char *volatile none = NULL;
+    log_ring_write(LOG_RING_INFO, "fmt", "%s", none);
+    CHECK_STR(next_message(&cursor), "(null)\n");
+
+    // Four words: the arguments that do not fit print as "?"
+    log_ring_write(LOG_RING_INFO, "fmt", "%d %d %d %d %d", 1, 2, 3, 4, 5);
+    CHECK_STR(next_message(&cursor), "1 2 3 4 ?\n");
+    log_ring_write(LOG_RING_INFO, "fmt", "%d %.1f %d %d", 1, 2.5, 3, 4);
+    CHECK_STR(next_message(&cursor), "1 2.5 3 ?\n");
+
+    // '*' widths end the scan; the rest is copied as text
+    log_ring_write(LOG_RING_INFO, "fmt", "%d %*d", 9, 3, 4);
+    CHECK_STR(next_message(&cursor), "9 %*d\n");
+
+    // Level characters and an unknown tag
+    log_ring_write(LOG_RING_WARN, NULL, "no tag");
+    const char *line = next_line(&cursor);
+    CHECK(strstr(line, " W ?: no tag\n") != NULL);
+}
+
+static void test_long_line(void)
+{
+    static char long_msg[400];
+    memset(long_msg, 'x', sizeof(long_msg) - 1);
+
+    uint32_t cursor = log_ring_head();
+    log_ring_write(LOG_RING_INFO, "long", "%s", long_msg);
+
+    char line[LOG_RING_LINE_MAX];
+    size_t n = log_ring_read(&cursor, line, sizeof(line));
+    CHECK_INT(n, LOG_RING_LINE_MAX - 1);
+    CHECK_INT(strlen(line), n);
+    CHECK(line[n - 1] == '\n');
+    CHECK(line[n - 2] == 'x');
+
+    // Too small a buffer reads nothing and leaves the cursor alone
+    uint32_t before = cursor - 1;
+    uint32_t small = before;
+    CHECK_INT(log_ring_read(&small, line, 16), 0);
+    CHECK_INT(small, before);
+}
+
+// ============================================================================
+// Cursors
+// ============================================================================
+
+static void test_overrun(void)
+{
+    uint32_t cursor = log_ring_head();
+
+    // A reader that falls more than a ring behind gets one marker, then the
+    // oldest record still held
+    for (int i = 0; i < LOG_RING_SIZE + 10; i++) {
+        log_ring_write(LOG_RING_INFO, "ovr", "line %d", i);
+    }
+    CHECK_INT(log_ring_head() - log_ring_oldest(), LOG_RING_SIZE);
+    CHECK_STR(next_line(&cursor), "--- 10 lines dropped ---\n");
+    CHECK_STR(next_message(&cursor), "line 10\n");
+
+    // Then every record in order up to the head
+    int seen = 1;
+    const char *msg;
+    while (*(msg = next_message(&cursor))) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "line %d\n", 10 + seen);
+        CHECK_STR(msg, expected);
+        seen++;
+    }
+    CHECK_INT(seen, LOG_RING_SIZE);
+    CHECK_INT(cursor, log_ring_head());
+
+    // A cursor from before the first record starts at the oldest one
+    uint32_t from_zero = 0;
+    CHECK(strstr(next_line(&from_zero), "lines dropped") != NULL);
+    CHECK_INT(from_zero, log_ring_oldest());
+}
+
+static void test_clear(void)
+{
+    log_ring_write(LOG_RING_INFO, "clr", "before");
+    uint32_t cursor = log_ring_head() - 1;
+
+    log_ring_clear();
+    CHECK_INT(log_ring_oldest(), log_ring_head());
+    CHECK_STR(next_line(&cursor), "--- 1 lines dropped ---\n");
+    CHECK_STR(next_line(&cursor), "");
+
+    log_ring_write(LOG_RING_INFO, "clr", "after");
+    CHECK_STR(next_message(&cursor), "after\n");
+    CHECK_STR(next_line(&cursor), "");
+}
+
+// ============================================================================
+// Tags
+// ============================================================================
+
+static void test_tags(void)
+{
+    // Same name from another pointer shares the slot
+    static char copy[] = "fmt";
+    uint32_t cursor = log_ring_head();
+    log_ring_write(LOG_RING_INFO, copy, "copied tag");
+    CHECK(strstr(next_line(&cursor), " I fmt: copied tag\n") != NULL);
+
+    // Once every slot is taken, new tags print as "?"
+    static const char *const names[] = {
+        "t00", "t01", "t02", "t03", "t04", "t05", "t06", "t07", "t08", "t09",
+        "t10", "t11", "t12", "t13", "t14", "t15", "t16", "t17", "t18", "t19",
+        "t20", "t21", "t22", "t23", "t24", "t25", "t26", "t27", "t28", "t29",
+        "t30", "t31",
+    };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        log_ring_write(LOG_RING_INFO, names[i], "tag");
+    }
+    log_ring_write(LOG_RING_INFO, "late", "overflow");
+    cursor = log_ring_head() - 1;
+    CHECK(strstr(next_line(&cursor), " I ?: overflow\n") != NULL);
+
+    // Tags interned earlier still resolve
+    log_ring_write(LOG_RING_INFO, "fmt", "still");
+    CHECK(strstr(next_line(&cursor), " I fmt: still\n") != NULL);
+}
+
+// ============================================================================
+// HTTP Export
+// ============================================================================
+
+static void test_export(void)
+{
+    log_ring_clear();
+    uint32_t first = log_ring_head();
+    for (int i = 0; i < 100; i++) {
+        log_ring_write(LOG_RING_INFO, "exp", "export line %03d", i);
+    }
+
+    // The body is the lines log_ring_read returns, sent in ~1 KB chunks
+    static char expected[100 * LOG_RING_LINE_MAX];
+    size_t expected_len = 0;
+    uint32_t cursor = first;
+    size_t n;
+    while ((n = log_ring_read(&cursor, expected + expected_len, LOG_RING_LINE_MAX)) > 0) {
+        expected_len += n;
+    }
+
+    httpd_req_t req;
+    host_req_init(&req, 1);
+    CHECK_INT(log_ring_export(&req, first), ESP_OK);
+    CHECK_STR(req.type, "text/plain; charset=utf-8");
+    CHECK(req.finished);
+    CHECK_INT(req.body_len, expected_len);
+    CHECK(req.body && memcmp(req.body, expected, expected_len) == 0);
+    CHECK(req.chunks > (int)(expected_len / 1024));
+    host_req_free(&req);
+
+    // since = 0 after a clear: the marker, then the same lines
+    host_req_init(&req, 1);
+    CHECK_INT(log_ring_export(&req, 0), ESP_OK);
+    CHECK(req.body && strncmp(req.body, "--- ", 4) == 0);
+    CHECK(req.body && strstr(req.body, "exp: export line 000\n") != NULL);
+    host_req_free(&req);
+
+    // since = head: an empty, finished response
+    host_req_init(&req, 1);
+    CHECK_INT(log_ring_export(&req, log_ring_head()), ESP_OK);
+    CHECK(req.finished);
+    CHECK_INT(req.body_len, 0);
+    host_req_free(&req);
+}
+
+// ============================================================================
+// Concurrent Writers
+// ============================================================================
+
+#define WRITERS         4
+#define WRITER_LINES    20000
+
+static void *writer(void *arg)
+{
+    int id = (int)(intptr_t)arg;
+    for (int i = 0; i < WRITER_LINES; i++) {
+        log_ring_write(LOG_RING_DEBUG, "race", "writer %d line %d", id, i);
+    }
+    return NULL;
+}
+
+static void test_concurrent(void)
+{
+    log_ring_clear();
+    uint32_t cursor = log_ring_head();
+    uint32_t end = cursor + WRITERS * WRITER_LINES;
+
+    pthread_t threads[WRITERS];
+    for (int i = 0; i < WRITERS; i++) {
+        pthread_create(&threads[i], NULL, writer, (void *)(intptr_t)i);
+    }
+
+    // Every line read is whole and in order: sequence numbers increase and
+    // each writer's lines come in the order it wrote them
+    int last_line[WRITERS];
+    for (int i = 0; i < WRITERS; i++) last_line[i] = -1;
+    int lines = 0, markers = 0, bad = 0;
+    uint32_t last_seq = cursor - 1;
+
+    while ((int32_t)(end - cursor) > 0) {
+        char line[LOG_RING_LINE_MAX];
+        if (log_ring_read(&cursor, line, sizeof(line)) == 0) continue;
+
+        unsigned long seq, dropped;
+        int id, n;
+        if (sscanf(line, "--- %lu lines dropped ---", &dropped) == 1) {
+            markers++;
+            continue;
+        }
+        if (sscanf(line, "%lu %*u.%*u D race: writer %d line %d", &seq, &id, &n) != 3 ||
+            id < 0 || id >= WRITERS || n <= last_line[id] ||
+            (int32_t)((uint32_t)seq - last_seq) <= 0) {
+            if (bad++ < 5) fprintf(stderr, "bad line: %s", line);
+            continue;
+        }
+        last_line[id] = n;
+        last_seq = (uint32_t)seq;
+        lines++;
+    }
+    for (int i = 0; i < WRITERS; i++) pthread_join(threads[i], NULL);
+
+    CHECK_INT(bad, 0);
+    CHECK(lines > 0);
+    printf("concurrent: %d lines read, %d drop markers\n", lines, markers);
+}
+
+int main(void)
+{
+    test_format();
+    test_long_line();
+    test_overrun();
+    test_clear();
+    test_export();
+    test_concurrent();
+    test_tags();        // Last: fills the tag table
+
+    return host_test_result("test_log_ring");
+}
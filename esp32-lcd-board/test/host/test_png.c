@@ -0,0 +1,47 @@
+// The golden image writer and reader agree, and the reader refuses files
+// it did not write whole.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "png.h"
+
+int main(void)
+{
+    const int w = 37, h = 1200;     // Several stored deflate blocks
+    uint8_t* rgb = malloc(w * h * 3);
+    for (int i = 0; i < w * h * 3; i++) rgb[i] = (uint8_t)(i * 7 + i / 11);
+
+    const char* path = "test_png.png";
+    CHECK(png_write(path, rgb, w, h));
+
+    uint8_t* back = NULL;
+    int bw = 0, bh = 0;
+    CHECK(png_read(path, &back, &bw, &bh));
+    CHECK_INT(bw, w);
+    CHECK_INT(bh, h);
+    CHECK(back && memcmp(back, rgb, w * h * 3) == 0);
+    free(back);
+
+    // Truncated: the IDAT chunk runs past the end
+    FILE* f = fopen(path, "rb");
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* file = malloc(size);
+    CHECK(fread(file, 1, size, f) == (size_t)size);
+    fclose(f);
+    f = fopen(path, "wb");
+    fwrite(file, 1, size / 2, f);
+    fclose(f);
+    back = NULL;
+    CHECK(!png_read(path, &back, &bw, &bh));
+    CHECK(back == NULL);
+
+    free(file);
+    free(rgb);
+    remove(path);
+    return host_test_result("png");
+}
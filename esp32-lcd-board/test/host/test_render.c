@@ -0,0 +1,256 @@
+// Renders every view from fixture departures through the real view code
+// (lcd_driver.c built with LCD_HEADLESS), compares each frame with
+// golden/<case>.png and reports render time, object count and LVGL heap.
+//
+// UPDATE_GOLDEN=1 rewrites the goldens from this run. A case without a
+// golden writes its candidate to the build directory and fails: an
+// unrecorded case would otherwise guard nothing.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lvgl.h"
+#include "config.h"
+#include "lcd_driver.h"
+#include "host_clock.h"
+#include "host_test.h"
+#include "png.h"
+
+#define FIXTURE_WALL    1767225600      // 2026-01-01 00:00 UTC, 11:00 AEDT
+#define BENCH_RUNS      20
+
+typedef struct {
+    const char* name;
+    view_id_t view;
+    bool has_data;
+    tfnsw_departures_t data;
+} render_case_t;
+
+static void add_departure(tfnsw_departures_t* d, const char* dest, const char* calling,
+                          int mins, int delay_s, tfnsw_direction_t dir, bool realtime)
+{
+    tfnsw_departure_t* dep = &d->departures[d->count++];
+    memset(dep, 0, sizeof(*dep));
+    snprintf(dep->destination, sizeof(dep->destination), "%s", dest);
+    snprintf(dep->calling_stations, sizeof(dep->calling_stations), "%s", calling);
+    snprintf(dep->platform, sizeof(dep->platform), "%d", dir == TFNSW_DIRECTION_SOUTHBOUND ? 1 : 2);
+    snprintf(dep->line_name, sizeof(dep->line_name), "Metro North West & Bankstown");
+    // Half a minute past the whole minute, so the countdown is not on an edge
+    dep->scheduled_time = FIXTURE_WALL + mins * 60 + 30 - delay_s;
+    dep->estimated_time = realtime ? FIXTURE_WALL + mins * 60 + 30 : 0;
+    dep->mins_to_departure = mins;
+    dep->delay_seconds = delay_s;
+    dep->direction = dir;
+    dep->is_realtime = realtime;
+    dep->is_delayed = delay_s >= 120;
+}
+
+static void fixture(tfnsw_departures_t* d, const char* station)
+{
+    memset(d, 0, sizeof(*d));
+    snprintf(d->station_name, sizeof(d->station_name), "%s", station);
+    d->status = TFNSW_STATUS_SUCCESS;
+    d->last_fetch_time = FIXTURE_WALL - 12;
+    d->data_age_seconds = 12;
+}
+
+static int build_cases(render_case_t* cases)
+{
+    int n = 0;
+    render_case_t* c;
+
+    c = &cases[n++];
+    c->name = "metro_north";
+    c->view = VIEW_METRO_NORTH;
+    c->has_data = true;
+    fixture(&c->data, "Victoria Cross Station");
+    add_departure(&c->data, "Tallawong", "Crows Nest, St Leonards, Artarmon, Chatswood, Macquarie Park",
+                  1, 0, TFNSW_DIRECTION_NORTHBOUND, true);
+    add_departure(&c->data, "Tallawong", "Crows Nest, Chatswood", 5, 180, TFNSW_DIRECTION_NORTHBOUND, true);
+    add_departure(&c->data, "Tallawong", "", 11, 0, TFNSW_DIRECTION_NORTHBOUND, false);
+    add_departure(&c->data, "Tallawong", "", 19, 0, TFNSW_DIRECTION_NORTHBOUND, true);
+
+    c = &cases[n++];
+    c->name = "metro_south";
+    c->view = VIEW_METRO_SOUTH;
+    c->has_data = true;
+    fixture(&c->data, "Crows Nest Station");
+    add_departure(&c->data, "Sydenham", "Victoria Cross, Barangaroo, Martin Place, Gadigal, Central",
+                  0, 0, TFNSW_DIRECTION_SOUTHBOUND, true);
+    add_departure(&c->data, "Sydenham", "", 4, 0, TFNSW_DIRECTION_SOUTHBOUND, true);
+    add_departure(&c->data, "Sydenham", "", 10, 60, TFNSW_DIRECTION_SOUTHBOUND, true);
+
+    c = &cases[n++];
+    c->name = "metro_south_cached";
+    c->view = VIEW_METRO_SOUTH;
+    c->has_data = true;
+    fixture(&c->data, "Crows Nest Station");
+    c->data.status = TFNSW_STATUS_SUCCESS_CACHED;
+    c->data.is_stale = true;
+    c->data.is_cached_fallback = true;
+    c->data.data_age_seconds = 400;
+    add_departure(&c->data, "Sydenham", "", 3, 0, TFNSW_DIRECTION_SOUTHBOUND, false);
+
+    c = &cases[n++];
+    c->name = "train_artarmon";
+    c->view = VIEW_TRAIN_ARTARMON;
+    c->has_data = true;
+    fixture(&c->data, "Artarmon Station");
+    add_departure(&c->data, "Hornsby via Gordon", "Chatswood, Roseville, Lindfield, Killara, Gordon",
+                  2, 0, TFNSW_DIRECTION_NORTHBOUND, true);
+    add_departure(&c->data, "Central", "St Leonards, Wollstonecraft, Waverton, North Sydney",
+                  6, 240, TFNSW_DIRECTION_SOUTHBOUND, true);
+    add_departure(&c->data, "Berowra", "", 14, 0, TFNSW_DIRECTION_NORTHBOUND, false);
+
+    c = &cases[n++];
+    c->name = "high_speed";
+    c->view = VIEW_HIGH_SPEED;
+
+    c = &cases[n++];
+    c->name = "status_info";
+    c->view = VIEW_STATUS_INFO;
+
+    return n;
+}
+
+static uint32_t count_objects(lv_obj_t* obj)
+{
+    uint32_t n = 1;
+    uint32_t children = lv_obj_get_child_cnt(obj);
+    for (uint32_t i = 0; i < children; i++) {
+        n += count_objects(lv_obj_get_child(obj, i));
+    }
+    return n;
+}
+
+static int64_t mono_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int cmp_i64(const void* a, const void* b)
+{
+    int64_t x = *(const int64_t*)a, y = *(const int64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// The framebuffer as RGB888
+static uint8_t* grab_frame(void)
+{
+    const lv_color_t* fb = lcd_get_framebuffer();
+    uint8_t* rgb = malloc(LCD_WIDTH * LCD_HEIGHT * 3);
+    for (int i = 0; i < LCD_WIDTH * LCD_HEIGHT; i++) {
+        uint32_t c = lv_color_to32(fb[i]);
+        rgb[i * 3 + 0] = (c >> 16) & 0xff;
+        rgb[i * 3 + 1] = (c >> 8) & 0xff;
+        rgb[i * 3 + 2] = c & 0xff;
+    }
+    return rgb;
+}
+
+// 1 = matches, 0 = differs, -1 = no golden
+static int compare_golden(const char* name, const uint8_t* rgb, bool update)
+{
+    char golden[512], out[512];
+    snprintf(golden, sizeof(golden), "%s/%s.png", HOST_GOLDEN_DIR, name);
+    snprintf(out, sizeof(out), "%s/%s.png", HOST_OUT_DIR, name);
+    png_write(out, rgb, LCD_WIDTH, LCD_HEIGHT);
+
+    if (update) {
+        CHECK(png_write(golden, rgb, LCD_WIDTH, LCD_HEIGHT));
+        return 1;
+    }
+
+    uint8_t* expected;
+    int w, h;
+    if (!png_read(golden, &expected, &w, &h)) {
+        fprintf(stderr, "%s: no golden at %s (candidate: %s)\n", name, golden, out);
+        return -1;
+    }
+    int differ = 0;
+    if (w != LCD_WIDTH || h != LCD_HEIGHT) {
+        differ = LCD_WIDTH * LCD_HEIGHT;
+    } else {
+        for (int i = 0; i < LCD_WIDTH * LCD_HEIGHT; i++) {
+            if (memcmp(&rgb[i * 3], &expected[i * 3], 3) != 0) differ++;
+        }
+    }
+    free(expected);
+    if (differ) {
+        fprintf(stderr, "%s: %d pixels differ from %s (actual: %s)\n", name, differ, golden, out);
+        return 0;
+    }
+    return 1;
+}
+
+int main(void)
+{
+    static render_case_t cases[8];
+    bool update = getenv("UPDATE_GOLDEN") != NULL;
+
+    setenv("TZ", "AEST-10AEDT,M10.1.0,M4.1.0/3", 1);
+    tzset();
+    host_clock_set_wall(FIXTURE_WALL);
+    host_clock_set_us(1000000);
+
+    CHECK_INT(lcd_init(), ESP_OK);
+    lcd_set_ip("192.168.1.50");
+    lcd_set_wifi_ssid("depot-wifi");
+    lcd_set_wifi_rssi(-58);
+    lcd_set_uptime(3725);
+
+    int n = build_cases(cases);
+    int missing = 0;
+    lv_mem_monitor_t mon;
+
+    printf("%-20s %10s %10s %8s %10s %10s\n",
+           "case", "build_us", "draw_us", "objects", "heap_used", "heap_peak");
+    for (int i = 0; i < n; i++) {
+        render_case_t* c = &cases[i];
+        if (c->has_data) {
+            lcd_update_view_data(c->view, &c->data);
+        } else {
+            lcd_clear_view_data(c->view);
+        }
+        lcd_set_view(c->view);
+        lcd_update();
+        lv_refr_now(NULL);
+
+        uint8_t* rgb = grab_frame();
+        int match = compare_golden(c->name, rgb, update);
+        free(rgb);
+        if (match < 0) missing++;
+        CHECK(match > 0);
+
+        // Rebuild and redraw the same frame; the clock stands still, so
+        // each run does the same work
+        int64_t build_us[BENCH_RUNS], draw_us[BENCH_RUNS];
+        for (int r = 0; r < BENCH_RUNS; r++) {
+            int64_t t0 = mono_us();
+            lcd_render_current_view();
+            int64_t t1 = mono_us();
+            lv_obj_invalidate(lv_scr_act());
+            lv_refr_now(NULL);
+            build_us[r] = t1 - t0;
+            draw_us[r] = mono_us() - t1;
+        }
+        qsort(build_us, BENCH_RUNS, sizeof(build_us[0]), cmp_i64);
+        qsort(draw_us, BENCH_RUNS, sizeof(draw_us[0]), cmp_i64);
+
+        lv_mem_monitor(&mon);
+        printf("%-20s %10lld %10lld %8u %10u %10u\n", c->name,
+               (long long)build_us[BENCH_RUNS / 2], (long long)draw_us[BENCH_RUNS / 2],
+               (unsigned)count_objects(lv_scr_act()),
+               (unsigned)(mon.total_size - mon.free_size), (unsigned)mon.max_used);
+    }
+
+    if (missing) {
+        fprintf(stderr, "render: %d case(s) without a golden; run with UPDATE_GOLDEN=1 to record them\n",
+                missing);
+    }
+    return host_test_result("render");
+}
@@ -0,0 +1,311 @@
+// settings write-behind against a fake NVS: a burst of changes is one
+// commit after the quiet period, a steady stream is committed at the
+// max delay, commits run on the writer task (not the esp_timer callback),
+// per-key settings migrate to the blob, a restart flushes what is
+// pending, and a reset is not undone by a commit already in flight. The esp_timer clock is fake; the writer task is a real thread.
+
+#include <stdarg.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "esp_system.h"
+#include "host_clock.h"
+#include "nvs.h"
+#include "settings.h"
+#include "sd_card.h"
+#include "log_ring.h"
+#include "host_test.h"
+
+// settings.c's log functions feed these
+esp_err_t sd_log_start(void) { return ESP_OK; }
+size_t sd_log_size(void) { return 0; }
+esp_err_t sd_log_clear(void) { return ESP_OK; }
+void log_ring_vwrite(log_ring_level_t level, const char *tag, const char *fmt, va_list args) {}
+void log_ring_clear(void) {}
+
+#define QUIET_MS    2000        // SETTINGS_COMMIT_QUIET_MS
+#define MAX_MS      10000       // SETTINGS_COMMIT_MAX_MS
+
+// On-flash layout (settings_blob_t, v1)
+typedef struct __attribute__((packed)) {
+    uint16_t version;
+    uint16_t size;
+    uint32_t theme_color;
+    uint8_t brightness;
+    uint8_t default_scene;
+    uint8_t lan_role;
+    uint8_t power_save;
+    uint8_t night_sleep;
+} blob_v1_t;
+
+static void advance_ms(int ms)
+{
+    host_clock_advance_us((int64_t)ms * 1000);
+}
+
+// The writer task runs in real time: wait for it to reach n commits
+static bool wait_commits(int n)
+{
+    for (int ms = 0; ms < 2000; ms += 2) {
+        if (host_nvs_commits() >= n) return host_nvs_commits() == n;
+        usleep(2000);
+    }
+    return false;
+}
+
+// Long enough for a woken writer to have committed, had it been woken
+static int settled_commits(void)
+{
+    usleep(30000);
+    return host_nvs_commits();
+}
+
+static bool read_blob(blob_v1_t *blob)
+{
+    nvs_handle_t h;
+    if (nvs_open("settings", NVS_READONLY, &h) != ESP_OK) return false;
+    size_t len = sizeof(*blob);
+    esp_err_t err = nvs_get_blob(h, "blob", blob, &len);
+    nvs_close(h);
+    return err == ESP_OK && len == sizeof(*blob);
+}
+
+static void write_raw(const char *key, const void *data, size_t len)
+{
+    nvs_handle_t h;
+    CHECK_INT(nvs_open("settings", NVS_READWRITE, &h), ESP_OK);
+    CHECK_INT(nvs_set_blob(h, key, data, len), ESP_OK);
+    nvs_close(h);
+}
+
+static void test_coalescing(void)
+{
+    int base = host_nvs_commits();
+
+    // Ten slider steps 100 ms apart
+    for (int i = 0; i < 10; i++) {
+        settings_set_brightness((uint8_t)(30 + i));
+        advance_ms(100);
+    }
+    CHECK_INT(settings_get()->brightness, 39);
+
+    // Quiet period counts from the last change
+    advance_ms(QUIET_MS - 100 - 100);
+    CHECK_INT(settled_commits(), base);
+    advance_ms(100);
+    CHECK(wait_commits(base + 1));
+    CHECK_STR(host_nvs_last_commit_task(), "settings");
+
+    blob_v1_t blob;
+    CHECK(read_blob(&blob));
+    CHECK_INT(blob.version, 1);
+    CHECK_INT(blob.size, sizeof(blob_v1_t));
+    CHECK_INT(blob.brightness, 39);
+
+    // Nothing more to write
+    advance_ms(30000);
+    CHECK_INT(settled_commits(), base + 1);
+}
+
+static void test_max_delay(void)
+{
+    int base = host_nvs_commits();
+
+    // A change every 500 ms never goes quiet: committed MAX_MS after the first
+    settings_set_theme_color(0x000001);
+    for (int t = 500; t < MAX_MS; t += 500) {
+        advance_ms(500);
+        settings_set_theme_color((uint32_t)t);
+    }
+    CHECK_INT(settled_commits(), base);
+    advance_ms(500);
+    CHECK(wait_commits(base + 1));
+    blob_v1_t blob;
+    CHECK(read_blob(&blob));
+    CHECK_INT(blob.theme_color, MAX_MS - 500);
+
+    // Changes after that start a new window, committed once they stop
+    for (int t = 0; t < 5000; t += 500) {
+        advance_ms(500);
+        settings_set_theme_color(0x100000u + (uint32_t)t);
+    }
+    advance_ms(QUIET_MS - 100);
+    CHECK_INT(settled_commits(), base + 1);
+    advance_ms(100);
+    CHECK(wait_commits(base + 2));
+    CHECK(read_blob(&blob));
+    CHECK_INT(blob.theme_color, 0x100000u + 4500);
+}
+
+static void test_shutdown_flush(void)
+{
+    int base = host_nvs_commits();
+
+    // Changed just before esp_restart(): committed by the shutdown handler
+    settings_set_default_scene(4);
+    settings_set_night_sleep(true);
+    host_run_shutdown_handlers();
+    CHECK_INT(host_nvs_commits(), base + 1);
+    blob_v1_t blob;
+    CHECK(read_blob(&blob));
+    CHECK_INT(blob.default_scene, 4);
+    CHECK_INT(blob.night_sleep, 1);
+
+    // The pending timer was stopped with it
+    advance_ms(MAX_MS * 2);
+    CHECK_INT(settled_commits(), base + 1);
+
+    // With nothing pending a restart writes nothing
+    host_run_shutdown_handlers();
+    CHECK_INT(host_nvs_commits(), base + 1);
+}
+
+static void test_failed_write(void)
+{
+    int base = host_nvs_commits();
+
+    // A failed commit keeps the change pending for the next flush
+    host_nvs_fail_writes(true);
+    settings_set_power_save(true);
+    advance_ms(QUIET_MS);
+    CHECK_INT(settled_commits(), base);
+    CHECK(settings_flush() != ESP_OK);
+
+    host_nvs_fail_writes(false);
+    CHECK_INT(settings_flush(), ESP_OK);
+    CHECK_INT(host_nvs_commits(), base + 1);
+    blob_v1_t blob;
+    CHECK(read_blob(&blob));
+    CHECK_INT(blob.power_save, 1);
+}
+
+static void test_migration(void)
+{
+    // NVS as left by firmware from before the blob
+    host_nvs_reset();
+    nvs_handle_t h;
+    CHECK_INT(nvs_open("settings", NVS_READWRITE, &h), ESP_OK);
+    nvs_set_u32(h, "theme_color", 0x00A3E0);
+    nvs_set_u8(h, "brightness", 55);
+    nvs_set_u8(h, "default_scene", 1);
+    nvs_set_u8(h, "lan_role", 2);
+    nvs_close(h);
+
+    settings_init();
+    CHECK(settings_is_loaded());
+    CHECK_INT(settings_get()->theme_color, 0x00A3E0);
+    CHECK_INT(settings_get()->brightness, 55);
+    CHECK_INT(settings_get()->default_scene, 1);
+    CHECK_INT(settings_get()->lan_role, 2);
+    CHECK(!settings_get()->power_save);
+
+    // Rewritten as one blob after the quiet period, old keys gone
+    CHECK_INT(settled_commits(), 0);
+    advance_ms(QUIET_MS);
+    CHECK(wait_commits(1));
+    CHECK_INT(host_nvs_key_count("settings"), 1);
+    blob_v1_t blob;
+    CHECK(read_blob(&blob));
+    CHECK_INT(blob.theme_color, 0x00A3E0);
+    CHECK_INT(blob.lan_role, 2);
+
+    // Next boot reads the blob and has nothing to write
+    settings_init();
+    CHECK(settings_is_loaded());
+    CHECK_INT(settings_get()->brightness, 55);
+    advance_ms(MAX_MS);
+    CHECK_INT(settled_commits(), 1);
+}
+
+static void test_blob_versions(void)
+{
+    blob_v1_t blob = {
+        .version = 1, .size = sizeof(blob_v1_t), .theme_color = 0x123456,
+        .brightness = 70, .default_scene = 2, .lan_role = 1, .power_save = 1, .night_sleep = 1,
+    };
+
+    // Older firmware's shorter blob: later fields keep their defaults
+    host_nvs_reset();
+    write_raw("blob", &blob, offsetof(blob_v1_t, power_save));
+    settings_init();
+    CHECK(settings_is_loaded());
+    CHECK_INT(settings_get()->brightness, 70);
+    CHECK_INT(settings_get()->lan_role, 1);
+    CHECK(!settings_get()->power_save);
+    CHECK(!settings_get()->night_sleep);
+
+    // Newer firmware's longer blob: known fields read, the rest ignored
+    uint8_t longer[sizeof(blob_v1_t) + 6];
+    memset(longer, 0xAA, sizeof(longer));
+    memcpy(longer, &blob, sizeof(blob));
+    host_nvs_reset();
+    write_raw("blob", longer, sizeof(longer));
+    settings_init();
+    CHECK(settings_is_loaded());
+    CHECK_INT(settings_get()->theme_color, 0x123456);
+    CHECK(settings_get()->power_save && settings_get()->night_sleep);
+
+    // Another layout version: defaults, and the blob is left alone
+    blob.version = 2;
+    host_nvs_reset();
+    write_raw("blob", &blob, sizeof(blob));
+    settings_init();
+    CHECK(!settings_is_loaded());
+    CHECK_INT(settings_get()->brightness, 20);
+    advance_ms(MAX_MS);
+    CHECK_INT(settled_commits(), 0);
+}
+
+static void *reset_thread(void *arg)
+{
+    settings_reset();
+    return NULL;
+}
+
+static void test_reset_race(void)
+{
+    int base = host_nvs_commits();
+
+    // The writer is parked in nvs_set_blob with the old settings in hand
+    host_nvs_hold_writes(true);
+    settings_set_brightness(55);
+    advance_ms(QUIET_MS);
+    for (int ms = 0; ms < 2000 && host_nvs_held_writes() == 0; ms += 2) {
+        usleep(2000);
+    }
+    CHECK_INT(host_nvs_held_writes(), 1);
+
+    // The reset waits for that commit, then erases what it wrote
+    pthread_t thread;
+    CHECK_INT(pthread_create(&thread, NULL, reset_thread, NULL), 0);
+    usleep(30000);
+    host_nvs_hold_writes(false);
+    pthread_join(thread, NULL);
+    CHECK(wait_commits(base + 2));
+
+    CHECK_INT(host_nvs_key_count("settings"), 0);
+    CHECK_INT(settings_get()->brightness, 20);
+    advance_ms(MAX_MS);
+    CHECK_INT(host_nvs_key_count("settings"), 0);
+}
+
+int main(void)
+{
+    host_nvs_reset();
+    settings_init();
+    CHECK(!settings_is_loaded());
+    CHECK_INT(settings_get()->brightness, 20);
+    CHECK_INT(host_nvs_commits(), 0);
+
+    test_coalescing();
+    test_max_delay();
+    test_shutdown_flush();
+    test_failed_write();
+    test_migration();
+    test_blob_versions();
+    test_reset_race();
+
+    return host_test_result("test_settings");
+}
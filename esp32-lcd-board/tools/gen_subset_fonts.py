@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+"""
+Generate subset Montserrat fonts for the departure board.
+
+Scans the firmware sources for every lv_font_montserrat_N the UI references
+(plus LV_FONT_DEFAULT), every string literal (view registry, station list, UI
+text) and every LV_SYMBOL_* used, then runs lv_font_conv once per size with
+just those glyphs. Output goes to src/fonts/lv_font_montserrat_N.c and keeps
+LVGL's built-in symbol names. src/fonts/lv_font_subset.h gets the matching
+LV_FONT_CUSTOM_DECLARE list from the same scan; lv_conf.h includes it when
+LCD_USE_SUBSET_FONTS is set, so lcd_driver.c is unchanged.
+
+src/CMakeLists.txt runs this as a build step whenever LCD_USE_SUBSET_FONTS is
+1 in lv_conf.h. The size list is read at configure time (--list-sizes); if a
+build finds a different set, sizes.txt changes and the next build
+reconfigures.
+
+Printable ASCII is always kept: destinations and station names arrive from
+the TfNSW API at runtime and the /api/display "text" command draws free text.
+
+Usage:
+    python3 tools/gen_subset_fonts.py [--bpp 2] [--font-dir DIR] [--out-dir DIR]
+                                      [--list-sizes] [--dry-run]
+
+Requires lv_font_conv (npm i -g lv_font_conv, or run through npx).
+"""
+
+import argparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SCAN_DIRS = [os.path.join(ROOT, "src"), os.path.join(ROOT, "include")]
+OUT_DIR = os.path.join(ROOT, "src", "fonts")
+LV_CONF = os.path.join(ROOT, "include", "lv_conf.h")
+HEADER_NAME = "lv_font_subset.h"
+SIZES_NAME = "sizes.txt"
+
+# LVGL ships its built-in fonts' sources here once PlatformIO has fetched it
+DEFAULT_FONT_DIR = os.path.join(ROOT, ".pio", "libdeps", "esp32-c6", "lvgl",
+                                "scripts", "built_in_font")
+TEXT_FONT = "Montserrat-Medium.ttf"
+SYMBOL_FONT = "FontAwesome5-Solid+Brands+Regular.woff"
+
+# Fallback for LV_SYMBOL_* code points when lv_symbol_def.h is not available
+KNOWN_SYMBOLS = {
+    "REFRESH": 0xF021,
+    "WIFI": 0xF1EB,
+    "WARNING": 0xF071,
+    "OK": 0xF00C,
+    "CLOSE": 0xF00D,
+    "SETTINGS": 0xF013,
+    "BELL": 0xF0F3,
+    "GPS": 0xF124,
+    "UP": 0xF077,
+    "DOWN": 0xF078,
+    "LEFT": 0xF053,
+    "RIGHT": 0xF054,
+}
+
+STRING_RE = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+FONT_RE = re.compile(r"\blv_font_montserrat_(\d+)\b")
+SYMBOL_RE = re.compile(r"\bLV_SYMBOL_([A-Z0-9_]+)\b")
+SYMBOL_DEF_RE = re.compile(r'#define\s+LV_SYMBOL_([A-Z0-9_]+)\s+"((?:\\x[0-9A-Fa-f]{2})+)"')
+DEFAULT_FONT_RE = re.compile(r"^#define\s+LV_FONT_DEFAULT\s+&lv_font_montserrat_(\d+)", re.M)
+
+
+def source_files(out_dir):
+    for base in SCAN_DIRS:
+        for dirpath, _, names in os.walk(base):
+            if os.path.abspath(dirpath).startswith(os.path.abspath(out_dir)):
+                continue  # Never scan our own output
+            for name in names:
+                if name.endswith((".c", ".h")) and name != "lv_conf.h":
+                    yield os.path.join(dirpath, name)
+
+
+def decode_literal(body):
+    """Decode a C string literal body (UTF-8 source, C escapes) to text."""
+    raw = bytearray()
+    i = 0
+    data = body.encode("utf-8")
+    while i < len(data):
+        c = data[i]
+        if c == 0x5C and i + 1 < len(data):  # backslash
+            n = chr(data[i + 1])
+            if n == "x":
+                j = i + 2
+                while j < len(data) and chr(data[j]) in "0123456789abcdefABCDEF":
+                    j += 1
+                raw.append(int(data[i + 2:j], 16) & 0xFF)
+                i = j
+                continue
+            raw.extend({"n": b"\n", "t": b"\t", "r": b"\r", "0": b""}.get(n, n.encode()))
+            i += 2
+            continue
+        raw.append(c)
+        i += 1
+    return raw.decode("utf-8", errors="ignore")
+
+
+def load_symbol_table(font_dir):
+    header = os.path.join(font_dir, "..", "..", "src", "font", "lv_symbol_def.h")
+    table = dict(KNOWN_SYMBOLS)
+    if os.path.exists(header):
+        with open(header, encoding="utf-8") as f:
+            for name, esc in SYMBOL_DEF_RE.findall(f.read()):
+                text = bytes(int(h, 16) for h in esc.split("\\x")[1:]).decode("utf-8")
+                table[name] = ord(text)
+    return table
+
+
+def scan(symbol_table, out_dir):
+    sizes, chars, symbols = set(), set(), set()
+
+    # lv_conf.h names every size, so only its default font is taken from it
+    with open(LV_CONF, encoding="utf-8") as f:
+        sizes.update(int(s) for s in DEFAULT_FONT_RE.findall(f.read()))
+
+    for path in source_files(out_dir):
+        with open(path, encoding="utf-8", errors="ignore") as f:
+            text = f.read()
+        sizes.update(int(s) for s in FONT_RE.findall(text))
+        for body in STRING_RE.findall(text):
+            chars.update(decode_literal(body))
+        for name in SYMBOL_RE.findall(text):
+            if name not in symbol_table:
+                sys.exit(f"error: unknown LV_SYMBOL_{name} in {path}, add it to KNOWN_SYMBOLS")
+            symbols.add(symbol_table[name])
+
+    # Keep the text font to what Montserrat covers; symbols come from FontAwesome
+    chars = {c for c in chars if c.isprintable() and ord(c) < 0xF000}
+    chars.update(chr(c) for c in range(0x20, 0x7F))
+    return sorted(sizes), sorted(ord(c) for c in chars), sorted(symbols)
+
+
+def to_ranges(codepoints):
+    """Collapse sorted code points into lv_font_conv range syntax."""
+    ranges, start, prev = [], None, None
+    for cp in codepoints:
+        if start is None:
+            start = prev = cp
+        elif cp == prev + 1:
+            prev = cp
+        else:
+            ranges.append((start, prev))
+            start = prev = cp
+    if start is not None:
+        ranges.append((start, prev))
+    return ",".join(f"0x{a:X}" if a == b else f"0x{a:X}-0x{b:X}" for a, b in ranges)
+
+
+def write_if_changed(path, text):
+    """Write text unless the file already holds it (keeps mtimes stable)."""
+    if os.path.exists(path):
+        with open(path, encoding="utf-8") as f:
+            if f.read() == text:
+                return False
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(text)
+    return True
+
+
+def write_header(out_dir, sizes):
+    lines = [
+        "// Generated by tools/gen_subset_fonts.py from the same scan as the fonts",
+        "// next to it. Do not edit.",
+        "#ifndef LV_FONT_SUBSET_H",
+        "#define LV_FONT_SUBSET_H",
+        "",
+        "#define LV_FONT_CUSTOM_DECLARE \\",
+    ]
+    lines += [f"    LV_FONT_DECLARE(lv_font_montserrat_{s}) \\" for s in sizes]
+    lines += ["", "#endif // LV_FONT_SUBSET_H", ""]
+    write_if_changed(os.path.join(out_dir, HEADER_NAME), "\n".join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--bpp", type=int, default=4, choices=(1, 2, 3, 4, 8),
+                        help="bits per pixel (built-in fonts use 4; 2 roughly halves bitmaps)")
+    parser.add_argument("--font-dir", default=DEFAULT_FONT_DIR,
+                        help="directory holding Montserrat and FontAwesome sources")
+    parser.add_argument("--out-dir", default=OUT_DIR,
+                        help="where the fonts, lv_font_subset.h and sizes.txt go")
+    parser.add_argument("--list-sizes", action="store_true",
+                        help="record and print the sizes (;-separated) without generating")
+    parser.add_argument("--dry-run", action="store_true",
+                        help="print the glyph set and commands without running them")
+    args = parser.parse_args()
+
+    sizes, text_cps, symbol_cps = scan(load_symbol_table(args.font_dir), args.out_dir)
+    if not sizes:
+        sys.exit("error: no lv_font_montserrat_N references found")
+
+    sizes_text = ";".join(map(str, sizes)) + "\n"
+    sizes_path = os.path.join(args.out_dir, SIZES_NAME)
+    if args.list_sizes:
+        os.makedirs(args.out_dir, exist_ok=True)
+        write_if_changed(sizes_path, sizes_text)
+        print(sizes_text.strip())
+        return
+
+    print(f"sizes:   {' '.join(map(str, sizes))}")
+    print(f"glyphs:  {len(text_cps)} text + {len(symbol_cps)} symbols")
+
+    conv = shutil.which("lv_font_conv")
+    base_cmd = [conv] if conv else ["npx", "--yes", "lv_font_conv"]
+    if not args.dry_run:
+        os.makedirs(args.out_dir, exist_ok=True)
+
+    for size in sizes:
+        name = f"lv_font_montserrat_{size}"
+        cmd = base_cmd + [
+            "--no-compress", "--no-prefilter",
+            "--bpp", str(args.bpp), "--size", str(size), "--format", "lvgl",
+            "--lv-include", "lvgl.h", "--lv-font-name", name,
+            "--font", os.path.join(args.font_dir, TEXT_FONT), "-r", to_ranges(text_cps),
+        ]
+        if symbol_cps:
+            cmd += ["--font", os.path.join(args.font_dir, SYMBOL_FONT), "-r", to_ranges(symbol_cps)]
+        cmd += ["-o", os.path.join(args.out_dir, name + ".c")]
+
+        if args.dry_run:
+            print(" ".join(cmd))
+            continue
+        print(f"generating {name}.c")
+        subprocess.run(cmd, check=True)
+
+    if args.dry_run:
+        return
+    write_header(args.out_dir, sizes)
+
+    # The build's source list came from the configure-time scan; a new size
+    # needs a reconfigure, which the changed sizes.txt triggers
+    if write_if_changed(sizes_path, sizes_text) and os.environ.get("GEN_FONTS_FROM_BUILD"):
+        sys.exit("font sizes changed (now " + sizes_text.strip() + "), build again to reconfigure")
+    print("done")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""
+Minify and gzip the web dashboard for embedding in flash.
+
+Reads index.html, app.css and app.js from src/web/ and writes, for each,
+<name>.gz (gzip, mtime 0 so builds are reproducible) and <name>.etag (a
+quoted strong ETag from a SHA-256 of the gzip bytes) into the output
+directory. index.html's references to /app.css and /app.js get a ?v=<hash>
+suffix, so those two can be cached as immutable and only the small page
+itself is revalidated.
+
+Run by src/CMakeLists.txt at build time:
+    python3 tools/pack_dashboard.py <src/web> <out_dir>
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+ASSETS = ["app.css", "app.js"]   # Packed first so index.html can reference their hashes
+PAGE = "index.html"
+
+
+def minify(name, text):
+    """Conservative minify: drop indentation, blank lines and whole-line
+    comments. Never rewrites inside a line, so strings and template literals
+    stay intact."""
+    out = []
+    in_block_comment = False
+    for line in text.splitlines():
+        line = line.strip()
+        if name.endswith(".css"):
+            if in_block_comment:
+                if "*/" in line:
+                    in_block_comment = False
+                continue
+            if line.startswith("/*"):
+                in_block_comment = "*/" not in line
+                continue
+        elif name.endswith(".js") and line.startswith("//"):
+            continue
+        if line:
+            out.append(line)
+    return "\n".join(out) + "\n"
+
+
+def pack(name, text, out_dir):
+    raw = minify(name, text).encode("utf-8")
+    gz = gzip.compress(raw, compresslevel=9, mtime=0)
+    digest = hashlib.sha256(gz).hexdigest()[:16]
+
+    with open(os.path.join(out_dir, name + ".gz"), "wb") as f:
+        f.write(gz)
+    with open(os.path.join(out_dir, name + ".etag"), "w") as f:
+        f.write(f'"{digest}"')
+
+    print(f"{name}: {len(text.encode('utf-8'))} -> {len(raw)} minified -> {len(gz)} gzip")
+    return digest
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(f"usage: {sys.argv[0]} <web_src_dir> <out_dir>")
+    src_dir, out_dir = sys.argv[1], sys.argv[2]
+    os.makedirs(out_dir, exist_ok=True)
+
+    hashes = {}
+    for name in ASSETS:
+        with open(os.path.join(src_dir, name), encoding="utf-8") as f:
+            hashes[name] = pack(name, f.read(), out_dir)
+
+    with open(os.path.join(src_dir, PAGE), encoding="utf-8") as f:
+        page = f.read()
+    for name, digest in hashes.items():
+        page, count = re.subn(rf'"/{re.escape(name)}"', f'"/{name}?v={digest}"', page)
+        if count == 0:
+            sys.exit(f"error: {PAGE} does not reference /{name}")
+    pack(PAGE, page, out_dir)
+
+
+if __name__ == "__main__":
+    main()